@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+""" Generates src/saline_base_table.h, the precomputed Ed25519 base-point
+tables used by saline's fixed-base scalar multiplication. Every entry is an
+affine point in Niels form (y + x, y - x, 2 * d * x * y), with each field
+element written as sixteen 16-bit little-endian limbs (saline's gf layout).
+
+Usage: gen_base_table.py > src/saline_base_table.h """
+
+import sys
+
+P = 2**255 - 19
+D = (-121665 * pow(121666, P - 2, P)) % P
+BASE_Y = (4 * pow(5, P - 2, P)) % P
+
+
+def recover_x(y, sign):
+    """ Recovers the x-coordinate of a point from y and the sign of x. """
+
+    xx = (y * y - 1) * pow(D * y * y + 1, P - 2, P)
+    x = pow(xx, (P + 3) // 8, P)
+
+    if (x * x - xx) % P != 0:
+        x = (x * pow(2, (P - 1) // 4, P)) % P
+
+    if x & 1 != sign:
+        x = P - x
+
+    return x
+
+
+def add(a, b):
+    """ Adds two affine points on the twisted Edwards curve. """
+
+    (x1, y1), (x2, y2) = a, b
+    t = D * x1 * x2 * y1 * y2
+    x3 = (x1 * y2 + x2 * y1) * pow(1 + t, P - 2, P)
+    y3 = (y1 * y2 + x1 * x2) * pow(1 - t, P - 2, P)
+    return (x3 % P, y3 % P)
+
+
+def niels(point):
+    """ Converts an affine point to (y + x, y - x, 2dxy). """
+
+    x, y = point
+    return ((y + x) % P, (y - x) % P, (2 * D * x * y) % P)
+
+
+def limbs(value):
+    """ Splits a field element into saline's sixteen 16-bit limbs. """
+
+    return [(value >> (16 * k)) & 0xffff for k in range(16)]
+
+
+def format_entry(point, indent):
+    """ Formats a Niels point as a C initializer. """
+
+    lines = []
+
+    for element in niels(point):
+        words = ["0x%04x" % x for x in limbs(element)]
+        lines.append(indent + "{" + ", ".join(words[0:8]) + ",")
+        lines.append(indent + " " + ", ".join(words[8:16]) + "},")
+
+    lines[-1] = lines[-1][:-1]
+    return lines
+
+
+def main():
+    """ Writes the base-point tables to stdout. """
+
+    base = (recover_x(BASE_Y, 0), BASE_Y)
+    out = sys.stdout
+
+    out.write("/* Generated by scripts/gen_base_table.py. Do not edit. */\n\n")
+    out.write("/* base_table[i][j] = (j + 1) * 256^i * B */\n\n")
+    out.write("static const uint16_t base_table[32][8][3][16] = {\n")
+
+    row = base
+    for i in range(32):
+        out.write("    {\n")
+        point = row
+
+        for j in range(8):
+            entry = format_entry(point, " " * 9)
+            entry[-1] += "}" if j == 7 else "},"
+            entry[0] = "        {" + entry[0].lstrip()
+            out.write("\n".join(entry) + "\n")
+            point = add(point, row)
+
+        out.write("    }" + ("\n" if i == 31 else ",\n"))
+
+        for _ in range(8):
+            row = add(row, row)
+
+    out.write("};\n\n")
+    out.write("/* base_odd[i] = (2 * i + 1) * B */\n\n")
+    out.write("static const uint16_t base_odd[32][3][16] = {\n")
+
+    point = base
+    double = add(base, base)
+    for i in range(32):
+        entry = format_entry(point, " " * 5)
+        entry[-1] += "}" if i == 31 else "},"
+        entry[0] = "    {" + entry[0].lstrip()
+        out.write("\n".join(entry) + "\n")
+        point = add(point, double)
+
+    out.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,221 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "config.h"
+#include "saline.h"
+
+#if defined HAVE_SYS_MMAN_H
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* The slots live in one mapping: a guard page, the slab, and another guard
+ * page. Only the slab is readable, and it is locked when the arena is
+ * created, so handing slots out and back makes no system calls. Free slots
+ * form a Treiber stack of indices. 'head' packs the index of the top slot
+ * below a tag that every push and pop bumps, so a pop that read a stale
+ * 'next' can't succeed after the slot was taken and put back (ABA). The
+ * links sit in 'next', outside the slab, so a slot holds nothing but key
+ * material. 'used' catches double frees before they corrupt the stack. */
+
+#define ARENA_EMPTY UINT32_MAX
+
+enum {
+    ARENA_ALIGN = 16,
+    ARENA_MASK = ARENA_ALIGN - 1
+};
+
+struct saline_arena {
+    uint64_t head;
+    uint32_t *next;
+    uint8_t *used;
+    unsigned char *slab;
+    unsigned char *map;
+    size_t map_bytes;
+    size_t slab_bytes;
+    size_t slot_bytes;
+    uint32_t slots;
+};
+
+static void arena_wipe(unsigned char *p, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        ((volatile unsigned char *) p)[i] = 0;
+    }
+}
+
+static uint64_t arena_link(uint64_t head, uint32_t index)
+{
+    return (((head >> 32) + 1) << 32) | index;
+}
+
+saline_arena *saline_arena_create(unsigned int slot_bytes, unsigned int slots)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    saline_arena *arena;
+    size_t size, body;
+
+    if (page <= 0 || slot_bytes == 0 || slots == 0 || slots == ARENA_EMPTY) {
+        return 0;
+    }
+
+    size = ((size_t) slot_bytes + ARENA_ALIGN - 1) & ~(size_t) ARENA_MASK;
+
+    if (size < slot_bytes || size > (SIZE_MAX - 3 * (size_t) page) / slots) {
+        return 0;
+    }
+
+    body = (size * slots + (size_t) page - 1) & ~((size_t) page - 1);
+    arena = calloc(1, sizeof(*arena));
+
+    if (arena == 0) {
+        return 0;
+    }
+
+    arena->next = malloc(slots * sizeof(*arena->next));
+    arena->used = calloc(slots, sizeof(*arena->used));
+    arena->map_bytes = body + 2 * (size_t) page;
+    arena->map = mmap(0, arena->map_bytes, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (arena->next == 0 || arena->used == 0 || arena->map == MAP_FAILED) {
+        arena->map = (arena->map == MAP_FAILED) ? 0 : arena->map;
+        saline_arena_destroy(arena);
+        return 0;
+    }
+
+    arena->slab = arena->map + page;
+    arena->slot_bytes = size;
+    arena->slots = slots;
+
+    if (mprotect(arena->slab, body, PROT_READ | PROT_WRITE) != 0) {
+        saline_arena_destroy(arena);
+        return 0;
+    }
+
+    arena->slab_bytes = body;
+
+    if (mlock(arena->slab, body) != 0) {
+        saline_arena_destroy(arena);
+        return 0;
+    }
+
+#if defined MADV_DONTDUMP
+    madvise(arena->slab, body, MADV_DONTDUMP);
+#endif
+
+    for (uint32_t i = 0; i < slots; ++i) {
+        arena->next[i] = (i + 1 < slots) ? i + 1 : ARENA_EMPTY;
+    }
+
+    arena->head = 0;
+    return arena;
+}
+
+void *saline_arena_alloc(saline_arena *arena)
+{
+    uint64_t head, fresh;
+    uint32_t index;
+
+    if (arena == 0) {
+        return 0;
+    }
+
+    head = __atomic_load_n(&arena->head, __ATOMIC_ACQUIRE);
+
+    do {
+        index = (uint32_t) head;
+
+        if (index == ARENA_EMPTY) {
+            return 0;
+        }
+
+        fresh = arena_link(head, __atomic_load_n(&arena->next[index],
+                                                 __ATOMIC_RELAXED));
+    } while (!__atomic_compare_exchange_n(&arena->head, &head, fresh, 0,
+                                          __ATOMIC_ACQUIRE,
+                                          __ATOMIC_ACQUIRE));
+
+    __atomic_store_n(&arena->used[index], 1, __ATOMIC_RELAXED);
+    return arena->slab + index * arena->slot_bytes;
+}
+
+int saline_arena_free(saline_arena *arena, void *slot)
+{
+    unsigned char *p = slot;
+    uint64_t head;
+    uintptr_t offset;
+    uint32_t index;
+
+    if (arena == 0) {
+        return -1;
+    }
+
+    offset = (uintptr_t) p - (uintptr_t) arena->slab;
+    index = (uint32_t) (offset / arena->slot_bytes);
+
+    if (offset >= arena->slots * arena->slot_bytes ||
+        offset % arena->slot_bytes != 0 ||
+        __atomic_exchange_n(&arena->used[index], 0, __ATOMIC_RELAXED) == 0) {
+        return -1;
+    }
+
+    arena_wipe(p, arena->slot_bytes);
+    head = __atomic_load_n(&arena->head, __ATOMIC_RELAXED);
+
+    do {
+        __atomic_store_n(&arena->next[index], (uint32_t) head,
+                         __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&arena->head, &head,
+                                          arena_link(head, index), 0,
+                                          __ATOMIC_RELEASE,
+                                          __ATOMIC_RELAXED));
+
+    return 0;
+}
+
+void saline_arena_destroy(saline_arena *arena)
+{
+    if (arena == 0) {
+        return;
+    }
+
+    if (arena->map != 0) {
+        arena_wipe(arena->slab, arena->slab_bytes);
+        munlock(arena->slab, arena->slab_bytes);
+        munmap(arena->map, arena->map_bytes);
+    }
+
+    free(arena->next);
+    free(arena->used);
+    free(arena);
+}
+
+#else
+
+saline_arena *saline_arena_create(unsigned int slot_bytes, unsigned int slots)
+{
+    (void) slot_bytes;
+    (void) slots;
+    return 0;
+}
+
+void *saline_arena_alloc(saline_arena *arena)
+{
+    (void) arena;
+    return 0;
+}
+
+int saline_arena_free(saline_arena *arena, void *slot)
+{
+    (void) arena;
+    (void) slot;
+    return -1;
+}
+
+void saline_arena_destroy(saline_arena *arena)
+{
+    (void) arena;
+}
+
+#endif
@@ -0,0 +1,487 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "config.h"
+#include "parallel.h"
+#include "saline.h"
+#include "stats.h"
+#include "treehash.h"
+
+#if defined SALINE_USE_THREADS
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#if defined HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+
+/* Submitted jobs wait on the pool's shared injection queue. Each worker also
+ * owns a deque for the sub-tasks of jobs it splits: it pushes and takes them
+ * at the front, so it works through its own split in order, while idle
+ * workers steal from the back. A worker looks in its own deque first, then
+ * the injection queue, then the other deques, and sleeps when all are empty.
+ * 'queued' counts the tasks in all of them and may dip below zero while a
+ * push is being counted. The pool lock guards the injection queue, the
+ * completion queue and the counts; each deque has its own lock. */
+
+enum {
+    ASYNC_LEAVES = -1,
+    ASYNC_SPLIT_PER_THREAD = 4
+};
+
+struct async_list {
+    saline_async_job *front;
+    saline_async_job *back;
+};
+
+struct async_worker {
+    saline_async *pool;
+    pthread_t id;
+    pthread_mutex_t lock;
+    struct async_list deque;
+    unsigned int index;
+};
+
+struct saline_async {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    struct async_list injector;
+    struct async_list done;
+    long queued;
+    unsigned long long inflight;
+    int stop;
+    int fds[2];
+    unsigned int threads;
+    struct async_worker workers[PARALLEL_MAX_THREADS];
+};
+
+/* A split tree hash: the tree, its leaf count, and one sub-task per range of
+ * leaves. The job's 'pending' counts the sub-tasks still running. */
+
+struct async_split {
+    struct saline_tree tree;
+    unsigned long long count;
+    saline_async_job tasks[];
+};
+
+static void async_push(struct async_list *list, saline_async_job *job,
+                       int front)
+{
+    if (front) {
+        job->prev = 0;
+        job->next = list->front;
+        *(list->front ? &list->front->prev : &list->back) = job;
+        list->front = job;
+    } else {
+        job->next = 0;
+        job->prev = list->back;
+        *(list->back ? &list->back->next : &list->front) = job;
+        list->back = job;
+    }
+}
+
+static saline_async_job *async_pop(struct async_list *list, int front)
+{
+    saline_async_job *job = front ? list->front : list->back;
+
+    if (job == 0) {
+        return 0;
+    }
+
+    if (front) {
+        list->front = job->next;
+        *(list->front ? &list->front->prev : &list->back) = 0;
+    } else {
+        list->back = job->prev;
+        *(list->back ? &list->back->next : &list->front) = 0;
+    }
+
+    return job;
+}
+
+static void async_notify(saline_async *pool)
+{
+#if defined HAVE_SYS_EVENTFD_H
+    uint64_t one = 1;
+#else
+    unsigned char one = 1;
+#endif
+
+    /* A full counter or pipe is already readable, so a failure is harmless. */
+
+    if (write(pool->fds[1], &one, sizeof(one)) < 0) {
+        return;
+    }
+}
+
+static void async_complete(saline_async *pool, saline_async_job *job)
+{
+    if (job->callback != 0) {
+        job->callback(job, job->arg);
+        pthread_mutex_lock(&pool->lock);
+    } else {
+        pthread_mutex_lock(&pool->lock);
+        async_push(&pool->done, job, 0);
+        async_notify(pool);
+    }
+
+    if (--pool->inflight == 0) {
+        pthread_cond_broadcast(&pool->idle);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Splits a tree hash into ranges of leaves on the worker's own deque. Small
+ * trees, and trees whose sub-tasks can't be allocated, are hashed here. */
+
+static void async_split(struct async_worker *w, saline_async_job *job)
+{
+    saline_async *pool = w->pool;
+    struct saline_tree tree;
+    struct async_split *split;
+    unsigned long long count, parts;
+
+    SALINE_STAT_CALL(hash_tree, job->in_length);
+    count = saline_tree_init(&tree, job->in, job->in_length,
+                             job->chunk_length);
+
+    if (count == 0) {
+        job->result = -1;
+        async_complete(pool, job);
+        return;
+    }
+
+    parts = (unsigned long long) pool->threads * ASYNC_SPLIT_PER_THREAD;
+    parts = (count < parts) ? count : parts;
+    split = (parts > 1) ? malloc(sizeof(*split) + parts * sizeof(*job)) : 0;
+
+    if (split == 0) {
+        saline_tree_hash_leaves(&tree, 0, count);
+        job->result = saline_tree_finish(job->out, &tree, count);
+        async_complete(pool, job);
+        return;
+    }
+
+    split->tree = tree;
+    split->count = count;
+    job->scratch = split;
+    job->pending = parts;
+
+    pthread_mutex_lock(&w->lock);
+
+    for (unsigned long long i = parts; i-- > 0;) {
+        saline_async_job *task = &split->tasks[i];
+
+        task->op = ASYNC_LEAVES;
+        task->parent = job;
+        task->begin = count * i / parts;
+        task->end = count * (i + 1) / parts;
+        async_push(&w->deque, task, 1);
+    }
+
+    pthread_mutex_unlock(&w->lock);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->queued += (long) parts;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Hashes one range of a split tree. The last range to finish builds the root
+ * and completes the job. */
+
+static void async_leaves(struct async_worker *w, saline_async_job *task)
+{
+    saline_async_job *job = task->parent;
+    struct async_split *split = job->scratch;
+
+    saline_tree_hash_leaves(&split->tree, task->begin, task->end);
+
+    if (__atomic_sub_fetch(&job->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+        job->result = saline_tree_finish(job->out, &split->tree,
+                                         split->count);
+        job->scratch = 0;
+        free(split);
+        async_complete(w->pool, job);
+    }
+}
+
+static void async_run(struct async_worker *w, saline_async_job *job)
+{
+    const unsigned char *in = job->in;
+    unsigned long long n = job->in_length;
+
+    switch (job->op) {
+    case saline_async_BOX:
+        job->result = crypto_box(job->out, in, n, job->nonce, job->peer_key,
+                                 job->key);
+        break;
+    case saline_async_BOX_OPEN:
+        job->result = crypto_box_open(job->out, in, n, job->nonce,
+                                      job->peer_key, job->key);
+        break;
+    case saline_async_SECRETBOX:
+        job->result = crypto_secretbox(job->out, in, n, job->nonce, job->key);
+        break;
+    case saline_async_SECRETBOX_OPEN:
+        job->result = crypto_secretbox_open(job->out, in, n, job->nonce,
+                                            job->key);
+        break;
+    case saline_async_SIGN:
+        job->result = crypto_sign(job->out, job->out_length, in, n, job->key);
+        break;
+    case saline_async_SIGN_OPEN:
+        job->result = crypto_sign_open(job->out, job->out_length, in, n,
+                                       job->key);
+        break;
+    case saline_async_HASH:
+        if (job->chunk_length != 0) {
+            async_split(w, job);
+            return;
+        }
+
+        job->result = crypto_hash(job->out, in, n);
+        break;
+    case ASYNC_LEAVES:
+        async_leaves(w, job);
+        return;
+    }
+
+    async_complete(w->pool, job);
+}
+
+static saline_async_job *async_take(struct async_worker *w)
+{
+    saline_async *pool = w->pool;
+    saline_async_job *job;
+
+    pthread_mutex_lock(&w->lock);
+    job = async_pop(&w->deque, 1);
+    pthread_mutex_unlock(&w->lock);
+
+    pthread_mutex_lock(&pool->lock);
+
+    if (job == 0) {
+        job = async_pop(&pool->injector, 1);
+    }
+
+    pool->queued -= (job != 0);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (unsigned int i = 1; i < pool->threads && job == 0; ++i) {
+        struct async_worker *victim =
+            &pool->workers[(w->index + i) % pool->threads];
+
+        pthread_mutex_lock(&victim->lock);
+        job = async_pop(&victim->deque, 0);
+        pthread_mutex_unlock(&victim->lock);
+
+        if (job != 0) {
+            pthread_mutex_lock(&pool->lock);
+            --pool->queued;
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+
+    return job;
+}
+
+static void *async_worker_main(void *arg)
+{
+    struct async_worker *w = arg;
+    saline_async *pool = w->pool;
+
+    for (;;) {
+        saline_async_job *job = async_take(w);
+        int stop;
+
+        if (job != 0) {
+            async_run(w, job);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+
+        while (pool->queued <= 0 && !pool->stop) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+
+        stop = (pool->queued <= 0);
+        pthread_mutex_unlock(&pool->lock);
+
+        if (stop) {
+            return 0;
+        }
+    }
+}
+
+static int async_open_fds(int fds[2])
+{
+#if defined HAVE_SYS_EVENTFD_H
+    fds[0] = fds[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return (fds[0] < 0) ? -1 : 0;
+#else
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    return 0;
+#endif
+}
+
+/* Stops and joins the first 'started' workers, then frees the pool. */
+
+static void async_free(saline_async *pool, unsigned int started)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (unsigned int t = 0; t < started; ++t) {
+        pthread_join(pool->workers[t].id, 0);
+    }
+
+    for (unsigned int t = 0; t < pool->threads; ++t) {
+        pthread_mutex_destroy(&pool->workers[t].lock);
+    }
+
+    if (pool->fds[1] != pool->fds[0]) {
+        close(pool->fds[1]);
+    }
+
+    close(pool->fds[0]);
+    pthread_cond_destroy(&pool->idle);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+saline_async *saline_async_create(unsigned int threads)
+{
+    saline_async *pool = calloc(1, sizeof(*pool));
+
+    if (pool == 0) {
+        return 0;
+    }
+
+    if (async_open_fds(pool->fds) != 0) {
+        free(pool);
+        return 0;
+    }
+
+    pthread_mutex_init(&pool->lock, 0);
+    pthread_cond_init(&pool->wake, 0);
+    pthread_cond_init(&pool->idle, 0);
+    pool->threads = saline_parallel_threads(threads);
+
+    for (unsigned int t = 0; t < pool->threads; ++t) {
+        pool->workers[t].pool = pool;
+        pool->workers[t].index = t;
+        pthread_mutex_init(&pool->workers[t].lock, 0);
+    }
+
+    for (unsigned int t = 0; t < pool->threads; ++t) {
+        if (pthread_create(&pool->workers[t].id, 0, async_worker_main,
+                           &pool->workers[t]) != 0) {
+            async_free(pool, t);
+            return 0;
+        }
+    }
+
+    return pool;
+}
+
+int saline_async_submit(saline_async *pool, saline_async_job *job)
+{
+    if (pool == 0 || job->op < saline_async_BOX ||
+        job->op > saline_async_HASH) {
+        return -1;
+    }
+
+    job->parent = 0;
+    job->scratch = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    ++pool->inflight;
+    ++pool->queued;
+    async_push(&pool->injector, job, 0);
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+int saline_async_fd(saline_async *pool)
+{
+    return (pool != 0) ? pool->fds[0] : -1;
+}
+
+saline_async_job *saline_async_poll(saline_async *pool)
+{
+    saline_async_job *job;
+
+    if (pool == 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    job = async_pop(&pool->done, 1);
+    pthread_mutex_unlock(&pool->lock);
+    return job;
+}
+
+void saline_async_destroy(saline_async *pool)
+{
+    if (pool == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+
+    while (pool->inflight > 0) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    async_free(pool, pool->threads);
+}
+
+#else
+
+saline_async *saline_async_create(unsigned int threads)
+{
+    (void) threads;
+    return 0;
+}
+
+int saline_async_submit(saline_async *pool, saline_async_job *job)
+{
+    (void) pool;
+    (void) job;
+    return -1;
+}
+
+int saline_async_fd(saline_async *pool)
+{
+    (void) pool;
+    return -1;
+}
+
+saline_async_job *saline_async_poll(saline_async *pool)
+{
+    (void) pool;
+    return 0;
+}
+
+void saline_async_destroy(saline_async *pool)
+{
+    (void) pool;
+}
+
+#endif
@@ -0,0 +1,553 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+
+#ifdef USE_SALINE
+#include "saline.h"
+#define BENCH_LIBRARY "saline"
+#define BENCH_VERSION PACKAGE_VERSION
+#else
+#include <sodium.h>
+#define BENCH_LIBRARY "libsodium"
+#define BENCH_VERSION sodium_version_string()
+#endif
+
+#ifdef BENCH_HPP
+#include "bench_hpp.h"
+#undef BENCH_LIBRARY
+#define BENCH_LIBRARY "saline.hpp"
+#endif
+
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#define BENCH_CYCLE_COUNTER "\"tsc\""
+#else
+#define BENCH_CYCLE_COUNTER "null"
+#endif
+
+/* Throughput and latency benchmark for every public primitive. The same
+ * source is built against libsaline and, when configured, libsodium; each
+ * binary prints one JSON object on stdout, and 'make bench' collects them.
+ *
+ * For each (primitive, size) point the operation is warmed up for
+ * BENCH_WARMUP_NS, then timed in samples of 'inner' back-to-back calls so
+ * that one sample lasts at least BENCH_SAMPLE_NS. Medians and 99th
+ * percentiles are per call. Cycle counts come from the TSC where there is
+ * one; it ticks at the reference clock, so pin the frequency (or disable
+ * turbo) for cycle figures that compare across runs. */
+
+enum {
+    BENCH_MAX_SAMPLES = 201,
+    BENCH_MIN_SAMPLES = 5,
+    BENCH_PAD = 64
+};
+
+static const double BENCH_WARMUP_NS = 10e6;
+static const double BENCH_SAMPLE_NS = 50e3;
+
+static const unsigned long long bench_sizes[] = {
+    0, 16, 64, 256, 1024, 4096, 16384, 65536, 1048576, 16777216
+};
+
+struct bench_case {
+    const char *name;
+    int sized;
+    void (*setup)(unsigned long long size);
+    int (*run)(unsigned long long size);
+};
+
+static unsigned char *msg, *out, *aux;
+static unsigned long long out_length;
+
+static unsigned char key[32], nonce[24], shared[32];
+static unsigned char box_pk[32], box_sk[32], peer_pk[32], peer_sk[32];
+static unsigned char sign_pk[32], sign_sk[64], tag[64];
+static unsigned char new_pk[32], new_sk[64];
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static double bench_cycles(void)
+{
+#ifdef BENCH_HAVE_TSC
+    return (double) __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void setup_none(unsigned long long size)
+{
+    (void) size;
+}
+
+static void setup_auth(unsigned long long size)
+{
+    crypto_auth(tag, msg, size, key);
+}
+
+static void setup_onetimeauth(unsigned long long size)
+{
+    crypto_onetimeauth(tag, msg, size, key);
+}
+
+/* The NaCl box and secretbox APIs take crypto_secretbox_ZEROBYTES of zero
+ * padding in front of the message, so 'size' counts only the payload. */
+
+static void setup_secretbox(unsigned long long size)
+{
+    memset(msg, 0, crypto_secretbox_ZEROBYTES);
+    crypto_secretbox(aux, msg, size + crypto_secretbox_ZEROBYTES, nonce, key);
+}
+
+static void setup_box(unsigned long long size)
+{
+    memset(msg, 0, crypto_box_ZEROBYTES);
+    crypto_box(aux, msg, size + crypto_box_ZEROBYTES, nonce, peer_pk,
+               box_sk);
+}
+
+/* The detached calls write the authenticator and cypher text separately;
+ * this lays them out as saline.hpp's combined forms expect, the
+ * authenticator first. */
+
+static void setup_secretbox_detached(unsigned long long size)
+{
+    crypto_secretbox_detached(aux + crypto_secretbox_MACBYTES, aux, msg, size,
+                              nonce, key);
+}
+
+static void setup_box_detached(unsigned long long size)
+{
+    crypto_box_detached(aux + crypto_box_MACBYTES, aux, msg, size, nonce,
+                        peer_pk, box_sk);
+}
+
+static void setup_sign_detached(unsigned long long size)
+{
+    crypto_sign_detached(tag, 0, msg, size, sign_sk);
+}
+
+static void setup_sign(unsigned long long size)
+{
+    crypto_sign(aux, &out_length, msg, size, sign_sk);
+}
+
+static int run_hash(unsigned long long size)
+{
+    return crypto_hash(out, msg, size);
+}
+
+static int run_auth(unsigned long long size)
+{
+    return crypto_auth(out, msg, size, key);
+}
+
+static int run_auth_verify(unsigned long long size)
+{
+    return crypto_auth_verify(tag, msg, size, key);
+}
+
+static int run_onetimeauth(unsigned long long size)
+{
+    return crypto_onetimeauth(out, msg, size, key);
+}
+
+static int run_onetimeauth_verify(unsigned long long size)
+{
+    return crypto_onetimeauth_verify(tag, msg, size, key);
+}
+
+static int run_stream(unsigned long long size)
+{
+    return crypto_stream(out, size, nonce, key);
+}
+
+static int run_stream_xor(unsigned long long size)
+{
+    return crypto_stream_xor(out, msg, size, nonce, key);
+}
+
+static int run_secretbox(unsigned long long size)
+{
+    return crypto_secretbox(out, msg, size + crypto_secretbox_ZEROBYTES,
+                            nonce, key);
+}
+
+static int run_secretbox_open(unsigned long long size)
+{
+    return crypto_secretbox_open(out, aux, size + crypto_secretbox_ZEROBYTES,
+                                 nonce, key);
+}
+
+static int run_box(unsigned long long size)
+{
+    return crypto_box(out, msg, size + crypto_box_ZEROBYTES, nonce, peer_pk,
+                      box_sk);
+}
+
+static int run_box_open(unsigned long long size)
+{
+    return crypto_box_open(out, aux, size + crypto_box_ZEROBYTES, nonce,
+                           box_pk, peer_sk);
+}
+
+static int run_secretbox_detached(unsigned long long size)
+{
+    return crypto_secretbox_detached(out + crypto_secretbox_MACBYTES, out,
+                                     msg, size, nonce, key);
+}
+
+static int run_secretbox_open_detached(unsigned long long size)
+{
+    return crypto_secretbox_open_detached(out, aux + crypto_secretbox_MACBYTES,
+                                          aux, size, nonce, key);
+}
+
+static int run_box_detached(unsigned long long size)
+{
+    return crypto_box_detached(out + crypto_box_MACBYTES, out, msg, size,
+                               nonce, peer_pk, box_sk);
+}
+
+static int run_box_open_detached(unsigned long long size)
+{
+    return crypto_box_open_detached(out, aux + crypto_box_MACBYTES, aux, size,
+                                    nonce, box_pk, peer_sk);
+}
+
+static int run_box_afternm(unsigned long long size)
+{
+    return crypto_box_afternm(out, msg, size + crypto_box_ZEROBYTES, nonce,
+                              shared);
+}
+
+static int run_box_open_afternm(unsigned long long size)
+{
+    return crypto_box_open_afternm(out, aux, size + crypto_box_ZEROBYTES,
+                                   nonce, shared);
+}
+
+static int run_sign(unsigned long long size)
+{
+    unsigned long long length;
+    return crypto_sign(out, &length, msg, size, sign_sk);
+}
+
+static int run_sign_open(unsigned long long size)
+{
+    unsigned long long length;
+    (void) size;
+    return crypto_sign_open(out, &length, aux, out_length, sign_pk);
+}
+
+static int run_sign_detached(unsigned long long size)
+{
+    return crypto_sign_detached(out, 0, msg, size, sign_sk);
+}
+
+static int run_sign_verify_detached(unsigned long long size)
+{
+    return crypto_sign_verify_detached(tag, msg, size, sign_pk);
+}
+
+#ifdef USE_SALINE
+static int run_hash_tree(unsigned long long size)
+{
+    return crypto_hash_tree(out, msg, size, crypto_hash_tree_CHUNKBYTES, 0);
+}
+#endif
+
+static int run_box_keypair(unsigned long long size)
+{
+    (void) size;
+    return crypto_box_keypair(new_pk, new_sk);
+}
+
+static int run_box_beforenm(unsigned long long size)
+{
+    (void) size;
+    return crypto_box_beforenm(out, peer_pk, box_sk);
+}
+
+static int run_scalarmult(unsigned long long size)
+{
+    (void) size;
+    return crypto_scalarmult(out, box_sk, peer_pk);
+}
+
+static int run_scalarmult_base(unsigned long long size)
+{
+    (void) size;
+    return crypto_scalarmult_base(out, box_sk);
+}
+
+static int run_sign_keypair(unsigned long long size)
+{
+    (void) size;
+    return crypto_sign_keypair(new_pk, new_sk);
+}
+
+static int run_verify_16(unsigned long long size)
+{
+    (void) size;
+    return crypto_verify_16(key, key);
+}
+
+static int run_verify_32(unsigned long long size)
+{
+    (void) size;
+    return crypto_verify_32(key, key);
+}
+
+static const struct bench_case bench_cases[] = {
+    {"crypto_hash", 1, setup_none, run_hash},
+#ifdef USE_SALINE
+    {"crypto_hash_tree", 1, setup_none, run_hash_tree},
+#endif
+    {"crypto_auth", 1, setup_none, run_auth},
+    {"crypto_auth_verify", 1, setup_auth, run_auth_verify},
+    {"crypto_onetimeauth", 1, setup_none, run_onetimeauth},
+    {"crypto_onetimeauth_verify", 1, setup_onetimeauth,
+     run_onetimeauth_verify},
+    {"crypto_stream", 1, setup_none, run_stream},
+    {"crypto_stream_xor", 1, setup_none, run_stream_xor},
+    {"crypto_secretbox", 1, setup_secretbox, run_secretbox},
+    {"crypto_secretbox_open", 1, setup_secretbox, run_secretbox_open},
+    {"crypto_box", 1, setup_box, run_box},
+    {"crypto_box_open", 1, setup_box, run_box_open},
+    {"crypto_secretbox_detached", 1, setup_none, run_secretbox_detached},
+    {"crypto_secretbox_open_detached", 1, setup_secretbox_detached,
+     run_secretbox_open_detached},
+    {"crypto_box_detached", 1, setup_none, run_box_detached},
+    {"crypto_box_open_detached", 1, setup_box_detached,
+     run_box_open_detached},
+    {"crypto_box_afternm", 1, setup_box, run_box_afternm},
+    {"crypto_box_open_afternm", 1, setup_box, run_box_open_afternm},
+    {"crypto_sign", 1, setup_none, run_sign},
+    {"crypto_sign_open", 1, setup_sign, run_sign_open},
+    {"crypto_sign_detached", 1, setup_none, run_sign_detached},
+    {"crypto_sign_verify_detached", 1, setup_sign_detached,
+     run_sign_verify_detached},
+    {"crypto_box_keypair", 0, setup_none, run_box_keypair},
+    {"crypto_box_beforenm", 0, setup_none, run_box_beforenm},
+    {"crypto_scalarmult", 0, setup_none, run_scalarmult},
+    {"crypto_scalarmult_base", 0, setup_none, run_scalarmult_base},
+    {"crypto_sign_keypair", 0, setup_none, run_sign_keypair},
+    {"crypto_verify_16", 0, setup_none, run_verify_16},
+    {"crypto_verify_32", 0, setup_none, run_verify_32},
+#ifdef BENCH_HPP
+    {"saline::hash", 1, setup_none, bench_hpp_hash},
+    {"saline::secretbox", 1, setup_none, bench_hpp_secretbox},
+    {"saline::secretbox_open", 1, setup_secretbox_detached,
+     bench_hpp_secretbox_open},
+    {"saline::box", 1, setup_none, bench_hpp_box},
+    {"saline::box_open", 1, setup_box_detached, bench_hpp_box_open},
+    {"saline::sign_detached", 1, setup_none, bench_hpp_sign_detached},
+    {"saline::sign_verify_detached", 1, setup_sign_detached,
+     bench_hpp_sign_verify_detached},
+#endif
+};
+
+/*----------------------------------------------------------------------------*/
+
+static int bench_compare(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/* Sorts 'values' and returns the nearest-rank percentile 'p'. */
+
+static double bench_percentile(double *values, int count, double p)
+{
+    int rank = (int) (p * count + 0.999999);
+
+    qsort(values, (size_t) count, sizeof(double), bench_compare);
+    rank = (rank < 1) ? 1 : (rank > count) ? count : rank;
+    return values[rank - 1];
+}
+
+static int bench_point(const struct bench_case *c, unsigned long long size,
+                       double budget_ns, int first)
+{
+    double ns[BENCH_MAX_SAMPLES], cycles[BENCH_MAX_SAMPLES];
+    double start, elapsed, per_call, median_ns, p99_ns, median_cycles;
+    long long inner = 1, calls = 0;
+    int samples;
+
+    c->setup(size);
+    start = bench_now();
+
+    do {
+        if (c->run(size) != 0) {
+            fprintf(stderr, "%s failed at %llu bytes\n", c->name, size);
+            return -1;
+        }
+
+        ++calls;
+        elapsed = bench_now() - start;
+    } while (elapsed < BENCH_WARMUP_NS);
+
+    per_call = elapsed / (double) calls;
+
+    if (per_call < BENCH_SAMPLE_NS) {
+        inner = (long long) (BENCH_SAMPLE_NS / per_call) + 1;
+    }
+
+    samples = (int) (budget_ns / (per_call * (double) inner));
+    samples = (samples < BENCH_MIN_SAMPLES) ? BENCH_MIN_SAMPLES : samples;
+    samples = (samples > BENCH_MAX_SAMPLES) ? BENCH_MAX_SAMPLES : samples;
+
+    for (int i = 0; i < samples; ++i) {
+        double t0 = bench_now(), c0 = bench_cycles();
+
+        for (long long j = 0; j < inner; ++j) {
+            c->run(size);
+        }
+
+        cycles[i] = (bench_cycles() - c0) / (double) inner;
+        ns[i] = (bench_now() - t0) / (double) inner;
+    }
+
+    median_ns = bench_percentile(ns, samples, 0.5);
+    p99_ns = bench_percentile(ns, samples, 0.99);
+    median_cycles = bench_percentile(cycles, samples, 0.5);
+
+    printf("%s\n    {\"primitive\": \"%s\", \"bytes\": %llu, "
+           "\"samples\": %d, \"calls_per_sample\": %lld,\n     "
+           "\"median_ns\": %.1f, \"p99_ns\": %.1f, \"ops_per_sec\": %.1f",
+           first ? "" : ",", c->name, c->sized ? size : 0, samples, inner,
+           median_ns, p99_ns, 1e9 / median_ns);
+
+    if (c->sized && size > 0) {
+        printf(", \"mib_per_sec\": %.3f",
+               (double) size / median_ns * 1e9 / 1048576.0);
+    }
+
+#ifdef BENCH_HAVE_TSC
+    printf(", \"cycles_per_op\": %.0f", median_cycles);
+
+    if (c->sized && size > 0) {
+        printf(", \"cycles_per_byte\": %.3f", median_cycles / (double) size);
+    }
+#else
+    (void) median_cycles;
+#endif
+
+    printf("}");
+    return 0;
+}
+
+static void bench_usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [--max-bytes N] [--budget-ms N] "
+            "[--only SUBSTRING]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long long max_bytes = 16777216;
+    double budget_ns = 200e6;
+    const char *only = 0;
+    int first = 1;
+#ifdef USE_SALINE
+    saline_implementation info;
+#endif
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "--max-bytes") == 0) {
+            max_bytes = strtoull(argv[++i], 0, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--budget-ms") == 0) {
+            budget_ns = strtod(argv[++i], 0) * 1e6;
+        } else if (i + 1 < argc && strcmp(argv[i], "--only") == 0) {
+            only = argv[++i];
+        } else {
+            bench_usage(argv[0]);
+            return 2;
+        }
+    }
+
+#ifndef USE_SALINE
+    if (sodium_init() < 0) {
+        fprintf(stderr, "sodium_init() failed\n");
+        return 1;
+    }
+#endif
+
+    msg = calloc(1, max_bytes + BENCH_PAD);
+    out = calloc(1, max_bytes + BENCH_PAD);
+    aux = calloc(1, max_bytes + BENCH_PAD);
+
+    if (msg == 0 || out == 0 || aux == 0) {
+        fprintf(stderr, "can't allocate %llu-byte buffers\n", max_bytes);
+        return 1;
+    }
+
+    for (unsigned long long i = 0; i < max_bytes + BENCH_PAD; ++i) {
+        msg[i] = (unsigned char) (i * 131 + 7);
+    }
+
+    memset(key, 0x42, sizeof(key));
+    memset(nonce, 0x24, sizeof(nonce));
+    crypto_box_keypair(box_pk, box_sk);
+    crypto_box_keypair(peer_pk, peer_sk);
+    crypto_box_beforenm(shared, peer_pk, box_sk);
+    crypto_sign_keypair(sign_pk, sign_sk);
+
+#ifdef BENCH_HPP
+    bench_hpp_init(msg, out, aux, max_bytes + BENCH_PAD, key, nonce, box_sk,
+                   box_pk, peer_sk, peer_pk, sign_sk, sign_pk, tag);
+#endif
+
+    printf("{\"library\": \"%s\", \"version\": \"%s\"", BENCH_LIBRARY,
+           BENCH_VERSION);
+
+#ifdef USE_SALINE
+    saline_implementation_info(&info);
+    printf(", \"profile\": \"%s\", \"backend\": \"%s\"", info.profile,
+           info.backend);
+#endif
+
+    printf(", \"cycle_counter\": %s,\n \"results\": [",
+           BENCH_CYCLE_COUNTER);
+
+    for (size_t i = 0; i < sizeof(bench_cases) / sizeof(*bench_cases); ++i) {
+        const struct bench_case *c = &bench_cases[i];
+
+        if (only != 0 && strstr(c->name, only) == 0) {
+            continue;
+        }
+
+        for (size_t j = 0; j < sizeof(bench_sizes) / sizeof(*bench_sizes);
+             ++j) {
+            if (bench_sizes[j] > max_bytes || (!c->sized && j > 0)) {
+                break;
+            }
+
+            if (bench_point(c, bench_sizes[j], budget_ns, first) != 0) {
+                return 1;
+            }
+
+            first = 0;
+            fflush(stdout);
+        }
+    }
+
+    printf("\n]}\n");
+    free(msg);
+    free(out);
+    free(aux);
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "bench_hpp.h"
+#include "saline.hpp"
+
+namespace {
+
+saline::mutable_bytes msg, out;
+saline::bytes aux;
+saline::secretbox_key key;
+saline::box_secret_key box_sk, peer_sk;
+saline::sign_secret_key sign_sk;
+const unsigned char *nonce, *box_pk, *peer_pk, *sign_pk, *tag;
+
+saline::fixed_bytes<saline::box_nonce_bytes> nonce_bytes()
+{
+    return saline::fixed_bytes<saline::box_nonce_bytes>(nonce,
+                                                        saline::box_nonce_bytes);
+}
+
+} // namespace
+
+extern "C" void bench_hpp_init(unsigned char *m, unsigned char *o,
+                               const unsigned char *a,
+                               unsigned long long length,
+                               const unsigned char *k, const unsigned char *n,
+                               const unsigned char *bsk,
+                               const unsigned char *bpk,
+                               const unsigned char *psk,
+                               const unsigned char *ppk,
+                               const unsigned char *ssk,
+                               const unsigned char *spk,
+                               const unsigned char *t)
+{
+    msg = saline::mutable_bytes(m, length);
+    out = saline::mutable_bytes(o, length);
+    aux = saline::bytes(a, length);
+    key = saline::secretbox_key(saline::fixed_bytes<32>(k, 32));
+    box_sk = saline::box_secret_key(saline::fixed_bytes<32>(bsk, 32));
+    peer_sk = saline::box_secret_key(saline::fixed_bytes<32>(psk, 32));
+    sign_sk = saline::sign_secret_key(saline::fixed_bytes<64>(ssk, 64));
+    nonce = n;
+    box_pk = bpk;
+    peer_pk = ppk;
+    sign_pk = spk;
+    tag = t;
+}
+
+/* The open cases read what bench.c's detached setups wrote to 'aux': the
+ * authenticator, then the cypher text. */
+
+extern "C" int bench_hpp_hash(unsigned long long size)
+{
+    return saline::hash(out.first<saline::hash_bytes>(), msg.first(size));
+}
+
+extern "C" int bench_hpp_secretbox(unsigned long long size)
+{
+    return saline::secretbox(out.first(size + saline::secretbox_mac_bytes),
+                             msg.first(size), nonce_bytes(), key);
+}
+
+extern "C" int bench_hpp_secretbox_open(unsigned long long size)
+{
+    return saline::secretbox_open(out.first(size),
+                                  aux.first(size + saline::secretbox_mac_bytes),
+                                  nonce_bytes(), key);
+}
+
+extern "C" int bench_hpp_box(unsigned long long size)
+{
+    return saline::box(out.first(size + saline::box_mac_bytes),
+                       msg.first(size), nonce_bytes(),
+                       saline::fixed_bytes<32>(peer_pk, 32), box_sk);
+}
+
+extern "C" int bench_hpp_box_open(unsigned long long size)
+{
+    return saline::box_open(out.first(size),
+                            aux.first(size + saline::box_mac_bytes),
+                            nonce_bytes(), saline::fixed_bytes<32>(box_pk, 32),
+                            peer_sk);
+}
+
+extern "C" int bench_hpp_sign_detached(unsigned long long size)
+{
+    return saline::sign_detached(out.first<saline::sign_bytes>(),
+                                 msg.first(size), sign_sk);
+}
+
+extern "C" int bench_hpp_sign_verify_detached(unsigned long long size)
+{
+    return saline::sign_verify_detached(
+        saline::fixed_bytes<saline::sign_bytes>(tag, saline::sign_bytes),
+        msg.first(size), saline::fixed_bytes<32>(sign_pk, 32));
+}
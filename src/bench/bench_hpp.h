@@ -0,0 +1,32 @@
+#ifndef _BENCH_HPP_H_
+#define _BENCH_HPP_H_
+
+/* saline.hpp versions of some of bench.c's cases, to show that the C++ layer
+ * costs nothing over the C calls it wraps. bench_hpp_init() takes bench.c's
+ * buffers and keys; the run functions then match bench.c's signature. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void bench_hpp_init(unsigned char *msg, unsigned char *out,
+                    const unsigned char *aux, unsigned long long length,
+                    const unsigned char *key, const unsigned char *nonce,
+                    const unsigned char *box_sk, const unsigned char *box_pk,
+                    const unsigned char *peer_sk, const unsigned char *peer_pk,
+                    const unsigned char *sign_sk, const unsigned char *sign_pk,
+                    const unsigned char *tag);
+
+int bench_hpp_hash(unsigned long long size);
+int bench_hpp_secretbox(unsigned long long size);
+int bench_hpp_secretbox_open(unsigned long long size);
+int bench_hpp_box(unsigned long long size);
+int bench_hpp_box_open(unsigned long long size);
+int bench_hpp_sign_detached(unsigned long long size);
+int bench_hpp_sign_verify_detached(unsigned long long size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,343 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "dispatch.h"
+#include "saline.h"
+#include "saline_hooks.h"
+#include "scalar.h"
+
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+#include <x86intrin.h>
+#define MICRO_HAVE_TSC 1
+#define MICRO_UNIT "TSC cycles"
+#else
+#define MICRO_UNIT "nanoseconds"
+#endif
+
+extern void crypto_hashblocks(uint8_t *x, const uint8_t *m, uint64_t n);
+
+/* Per-kernel cost of saline's building blocks, for attributing optimization
+ * work. Built from the library sources with -D SALINE_TEST_HOOKS so the
+ * static field, point and core functions in saline.c are reachable. Each
+ * kernel is run MICRO_CALLS times per sample; the median over MICRO_SAMPLES
+ * samples is reported per call, in TSC cycles where there is a TSC. */
+
+enum {
+    MICRO_SAMPLES = 31,
+    MICRO_TARGET_NS = 200000
+};
+
+struct micro_case {
+    const char *group;
+    const char *name;
+    void (*run)(void);
+};
+
+static int64_t fa[16], fb[16], fc[16];
+static int64_t pa[4][16], pb[4][16], pc[4][16], pn[3][16];
+static uint8_t bytes32[32], scalar_a[32], scalar_b[32], wide[64];
+static uint8_t block[1024], stream[256], out[64], state[64];
+static uint8_t nonce[16];
+static uint8_t key[32];
+
+static double micro_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static double micro_cycles(void)
+{
+#ifdef MICRO_HAVE_TSC
+    return (double) __rdtsc();
+#else
+    return micro_now();
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void run_M(void)
+{
+    saline_hook_M(fc, fa, fb);
+}
+
+static void run_S(void)
+{
+    saline_hook_S(fc, fa);
+}
+
+static void run_car25519(void)
+{
+    memcpy(fc, fa, sizeof(fc));
+    saline_hook_car25519(fc);
+}
+
+static void run_inv25519(void)
+{
+    saline_hook_inv25519(fc, fa);
+}
+
+static void run_pow2523(void)
+{
+    saline_hook_pow2523(fc, fa);
+}
+
+static void run_pack25519(void)
+{
+    saline_hook_pack25519(out, fa);
+}
+
+static void run_unpack25519(void)
+{
+    saline_hook_unpack25519(fc, bytes32);
+}
+
+static void run_add(void)
+{
+    memcpy(pc, pa, sizeof(pc));
+    saline_hook_add(pc, pb);
+}
+
+static void run_dbl(void)
+{
+    saline_hook_dbl(pc, pa);
+}
+
+static void run_add_cached(void)
+{
+    saline_hook_add_cached(pc, pa, pb);
+}
+
+static void run_madd(void)
+{
+    saline_hook_madd(pc, pa, pn);
+}
+
+static void run_p1p1_to_p3(void)
+{
+    saline_hook_p1p1_to_p3(pc, pa);
+}
+
+static void run_pack(void)
+{
+    saline_hook_pack(out, pa);
+}
+
+static void run_unpackneg(void)
+{
+    saline_hook_unpackneg(pc, bytes32);
+}
+
+static void run_scalarbase(void)
+{
+    saline_hook_scalarbase(pc, scalar_a);
+}
+
+static void run_double_scalarmult(void)
+{
+    saline_hook_double_scalarmult(pc, scalar_a, pb, scalar_b);
+}
+
+static void run_sc_reduce(void)
+{
+    memcpy(state, wide, sizeof(state));
+    saline_sc_reduce(state);
+}
+
+static void run_sc_muladd(void)
+{
+    saline_sc_muladd(out, scalar_a, scalar_b, scalar_a);
+}
+
+static void run_sc_is_canonical(void)
+{
+    saline_sc_is_canonical(scalar_a);
+}
+
+static void run_core_salsa20(void)
+{
+    saline_hook_core_salsa20(out, nonce, key);
+}
+
+static void run_core_hsalsa20(void)
+{
+    saline_hook_core_hsalsa20(out, nonce, key);
+}
+
+static void run_salsa20_portable(void)
+{
+    saline_salsa20_blocks_portable(stream, 0, 4, nonce, key);
+}
+
+#if defined SALINE_DISPATCH_X86
+static void run_salsa20_sse2(void)
+{
+    saline_salsa20_blocks_sse2(stream, 0, 4, nonce, key);
+}
+#endif
+
+static void run_poly1305(void)
+{
+    saline_poly1305_portable(out, block, sizeof(block), key);
+}
+
+#if defined SALINE_DISPATCH_BMI2
+static void run_poly1305_bmi2(void)
+{
+    saline_poly1305_bmi2(out, block, sizeof(block), key);
+}
+#endif
+
+static void run_sha512_blocks(void)
+{
+    saline_sha512_blocks_portable(state, block, 128);
+}
+
+static void run_hashblocks(void)
+{
+    crypto_hashblocks(state, block, 128);
+}
+
+static const struct micro_case micro_cases[] = {
+    {"field", "M", run_M},
+    {"field", "S", run_S},
+    {"field", "car25519 (+copy)", run_car25519},
+    {"field", "inv25519", run_inv25519},
+    {"field", "pow2523", run_pow2523},
+    {"field", "pack25519", run_pack25519},
+    {"field", "unpack25519", run_unpack25519},
+    {"point", "add (unified)", run_add},
+    {"point", "dbl", run_dbl},
+    {"point", "add_cached", run_add_cached},
+    {"point", "madd", run_madd},
+    {"point", "p1p1_to_p3", run_p1p1_to_p3},
+    {"point", "pack", run_pack},
+    {"point", "unpackneg", run_unpackneg},
+    {"point", "scalarbase", run_scalarbase},
+    {"point", "double_scalarmult_vartime", run_double_scalarmult},
+    {"scalar", "sc_reduce", run_sc_reduce},
+    {"scalar", "sc_muladd", run_sc_muladd},
+    {"scalar", "sc_is_canonical", run_sc_is_canonical},
+    {"salsa20", "core", run_core_salsa20},
+    {"salsa20", "core (hsalsa20)", run_core_hsalsa20},
+    {"salsa20", "blocks_portable (4 blocks)", run_salsa20_portable},
+#if defined SALINE_DISPATCH_X86
+    {"salsa20", "blocks_sse2 (4 blocks)", run_salsa20_sse2},
+#endif
+    {"poly1305", "portable (1024 bytes)", run_poly1305},
+#if defined SALINE_DISPATCH_BMI2
+    {"poly1305", "bmi2 (1024 bytes)", run_poly1305_bmi2},
+#endif
+    {"sha512", "blocks_portable (1 block)", run_sha512_blocks},
+    {"sha512", "crypto_hashblocks (1 block)", run_hashblocks}
+};
+
+/*----------------------------------------------------------------------------*/
+
+static int micro_compare(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static void micro_measure(const struct micro_case *c)
+{
+    double cycles[MICRO_SAMPLES], ns[MICRO_SAMPLES], start, once;
+    long calls = 1;
+
+    /* Warm up and size the sample so it lasts about MICRO_TARGET_NS. */
+
+    start = micro_now();
+    c->run();
+    c->run();
+    once = (micro_now() - start) / 2;
+
+    if (once < MICRO_TARGET_NS) {
+        calls = (long) (MICRO_TARGET_NS / (once + 1)) + 1;
+    }
+
+    for (int i = 0; i < MICRO_SAMPLES; ++i) {
+        double t0 = micro_now(), c0 = micro_cycles();
+
+        for (long j = 0; j < calls; ++j) {
+            c->run();
+        }
+
+        cycles[i] = (micro_cycles() - c0) / (double) calls;
+        ns[i] = (micro_now() - t0) / (double) calls;
+    }
+
+    qsort(cycles, MICRO_SAMPLES, sizeof(double), micro_compare);
+    qsort(ns, MICRO_SAMPLES, sizeof(double), micro_compare);
+
+    printf("%-9s %-30s %12.1f %12.1f\n", c->group, c->name,
+           cycles[MICRO_SAMPLES / 2], ns[MICRO_SAMPLES / 2]);
+}
+
+int main(int argc, char **argv)
+{
+    const char *only = (argc > 1) ? argv[1] : 0;
+    saline_implementation info;
+
+    for (int i = 0; i < 16; ++i) {
+        fa[i] = (i * 0x3b5d + 11) & 0xffff;
+        fb[i] = (i * 0x7a13 + 5) & 0xffff;
+    }
+
+    for (int i = 0; i < 32; ++i) {
+        scalar_a[i] = (uint8_t) (i * 29 + 3);
+        scalar_b[i] = (uint8_t) (i * 71 + 1);
+        key[i] = (uint8_t) (i * 13);
+    }
+
+    scalar_a[31] &= 0x0f;
+    scalar_b[31] &= 0x0f;
+
+    for (int i = 0; i < 64; ++i) {
+        wide[i] = (uint8_t) (i * 97 + 5);
+    }
+
+    for (int i = 0; i < (int) sizeof(block); ++i) {
+        block[i] = (uint8_t) i;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        memcpy(pn[i], fa, sizeof(fa));
+    }
+
+    /* A valid encoded point for unpackneg, and two points to work on. */
+
+    saline_hook_scalarbase(pa, scalar_a);
+    saline_hook_scalarbase(pb, scalar_b);
+    saline_hook_pack(bytes32, pa);
+
+    saline_implementation_info(&info);
+    printf("# saline %s, profile %s, backend %s, %s per call (median of %d)\n",
+           PACKAGE_VERSION, info.profile, info.backend, MICRO_UNIT,
+           MICRO_SAMPLES);
+    printf("%-9s %-30s %12s %12s\n", "# group", "kernel", "cycles", "ns");
+
+    for (size_t i = 0; i < sizeof(micro_cases) / sizeof(*micro_cases); ++i) {
+#if defined SALINE_DISPATCH_BMI2
+        /* The only kernel here that the CPU might not run. */
+
+        if (micro_cases[i].run == run_poly1305_bmi2 &&
+            !(info.cpu_features & saline_cpu_BMI2)) {
+            continue;
+        }
+#endif
+
+        if (only == 0 || strstr(micro_cases[i].name, only) != 0 ||
+            strcmp(micro_cases[i].group, only) == 0) {
+            micro_measure(&micro_cases[i]);
+        }
+    }
+
+    return 0;
+}
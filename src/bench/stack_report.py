@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+""" Prints the worst-case stack depth of every global function in the library,
+from the call-graph files (.ci) that GCC writes with -fcallgraph-info=su.
+
+A function's depth is its own frame plus the deepest of its callees. Calls
+through the kernel table are indirect; the call site's source line names the
+slot, and the call is charged the deepest kernel for that slot. Calls the
+report can't follow (libc, pthreads, callbacks) are not counted, and the
+functions that make them are marked with a '+'. Frames GCC can't bound (VLAs,
+alloca) are marked with a '?'.
+
+Usage: stack_report.py file.ci [file.ci ...] """
+
+import re
+import sys
+
+NODE = re.compile(r'node: \{ title: "([^"]+)" label: "([^"]*)"')
+EDGE = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"'
+                  r'(?: label: "([^"]+)")?')
+FRAME = re.compile(r'\\n(\d+) bytes \(([^)]*)\)')
+SLOT = re.compile(r'saline_kernels\(\)->(\w+)\s*\(')
+INDIRECT = '__indirect_call'
+
+
+def slot(site):
+    """ Returns the kernel-table slot called at 'file:line:column', or None
+    for any other indirect call. """
+
+    try:
+        path, line = site.split(':')[0:2]
+
+        with open(path) as source:
+            match = SLOT.search(source.readlines()[int(line) - 1])
+    except (AttributeError, OSError, IndexError, ValueError):
+        return None
+
+    return match.group(1) if match else None
+
+
+def load(paths):
+    """ Returns ({function: (frame bytes, bounded)}, {function: callees}). """
+
+    frames, calls = {}, {}
+
+    for path in paths:
+        with open(path) as ci:
+            for line in ci:
+                node, edge = NODE.search(line), EDGE.search(line)
+
+                if node and FRAME.search(node.group(2)):
+                    size, kind = FRAME.search(node.group(2)).groups()
+                    frames[node.group(1)] = (int(size), 'dynamic' not in kind
+                                             or 'bounded' in kind)
+                elif edge:
+                    source, target, site = edge.groups()
+
+                    if target == INDIRECT:
+                        target = 'saline_%s_*' % slot(site)
+
+                    calls.setdefault(source, set()).add(target)
+
+    return frames, calls
+
+
+def depth(name, frames, calls, memo, active=()):
+    """ Returns (bytes, complete, bounded) for the deepest path from 'name'.
+    'complete' is False when some call leaves the library. """
+
+    if name in memo:
+        return memo[name]
+
+    if name.endswith('_*'):
+        kernels = [x for x in frames if x.startswith(name[0:-1])]
+        results = [depth(x, frames, calls, memo, active) for x in kernels]
+        return max(results) if results else (0, False, True)
+
+    if name not in frames or name in active:
+        return (0, False, name not in active)
+
+    size, bounded = frames[name]
+    worst, complete = 0, True
+
+    for callee in calls.get(name, ()):
+        below, done, fixed = depth(callee, frames, calls, memo,
+                                   active + (name,))
+        worst = max(worst, below)
+        complete = complete and done
+        bounded = bounded and fixed
+
+    memo[name] = (size + worst, complete, bounded)
+    return memo[name]
+
+
+def main(paths):
+    frames, calls = load(paths)
+    memo = {}
+    public = sorted(x for x in frames
+                    if ':' not in x and not x.startswith('saline_hook_'))
+
+    print("# worst-case stack in bytes ('+': plus libc, '?': unbounded)")
+
+    for name in public:
+        size, complete, bounded = depth(name, frames, calls, memo)
+        flags = ('' if complete else '+') + ('' if bounded else '?')
+        print("%-40s %8d%s" % (name, size, flags))
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
@@ -0,0 +1,166 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "dispatch.h"
+#include "saline.h"
+
+#if defined SALINE_USE_THREADS
+#include <pthread.h>
+#define DISPATCH_LOAD(x) __atomic_load_n((x), __ATOMIC_ACQUIRE)
+#define DISPATCH_STORE(x, v) __atomic_store_n((x), (v), __ATOMIC_RELEASE)
+#else
+#define DISPATCH_LOAD(x) (*(x))
+#define DISPATCH_STORE(x, v) (*(x) = (v))
+#endif
+
+#if defined SALINE_DISPATCH_X86
+#include <cpuid.h>
+#endif
+
+#if !defined SALINE_PROFILE
+#define SALINE_PROFILE "balanced"
+#endif
+
+/* Backends in order of preference: the last one the CPU supports wins unless
+ * SALINE_IMPL names another. SSSE3 and AVX2 are only reported: no kernel
+ * needs them yet, and SSSE3 byte shuffles don't help Salsa20's rotation
+ * amounts. */
+
+static const struct saline_kernels dispatch_backends[] = {
+    {
+        "portable", 0,
+        saline_salsa20_blocks_portable, "portable",
+        saline_poly1305_portable, "portable",
+        saline_sha512_blocks_portable, "portable",
+        saline_x25519_portable, "portable"
+    },
+#if defined SALINE_DISPATCH_X86
+    {
+        "sse2", saline_cpu_SSE2,
+        saline_salsa20_blocks_sse2, "sse2",
+        saline_poly1305_portable, "portable",
+        saline_sha512_blocks_portable, "portable",
+        saline_x25519_portable, "portable"
+    },
+#endif
+#if defined SALINE_DISPATCH_BMI2
+    {
+        "bmi2", saline_cpu_SSE2 | saline_cpu_BMI2,
+        saline_salsa20_blocks_sse2, "sse2",
+        saline_poly1305_bmi2, "bmi2",
+        saline_sha512_blocks_portable, "portable",
+        saline_x25519_portable, "portable"
+    },
+#endif
+};
+
+enum {
+    DISPATCH_BACKENDS = sizeof(dispatch_backends) /
+                        sizeof(dispatch_backends[0])
+};
+
+static const struct saline_kernels *dispatch_selected;
+static unsigned int dispatch_features;
+
+#if defined SALINE_USE_THREADS
+static pthread_once_t dispatch_once = PTHREAD_ONCE_INIT;
+#endif
+
+static unsigned int dispatch_probe(void)
+{
+    unsigned int features = 0;
+
+#if defined SALINE_DISPATCH_X86
+    unsigned int a, b, c, d;
+
+    if (!__get_cpuid(1, &a, &b, &c, &d)) {
+        return 0;
+    }
+
+    if (d & (1u << 26)) {
+        features |= saline_cpu_SSE2;
+    }
+
+    if (c & (1u << 9)) {
+        features |= saline_cpu_SSSE3;
+    }
+
+    /* AVX2 also needs the OS to save YMM state (OSXSAVE, then XCR0). */
+
+    if ((c & (1u << 27)) && (c & (1u << 28))) {
+        unsigned int xcr0, xcr0_high;
+        int avx = 0;
+
+        __asm__ volatile ("xgetbv" : "=a" (xcr0), "=d" (xcr0_high) : "c" (0));
+        avx = (xcr0 & 6) == 6;
+
+        if (__get_cpuid_count(7, 0, &a, &b, &c, &d) && avx &&
+            (b & (1u << 5))) {
+            features |= saline_cpu_AVX2;
+        }
+    }
+
+    if (__get_cpuid_count(7, 0, &a, &b, &c, &d) && (b & (1u << 8))) {
+        features |= saline_cpu_BMI2;
+    }
+#endif
+
+    return features;
+}
+
+static void dispatch_select(void)
+{
+    const char *forced = getenv("SALINE_IMPL");
+    const struct saline_kernels *best = &dispatch_backends[0];
+    const struct saline_kernels *match = 0;
+    unsigned int features = dispatch_probe();
+
+    for (int i = 0; i < DISPATCH_BACKENDS; ++i) {
+        const struct saline_kernels *k = &dispatch_backends[i];
+
+        if ((k->requires & features) != k->requires) {
+            continue;
+        }
+
+        best = k;
+
+        if (forced != 0 && strcmp(forced, k->backend) == 0) {
+            match = k;
+        }
+    }
+
+    dispatch_features = features;
+    DISPATCH_STORE(&dispatch_selected, match ? match : best);
+}
+
+const struct saline_kernels *saline_kernels(void)
+{
+    const struct saline_kernels *k = DISPATCH_LOAD(&dispatch_selected);
+
+    if (k == 0) {
+#if defined SALINE_USE_THREADS
+        pthread_once(&dispatch_once, dispatch_select);
+#else
+        dispatch_select();
+#endif
+        k = DISPATCH_LOAD(&dispatch_selected);
+    }
+
+    return k;
+}
+
+int saline_implementation_info(saline_implementation *info)
+{
+    const struct saline_kernels *k = saline_kernels();
+
+    info->profile = SALINE_PROFILE;
+    info->backend = k->backend;
+    info->salsa20 = k->salsa20_name;
+    info->poly1305 = k->poly1305_name;
+    info->sha512 = k->sha512_name;
+    info->field = k->x25519_name;
+    info->cpu_features = dispatch_features;
+    return 0;
+}
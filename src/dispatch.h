@@ -0,0 +1,83 @@
+#ifndef _DISPATCH_H_
+#define _DISPATCH_H_
+
+#include <stdint.h>
+
+#include "config.h"
+
+/* --with-profile=small defines SALINE_NO_SIMD, leaving only the portable
+ * backend. */
+
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__) && \
+    !defined SALINE_NO_SIMD
+#define SALINE_DISPATCH_X86 1
+#endif
+
+/* The BMI2 Poly1305 kernel needs 64-bit registers and GCC's 128-bit
+ * integers. */
+
+#if defined SALINE_DISPATCH_X86 && defined __x86_64__ && \
+    defined __SIZEOF_INT128__
+#define SALINE_DISPATCH_BMI2 1
+#endif
+
+/* Per-primitive kernels. Each backend fills every slot, borrowing the
+ * portable kernel where it has nothing better. */
+
+typedef void (*salsa20_blocks_fn)(uint8_t *c, const uint8_t *m,
+                                  uint64_t blocks, uint8_t *z,
+                                  const uint8_t *k);
+
+typedef void (*poly1305_fn)(uint8_t *out, const uint8_t *m, uint64_t n,
+                            const uint8_t *k);
+
+typedef void (*sha512_blocks_fn)(uint8_t *x, const uint8_t *m, uint64_t n);
+
+typedef void (*x25519_fn)(uint8_t *q, const uint8_t *n, const uint8_t *p);
+
+struct saline_kernels {
+    const char *backend;
+    unsigned int requires;
+    salsa20_blocks_fn salsa20_blocks;
+    const char *salsa20_name;
+    poly1305_fn poly1305;
+    const char *poly1305_name;
+    sha512_blocks_fn sha512_blocks;
+    const char *sha512_name;
+    x25519_fn x25519;
+    const char *x25519_name;
+};
+
+/* Returns the kernel table for this machine. The CPU is probed and the
+ * table chosen on the first call; SALINE_IMPL in the environment may force
+ * any backend the CPU supports. */
+
+const struct saline_kernels *saline_kernels(void);
+
+/* Salsa20 kernels XOR 'blocks' whole 64-byte blocks of keystream into 'c'
+ * ('m' may be null for bare keystream) and advance the little-endian block
+ * counter in z[8..15]. */
+
+void saline_salsa20_blocks_portable(uint8_t *c, const uint8_t *m,
+                                    uint64_t blocks, uint8_t *z,
+                                    const uint8_t *k);
+
+#if defined SALINE_DISPATCH_X86
+void saline_salsa20_blocks_sse2(uint8_t *c, const uint8_t *m,
+                                uint64_t blocks, uint8_t *z,
+                                const uint8_t *k);
+#endif
+
+void saline_poly1305_portable(uint8_t *out, const uint8_t *m, uint64_t n,
+                              const uint8_t *k);
+
+#if defined SALINE_DISPATCH_BMI2
+void saline_poly1305_bmi2(uint8_t *out, const uint8_t *m, uint64_t n,
+                          const uint8_t *k);
+#endif
+
+void saline_sha512_blocks_portable(uint8_t *x, const uint8_t *m, uint64_t n);
+
+void saline_x25519_portable(uint8_t *q, const uint8_t *n, const uint8_t *p);
+
+#endif
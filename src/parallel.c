@@ -0,0 +1,108 @@
+#include <stdint.h>
+
+#include "config.h"
+#include "parallel.h"
+
+#if defined SALINE_USE_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+struct parallel_job {
+    parallel_fn fn;
+    void *ctx;
+    uint64_t count;
+    uint64_t grain;
+    uint64_t next;
+};
+
+unsigned int saline_parallel_threads(unsigned int requested)
+{
+#if defined SALINE_USE_THREADS && defined _SC_NPROCESSORS_ONLN
+    if (requested == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        requested = (online > 0) ? (unsigned int) online : 1;
+    }
+#else
+    requested = 1;
+#endif
+
+    if (requested > PARALLEL_MAX_THREADS) {
+        requested = PARALLEL_MAX_THREADS;
+    }
+
+    return requested;
+}
+
+/* Claims 'grain' indices at a time from the shared counter until none are
+ * left, so a thread that draws cheap items comes back for more instead of
+ * idling while another works through a fixed range of expensive ones. */
+
+static void parallel_run(struct parallel_job *job)
+{
+    for (;;) {
+        uint64_t begin = __atomic_fetch_add(&job->next, job->grain,
+                                            __ATOMIC_RELAXED);
+
+        if (begin >= job->count) {
+            return;
+        }
+
+        job->fn(job->ctx, begin, (job->count - begin < job->grain) ?
+                job->count : begin + job->grain);
+    }
+}
+
+#if defined SALINE_USE_THREADS
+
+static void *parallel_worker(void *arg)
+{
+    parallel_run(arg);
+    return 0;
+}
+
+#endif
+
+/* Runs 'fn' over [0, count) in ranges of up to 'grain' indices, on up to
+ * 'threads' threads started for this call. The calling thread works too, and
+ * a thread that can't be started simply leaves its share to the others. */
+
+void saline_parallel_for(unsigned int threads, uint64_t count, uint64_t grain,
+                         parallel_fn fn, void *ctx)
+{
+    struct parallel_job job;
+#if defined SALINE_USE_THREADS
+    pthread_t ids[PARALLEL_MAX_THREADS];
+    int started[PARALLEL_MAX_THREADS];
+    unsigned int t;
+#endif
+
+    job.fn = fn;
+    job.ctx = ctx;
+    job.count = count;
+    job.grain = (grain == 0) ? 1 : grain;
+    job.next = 0;
+
+#if defined SALINE_USE_THREADS
+    threads = saline_parallel_threads(threads);
+
+    if (threads > (count + job.grain - 1) / job.grain) {
+        threads = (unsigned int) ((count + job.grain - 1) / job.grain);
+    }
+
+    for (t = 1; t < threads; ++t) {
+        started[t] = !pthread_create(&ids[t], 0, parallel_worker, &job);
+    }
+
+    parallel_run(&job);
+
+    for (t = 1; t < threads; ++t) {
+        if (started[t]) {
+            pthread_join(ids[t], 0);
+        }
+    }
+#else
+    (void) threads;
+    parallel_run(&job);
+#endif
+}
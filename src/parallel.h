@@ -0,0 +1,17 @@
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include <stdint.h>
+
+enum {
+    PARALLEL_MAX_THREADS = 64
+};
+
+typedef void (*parallel_fn)(void *ctx, uint64_t begin, uint64_t end);
+
+unsigned int saline_parallel_threads(unsigned int requested);
+
+void saline_parallel_for(unsigned int threads, uint64_t count, uint64_t grain,
+                         parallel_fn fn, void *ctx);
+
+#endif
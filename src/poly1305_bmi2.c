@@ -0,0 +1,142 @@
+#include <stdint.h>
+
+#include "dispatch.h"
+
+#if defined SALINE_DISPATCH_BMI2
+
+/* Poly1305 with the accumulator and r in limbs of 44, 44 and 42 bits, as in
+ * poly1305-donna-64. A block costs nine 64x64->128-bit multiplications where
+ * the portable kernel's 17 byte-sized limbs cost 289 32-bit ones. Built for
+ * BMI2 so GCC can use mulx, which leaves the flags alone. */
+
+#define BMI2_FN __attribute__((target("bmi2")))
+
+__extension__ typedef unsigned __int128 bmi2_u128;
+
+#define MASK42 ((uint64_t) 0x3ffffffffff)
+#define MASK44 ((uint64_t) 0xfffffffffff)
+
+static uint64_t bmi2_ld64(const uint8_t *x)
+{
+    uint64_t u = 0;
+
+    for (int i = 7; i >= 0; --i) {
+        u = (u << 8) | x[i];
+    }
+
+    return u;
+}
+
+static void bmi2_st64(uint8_t *x, uint64_t u)
+{
+    for (int i = 0; i < 8; ++i) {
+        x[i] = (uint8_t) u;
+        u >>= 8;
+    }
+}
+
+BMI2_FN static void bmi2_block(uint64_t *h, const uint64_t *r,
+                               const uint8_t *m, uint64_t hibit)
+{
+    uint64_t t0 = bmi2_ld64(m), t1 = bmi2_ld64(m + 8);
+    uint64_t s1 = r[1] * 20, s2 = r[2] * 20, c;
+    bmi2_u128 d0, d1, d2;
+
+    h[0] += t0 & MASK44;
+    h[1] += ((t0 >> 44) | (t1 << 20)) & MASK44;
+    h[2] += ((t1 >> 24) & MASK42) | hibit;
+
+    d0 = (bmi2_u128) h[0] * r[0] + (bmi2_u128) h[1] * s2 +
+         (bmi2_u128) h[2] * s1;
+    d1 = (bmi2_u128) h[0] * r[1] + (bmi2_u128) h[1] * r[0] +
+         (bmi2_u128) h[2] * s2;
+    d2 = (bmi2_u128) h[0] * r[2] + (bmi2_u128) h[1] * r[1] +
+         (bmi2_u128) h[2] * r[0];
+
+    c = (uint64_t) (d0 >> 44);
+    h[0] = (uint64_t) d0 & MASK44;
+    d1 += c;
+    c = (uint64_t) (d1 >> 44);
+    h[1] = (uint64_t) d1 & MASK44;
+    d2 += c;
+    c = (uint64_t) (d2 >> 42);
+    h[2] = (uint64_t) d2 & MASK42;
+    h[0] += c * 5;
+    c = h[0] >> 44;
+    h[0] &= MASK44;
+    h[1] += c;
+}
+
+BMI2_FN void saline_poly1305_bmi2(uint8_t *out, const uint8_t *m, uint64_t n,
+                                  const uint8_t *k)
+{
+    uint64_t t0 = bmi2_ld64(k), t1 = bmi2_ld64(k + 8);
+    uint64_t r[3], h[3] = {0, 0, 0}, g[3], c;
+
+    r[0] = t0 & 0xffc0fffffff;
+    r[1] = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffff;
+    r[2] = (t1 >> 24) & 0x00ffffffc0f;
+
+    for (; n >= 16; n -= 16, m += 16) {
+        bmi2_block(h, r, m, (uint64_t) 1 << 40);
+    }
+
+    if (n > 0) {
+        uint8_t last[16] = {0};
+
+        for (uint64_t i = 0; i < n; ++i) {
+            last[i] = m[i];
+        }
+
+        last[n] = 1;
+        bmi2_block(h, r, last, 0);
+    }
+
+    /* Fully carry h, then subtract p = 2^130 - 5 if h >= p, in constant
+     * time. */
+
+    for (int i = 0; i < 2; ++i) {
+        c = h[1] >> 44;
+        h[1] &= MASK44;
+        h[2] += c;
+        c = h[2] >> 42;
+        h[2] &= MASK42;
+        h[0] += c * 5;
+        c = h[0] >> 44;
+        h[0] &= MASK44;
+        h[1] += c;
+    }
+
+    g[0] = h[0] + 5;
+    c = g[0] >> 44;
+    g[0] &= MASK44;
+    g[1] = h[1] + c;
+    c = g[1] >> 44;
+    g[1] &= MASK44;
+    g[2] = h[2] + c - ((uint64_t) 1 << 42);
+
+    c = (g[2] >> 63) - 1;
+
+    for (int i = 0; i < 3; ++i) {
+        h[i] = (h[i] & ~c) | (g[i] & c);
+    }
+
+    /* Add s, the second half of the key, mod 2^128. */
+
+    t0 = bmi2_ld64(k + 16);
+    t1 = bmi2_ld64(k + 24);
+
+    h[0] += t0 & MASK44;
+    c = h[0] >> 44;
+    h[0] &= MASK44;
+    h[1] += (((t0 >> 44) | (t1 << 20)) & MASK44) + c;
+    c = h[1] >> 44;
+    h[1] &= MASK44;
+    h[2] += ((t1 >> 24) & MASK42) + c;
+    h[2] &= MASK42;
+
+    bmi2_st64(out, h[0] | (h[1] << 44));
+    bmi2_st64(out + 8, (h[1] >> 20) | (h[2] << 24));
+}
+
+#endif
@@ -3,8 +3,30 @@
 
 #include "config.h"
 #include "randombytes.h"
+#include "stats.h"
 
-#if !defined RANDOMBYTES_USE_STDLIB
+/* test/test_rand compiles this file with -D RANDOMBYTES_TEST_BUFFERED so
+ * that 'make check' covers the buffered generator whatever --with-rand
+ * chose. */
+
+#if defined RANDOMBYTES_TEST_BUFFERED
+#undef RANDOMBYTES_USE_STDLIB
+#undef RANDOMBYTES_USE_URANDOM
+#undef RANDOMBYTES_USE_DEVRANDOM
+#define RANDOMBYTES_USE_GETRANDOM_BUFFERED 1
+#endif
+
+#if defined RANDOMBYTES_USE_GETRANDOM_BUFFERED
+#include <sys/random.h>
+#include <unistd.h>
+#include "saline.h"
+#if defined HAVE_PTHREAD_ATFORK
+#include <pthread.h>
+#endif
+#if defined SALINE_TEST_HOOKS
+#include "saline_hooks.h"
+#endif
+#elif !defined RANDOMBYTES_USE_STDLIB
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -21,19 +43,213 @@ static inline void randombytes_stdlib(uint8_t *output, uint64_t length)
     }
 }
 
+#elif defined RANDOMBYTES_USE_GETRANDOM_BUFFERED
+
+#if defined __STDC_VERSION__ && __STDC_VERSION__ >= 201112L
+#define RANDOMBYTES_THREAD_LOCAL _Thread_local
+#else
+#define RANDOMBYTES_THREAD_LOCAL __thread
+#endif
+
+/* Each thread runs its own XSalsa20 generator with fast key erasure: every
+ * refill produces 32 bytes of replacement key followed by RNG_BUFFER bytes of
+ * output, and the old key is gone before anything is handed out. Output is
+ * wiped from the buffer as it is returned, so a later compromise of the
+ * state reveals nothing about earlier output. A new process after fork()
+ * reseeds from getrandom() before its first draw. */
+
+enum {
+    RNG_BUFFER = 512
+};
+
+struct rng_state {
+    uint8_t key[32];
+    uint8_t buffer[RNG_BUFFER];
+    unsigned int available;
+    unsigned long generation;
+    int seeded;
+};
+
+static RANDOMBYTES_THREAD_LOCAL struct rng_state rng;
+
+#if defined HAVE_PTHREAD_ATFORK
+
+/* Bumped in the child after every fork(). Only the child ever writes it, and
+ * the child starts out single-threaded, so reads need no locking. Checking it
+ * costs no system call, unlike getpid(). pthread_atfork() is in the C library
+ * on the platforms that have getrandom(), so builds without threads use it
+ * too; they register on the first draw, which has no other thread to race. */
+
+static unsigned long rng_forks;
+
+static void rng_child(void)
+{
+    ++rng_forks;
+}
+
+#if defined SALINE_USE_THREADS
+
+static pthread_once_t rng_once = PTHREAD_ONCE_INIT;
+
+static void rng_register(void)
+{
+    pthread_atfork(0, 0, rng_child);
+}
+
+static unsigned long rng_generation(void)
+{
+    pthread_once(&rng_once, rng_register);
+    return rng_forks;
+}
+
+#else
+
+static unsigned long rng_generation(void)
+{
+    static int registered;
+
+    if (!registered) {
+        pthread_atfork(0, 0, rng_child);
+        registered = 1;
+    }
+
+    return rng_forks;
+}
+
+#endif
+
+#else
+
+/* Without fork handlers the only way to tell a child from its parent is to
+ * ask for the pid on every draw. Caching it at refill would let a child hand
+ * out the rest of the buffer it inherited. */
+
+static unsigned long rng_generation(void)
+{
+    return (unsigned long) getpid();
+}
+
+#endif
+
+static void rng_getrandom(uint8_t *output, size_t length)
+{
+    while (length > 0) {
+        ssize_t count = getrandom(output, length, 0);
+
+        if (count < 1) {
+            sleep(1);
+            continue;
+        }
+
+        output += count;
+        length -= (size_t) count;
+    }
+}
+
+static void rng_refill(void)
+{
+    static const uint8_t nonce[crypto_stream_NONCEBYTES] = {0};
+    uint8_t block[32 + RNG_BUFFER];
+
+    crypto_stream(block, sizeof(block), nonce, rng.key);
+
+    for (int i = 0; i < 32; ++i) {
+        rng.key[i] = block[i];
+    }
+
+    for (int i = 0; i < RNG_BUFFER; ++i) {
+        rng.buffer[i] = block[32 + i];
+    }
+
+    for (unsigned int i = 0; i < sizeof(block); ++i) {
+        ((volatile uint8_t *) block)[i] = 0;
+    }
+
+    rng.available = RNG_BUFFER;
+}
+
+static inline void randombytes_buffered(uint8_t *output, uint64_t length)
+{
+    unsigned long generation = rng_generation();
+
+    if (!rng.seeded || rng.generation != generation) {
+        rng_getrandom(rng.key, sizeof(rng.key));
+        rng.available = 0;
+        rng.generation = generation;
+        rng.seeded = 1;
+    }
+
+    while (length > 0) {
+        unsigned int offset;
+
+        if (rng.available == 0) {
+            rng_refill();
+        }
+
+        offset = RNG_BUFFER - rng.available;
+
+        while (length > 0 && offset < RNG_BUFFER) {
+            *output++ = rng.buffer[offset];
+            rng.buffer[offset++] = 0;
+            --length;
+        }
+
+        rng.available = RNG_BUFFER - offset;
+    }
+}
+
+#if defined SALINE_TEST_HOOKS
+
+void saline_hook_rng_seed(const uint8_t *key)
+{
+    for (int i = 0; i < 32; ++i) {
+        rng.key[i] = key[i];
+    }
+
+    rng.available = 0;
+    rng.generation = rng_generation();
+    rng.seeded = 1;
+}
+
+void saline_hook_rng_state(uint8_t *key, uint8_t *buffer)
+{
+    for (int i = 0; i < 32; ++i) {
+        key[i] = rng.key[i];
+    }
+
+    for (int i = 0; i < RNG_BUFFER; ++i) {
+        buffer[i] = rng.buffer[i];
+    }
+}
+
+#endif
+
 #else
 
 static inline void randombytes_rand_device(uint8_t *output, uint64_t length,
                                            const char *device)
 {
-    static int fd = -1;
+    static int shared_fd = -1;
+    int fd = __atomic_load_n(&shared_fd, __ATOMIC_ACQUIRE);
+
+    /* Threads that race to open the device publish one descriptor between
+     * them; the losers close their own. */
 
     if (fd == -1) {
+        int expected = -1;
+
         fd = open(device, O_RDONLY);
         while (fd == -1) {
             sleep(1);
             fd = open(device, O_RDONLY);
         }
+
+        if (!__atomic_compare_exchange_n(&shared_fd, &expected, fd, 0,
+                                         __ATOMIC_ACQ_REL,
+                                         __ATOMIC_ACQUIRE)) {
+            close(fd);
+            fd = expected;
+        }
     }
 
     while (length > 0) {
@@ -64,12 +280,16 @@ static inline void randombytes_devrandom(uint8_t *output, uint64_t length)
 
 void randombytes(uint8_t *output, uint64_t length)
 {
+    SALINE_STAT_CALL(randombytes, length);
+
 #if defined RANDOMBYTES_USE_STDLIB
     randombytes_stdlib(output, length);
 #elif defined RANDOMBYTES_USE_URANDOM
     randombytes_urandom(output, length);
 #elif defined RANDOMBYTES_USE_DEVRANDOM
     randombytes_devrandom(output, length);
+#elif defined RANDOMBYTES_USE_GETRANDOM_BUFFERED
+    randombytes_buffered(output, length);
 #else
 #error randombytes: no method specified!
 #endif
@@ -1,10 +1,22 @@
 #include "saline.h"
 #include <stdint.h>
+#include <stdlib.h>
+
+#include "dispatch.h"
+#include "scalar.h"
+#include "stats.h"
+#include "treehash.h"
+
+#if !defined SALINE_NO_BASE_TABLES
+#include "saline_base_table.h"
+#endif
 
 typedef int64_t gf[16];
 
 extern void randombytes(uint8_t *, uint64_t);
 void crypto_hashblocks(uint8_t *x, const uint8_t *m, uint64_t n);
+static int crypto_core_salsa20(uint8_t *out, const uint8_t *in,
+                               const uint8_t *k, const uint8_t *c);
 
 static const uint8_t _0[16] = {0};
 static const uint8_t _9[32] = {9};
@@ -21,14 +33,6 @@ static const gf D2 = {0xf159, 0x26b2, 0x9b94, 0xebd6, 0xb156, 0x8283,
                       0x149a, 0x00e0, 0xd130, 0xeef3, 0x80f2, 0x198e,
                       0xfce7, 0x56df, 0xd9dc, 0x2406};
 
-static const gf X = {0xd51a, 0x8f25, 0x2d60, 0xc956, 0xa7b2, 0x9525,
-                     0xc760, 0x692c, 0xdc5c, 0xfdd6, 0xe231, 0xc0a4,
-                     0x53fe, 0xcd6e, 0x36d3, 0x2169};
-
-static const gf Y = {0x6658, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666,
-                     0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666,
-                     0x6666, 0x6666, 0x6666, 0x6666};
-
 static const gf I = {0xa0b0, 0x4a0e, 0x1b27, 0xc4ee, 0xe478, 0xad2f,
                      0x1806, 0x2f43, 0xd7a7, 0x3dfb, 0x0099, 0x2b4d,
                      0xdf0b, 0x4fc1, 0x2480, 0x2b83};
@@ -73,6 +77,16 @@ static void ts64(uint8_t *x, uint64_t u)
     }
 }
 
+/* Clears key material that would otherwise stay behind on the stack. The
+ * volatile stores can't be dropped as dead. */
+
+static void wipe(void *p, uint64_t n)
+{
+    for (uint64_t i = 0; i < n; ++i) {
+        ((volatile uint8_t *) p)[i] = 0;
+    }
+}
+
 static int vn(const uint8_t *x, const uint8_t *y, int n)
 {
     uint32_t d = 0;
@@ -163,31 +177,21 @@ static int crypto_core_salsa20(uint8_t *out, const uint8_t *in,
 static int crypto_core_hsalsa20(uint8_t *out, const uint8_t *in,
                                 const uint8_t *k, const uint8_t *c)
 {
+    SALINE_STAT(salsa20_blocks, 1);
     core(out, in, k, c, 1);
     return 0;
 }
 
 static const uint8_t sigma[17] = "expand 32-byte k";
 
-static int crypto_stream_salsa20_xor(uint8_t *c, const uint8_t *m, uint64_t b,
-                                     const uint8_t *n, const uint8_t *k)
+void saline_salsa20_blocks_portable(uint8_t *c, const uint8_t *m,
+                                    uint64_t blocks, uint8_t *z,
+                                    const uint8_t *k)
 {
-    uint8_t z[16], x[64];
+    uint8_t x[64];
     uint32_t u, i;
 
-    if (!b) {
-        return 0;
-    }
-
-    for (i = 0; i < 16; ++i) {
-        z[i] = 0;
-    }
-
-    for (i = 0; i < 8; ++i) {
-        z[i] = n[i];
-    }
-
-    while (b >= 64) {
+    while (blocks > 0) {
         crypto_core_salsa20(x, z, k, sigma);
 
         for (i = 0; i < 64; ++i) {
@@ -202,13 +206,45 @@ static int crypto_stream_salsa20_xor(uint8_t *c, const uint8_t *m, uint64_t b,
             u >>= 8;
         }
 
-        b -= 64;
+        --blocks;
         c += 64;
 
         if (m) {
             m += 64;
         }
     }
+}
+
+/* Salsa20 starting at block 'ic' of the stream. */
+
+static int stream_salsa20_xor_ic(uint8_t *c, const uint8_t *m, uint64_t b,
+                                 const uint8_t *n, uint64_t ic,
+                                 const uint8_t *k)
+{
+    uint8_t z[16], x[64];
+    uint32_t i;
+
+    if (!b) {
+        return 0;
+    }
+
+    SALINE_STAT(salsa20_blocks, (b + 63) / 64);
+
+    for (i = 0; i < 8; ++i) {
+        z[i] = n[i];
+        z[8 + i] = (uint8_t) (ic >> 8 * i);
+    }
+
+    if (b >= 64) {
+        saline_kernels()->salsa20_blocks(c, m, b / 64, z, k);
+        c += b & ~(uint64_t) 63;
+
+        if (m) {
+            m += b & ~(uint64_t) 63;
+        }
+
+        b &= 63;
+    }
 
     if (b) {
         crypto_core_salsa20(x, z, k, sigma);
@@ -221,6 +257,12 @@ static int crypto_stream_salsa20_xor(uint8_t *c, const uint8_t *m, uint64_t b,
     return 0;
 }
 
+static int crypto_stream_salsa20_xor(uint8_t *c, const uint8_t *m, uint64_t b,
+                                     const uint8_t *n, const uint8_t *k)
+{
+    return stream_salsa20_xor_ic(c, m, b, n, 0, k);
+}
+
 static int crypto_stream_salsa20(uint8_t *c, uint64_t d, const uint8_t *n,
                                  const uint8_t *k)
 {
@@ -231,6 +273,7 @@ int crypto_stream(unsigned char *c, unsigned long long d,
                   const unsigned char *n, const unsigned char *k)
 {
     uint8_t s[32];
+    SALINE_STAT_CALL(stream, d);
     crypto_core_hsalsa20(s, n, k, sigma);
     return crypto_stream_salsa20(c, d, n + 16, s);
 }
@@ -240,6 +283,7 @@ int crypto_stream_xor(unsigned char *c, const unsigned char *m,
                       const unsigned char *k)
 {
     uint8_t s[32];
+    SALINE_STAT_CALL(stream, d);
     crypto_core_hsalsa20(s, n, k, sigma);
     return crypto_stream_salsa20_xor(c, m, d, n + 16, s);
 }
@@ -261,6 +305,15 @@ static const uint32_t minusp[17] = {5, 0, 0, 0, 0, 0, 0, 0, 0,
 
 int crypto_onetimeauth(unsigned char *out, const unsigned char *m,
                        unsigned long long n, const unsigned char *k)
+{
+    SALINE_STAT_CALL(onetimeauth, n);
+    SALINE_STAT(poly1305_blocks, (n + 15) / 16);
+    saline_kernels()->poly1305(out, m, n, k);
+    return 0;
+}
+
+void saline_poly1305_portable(uint8_t *out, const uint8_t *m, uint64_t n,
+                              const uint8_t *k)
 {
     uint32_t s, i, j, u, x[17], r[17], h[17], c[17], g[17];
 
@@ -349,8 +402,6 @@ int crypto_onetimeauth(unsigned char *out, const unsigned char *m,
     for (j = 0; j < 16; ++j) {
         out[j] = (uint8_t) h[j];
     }
-
-    return 0;
 }
 
 int crypto_onetimeauth_verify(const unsigned char *h, const unsigned char *m,
@@ -371,6 +422,7 @@ int crypto_secretbox(unsigned char *c, const unsigned char *m,
         return -1;
     }
 
+    SALINE_STAT_CALL(secretbox, d);
     crypto_stream_xor(c, m, d, n, k);
     crypto_onetimeauth(c + 16, c + 32, d - 32, c);
 
@@ -392,9 +444,12 @@ int crypto_secretbox_open(unsigned char *m, const unsigned char *c,
         return -1;
     }
 
+    SALINE_STAT_CALL(secretbox_open, d);
     crypto_stream(x, 32, n, k);
+    i = crypto_onetimeauth_verify(c + 16, c + 32, d - 32, x);
+    wipe(x, sizeof(x));
 
-    if (crypto_onetimeauth_verify(c + 16, c + 32, d - 32, x) != 0) {
+    if (i != 0) {
         return -1;
     }
 
@@ -407,6 +462,71 @@ int crypto_secretbox_open(unsigned char *m, const unsigned char *c,
     return 0;
 }
 
+/* The detached secretbox runs the same stream as the padded one: the first
+ * 32 bytes of keystream are the Poly1305 key, and the text is XORed with
+ * the stream from byte 32 on. secretbox_start() sets 's' to the XSalsa20
+ * subkey and 'x' to the first keystream block. */
+
+static void secretbox_start(uint8_t s[32], uint8_t x[64], const uint8_t *n,
+                            const uint8_t *k)
+{
+    crypto_core_hsalsa20(s, n, k, sigma);
+    stream_salsa20_xor_ic(x, 0, 64, n + 16, 0, s);
+}
+
+static void secretbox_xor(uint8_t *out, const uint8_t *in, uint64_t d,
+                          const uint8_t x[64], const uint8_t *n,
+                          const uint8_t s[32])
+{
+    uint64_t i, head = (d < 32) ? d : 32;
+
+    for (i = 0; i < head; ++i) {
+        out[i] = in[i] ^ x[32 + i];
+    }
+
+    if (d > head) {
+        stream_salsa20_xor_ic(out + head, in + head, d - head, n + 16, 1, s);
+    }
+}
+
+int crypto_secretbox_detached(unsigned char *c, unsigned char mac[16],
+                              const unsigned char *m, unsigned long long d,
+                              const unsigned char n[24],
+                              const unsigned char k[32])
+{
+    uint8_t s[32], x[64];
+
+    SALINE_STAT_CALL(secretbox, d);
+    secretbox_start(s, x, n, k);
+    secretbox_xor(c, m, d, x, n, s);
+    crypto_onetimeauth(mac, c, d, x);
+    wipe(s, sizeof(s));
+    wipe(x, sizeof(x));
+    return 0;
+}
+
+int crypto_secretbox_open_detached(unsigned char *m, const unsigned char *c,
+                                   const unsigned char mac[16],
+                                   unsigned long long d,
+                                   const unsigned char n[24],
+                                   const unsigned char k[32])
+{
+    uint8_t s[32], x[64];
+    int result;
+
+    SALINE_STAT_CALL(secretbox_open, d);
+    secretbox_start(s, x, n, k);
+    result = crypto_onetimeauth_verify(mac, c, d, x);
+
+    if (result == 0) {
+        secretbox_xor(m, c, d, x, n, s);
+    }
+
+    wipe(s, sizeof(s));
+    wipe(x, sizeof(x));
+    return result;
+}
+
 static void set25519(gf r, const gf a)
 {
     int i;
@@ -521,6 +641,8 @@ static void M(gf o, const gf a, const gf b)
 {
     int64_t i, j, t[31];
 
+    SALINE_STAT(field_multiplications, 1);
+
     for (i = 0; i < 31; ++i) {
         t[i] = 0;
     }
@@ -553,6 +675,8 @@ static void inv25519(gf o, const gf i)
     gf c;
     int a;
 
+    SALINE_STAT(field_inversions, 1);
+
     for (a = 0; a < 16; ++a) {
         c[a] = i[a];
     }
@@ -575,6 +699,8 @@ static void pow2523(gf o, const gf i)
     gf c;
     int a;
 
+    SALINE_STAT(field_inversions, 1);
+
     for (a = 0; a < 16; ++a) {
         c[a] = i[a];
     }
@@ -595,9 +721,23 @@ static void pow2523(gf o, const gf i)
 int crypto_scalarmult(unsigned char *q, const unsigned char *n,
                       const unsigned char *p)
 {
+    SALINE_STAT_CALL(scalarmult, 0);
+    saline_kernels()->x25519(q, n, p);
+    return 0;
+}
+
+struct x25519_scratch {
     uint8_t z[32];
-    int64_t x[80], r, i;
+    int64_t x[80];
     gf a, b, c, d, e, f;
+};
+
+static void x25519_ws(uint8_t *q, const uint8_t *n, const uint8_t *p,
+                      struct x25519_scratch *ws)
+{
+    uint8_t *z = ws->z;
+    int64_t *x = ws->x, *a = ws->a, *b = ws->b, *c = ws->c, *d = ws->d;
+    int64_t *e = ws->e, *f = ws->f, r, i;
 
     for (i = 0; i < 31; ++i) {
         z[i] = n[i];
@@ -650,7 +790,12 @@ int crypto_scalarmult(unsigned char *q, const unsigned char *n,
     inv25519(x + 32, x + 32);
     M(x + 16, x + 16, x + 32);
     pack25519(q, x + 16);
-    return 0;
+}
+
+void saline_x25519_portable(uint8_t *q, const uint8_t *n, const uint8_t *p)
+{
+    struct x25519_scratch ws;
+    x25519_ws(q, n, p, &ws);
 }
 
 int crypto_scalarmult_base(unsigned char *q, const unsigned char *n)
@@ -658,6 +803,21 @@ int crypto_scalarmult_base(unsigned char *q, const unsigned char *n)
     return crypto_scalarmult(q, n, _9);
 }
 
+int crypto_scalarmult_ws(unsigned char q[32], const unsigned char n[32],
+                         const unsigned char p[32],
+                         crypto_scalarmult_workspace *workspace)
+{
+    SALINE_STAT_CALL(scalarmult, 0);
+    x25519_ws(q, n, p, (struct x25519_scratch *) (void *) workspace);
+    return 0;
+}
+
+int crypto_scalarmult_base_ws(unsigned char q[32], const unsigned char n[32],
+                              crypto_scalarmult_workspace *workspace)
+{
+    return crypto_scalarmult_ws(q, n, _9, workspace);
+}
+
 int crypto_box_keypair(unsigned char *y, unsigned char *x)
 {
     randombytes(x, 32);
@@ -668,14 +828,30 @@ int crypto_box_beforenm(unsigned char *k, const unsigned char *y,
                         const unsigned char *x)
 {
     uint8_t s[32];
+    SALINE_STAT_CALL(box_beforenm, 0);
     crypto_scalarmult(s, x, y);
-    return crypto_core_hsalsa20(k, _0, s, sigma);
+    crypto_core_hsalsa20(k, _0, s, sigma);
+    wipe(s, sizeof(s));
+    return 0;
+}
+
+int crypto_box_beforenm_ws(unsigned char k[32], const unsigned char y[32],
+                           const unsigned char x[32],
+                           crypto_scalarmult_workspace *workspace)
+{
+    uint8_t s[32];
+    SALINE_STAT_CALL(box_beforenm, 0);
+    crypto_scalarmult_ws(s, x, y, workspace);
+    crypto_core_hsalsa20(k, _0, s, sigma);
+    wipe(s, sizeof(s));
+    return 0;
 }
 
 int crypto_box_afternm(unsigned char *c, const unsigned char *m,
                        unsigned long long d, const unsigned char *n,
                        const unsigned char *k)
 {
+    SALINE_STAT_CALL(box, d);
     return crypto_secretbox(c, m, d, n, k);
 }
 
@@ -683,6 +859,7 @@ int crypto_box_open_afternm(unsigned char *m, const unsigned char *c,
                             unsigned long long d, const unsigned char *n,
                             const unsigned char *k)
 {
+    SALINE_STAT_CALL(box_open, d);
     return crypto_secretbox_open(m, c, d, n, k);
 }
 
@@ -691,8 +868,12 @@ int crypto_box(unsigned char *c, const unsigned char *m, unsigned long long d,
                const unsigned char *x)
 {
     uint8_t k[32];
+    int result;
+
     crypto_box_beforenm(k, y, x);
-    return crypto_box_afternm(c, m, d, n, k);
+    result = crypto_box_afternm(c, m, d, n, k);
+    wipe(k, sizeof(k));
+    return result;
 }
 
 int crypto_box_open(unsigned char *m, const unsigned char *c,
@@ -700,8 +881,43 @@ int crypto_box_open(unsigned char *m, const unsigned char *c,
                     const unsigned char *y, const unsigned char *x)
 {
     uint8_t k[32];
+    int result;
+
+    crypto_box_beforenm(k, y, x);
+    result = crypto_box_open_afternm(m, c, d, n, k);
+    wipe(k, sizeof(k));
+    return result;
+}
+
+int crypto_box_detached(unsigned char *c, unsigned char mac[16],
+                        const unsigned char *m, unsigned long long d,
+                        const unsigned char n[24], const unsigned char y[32],
+                        const unsigned char x[32])
+{
+    uint8_t k[32];
+    int result;
+
+    crypto_box_beforenm(k, y, x);
+    SALINE_STAT_CALL(box, d);
+    result = crypto_secretbox_detached(c, mac, m, d, n, k);
+    wipe(k, sizeof(k));
+    return result;
+}
+
+int crypto_box_open_detached(unsigned char *m, const unsigned char *c,
+                             const unsigned char mac[16],
+                             unsigned long long d, const unsigned char n[24],
+                             const unsigned char y[32],
+                             const unsigned char x[32])
+{
+    uint8_t k[32];
+    int result;
+
     crypto_box_beforenm(k, y, x);
-    return crypto_box_open_afternm(m, c, d, n, k);
+    SALINE_STAT_CALL(box_open, d);
+    result = crypto_secretbox_open_detached(m, c, mac, d, n, k);
+    wipe(k, sizeof(k));
+    return result;
 }
 
 static uint64_t R(uint64_t x, int c)
@@ -770,6 +986,12 @@ static const uint64_t K[80] = {
 };
 
 void crypto_hashblocks(uint8_t *x, const uint8_t *m, uint64_t n)
+{
+    SALINE_STAT(sha512_blocks, n / 128);
+    saline_kernels()->sha512_blocks(x, m, n);
+}
+
+void saline_sha512_blocks_portable(uint8_t *x, const uint8_t *m, uint64_t n)
 {
     uint64_t z[8], b[8], a[8], w[16], t;
     int i, j;
@@ -827,12 +1049,23 @@ static const uint8_t iv[64] = {
     0x6b, 0x5b, 0xe0, 0xcd, 0x19, 0x13, 0x7e, 0x21, 0x79
 };
 
-int crypto_hash(unsigned char *out, const unsigned char *m,
-                unsigned long long n)
+/* Scratch layouts. Functions with large temporaries keep them in one of
+ * these structs: the plain API puts the struct on the stack, and the _ws API
+ * places it in the caller's workspace. */
+
+struct hash_scratch {
+    uint8_t h[64];
+    uint8_t x[256];
+};
+
+static void hash_ws(uint8_t *out, const uint8_t *m, uint64_t n,
+                    struct hash_scratch *ws)
 {
-    uint8_t h[64], x[256];
+    uint8_t *h = ws->h, *x = ws->x;
     uint64_t i, b = n;
 
+    SALINE_STAT_CALL(hash, n);
+
     for (i = 0; i < 64; ++i) {
         h[i] = iv[i];
     }
@@ -860,293 +1093,1533 @@ int crypto_hash(unsigned char *out, const unsigned char *m,
     for (i = 0; i < 64; ++i) {
         out[i] = h[i];
     }
-
-    return 0;
 }
 
-static void add(gf p[4], gf q[4])
+int crypto_hash(unsigned char *out, const unsigned char *m,
+                unsigned long long n)
 {
-    gf a, b, c, d, t, e, f, g, h;
-
-    Z(a, p[1], p[0]);
-    Z(t, q[1], q[0]);
-    M(a, a, t);
-    A(b, p[0], p[1]);
-    A(t, q[0], q[1]);
-    M(b, b, t);
-    M(c, p[3], q[3]);
-    M(c, c, D2);
-    M(d, p[2], q[2]);
-    A(d, d, d);
-    Z(e, b, a);
-    Z(f, d, c);
-    A(g, d, c);
-    A(h, b, a);
+    struct hash_scratch ws;
 
-    M(p[0], e, f);
-    M(p[1], h, g);
-    M(p[2], g, f);
-    M(p[3], e, h);
+    hash_ws(out, m, n, &ws);
+    return 0;
 }
 
-static void cswap(gf p[4], gf q[4], uint8_t b)
+int crypto_hash_ws(unsigned char out[crypto_hash_BYTES],
+                   const unsigned char *m, unsigned long long n,
+                   crypto_hash_workspace *workspace)
 {
-    int i;
-
-    for (i = 0; i < 4; ++i) {
-        sel25519(p[i], q[i], b);
-    }
+    hash_ws(out, m, n, (struct hash_scratch *) (void *) workspace);
+    return 0;
 }
 
-static void pack(uint8_t *r, gf p[4])
+int crypto_hash_init(crypto_hash_state *state)
 {
-    gf tx, ty, zi;
-    inv25519(zi, p[2]);
-    M(tx, p[0], zi);
-    M(ty, p[1], zi);
-    pack25519(r, ty);
-    r[31] ^= (uint8_t) (par25519(tx) << 7);
+    for (int i = 0; i < 64; ++i) {
+        state->h[i] = iv[i];
+    }
+
+    state->length = 0;
+    return 0;
 }
 
-static void scalarmult(gf p[4], gf q[4], const uint8_t *s)
+int crypto_hash_update(crypto_hash_state *state, const unsigned char *m,
+                       unsigned long long n)
 {
-    int i;
-    set25519(p[0], gf0);
-    set25519(p[1], gf1);
-    set25519(p[2], gf1);
-    set25519(p[3], gf0);
+    uint64_t used = state->length & 127;
 
-    for (i = 255; i >= 0; --i) {
-        uint8_t b = (s[i / 8] >> (i & 7)) & 1;
-        cswap(p, q, b);
-        add(q, p);
-        add(p, p);
-        cswap(p, q, b);
+    SALINE_STAT(hash.bytes, n);
+
+    if (n == 0) {
+        return 0;
     }
-}
 
-static void scalarbase(gf p[4], const uint8_t *s)
-{
-    gf q[4];
-    set25519(q[0], X);
-    set25519(q[1], Y);
-    set25519(q[2], gf1);
-    M(q[3], X, Y);
-    scalarmult(p, q, s);
-}
+    state->length += n;
 
-int crypto_sign_keypair(unsigned char *pk, unsigned char *sk)
-{
-    uint8_t d[64];
-    gf p[4];
-    int i;
+    if (used) {
+        while (n > 0 && used < 128) {
+            state->buffer[used++] = *m++;
+            --n;
+        }
 
-    randombytes(sk, 32);
-    crypto_hash(d, sk, 32);
-    d[0] &= 248;
-    d[31] &= 127;
-    d[31] |= 64;
+        if (used < 128) {
+            return 0;
+        }
 
-    scalarbase(p, d);
-    pack(pk, p);
+        crypto_hashblocks(state->h, state->buffer, 128);
+    }
 
-    for (i = 0; i < 32; ++i) {
-        sk[32 + i] = pk[i];
+    crypto_hashblocks(state->h, m, n);
+    m += n;
+    n &= 127;
+    m -= n;
+
+    for (uint64_t i = 0; i < n; ++i) {
+        state->buffer[i] = m[i];
     }
 
     return 0;
 }
 
-static const uint64_t L[32] = {0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58,
-                               0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
-                               0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                               0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
-                              };
+/* Pads and finishes 'state', using 'x' for the final one or two blocks. */
 
-static void modL(uint8_t *r, int64_t x[64])
+static void hash_final_ws(crypto_hash_state *state, uint8_t *out,
+                          uint8_t x[256])
 {
-    int64_t carry, i, j;
+    uint64_t i, n = state->length & 127, b = state->length;
 
-    for (i = 63; i >= 32; --i) {
-        carry = 0;
+    SALINE_STAT(hash.calls, 1);
 
-        for (j = i - 32; j < i - 12; ++j) {
-            x[j] += carry - 16 * x[i] * (int64_t) L[j - (i - 32)];
-            carry = (x[j] + 128) >> 8;
-            x[j] -= carry << 8;
-        }
-
-        x[j] += carry;
+    for (i = 0; i < 256; ++i) {
         x[i] = 0;
     }
 
-    carry = 0;
-
-    for (j = 0; j < 32; ++j) {
-        x[j] += carry - (x[31] >> 4) * (int64_t) L[j];
-        carry = x[j] >> 8;
-        x[j] &= 255;
+    for (i = 0; i < n; ++i) {
+        x[i] = state->buffer[i];
     }
 
-    for (j = 0; j < 32; ++j) {
-        x[j] -= carry * (int64_t) L[j];
-    }
+    x[n] = 128;
 
-    for (i = 0; i < 32; ++i) {
-        x[i + 1] += x[i] >> 8;
-        r[i] = (uint8_t) x[i];
+    n = 256 - 128 * (n < 112);
+    x[n - 9] = (uint8_t) (b >> 61);
+    ts64(x + n - 8, b << 3);
+    crypto_hashblocks(state->h, x, n);
+
+    for (i = 0; i < 64; ++i) {
+        out[i] = state->h[i];
     }
 }
 
-static void reduce(uint8_t *r)
+int crypto_hash_final(crypto_hash_state *state,
+                      unsigned char out[crypto_hash_BYTES])
 {
-    int64_t x[64], i;
+    uint8_t x[256];
 
-    for (i = 0; i < 64; ++i) {
-        x[i] = (uint64_t) r[i];
-    }
+    hash_final_ws(state, out, x);
+    return 0;
+}
 
-    for (i = 0; i < 64; ++i) {
-        r[i] = 0;
-    }
+enum {
+    HASH_LANES = 4
+};
 
-    modL(r, x);
-}
+struct hash_lane {
+    const uint8_t *m;
+    const uint8_t *resume;
+    uint64_t blocks;
+    uint8_t head[128];
+    uint8_t tail[256];
+    uint64_t tail_blocks;
+    uint64_t tail_offset;
+    uint64_t index;
+    int active;
+};
 
-int crypto_sign(unsigned char *sm, unsigned long long *smlen,
-                const unsigned char *m, unsigned long long n,
-                const unsigned char *sk)
-{
-    uint8_t d[64], h[64], r[64];
-    int64_t x[64];
-    gf p[4];
+static const uint8_t hash_idle_block[128] = {0};
 
-    crypto_hash(d, sk, 32);
-    d[0] &= 248;
-    d[31] &= 127;
-    d[31] |= 64;
+/* Runs one SHA-512 compression on each of HASH_LANES independent states.
+ * State words are stored lane-minor so that every step of the round function
+ * is a straight loop over the lanes, which compilers turn into SIMD code. */
 
-    *smlen = n + 64;
+static void hashblocks_lanes(uint64_t z[8][HASH_LANES],
+                             const uint8_t *m[HASH_LANES])
+{
+    uint64_t a[8][HASH_LANES], w[16][HASH_LANES];
+    uint64_t t1[HASH_LANES], t2[HASH_LANES];
+    int i, j, l;
 
-    for (unsigned long long i = 0; i < n; ++i) {
-        sm[64 + i] = m[i];
+    for (i = 0; i < 16; ++i) {
+        for (l = 0; l < HASH_LANES; ++l) {
+            w[i][l] = dl64(m[l] + 8 * i);
+        }
     }
 
-    for (int i = 0; i < 32; ++i) {
-        sm[32 + i] = d[32 + i];
+    for (i = 0; i < 8; ++i) {
+        for (l = 0; l < HASH_LANES; ++l) {
+            a[i][l] = z[i][l];
+        }
     }
 
-    crypto_hash(r, sm + 32, n + 32);
-    reduce(r);
-    scalarbase(p, r);
-    pack(sm, p);
+    for (i = 0; i < 80; ++i) {
+        for (l = 0; l < HASH_LANES; ++l) {
+            t1[l] = a[7][l] + Sigma1(a[4][l]) + Ch(a[4][l], a[5][l], a[6][l]) +
+                    K[i] + w[i % 16][l];
+            t2[l] = Sigma0(a[0][l]) + Maj(a[0][l], a[1][l], a[2][l]);
+        }
 
-    for (int i = 0; i < 32; ++i) {
-        sm[i + 32] = sk[i + 32];
-    }
+        for (j = 7; j > 0; --j) {
+            for (l = 0; l < HASH_LANES; ++l) {
+                a[j][l] = a[j - 1][l];
+            }
+        }
 
-    crypto_hash(h, sm, n + 64);
-    reduce(h);
+        for (l = 0; l < HASH_LANES; ++l) {
+            a[4][l] += t1[l];
+            a[0][l] = t1[l] + t2[l];
+        }
 
-    for (int i = 0; i < 64; ++i) {
-        x[i] = 0;
+        if (i % 16 == 15) {
+            for (j = 0; j < 16; ++j) {
+                for (l = 0; l < HASH_LANES; ++l) {
+                    w[j][l] += w[(j + 9) % 16][l] +
+                               sigma0(w[(j + 1) % 16][l]) +
+                               sigma1(w[(j + 14) % 16][l]);
+                }
+            }
+        }
     }
 
-    for (int i = 0; i < 32; ++i) {
-        x[i] = (uint64_t)r[i];
+    for (i = 0; i < 8; ++i) {
+        for (l = 0; l < HASH_LANES; ++l) {
+            z[i][l] += a[i][l];
+        }
     }
+}
+
+/* Starts a lane on prefix || m, where a negative prefix means none. With a
+ * prefix, the first block is assembled in 'head' and the lane then resumes
+ * reading m in place, one byte behind the block boundary. */
+
+static void hash_lane_load(struct hash_lane *lane, uint64_t z[8][HASH_LANES],
+                           int l, const uint8_t *m, uint64_t n, uint64_t index,
+                           int prefix)
+{
+    uint64_t i, skip = (prefix >= 0), total = n + skip, r = total & 127;
+
+    SALINE_STAT(hash_many.bytes, total);
+
+    for (i = 0; i < 8; ++i) {
+        z[i][l] = dl64(iv + 8 * i);
+    }
+
+    lane->m = m;
+    lane->blocks = total >> 7;
+    lane->index = index;
+    lane->active = 1;
+
+    if (skip && lane->blocks > 0) {
+        lane->head[0] = (uint8_t) prefix;
+
+        for (i = 1; i < 128; ++i) {
+            lane->head[i] = m[i - 1];
+        }
+
+        lane->m = lane->head;
+        lane->resume = m + 127;
+    }
+
+    for (i = 0; i < 256; ++i) {
+        lane->tail[i] = 0;
+    }
+
+    for (i = 0; i < r; ++i) {
+        uint64_t p = total - r + i;
+        lane->tail[i] = (p < skip) ? (uint8_t) prefix : m[p - skip];
+    }
+
+    lane->tail[r] = 128;
+    lane->tail_offset = 0;
+    lane->tail_blocks = 2 - (r < 112);
+    lane->tail[128 * lane->tail_blocks - 9] = (uint8_t) (total >> 61);
+    ts64(lane->tail + 128 * lane->tail_blocks - 8, total << 3);
+}
+
+static void hash_lane_advance(struct hash_lane *lane)
+{
+    lane->m = (lane->m == lane->head) ? lane->resume : lane->m + 128;
+    --lane->blocks;
+}
+
+static int hash_many(unsigned char *out, const unsigned char *const *m,
+                     const unsigned long long *n, unsigned long long count,
+                     int prefix)
+{
+    struct hash_lane lanes[HASH_LANES];
+    const uint8_t *blocks[HASH_LANES];
+    uint64_t z[8][HASH_LANES];
+    uint64_t next = 0;
+    int i, l, active = 0;
+
+    SALINE_STAT(hash_many.calls, 1);
+
+    for (l = 0; l < HASH_LANES; ++l) {
+        lanes[l].active = 0;
+
+        if (next < count) {
+            hash_lane_load(&lanes[l], z, l, m[next], n[next], next, prefix);
+            ++next;
+            ++active;
+        }
+    }
+
+    while (active > 0) {
+        if (active == 1 && next == count) {
+            break;
+        }
+
+        for (l = 0; l < HASH_LANES; ++l) {
+            struct hash_lane *lane = &lanes[l];
+
+            if (!lane->active) {
+                blocks[l] = hash_idle_block;
+            } else if (lane->blocks > 0) {
+                blocks[l] = lane->m;
+                hash_lane_advance(lane);
+            } else {
+                blocks[l] = lane->tail + lane->tail_offset;
+                lane->tail_offset += 128;
+                --lane->tail_blocks;
+            }
+        }
+
+        hashblocks_lanes(z, blocks);
+        SALINE_STAT(sha512_blocks, active);
+
+        for (l = 0; l < HASH_LANES; ++l) {
+            struct hash_lane *lane = &lanes[l];
+
+            if (!lane->active || lane->blocks > 0 || lane->tail_blocks > 0) {
+                continue;
+            }
+
+            for (i = 0; i < 8; ++i) {
+                ts64(out + 64 * lane->index + 8 * i, z[i][l]);
+            }
+
+            lane->active = 0;
+            --active;
+
+            if (next < count) {
+                hash_lane_load(lane, z, l, m[next], n[next], next, prefix);
+                ++next;
+                ++active;
+            }
+        }
+    }
+
+    for (l = 0; l < HASH_LANES; ++l) {
+        struct hash_lane *lane = &lanes[l];
+        uint8_t h[64];
+
+        if (!lane->active) {
+            continue;
+        }
+
+        for (i = 0; i < 8; ++i) {
+            ts64(h + 8 * i, z[i][l]);
+        }
+
+        if (lane->blocks > 0 && lane->m == lane->head) {
+            crypto_hashblocks(h, lane->head, 128);
+            hash_lane_advance(lane);
+        }
+
+        crypto_hashblocks(h, lane->m, lane->blocks << 7);
+        crypto_hashblocks(h, lane->tail + lane->tail_offset,
+                          lane->tail_blocks << 7);
+
+        for (i = 0; i < 64; ++i) {
+            out[64 * lane->index + i] = h[i];
+        }
+    }
+
+    return 0;
+}
+
+int crypto_hash_many(unsigned char *out, const unsigned char *const *m,
+                     const unsigned long long *n, unsigned long long count)
+{
+    return hash_many(out, m, n, count, -1);
+}
+
+int saline_hash_many_prefixed(unsigned char *out, unsigned char prefix,
+                              const unsigned char *const *m,
+                              const unsigned long long *n,
+                              unsigned long long count)
+{
+    return hash_many(out, m, n, count, prefix);
+}
+
+static void add(gf p[4], gf q[4])
+{
+    gf a, b, c, d, t, e, f, g, h;
+
+    Z(a, p[1], p[0]);
+    Z(t, q[1], q[0]);
+    M(a, a, t);
+    A(b, p[0], p[1]);
+    A(t, q[0], q[1]);
+    M(b, b, t);
+    M(c, p[3], q[3]);
+    M(c, c, D2);
+    M(d, p[2], q[2]);
+    A(d, d, d);
+    Z(e, b, a);
+    Z(f, d, c);
+    A(g, d, c);
+    A(h, b, a);
+
+    M(p[0], e, f);
+    M(p[1], h, g);
+    M(p[2], g, f);
+    M(p[3], e, h);
+}
+
+/* Encodes p, using t[3] for the affine coordinates. */
+
+static void pack_ws(uint8_t *r, gf p[4], gf t[3])
+{
+    inv25519(t[2], p[2]);
+    M(t[0], p[0], t[2]);
+    M(t[1], p[1], t[2]);
+    pack25519(r, t[1]);
+    r[31] ^= (uint8_t) (par25519(t[0]) << 7);
+}
+
+#if !defined SALINE_NO_BASE_TABLES
+static void cmov25519(gf p, const gf q, uint8_t b)
+{
+    int64_t i, c = -(int64_t) b;
+
+    for (i = 0; i < 16; ++i) {
+        p[i] ^= c & (p[i] ^ q[i]);
+    }
+}
+#endif
+
+/* Edwards point representations. Points are arrays of four field elements
+ * (or three for niels), in one of these forms:
+ *
+ *   p3      (X : Y : Z : T) with x = X/Z, y = Y/Z and xy = T/Z
+ *   p2      a p3 whose T is stale, which is all a doubling needs
+ *   p1p1    ((X : Z), (Y : T)), the completed result of an add or double
+ *   cached  (Y + X, Y - X, Z, 2dT), a p3 prepared as the right-hand side of
+ *           an addition
+ *   niels   (y + x, y - x, 2dxy), an affine point prepared the same way
+ *
+ * Additions and doublings produce a p1p1. Turning that into a p2 costs 3M and
+ * is enough for a following doubling; a following addition needs the 4M p3.
+ * add() is the unified in-place p3 addition, used where neither side has been
+ * prepared. */
+
+static void identity(gf p[4])
+{
+    set25519(p[0], gf0);
+    set25519(p[1], gf1);
+    set25519(p[2], gf1);
+    set25519(p[3], gf0);
+}
+
+static void copy_point(gf p[4], gf q[4])
+{
+    for (int i = 0; i < 4; ++i) {
+        set25519(p[i], q[i]);
+    }
+}
+
+static void p1p1_to_p2(gf r[4], gf p[4])
+{
+    M(r[0], p[0], p[3]);
+    M(r[1], p[1], p[2]);
+    M(r[2], p[2], p[3]);
+}
+
+static void p1p1_to_p3(gf r[4], gf p[4])
+{
+    p1p1_to_p2(r, p);
+    M(r[3], p[0], p[1]);
+}
+
+static void p3_to_cached(gf r[4], gf p[4])
+{
+    A(r[0], p[1], p[0]);
+    Z(r[1], p[1], p[0]);
+    set25519(r[2], p[2]);
+    M(r[3], p[3], D2);
+}
+
+static void neg_cached(gf r[4], gf q[4])
+{
+    set25519(r[0], q[1]);
+    set25519(r[1], q[0]);
+    set25519(r[2], q[2]);
+    Z(r[3], gf0, q[3]);
+}
+
+/* r = 2p for a p2 or p3 input, with the dedicated a = -1 doubling: four
+ * squarings and no multiplies before the conversion out of p1p1. */
+
+static void dbl(gf r[4], gf p[4])
+{
+    gf t;
+
+    S(r[0], p[0]);
+    S(r[2], p[1]);
+    S(r[3], p[2]);
+    A(r[3], r[3], r[3]);
+    A(r[1], p[0], p[1]);
+    S(t, r[1]);
+    A(r[1], r[2], r[0]);
+    Z(r[2], r[2], r[0]);
+    Z(r[0], t, r[1]);
+    Z(r[3], r[3], r[2]);
+}
+
+/* Doubles a p3 in place n >= 1 times, staying in p2 in between. */
+
+static void dbl_times(gf p[4], int n)
+{
+    gf r[4];
+
+    for (int i = 0; i < n; ++i) {
+        dbl(r, p);
+
+        if (i < n - 1) {
+            p1p1_to_p2(p, r);
+        } else {
+            p1p1_to_p3(p, r);
+        }
+    }
+}
+
+/* r = p + q for a p3 p and a cached q (4M). */
+
+static void add_cached(gf r[4], gf p[4], gf q[4])
+{
+    gf t;
+
+    A(r[0], p[1], p[0]);
+    Z(r[1], p[1], p[0]);
+    M(r[2], r[0], q[0]);
+    M(r[1], r[1], q[1]);
+    M(r[3], q[3], p[3]);
+    M(r[0], p[2], q[2]);
+    A(t, r[0], r[0]);
+    Z(r[0], r[2], r[1]);
+    A(r[1], r[2], r[1]);
+    A(r[2], t, r[3]);
+    Z(r[3], t, r[3]);
+}
+
+/* r = p + q for a p3 p and a niels q (3M). Only the base-point tables are
+ * stored as niels points. */
+
+#if !defined SALINE_NO_BASE_TABLES || defined SALINE_TEST_HOOKS
+
+static void madd(gf r[4], gf p[4], gf q[3])
+{
+    gf t;
+
+    A(r[0], p[1], p[0]);
+    Z(r[1], p[1], p[0]);
+    M(r[2], r[0], q[0]);
+    M(r[1], r[1], q[1]);
+    M(r[3], q[2], p[3]);
+    A(t, p[2], p[2]);
+    Z(r[0], r[2], r[1]);
+    A(r[1], r[2], r[1]);
+    A(r[2], t, r[3]);
+    Z(r[3], t, r[3]);
+}
+#endif
+
+#if !defined SALINE_NO_BASE_TABLES
+
+/* Sets t to b * 256^pos * B for a signed digit -8 <= b <= 8, without
+ * branching on or indexing by b. */
+
+static void base_select(gf t[3], int pos, int8_t b)
+{
+    uint8_t neg = (uint8_t) ((uint8_t) b >> 7);
+    uint8_t u = (uint8_t) (((uint8_t) b ^ (0u - neg)) + neg);
+    gf n;
+    int i, j;
+
+    set25519(t[0], gf1);
+    set25519(t[1], gf1);
+    set25519(t[2], gf0);
+
+    for (j = 0; j < 8; ++j) {
+        uint8_t eq = (uint8_t) ((((uint32_t) (u ^ (j + 1))) - 1) >> 31);
+
+        for (i = 0; i < 3; ++i) {
+            for (int k = 0; k < 16; ++k) {
+                n[k] = base_table[pos][j][i][k];
+            }
+
+            cmov25519(t[i], n, eq);
+        }
+    }
+
+    set25519(n, t[0]);
+    cmov25519(t[0], t[1], neg);
+    cmov25519(t[1], n, neg);
+    Z(n, gf0, t[2]);
+    cmov25519(t[2], n, neg);
+}
+
+/* Fixed-base multiplication by a scalar below 2^255, using a radix-16 signed
+ * window over the precomputed base_table. */
+
+struct scalarbase_scratch {
+    int8_t e[64];
+    gf r[4], t[3];
+};
+
+static void scalarbase_ws(gf p[4], const uint8_t *s,
+                          struct scalarbase_scratch *ws)
+{
+    int8_t *e = ws->e, carry = 0;
+    gf *r = ws->r, *t = ws->t;
+    int i;
+
+    for (i = 0; i < 32; ++i) {
+        e[2 * i] = (int8_t) (s[i] & 15);
+        e[2 * i + 1] = (int8_t) ((s[i] >> 4) & 15);
+    }
+
+    for (i = 0; i < 63; ++i) {
+        e[i] = (int8_t) (e[i] + carry);
+        carry = (int8_t) ((e[i] + 8) >> 4);
+        e[i] = (int8_t) (e[i] - (carry << 4));
+    }
+
+    e[63] = (int8_t) (e[63] + carry);
+    identity(p);
+
+    for (i = 1; i < 64; i += 2) {
+        base_select(t, i / 2, e[i]);
+        madd(r, p, t);
+        p1p1_to_p3(p, r);
+    }
+
+    dbl_times(p, 4);
+
+    for (i = 0; i < 64; i += 2) {
+        base_select(t, i / 2, e[i]);
+        madd(r, p, t);
+        p1p1_to_p3(p, r);
+    }
+}
+
+#else
+
+/* Without the precomputed tables (--with-profile=small), fixed-base
+ * multiplication is TweetNaCl's constant-time ladder: a double and an add
+ * per scalar bit, swapped in and out by masks rather than branches. */
+
+static const gf X = {0xd51a, 0x8f25, 0x2d60, 0xc956, 0xa7b2, 0x9525,
+                     0xc760, 0x692c, 0xdc5c, 0xfdd6, 0xe231, 0xc0a4,
+                     0x53fe, 0xcd6e, 0x36d3, 0x2169};
+
+static const gf Y = {0x6658, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666,
+                     0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666,
+                     0x6666, 0x6666, 0x6666, 0x6666};
+
+struct scalarbase_scratch {
+    gf q[4];
+};
+
+static void base_point(gf q[4])
+{
+    set25519(q[0], X);
+    set25519(q[1], Y);
+    set25519(q[2], gf1);
+    M(q[3], X, Y);
+}
+
+static void cswap_point(gf p[4], gf q[4], int b)
+{
+    for (int i = 0; i < 4; ++i) {
+        sel25519(p[i], q[i], b);
+    }
+}
+
+/* Sets p = s * q for a 256-bit s, overwriting q. The doubling is the
+ * dedicated one, which is complete, so every step does the same work
+ * whatever the bit. */
+
+static void ladder(gf p[4], gf q[4], const uint8_t *s)
+{
+    gf r[4];
+
+    identity(p);
+
+    for (int i = 255; i >= 0; --i) {
+        int b = (s[i >> 3] >> (i & 7)) & 1;
+
+        cswap_point(p, q, b);
+        add(q, p);
+        dbl(r, p);
+        p1p1_to_p3(p, r);
+        cswap_point(p, q, b);
+    }
+}
+
+static void scalarbase_ws(gf p[4], const uint8_t *s,
+                          struct scalarbase_scratch *ws)
+{
+    base_point(ws->q);
+    ladder(p, ws->q, s);
+}
+
+#endif
+
+static void scalarbase(gf p[4], const uint8_t *s)
+{
+    struct scalarbase_scratch ws;
+    scalarbase_ws(p, s, &ws);
+}
+
+struct sign_scratch {
+    uint8_t h[64], r[64];
+    gf p[4], t[3];
+    crypto_hash_state hs;
+    uint8_t pad[256];
+    struct scalarbase_scratch base;
+};
+
+/* The layout of crypto_sign_workspace: a signing scratch plus what expanding
+ * the secret key needs. */
+
+struct sign_ws {
+    crypto_sign_ctx ctx;
+    uint8_t d[64];
+    struct hash_scratch hash;
+    struct sign_scratch sign;
+};
+
+/* Expands the seed in sk into a clamped scalar and nonce prefix in d. */
+
+static void sign_expand_ws(uint8_t d[64], const uint8_t *sk,
+                           struct hash_scratch *ws)
+{
+    hash_ws(d, sk, 32, ws);
+    d[0] &= 248;
+    d[31] &= 127;
+    d[31] |= 64;
+}
+
+static void sign_keypair_ws(uint8_t *pk, uint8_t *sk, struct sign_ws *ws)
+{
+    randombytes(sk, 32);
+    sign_expand_ws(ws->d, sk, &ws->hash);
+    scalarbase_ws(ws->sign.p, ws->d, &ws->sign.base);
+    pack_ws(pk, ws->sign.p, ws->sign.t);
 
     for (int i = 0; i < 32; ++i) {
-        for (int j = 0; j < 32; ++j) {
-            x[i + j] += h[i] * (int64_t) d[j];
+        sk[32 + i] = pk[i];
+    }
+}
+
+int crypto_sign_keypair(unsigned char *pk, unsigned char *sk)
+{
+    struct sign_ws ws;
+
+    sign_keypair_ws(pk, sk, &ws);
+    return 0;
+}
+
+int crypto_sign_keypair_ws(unsigned char pk[32], unsigned char sk[64],
+                           crypto_sign_workspace *workspace)
+{
+    sign_keypair_ws(pk, sk, (struct sign_ws *) (void *) workspace);
+    return 0;
+}
+
+static const uint8_t dom2_ph[34] = "SigEd25519 no Ed25519 collisions\1";
+
+/* Signs 'm' with an optional RFC 8032 dom2() prefix. Plain Ed25519 passes no
+ * prefix; Ed25519ph passes dom2(1, "") and the SHA-512 of the message. */
+
+static void sign_detached_ws(uint8_t *sig, const uint8_t *dom,
+                             uint64_t domlen, const uint8_t *m, uint64_t n,
+                             const crypto_sign_ctx *ctx,
+                             struct sign_scratch *ws)
+{
+    uint8_t *h = ws->h, *r = ws->r;
+    crypto_hash_state *hs = &ws->hs;
+
+    SALINE_STAT_CALL(sign, n);
+    crypto_hash_init(hs);
+    crypto_hash_update(hs, dom, domlen);
+    crypto_hash_update(hs, ctx->prefix, 32);
+    crypto_hash_update(hs, m, n);
+    hash_final_ws(hs, r, ws->pad);
+    saline_sc_reduce(r);
+    scalarbase_ws(ws->p, r, &ws->base);
+    pack_ws(sig, ws->p, ws->t);
+
+    crypto_hash_init(hs);
+    crypto_hash_update(hs, dom, domlen);
+    crypto_hash_update(hs, sig, 32);
+    crypto_hash_update(hs, ctx->public_key, 32);
+    crypto_hash_update(hs, m, n);
+    hash_final_ws(hs, h, ws->pad);
+    saline_sc_reduce(h);
+    saline_sc_muladd(sig + 32, h, ctx->scalar, r);
+}
+
+static void sign_detached(uint8_t *sig, const uint8_t *dom, uint64_t domlen,
+                          const uint8_t *m, uint64_t n,
+                          const crypto_sign_ctx *ctx)
+{
+    struct sign_scratch ws;
+    sign_detached_ws(sig, dom, domlen, m, n, ctx, &ws);
+}
+
+static void sign_ctx_init_ws(crypto_sign_ctx *ctx, const uint8_t *sk,
+                             uint8_t d[64], struct hash_scratch *ws)
+{
+    sign_expand_ws(d, sk, ws);
+
+    for (int i = 0; i < 32; ++i) {
+        ctx->scalar[i] = d[i];
+        ctx->prefix[i] = d[32 + i];
+        ctx->public_key[i] = sk[32 + i];
+    }
+}
+
+int crypto_sign_ctx_init(crypto_sign_ctx *ctx, const unsigned char sk[64])
+{
+    uint8_t d[64];
+    struct hash_scratch ws;
+
+    sign_ctx_init_ws(ctx, sk, d, &ws);
+    return 0;
+}
+
+int crypto_sign_detached_with_ctx(unsigned char sig[64],
+                                  unsigned long long *siglen,
+                                  const unsigned char *m, unsigned long long n,
+                                  const crypto_sign_ctx *ctx)
+{
+    sign_detached(sig, 0, 0, m, n, ctx);
+
+    if (siglen) {
+        *siglen = 64;
+    }
+
+    return 0;
+}
+
+int crypto_sign_with_ctx(unsigned char *sm, unsigned long long *smlen,
+                         const unsigned char *m, unsigned long long n,
+                         const crypto_sign_ctx *ctx)
+{
+    uint8_t sig[64];
+
+    crypto_sign_detached_with_ctx(sig, 0, m, n, ctx);
+    *smlen = n + 64;
+
+    for (unsigned long long i = n; i > 0; --i) {
+        sm[63 + i] = m[i - 1];
+    }
+
+    for (int i = 0; i < 64; ++i) {
+        sm[i] = sig[i];
+    }
+
+    return 0;
+}
+
+int crypto_sign_detached(unsigned char sig[64], unsigned long long *siglen,
+                         const unsigned char *m, unsigned long long n,
+                         const unsigned char sk[64])
+{
+    crypto_sign_ctx ctx;
+
+    crypto_sign_ctx_init(&ctx, sk);
+    return crypto_sign_detached_with_ctx(sig, siglen, m, n, &ctx);
+}
+
+int crypto_sign_detached_ws(unsigned char sig[64], unsigned long long *siglen,
+                            const unsigned char *m, unsigned long long n,
+                            const unsigned char sk[64],
+                            crypto_sign_workspace *workspace)
+{
+    struct sign_ws *ws = (struct sign_ws *) (void *) workspace;
+
+    sign_ctx_init_ws(&ws->ctx, sk, ws->d, &ws->hash);
+    sign_detached_ws(sig, 0, 0, m, n, &ws->ctx, &ws->sign);
+
+    if (siglen) {
+        *siglen = 64;
+    }
+
+    return 0;
+}
+
+int crypto_sign(unsigned char *sm, unsigned long long *smlen,
+                const unsigned char *m, unsigned long long n,
+                const unsigned char *sk)
+{
+    crypto_sign_ctx ctx;
+
+    crypto_sign_ctx_init(&ctx, sk);
+    return crypto_sign_with_ctx(sm, smlen, m, n, &ctx);
+}
+
+struct unpack_scratch {
+    gf t, chk, num, den, den2, den4, den6;
+};
+
+static int unpackneg_ws(gf r[4], const uint8_t p[32],
+                        struct unpack_scratch *ws)
+{
+    int64_t *t = ws->t, *chk = ws->chk, *num = ws->num, *den = ws->den;
+    int64_t *den2 = ws->den2, *den4 = ws->den4, *den6 = ws->den6;
+
+    set25519(r[2], gf1);
+    unpack25519(r[1], p);
+    S(num, r[1]);
+    M(den, num, D);
+    Z(num, num, r[2]);
+    A(den, r[2], den);
+
+    S(den2, den);
+    S(den4, den2);
+    M(den6, den4, den2);
+    M(t, den6, num);
+    M(t, t, den);
+
+    pow2523(t, t);
+    M(t, t, num);
+    M(t, t, den);
+    M(t, t, den);
+    M(r[0], t, den);
+
+    S(chk, r[0]);
+    M(chk, chk, den);
+
+    if (neq25519(chk, num)) {
+        M(r[0], r[0], I);
+    }
+
+    S(chk, r[0]);
+    M(chk, chk, den);
+
+    if (neq25519(chk, num)) {
+        return -1;
+    }
+
+    if (par25519(r[0]) == (p[31] >> 7)) {
+        Z(r[0], gf0, r[0]);
+    }
+
+    M(r[3], r[0], r[1]);
+    return 0;
+}
+
+static int unpackneg(gf r[4], const uint8_t p[32])
+{
+    struct unpack_scratch ws;
+    return unpackneg_ws(r, p, &ws);
+}
+
+/* Recodes a scalar into width-w NAF form: every nonzero digit is odd, below
+ * 'max' in magnitude, and followed by enough zeros that the loop in
+ * double_scalarmult_vartime() rarely needs to add. */
+
+static void slide(int8_t r[256], const uint8_t *a, int max)
+{
+    int i, b, k;
+
+    for (i = 0; i < 256; ++i) {
+        r[i] = (int8_t) (1 & (a[i >> 3] >> (i & 7)));
+    }
+
+    for (i = 0; i < 256; ++i) {
+        if (r[i] == 0) {
+            continue;
+        }
+
+        for (b = 1; b <= 8 && i + b < 256; ++b) {
+            if (r[i + b] == 0) {
+                continue;
+            }
+
+            if (r[i] + (r[i + b] << b) <= max) {
+                r[i] = (int8_t) (r[i] + (r[i + b] << b));
+                r[i + b] = 0;
+            } else if (r[i] - (r[i + b] << b) >= -max) {
+                r[i] = (int8_t) (r[i] - (r[i + b] << b));
+
+                for (k = i + b; k < 256; ++k) {
+                    if (r[k] == 0) {
+                        r[k] = 1;
+                        break;
+                    }
+
+                    r[k] = 0;
+                }
+            } else {
+                break;
+            }
+        }
+    }
+}
+
+/* Sets p = a * q + b * B. Runs in variable time, so it must only be used
+ * with public inputs such as those of signature verification. q uses a
+ * width-5 window of 8 odd multiples built on the fly; B uses the 32 odd
+ * multiples in base_odd. */
+
+struct dsm_scratch {
+    int8_t na[256], nb[256];
+    gf qi[8][4], q2[4], r[4], t[4], n[3];
+};
+
+static void double_scalarmult_vartime(gf p[4], const uint8_t *a, gf q[4],
+                                      const uint8_t *b, struct dsm_scratch *ws)
+{
+    int8_t *na = ws->na, *nb = ws->nb;
+    gf (*qi)[4] = ws->qi, *q2 = ws->q2, *r = ws->r, *t = ws->t;
+    int i;
+
+    slide(na, a, 15);
+
+#if !defined SALINE_NO_BASE_TABLES
+    slide(nb, b, 63);
+#else
+    for (i = 0; i < 256; ++i) {
+        nb[i] = 0;
+    }
+#endif
+
+    copy_point(t, q);
+    p3_to_cached(qi[0], t);
+    dbl_times(t, 1);
+    p3_to_cached(q2, t);
+    copy_point(t, q);
+
+    for (i = 1; i < 8; ++i) {
+        add_cached(r, t, q2);
+        p1p1_to_p3(t, r);
+        p3_to_cached(qi[i], t);
+    }
+
+    identity(p);
+
+    for (i = 255; i >= 0 && na[i] == 0 && nb[i] == 0; --i) {
+    }
+
+    for (; i >= 0; --i) {
+        dbl(r, p);
+
+        if (na[i] != 0) {
+            p1p1_to_p3(t, r);
+
+            if (na[i] > 0) {
+                add_cached(r, t, qi[na[i] / 2]);
+            } else {
+                neg_cached(q2, qi[-na[i] / 2]);
+                add_cached(r, t, q2);
+            }
+        }
+
+#if !defined SALINE_NO_BASE_TABLES
+        if (nb[i] != 0) {
+            int k = (nb[i] < 0 ? -nb[i] : nb[i]) / 2;
+            gf *n = ws->n;
+
+            for (int j = 0; j < 16; ++j) {
+                n[0][j] = base_odd[k][nb[i] < 0][j];
+                n[1][j] = base_odd[k][nb[i] > 0][j];
+                n[2][j] = base_odd[k][2][j];
+            }
+
+            if (nb[i] < 0) {
+                Z(n[2], gf0, n[2]);
+            }
+
+            p1p1_to_p3(t, r);
+            madd(r, t, n);
+        }
+#endif
+
+        if (i > 0) {
+            p1p1_to_p2(p, r);
+        } else {
+            p1p1_to_p3(p, r);
+        }
+    }
+
+#if defined SALINE_NO_BASE_TABLES
+    /* Without base_odd, b * B comes from the ladder and is added at the end. */
+    base_point(q2);
+    ladder(t, q2, b);
+    add(p, t);
+#endif
+}
+
+static int vk_init_ws(crypto_sign_vk *vk, const uint8_t *pk,
+                      struct unpack_scratch *ws)
+{
+    vk->valid = 0;
+
+    for (int i = 0; i < 32; ++i) {
+        vk->public_key[i] = pk[i];
+    }
+
+    if (unpackneg_ws(vk->point, pk, ws)) {
+        return -1;
+    }
+
+    vk->valid = 1;
+    return 0;
+}
+
+int crypto_sign_vk_init(crypto_sign_vk *vk, const unsigned char pk[32])
+{
+    struct unpack_scratch ws;
+    return vk_init_ws(vk, pk, &ws);
+}
+
+/* Whether p is an encoding pack_ws() can produce: y below 2^255 - 19, and a
+ * clear sign bit when x = 0, which happens for y = 1 and y = -1. R must be
+ * one of these, as it is in any signature crypto_sign() makes. */
+
+static int canonical_point(const uint8_t *p)
+{
+    int zeros = (p[31] & 127) == 0, ones = (p[31] & 127) == 127;
+
+    for (int i = 1; i < 31; ++i) {
+        zeros &= p[i] == 0;
+        ones &= p[i] == 255;
+    }
+
+    if (ones && p[0] >= 0xed) {
+        return 0;
+    }
+
+    return !((p[31] & 128) && ((zeros && p[0] == 1) ||
+                               (ones && p[0] == 0xec)));
+}
+
+/* Returns 0 if 8 * p is the identity, clobbering p. Verification checks its
+ * equation multiplied by the cofactor, so single and batch verification
+ * accept the same signatures, whatever small-order components R and A
+ * carry. */
+
+static int cofactor_check(gf p[4])
+{
+    dbl_times(p, 3);
+    return (neq25519(p[0], gf0) || neq25519(p[1], p[2])) ? -1 : 0;
+}
+
+struct verify_scratch {
+    uint8_t h[64];
+    gf p[4], q[4];
+    crypto_hash_state hs;
+    uint8_t pad[256];
+    union {
+        struct dsm_scratch dsm;
+        struct unpack_scratch unpack;
+    } u;
+};
+
+/* The layout of crypto_sign_verify_workspace. The public key is decoded
+ * before verification starts, so the two scratches can overlap. */
+
+struct verify_ws {
+    crypto_sign_vk vk;
+    union {
+        struct unpack_scratch unpack;
+        struct verify_scratch verify;
+    } u;
+};
+
+static int verify_detached_ws(const uint8_t *sig, const uint8_t *dom,
+                              uint64_t domlen, const uint8_t *m, uint64_t n,
+                              const crypto_sign_vk *vk,
+                              struct verify_scratch *ws)
+{
+    uint8_t *h = ws->h;
+    crypto_hash_state *hs = &ws->hs;
+
+    SALINE_STAT_CALL(sign_verify, n);
+
+    if (!vk->valid || !canonical_point(sig) ||
+        !saline_sc_is_canonical(sig + 32)) {
+        return -1;
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 16; ++j) {
+            ws->q[i][j] = vk->point[i][j];
         }
     }
 
-    modL(sm + 32, x);
+    crypto_hash_init(hs);
+    crypto_hash_update(hs, dom, domlen);
+    crypto_hash_update(hs, sig, 32);
+    crypto_hash_update(hs, vk->public_key, 32);
+    crypto_hash_update(hs, m, n);
+    hash_final_ws(hs, h, ws->pad);
+    saline_sc_reduce(h);
+    double_scalarmult_vartime(ws->p, h, ws->q, sig + 32, &ws->u.dsm);
 
-    return 0;
+    /* The copy of the key point is no longer needed, so -R goes over it. */
+
+    if (unpackneg_ws(ws->q, sig, &ws->u.unpack)) {
+        return -1;
+    }
+
+    add(ws->p, ws->q);
+
+    return cofactor_check(ws->p);
 }
 
-static int unpackneg(gf r[4], const uint8_t p[32])
+static int verify_detached(const uint8_t *sig, const uint8_t *dom,
+                           uint64_t domlen, const uint8_t *m, uint64_t n,
+                           const crypto_sign_vk *vk)
 {
-    gf t, chk, num, den, den2, den4, den6;
-    set25519(r[2], gf1);
-    unpack25519(r[1], p);
-    S(num, r[1]);
-    M(den, num, D);
-    Z(num, num, r[2]);
-    A(den, r[2], den);
+    struct verify_scratch ws;
+    return verify_detached_ws(sig, dom, domlen, m, n, vk, &ws);
+}
 
-    S(den2, den);
-    S(den4, den2);
-    M(den6, den4, den2);
-    M(t, den6, num);
-    M(t, t, den);
+int crypto_sign_verify_detached_vk(const unsigned char sig[64],
+                                   const unsigned char *m,
+                                   unsigned long long n,
+                                   const crypto_sign_vk *vk)
+{
+    return verify_detached(sig, 0, 0, m, n, vk);
+}
 
-    pow2523(t, t);
-    M(t, t, num);
-    M(t, t, den);
-    M(t, t, den);
-    M(r[0], t, den);
+int crypto_sign_verify_detached(const unsigned char sig[64],
+                                const unsigned char *m, unsigned long long n,
+                                const unsigned char pk[32])
+{
+    crypto_sign_vk vk;
 
-    S(chk, r[0]);
-    M(chk, chk, den);
+    crypto_sign_vk_init(&vk, pk);
+    return verify_detached(sig, 0, 0, m, n, &vk);
+}
 
-    if (neq25519(chk, num)) {
-        M(r[0], r[0], I);
-    }
+int crypto_sign_verify_detached_ws(const unsigned char sig[64],
+                                   const unsigned char *m,
+                                   unsigned long long n,
+                                   const unsigned char pk[32],
+                                   crypto_sign_verify_workspace *workspace)
+{
+    struct verify_ws *ws = (struct verify_ws *) (void *) workspace;
 
-    S(chk, r[0]);
-    M(chk, chk, den);
+    vk_init_ws(&ws->vk, pk, &ws->u.unpack);
+    return verify_detached_ws(sig, 0, 0, m, n, &ws->vk, &ws->u.verify);
+}
 
-    if (neq25519(chk, num)) {
+int crypto_sign_vk_cache_init(crypto_sign_vk_cache *cache,
+                              crypto_sign_vk *slots, unsigned long long count)
+{
+    if (count == 0) {
         return -1;
     }
 
-    if (par25519(r[0]) == (p[31] >> 7)) {
-        Z(r[0], gf0, r[0]);
+    cache->slots = slots;
+    cache->count = count;
+
+    for (unsigned long long i = 0; i < count; ++i) {
+        slots[i].valid = 0;
     }
 
-    M(r[3], r[0], r[1]);
     return 0;
 }
 
-int crypto_sign_open(unsigned char *m, unsigned long long *mlen,
-                     const unsigned char *sm, unsigned long long n,
-                     const unsigned char *pk)
+/* Public keys are public, so the slot comes straight from the key bytes and
+ * the comparison doesn't need to be constant-time. A colliding key simply
+ * replaces the one in its slot. */
+
+const crypto_sign_vk *crypto_sign_vk_cache_lookup(crypto_sign_vk_cache *cache,
+                                                  const unsigned char pk[32])
 {
-    uint8_t t[32], h[64];
-    gf p[4], q[4];
+    uint64_t k = 0;
+    crypto_sign_vk *vk;
+    int i;
 
-    *mlen = (unsigned long long) (-1);
+    for (i = 7; i >= 0; --i) {
+        k = (k << 8) | pk[i];
+    }
 
-    if (n < 64) {
+    vk = &cache->slots[k % cache->count];
+
+    if (vk->valid) {
+        for (i = 0; i < 32 && vk->public_key[i] == pk[i]; ++i) {
+        }
+
+        if (i == 32) {
+            return vk;
+        }
+    }
+
+    return crypto_sign_vk_init(vk, pk) ? 0 : vk;
+}
+
+int crypto_sign_verify_detached_cached(const unsigned char sig[64],
+                                       const unsigned char *m,
+                                       unsigned long long n,
+                                       const unsigned char pk[32],
+                                       crypto_sign_vk_cache *cache)
+{
+    const crypto_sign_vk *vk = crypto_sign_vk_cache_lookup(cache, pk);
+
+    if (vk == 0) {
         return -1;
     }
 
-    if (unpackneg(q, pk)) {
+    return verify_detached(sig, 0, 0, m, n, vk);
+}
+
+/* The scratch for a group of 32 is 82 KiB, too much for the stack, so it is
+ * allocated once per call. Most of the cost per signature is decoding R and
+ * A, so larger groups or wider windows gain little. */
+
+enum {
+    BATCH_SIGS = 32,
+    BATCH_POINTS = 2 * BATCH_SIGS,
+    BATCH_ODD = 2
+};
+
+/* Scratch for one group: each point's scalar, its NAF digits and its table
+ * of odd multiples q, 3q, ..., (2 * BATCH_ODD - 1)q in cached form. */
+
+struct batch_scratch {
+    gf table[BATCH_POINTS][BATCH_ODD][4];
+    uint8_t s[BATCH_POINTS][32];
+    int8_t naf[BATCH_POINTS][256];
+};
+
+/* Decodes p as -P and fills 'table' with its odd multiples. */
+
+static int batch_point(gf table[BATCH_ODD][4], const uint8_t *p)
+{
+    gf q[4], q2[4], r[4], t[4];
+
+    if (unpackneg(q, p)) {
         return -1;
     }
 
-    for (unsigned long long i = 0; i < n; ++i) {
-        m[i] = sm[i];
+    copy_point(t, q);
+    p3_to_cached(table[0], t);
+    dbl_times(t, 1);
+    p3_to_cached(q2, t);
+    copy_point(t, q);
+
+    for (int k = 1; k < BATCH_ODD; ++k) {
+        add_cached(r, t, q2);
+        p1p1_to_p3(t, r);
+        p3_to_cached(table[k], t);
+    }
+
+    return 0;
+}
+
+/* Sets p = sum(s[i] * q[i]) over the first 'count' points in 'ws' using
+ * Straus's method: one run of doublings is shared by all the points, and
+ * each adds from its own table whenever its NAF has a digit. Runs in
+ * variable time, so it must only see public data. */
+
+static void msm_vartime(gf p[4], struct batch_scratch *ws, int count)
+{
+    gf r[4], t[4], q2[4];
+    int top = -1;
+
+    for (int i = 0; i < count; ++i) {
+        slide(ws->naf[i], ws->s[i], 2 * BATCH_ODD - 1);
+
+        for (int j = 255; j > top; --j) {
+            if (ws->naf[i][j] != 0) {
+                top = j;
+            }
+        }
+    }
+
+    identity(p);
+
+    for (int j = top; j >= 0; --j) {
+        dbl(r, p);
+
+        for (int i = 0; i < count; ++i) {
+            int d = ws->naf[i][j];
+
+            if (d == 0) {
+                continue;
+            }
+
+            p1p1_to_p3(t, r);
+
+            if (d > 0) {
+                add_cached(r, t, ws->table[i][d / 2]);
+            } else {
+                neg_cached(q2, ws->table[i][-d / 2]);
+                add_cached(r, t, q2);
+            }
+        }
+
+        if (j > 0) {
+            p1p1_to_p2(p, r);
+        } else {
+            p1p1_to_p3(p, r);
+        }
     }
+}
+
+/* Checks 8 * sum(z[i] * (S[i] * B - R[i] - h[i] * A[i])) == 0 for random
+ * 128-bit z[i]. Each term that is 0 after multiplying by the cofactor drops
+ * out, and any other term makes the sum nonzero except with probability
+ * about 2^-128. A public key repeated in the group is decoded once and its
+ * scalars are summed. */
+
+static int verify_batch(const unsigned char *const *sig,
+                        const unsigned char *const *m,
+                        const unsigned long long *n,
+                        const unsigned char *const *pk, int count,
+                        struct batch_scratch *ws)
+{
+    uint8_t z[BATCH_SIGS][16], sb[32], h[64], w[32];
+    int key[BATCH_SIGS], points = 0;
+    crypto_hash_state hs;
+    gf p[4], b[4];
+
+    randombytes(z[0], 16 * (uint64_t) count);
 
     for (int i = 0; i < 32; ++i) {
-        m[i + 32] = pk[i];
+        sb[i] = 0;
+        w[i] = 0;
     }
 
-    crypto_hash(h, m, n);
-    reduce(h);
-    scalarmult(p, q, h);
+    for (int i = 0; i < count; ++i) {
+        if (!canonical_point(sig[i]) || !saline_sc_is_canonical(sig[i] + 32)) {
+            return -1;
+        }
+
+        key[i] = -1;
 
-    scalarbase(q, sm + 32);
-    add(p, q);
-    pack(t, p);
+        for (int j = 0; j < i && key[i] < 0; ++j) {
+            if (crypto_verify_32(pk[i], pk[j]) == 0) {
+                key[i] = key[j];
+            }
+        }
+
+        if (key[i] < 0) {
+            if (batch_point(ws->table[points], pk[i])) {
+                return -1;
+            }
+
+            key[i] = points;
+
+            for (int j = 0; j < 32; ++j) {
+                ws->s[points][j] = 0;
+            }
+
+            ++points;
+        }
+
+        if (batch_point(ws->table[points], sig[i])) {
+            return -1;
+        }
+
+        crypto_hash_init(&hs);
+        crypto_hash_update(&hs, sig[i], 32);
+        crypto_hash_update(&hs, pk[i], 32);
+        crypto_hash_update(&hs, m[i], n[i]);
+        crypto_hash_final(&hs, h);
+        saline_sc_reduce(h);
+
+        for (int j = 0; j < 16; ++j) {
+            w[j] = z[i][j];
+            ws->s[points][j] = z[i][j];
+            ws->s[points][16 + j] = 0;
+        }
+
+        saline_sc_muladd(ws->s[key[i]], w, h, ws->s[key[i]]);
+        saline_sc_muladd(sb, w, sig[i] + 32, sb);
+        ++points;
+    }
+
+    msm_vartime(p, ws, points);
+    scalarbase(b, sb);
+    add(p, b);
+
+    return cofactor_check(p);
+}
+
+int crypto_sign_verify_batch(const unsigned char *const *sig,
+                             const unsigned char *const *m,
+                             const unsigned long long *n,
+                             const unsigned char *const *pk,
+                             unsigned long long count, int *results)
+{
+    struct batch_scratch *ws = 0;
+    int status = 0;
+
+    SALINE_STAT(sign_verify_batch.calls, 1);
+
+    for (unsigned long long i = 0; i < count; ++i) {
+        SALINE_STAT(sign_verify_batch.bytes, n[i]);
+    }
+
+    if (count > 1) {
+        ws = malloc(sizeof(*ws));
+    }
+
+    for (unsigned long long done = 0; done < count; done += BATCH_SIGS) {
+        int batch = BATCH_SIGS;
+
+        if (count - done < BATCH_SIGS) {
+            batch = (int) (count - done);
+        }
+
+        if (ws && verify_batch(sig + done, m + done, n + done, pk + done,
+                               batch, ws) == 0) {
+            for (int i = 0; results && i < batch; ++i) {
+                results[done + i] = 0;
+            }
+
+            continue;
+        }
+
+        if (ws && results == 0) {
+            status = -1;
+            break;
+        }
+
+        /* Check the group one signature at a time, after a failure or when
+         * there is no scratch. Single verification checks the same
+         * cofactored equation, so results[] doesn't depend on grouping. */
+
+        for (unsigned long long i = done; i < done + batch; ++i) {
+            int result = crypto_sign_verify_detached(sig[i], m[i], n[i],
+                                                     pk[i]);
+
+            if (results) {
+                results[i] = result;
+            }
+
+            status |= result;
+        }
+
+        if (status != 0 && results == 0) {
+            break;
+        }
+    }
+
+    free(ws);
+    return status;
+}
+
+static int sign_open(unsigned char *m, unsigned long long *mlen,
+                     const unsigned char *sm, unsigned long long n,
+                     const crypto_sign_vk *vk)
+{
+    *mlen = (unsigned long long) (-1);
+
+    if (n < 64) {
+        return -1;
+    }
 
     n -= 64;
 
-    if (crypto_verify_32(sm, t)) {
+    if (verify_detached(sm, 0, 0, sm + 64, n, vk)) {
         for (unsigned long long i = 0; i < n; ++i) {
             m[i] = 0;
         }
@@ -1161,3 +2634,179 @@ int crypto_sign_open(unsigned char *m, unsigned long long *mlen,
     *mlen = n;
     return 0;
 }
+
+int crypto_sign_open(unsigned char *m, unsigned long long *mlen,
+                     const unsigned char *sm, unsigned long long n,
+                     const unsigned char *pk)
+{
+    crypto_sign_vk vk;
+
+    crypto_sign_vk_init(&vk, pk);
+    return sign_open(m, mlen, sm, n, &vk);
+}
+
+int crypto_sign_open_vk(unsigned char *m, unsigned long long *mlen,
+                        const unsigned char *sm, unsigned long long n,
+                        const crypto_sign_vk *vk)
+{
+    return sign_open(m, mlen, sm, n, vk);
+}
+
+int crypto_sign_init(crypto_sign_state *state)
+{
+    return crypto_hash_init(&state->hs);
+}
+
+int crypto_sign_update(crypto_sign_state *state, const unsigned char *m,
+                       unsigned long long n)
+{
+    return crypto_hash_update(&state->hs, m, n);
+}
+
+int crypto_sign_final_create(crypto_sign_state *state, unsigned char sig[64],
+                             unsigned long long *siglen,
+                             const unsigned char sk[64])
+{
+    crypto_sign_ctx ctx;
+    uint8_t ph[64];
+
+    crypto_hash_final(&state->hs, ph);
+    crypto_sign_ctx_init(&ctx, sk);
+    sign_detached(sig, dom2_ph, sizeof(dom2_ph), ph, 64, &ctx);
+
+    if (siglen) {
+        *siglen = 64;
+    }
+
+    return 0;
+}
+
+int crypto_sign_final_verify(crypto_sign_state *state,
+                             const unsigned char sig[64],
+                             const unsigned char pk[32])
+{
+    crypto_sign_vk vk;
+    uint8_t ph[64];
+
+    crypto_hash_final(&state->hs, ph);
+    crypto_sign_vk_init(&vk, pk);
+    return verify_detached(sig, dom2_ph, sizeof(dom2_ph), ph, 64, &vk);
+}
+
+/* Each public workspace must hold the layout that is cast onto it. */
+
+#define WS_FITS(layout, bytes) \
+    typedef char ws_fits_##bytes[(sizeof(layout) <= (bytes)) ? 1 : -1]
+
+WS_FITS(struct hash_scratch, crypto_hash_WORKSPACEBYTES);
+WS_FITS(struct x25519_scratch, crypto_scalarmult_WORKSPACEBYTES);
+WS_FITS(struct sign_ws, crypto_sign_WORKSPACEBYTES);
+WS_FITS(struct verify_ws, crypto_sign_verify_WORKSPACEBYTES);
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef SALINE_TEST_HOOKS
+#include "saline_hooks.h"
+
+void saline_hook_M(int64_t *o, const int64_t *a, const int64_t *b)
+{
+    M(o, a, b);
+}
+
+void saline_hook_S(int64_t *o, const int64_t *a)
+{
+    S(o, a);
+}
+
+void saline_hook_car25519(int64_t *o)
+{
+    car25519(o);
+}
+
+void saline_hook_inv25519(int64_t *o, const int64_t *i)
+{
+    inv25519(o, i);
+}
+
+void saline_hook_pow2523(int64_t *o, const int64_t *i)
+{
+    pow2523(o, i);
+}
+
+void saline_hook_pack25519(uint8_t *o, const int64_t *n)
+{
+    pack25519(o, n);
+}
+
+void saline_hook_unpack25519(int64_t *o, const uint8_t *n)
+{
+    unpack25519(o, n);
+}
+
+void saline_hook_add(int64_t (*p)[16], int64_t (*q)[16])
+{
+    add(p, q);
+}
+
+void saline_hook_dbl(int64_t (*r)[16], int64_t (*p)[16])
+{
+    dbl(r, p);
+}
+
+void saline_hook_add_cached(int64_t (*r)[16], int64_t (*p)[16],
+                            int64_t (*q)[16])
+{
+    add_cached(r, p, q);
+}
+
+void saline_hook_madd(int64_t (*r)[16], int64_t (*p)[16], int64_t (*q)[16])
+{
+    madd(r, p, q);
+}
+
+void saline_hook_p1p1_to_p3(int64_t (*r)[16], int64_t (*p)[16])
+{
+    p1p1_to_p3(r, p);
+}
+
+void saline_hook_p3_to_cached(int64_t (*r)[16], int64_t (*p)[16])
+{
+    p3_to_cached(r, p);
+}
+
+void saline_hook_pack(uint8_t *r, int64_t (*p)[16])
+{
+    gf t[3];
+    pack_ws(r, p, t);
+}
+
+int saline_hook_unpackneg(int64_t (*r)[16], const uint8_t *p)
+{
+    return unpackneg(r, p);
+}
+
+void saline_hook_scalarbase(int64_t (*p)[16], const uint8_t *s)
+{
+    scalarbase(p, s);
+}
+
+void saline_hook_double_scalarmult(int64_t (*p)[16], const uint8_t *a,
+                                   int64_t (*q)[16], const uint8_t *b)
+{
+    struct dsm_scratch ws;
+    double_scalarmult_vartime(p, a, q, b, &ws);
+}
+
+void saline_hook_core_salsa20(uint8_t *out, const uint8_t *in,
+                              const uint8_t *k)
+{
+    crypto_core_salsa20(out, in, k, sigma);
+}
+
+void saline_hook_core_hsalsa20(uint8_t *out, const uint8_t *in,
+                               const uint8_t *k)
+{
+    crypto_core_hsalsa20(out, in, k, sigma);
+}
+
+#endif
@@ -1,6 +1,76 @@
 #ifndef SALINE_H
 #define SALINE_H
 
+#include <stdint.h>
+
+enum {
+    crypto_hash_BYTES = 64
+};
+
+int crypto_hash (
+    unsigned char hash[crypto_hash_BYTES],
+    const unsigned char *msg,
+    unsigned long long msg_length
+);
+
+/* Incremental SHA-512. Feeding a message through any sequence of update
+ * calls gives the same result as a single crypto_hash() call. */
+
+typedef struct crypto_hash_state {
+    unsigned char h[64];
+    unsigned char buffer[128];
+    unsigned long long length;
+} crypto_hash_state;
+
+int crypto_hash_init (
+    crypto_hash_state *state
+);
+
+int crypto_hash_update (
+    crypto_hash_state *state,
+    const unsigned char *msg,
+    unsigned long long msg_length
+);
+
+int crypto_hash_final (
+    crypto_hash_state *state,
+    unsigned char hash[crypto_hash_BYTES]
+);
+
+/* Hashes 'count' independent messages, writing crypto_hash_BYTES per message
+ * into consecutive slots of 'hashes'. Messages are interleaved through a
+ * multi-lane SHA-512 core, so each result matches crypto_hash() exactly. */
+
+int crypto_hash_many (
+    unsigned char *hashes,
+    const unsigned char *const *msgs,
+    const unsigned long long *msg_lengths,
+    unsigned long long count
+);
+
+/*----------------------------------------------------------------------------*/
+
+enum {
+    crypto_hash_tree_BYTES = 64,
+    crypto_hash_tree_CHUNKBYTES = 1048576
+};
+
+/* Parallel tree hash over SHA-512. This is its own construction, and its
+ * output does not match crypto_hash(). Leaves are chunk_length-byte slices of
+ * the message, hashed on up to 'threads' threads (0 means one thread per
+ * online CPU). The layout is documented in saline_treehash.c and README.md.
+ * Returns -1 if chunk_length is zero or memory can't be allocated. */
+
+int crypto_hash_tree (
+    unsigned char hash[crypto_hash_tree_BYTES],
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    unsigned long long chunk_length,
+    unsigned int threads
+);
+
+/*----------------------------------------------------------------------------*/
+
 enum {
     crypto_auth_BYTES = 32,
     crypto_auth_KEYBYTES = 32
@@ -20,6 +90,68 @@ int crypto_auth_verify (
     const unsigned char key[crypto_auth_KEYBYTES]
 );
 
+/* Per-key HMAC-SHA-512-256 schedule. Holds the SHA-512 midstates after the
+ * ipad and opad blocks, so the *_with_ctx() calls skip both key compressions.
+ * The contents are as sensitive as the key itself. */
+
+typedef struct crypto_auth_ctx {
+    unsigned char inner[64];
+    unsigned char outer[64];
+} crypto_auth_ctx;
+
+int crypto_auth_ctx_init (
+    crypto_auth_ctx *ctx,
+    const unsigned char key[crypto_auth_KEYBYTES]
+);
+
+int crypto_auth_with_ctx (
+    unsigned char auth[crypto_auth_BYTES],
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    const crypto_auth_ctx *ctx
+);
+
+int crypto_auth_verify_with_ctx (
+    const unsigned char auth[crypto_auth_BYTES],
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    const crypto_auth_ctx *ctx
+);
+
+/* Incremental HMAC-SHA-512-256. The tag from init/update/final matches a
+ * one-shot crypto_auth() over the concatenated message. */
+
+typedef struct crypto_auth_state {
+    crypto_hash_state inner;
+    unsigned char outer[64];
+} crypto_auth_state;
+
+int crypto_auth_init (
+    crypto_auth_state *state,
+    const unsigned char key[crypto_auth_KEYBYTES]
+);
+
+int crypto_auth_init_with_ctx (
+    crypto_auth_state *state,
+    const crypto_auth_ctx *ctx
+);
+
+int crypto_auth_update (
+    crypto_auth_state *state,
+    const unsigned char *msg,
+    unsigned long long msg_length
+);
+
+int crypto_auth_final (
+    crypto_auth_state *state,
+    unsigned char auth[crypto_auth_BYTES]
+);
+
+int crypto_auth_final_verify (
+    crypto_auth_state *state,
+    const unsigned char auth[crypto_auth_BYTES]
+);
+
 /*----------------------------------------------------------------------------*/
 
 enum {
@@ -28,7 +160,8 @@ enum {
     crypto_box_BEFORENMBYTES = 32,
     crypto_box_NONCEBYTES = 24,
     crypto_box_ZEROBYTES = 32,
-    crypto_box_BOXZEROBYTES = 16
+    crypto_box_BOXZEROBYTES = 16,
+    crypto_box_MACBYTES = 16
 };
 
 int crypto_box (
@@ -49,6 +182,30 @@ int crypto_box_open (
     const unsigned char receiver_secret[crypto_box_SECRETKEYBYTES]
 );
 
+/* Same as crypto_box() and crypto_box_open(), but without the padding: the
+ * cypher text is exactly as long as the message, and the authenticator is
+ * kept apart in 'mac'. The text may be encrypted or decrypted in place. */
+
+int crypto_box_detached (
+    unsigned char *cypher,
+    unsigned char mac[crypto_box_MACBYTES],
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    const unsigned char nonce[crypto_box_NONCEBYTES],
+    const unsigned char receiver_public[crypto_box_PUBLICKEYBYTES],
+    const unsigned char sender_secret[crypto_box_SECRETKEYBYTES]
+);
+
+int crypto_box_open_detached (
+    unsigned char *msg,
+    const unsigned char *cypher,
+    const unsigned char mac[crypto_box_MACBYTES],
+    unsigned long long cypher_length,
+    const unsigned char nonce[crypto_box_NONCEBYTES],
+    const unsigned char sender_public[crypto_box_PUBLICKEYBYTES],
+    const unsigned char receiver_secret[crypto_box_SECRETKEYBYTES]
+);
+
 int crypto_box_keypair (
     unsigned char public_key[crypto_box_PUBLICKEYBYTES],
     unsigned char secret_key[crypto_box_SECRETKEYBYTES]
@@ -78,18 +235,6 @@ int crypto_box_open_afternm (
 
 /*----------------------------------------------------------------------------*/
 
-enum {
-    crypto_hash_BYTES = 64
-};
-
-int crypto_hash (
-    unsigned char hash[crypto_hash_BYTES],
-    const unsigned char *msg,
-    unsigned long long msg_length
-);
-
-/*----------------------------------------------------------------------------*/
-
 enum {
     crypto_onetimeauth_BYTES = 16,
     crypto_onetimeauth_KEYBYTES = 32
@@ -133,7 +278,8 @@ enum {
     crypto_secretbox_KEYBYTES = 32,
     crypto_secretbox_NONCEBYTES = 24,
     crypto_secretbox_ZEROBYTES = 32,
-    crypto_secretbox_BOXZEROBYTES = 16
+    crypto_secretbox_BOXZEROBYTES = 16,
+    crypto_secretbox_MACBYTES = 16
 };
 
 int crypto_secretbox (
@@ -152,6 +298,119 @@ int crypto_secretbox_open (
     const unsigned char key[crypto_secretbox_KEYBYTES]
 );
 
+/* Unpadded secretbox, like crypto_box_detached(). In crypto_secretbox()
+ * output, the cypher text is everything after the first
+ * crypto_secretbox_ZEROBYTES, and 'mac' is the crypto_secretbox_MACBYTES
+ * that end them. */
+
+int crypto_secretbox_detached (
+    unsigned char *cypher,
+    unsigned char mac[crypto_secretbox_MACBYTES],
+    const unsigned char *msg,
+    unsigned long long msg_len,
+    const unsigned char nonce[crypto_secretbox_NONCEBYTES],
+    const unsigned char key[crypto_secretbox_KEYBYTES]
+);
+
+int crypto_secretbox_open_detached (
+    unsigned char *msg,
+    const unsigned char *cypher,
+    const unsigned char mac[crypto_secretbox_MACBYTES],
+    unsigned long long cypher_len,
+    const unsigned char nonce[crypto_secretbox_NONCEBYTES],
+    const unsigned char key[crypto_secretbox_KEYBYTES]
+);
+
+/*----------------------------------------------------------------------------*/
+
+enum {
+    crypto_nonce_BYTES = 24,
+    crypto_nonce_PREFIXBYTES = 16,
+    crypto_nonce_WINDOW = 128
+};
+
+/* Nonce sequencer for box and secretbox sessions. Each nonce is a random
+ * 16-byte session prefix followed by a 64-bit big-endian counter, so issuing
+ * one costs an atomic increment rather than a call to randombytes(). Several
+ * threads may share a sequencer. crypto_nonce_seq_next() returns -1 once the
+ * counter is exhausted, and never repeats a nonce. */
+
+typedef struct crypto_nonce_seq {
+    unsigned char prefix[crypto_nonce_PREFIXBYTES];
+    uint64_t counter;
+} crypto_nonce_seq;
+
+int crypto_nonce_seq_init (
+    crypto_nonce_seq *seq
+);
+
+int crypto_nonce_seq_next (
+    crypto_nonce_seq *seq,
+    unsigned char nonce[crypto_nonce_BYTES]
+);
+
+/* Receiving side of a sequenced session, initialized with the sender's
+ * prefix. The _open_seq() calls keep an anti-replay window, as IPsec and
+ * DTLS do: the highest counter accepted so far and a bitmap of the
+ * crypto_nonce_WINDOW counters below it. A message is accepted if its nonce
+ * carries the prefix and its counter is either above the highest or inside
+ * the window and not yet seen. Messages from several sending threads may
+ * therefore arrive out of order, while replays and counters that have
+ * fallen behind the window are rejected. Several threads may share a
+ * check. */
+
+typedef struct crypto_nonce_check {
+    unsigned char prefix[crypto_nonce_PREFIXBYTES];
+    uint64_t next;
+    uint64_t window[crypto_nonce_WINDOW / 64];
+    unsigned char lock;
+} crypto_nonce_check;
+
+int crypto_nonce_check_init (
+    crypto_nonce_check *check,
+    const unsigned char prefix[crypto_nonce_PREFIXBYTES]
+);
+
+/* Same as crypto_secretbox() and crypto_box_afternm(), but take the next
+ * nonce from 'seq' and write it to 'nonce' for sending along with the
+ * message. */
+
+int crypto_secretbox_seq (
+    unsigned char *cypher,
+    const unsigned char *msg,
+    unsigned long long msg_len,
+    unsigned char nonce[crypto_nonce_BYTES],
+    crypto_nonce_seq *seq,
+    const unsigned char key[crypto_secretbox_KEYBYTES]
+);
+
+int crypto_secretbox_open_seq (
+    unsigned char *msg,
+    const unsigned char *cypher,
+    unsigned long long cypher_len,
+    const unsigned char nonce[crypto_nonce_BYTES],
+    crypto_nonce_check *check,
+    const unsigned char key[crypto_secretbox_KEYBYTES]
+);
+
+int crypto_box_afternm_seq (
+    unsigned char *cypher,
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    unsigned char nonce[crypto_nonce_BYTES],
+    crypto_nonce_seq *seq,
+    const unsigned char shared_secret[crypto_box_BEFORENMBYTES]
+);
+
+int crypto_box_open_afternm_seq (
+    unsigned char *msg,
+    const unsigned char *cypher,
+    unsigned long long cypher_length,
+    const unsigned char nonce[crypto_nonce_BYTES],
+    crypto_nonce_check *check,
+    const unsigned char shared_secret[crypto_box_BEFORENMBYTES]
+);
+
 /*----------------------------------------------------------------------------*/
 
 enum {
@@ -181,6 +440,208 @@ int crypto_sign_keypair (
     unsigned char secret_key[crypto_sign_SECRETKEYBYTES]
 );
 
+/* Detached Ed25519: the signature is kept apart from the message, which is
+ * hashed in place rather than copied. Signatures are identical to the first
+ * crypto_sign_BYTES of crypto_sign() output. signature_length may be NULL.
+ * Like every verification function here, crypto_sign_verify_detached()
+ * rejects signatures whose S half is not reduced mod L or whose R is not a
+ * canonical encoding, and accepts if 8 * (S * B - R - h * A) is the identity:
+ * the cofactored equation of RFC 8032, so small-order components of R and
+ * the public key are ignored. */
+
+int crypto_sign_detached (
+    unsigned char signature[crypto_sign_BYTES],
+    unsigned long long *signature_length,
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    const unsigned char secret_key[crypto_sign_SECRETKEYBYTES]
+);
+
+int crypto_sign_verify_detached (
+    const unsigned char signature[crypto_sign_BYTES],
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    const unsigned char public_key[crypto_sign_PUBLICKEYBYTES]
+);
+
+/* Verification keys: a public key decoded once by crypto_sign_vk_init() and
+ * then reused, so repeated verification against the same key skips point
+ * decompression. crypto_sign_vk_init() returns -1 for a key that doesn't
+ * decode; verifying against such a vk always fails. */
+
+typedef struct crypto_sign_vk {
+    unsigned char public_key[crypto_sign_PUBLICKEYBYTES];
+    int64_t point[4][16];
+    int valid;
+} crypto_sign_vk;
+
+int crypto_sign_vk_init (
+    crypto_sign_vk *vk,
+    const unsigned char public_key[crypto_sign_PUBLICKEYBYTES]
+);
+
+int crypto_sign_open_vk (
+    unsigned char *msg,
+    unsigned long long *msg_length,
+    const unsigned char *signed_msg,
+    unsigned long long signed_length,
+    const crypto_sign_vk *vk
+);
+
+int crypto_sign_verify_detached_vk (
+    const unsigned char signature[crypto_sign_BYTES],
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    const crypto_sign_vk *vk
+);
+
+/* A bounded, direct-mapped cache of verification keys in caller-provided
+ * storage, for verifiers that see the same few keys over and over. Lookups
+ * decode and insert missing keys, evicting whatever shared their slot, and
+ * return NULL for keys that don't decode. The cache is not thread-safe; use
+ * one per thread or lock around it. */
+
+typedef struct crypto_sign_vk_cache {
+    crypto_sign_vk *slots;
+    unsigned long long count;
+} crypto_sign_vk_cache;
+
+int crypto_sign_vk_cache_init (
+    crypto_sign_vk_cache *cache,
+    crypto_sign_vk *slots,
+    unsigned long long count
+);
+
+const crypto_sign_vk *crypto_sign_vk_cache_lookup (
+    crypto_sign_vk_cache *cache,
+    const unsigned char public_key[crypto_sign_PUBLICKEYBYTES]
+);
+
+int crypto_sign_verify_detached_cached (
+    const unsigned char signature[crypto_sign_BYTES],
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    const unsigned char public_key[crypto_sign_PUBLICKEYBYTES],
+    crypto_sign_vk_cache *cache
+);
+
+/* Batch Ed25519 verification. Checks 'count' (signature, message, public
+ * key) tuples in groups of up to 32, each with one random linear combination
+ * and one multi-scalar multiplication. A public key that repeats within a
+ * group is decoded once. Decoding R and the public key is most of the
+ * remaining cost, so with distinct keys this is about twice as fast as
+ * verifying the signatures one by one. Returns 0 if every signature is
+ * valid. The group scratch, about 82 KiB, comes from malloc(); a single
+ * tuple, or a failed allocation, is verified with
+ * crypto_sign_verify_detached() instead.
+ *
+ * A tuple passes under the same cofactored equation as
+ * crypto_sign_verify_detached(). An invalid tuple in a group makes the group
+ * fail, except with probability about 2^-128.
+ *
+ * If 'results' is non-NULL, a failing group is re-checked one tuple at a
+ * time with crypto_sign_verify_detached(). results[i] gets 0 or -1 for every
+ * tuple, and the value doesn't depend on how the tuples were grouped. With a
+ * NULL 'results' the call stops at the first failing group. */
+
+int crypto_sign_verify_batch (
+    const unsigned char *const *signatures,
+    const unsigned char *const *msgs,
+    const unsigned long long *msg_lengths,
+    const unsigned char *const *public_keys,
+    unsigned long long count,
+    int *results
+);
+
+/* Signing context: the expanded form of a secret key (clamped scalar, nonce
+ * prefix and public key), computed once by crypto_sign_ctx_init(). Signing
+ * through a context skips the per-call SHA-512 of the seed and produces the
+ * same signatures as crypto_sign() and crypto_sign_detached(). The context
+ * holds secret material and should be wiped like the key it came from. */
+
+typedef struct crypto_sign_ctx {
+    unsigned char scalar[32];
+    unsigned char prefix[32];
+    unsigned char public_key[crypto_sign_PUBLICKEYBYTES];
+} crypto_sign_ctx;
+
+int crypto_sign_ctx_init (
+    crypto_sign_ctx *ctx,
+    const unsigned char secret_key[crypto_sign_SECRETKEYBYTES]
+);
+
+int crypto_sign_with_ctx (
+    unsigned char *signed_msg,
+    unsigned long long *signed_length,
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    const crypto_sign_ctx *ctx
+);
+
+int crypto_sign_detached_with_ctx (
+    unsigned char signature[crypto_sign_BYTES],
+    unsigned long long *signature_length,
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    const crypto_sign_ctx *ctx
+);
+
+/* Signs 'count' messages with one key, writing crypto_sign_BYTES detached
+ * signatures per message to 'signatures' in order. The key is expanded once
+ * and shared by up to 'threads' threads started for the call (0 picks one per
+ * online CPU), each taking the next unsigned message when it finishes one.
+ * Signatures are identical to crypto_sign_detached() output. */
+
+int crypto_sign_many (
+    unsigned char *signatures,
+    const unsigned char *const *msgs,
+    const unsigned long long *msg_lengths,
+    unsigned long long count,
+    const unsigned char secret_key[crypto_sign_SECRETKEYBYTES],
+    unsigned int threads
+);
+
+int crypto_sign_many_with_ctx (
+    unsigned char *signatures,
+    const unsigned char *const *msgs,
+    const unsigned long long *msg_lengths,
+    unsigned long long count,
+    const crypto_sign_ctx *ctx,
+    unsigned int threads
+);
+
+/* Streaming Ed25519ph (RFC 8032, empty context). The message is fed through
+ * init/update in any number of pieces and only its SHA-512 is signed, so
+ * large inputs need a single pass and constant memory. These signatures are
+ * not interchangeable with plain crypto_sign() signatures. */
+
+typedef struct crypto_sign_state {
+    crypto_hash_state hs;
+} crypto_sign_state;
+
+int crypto_sign_init (
+    crypto_sign_state *state
+);
+
+int crypto_sign_update (
+    crypto_sign_state *state,
+    const unsigned char *msg,
+    unsigned long long msg_length
+);
+
+int crypto_sign_final_create (
+    crypto_sign_state *state,
+    unsigned char signature[crypto_sign_BYTES],
+    unsigned long long *signature_length,
+    const unsigned char secret_key[crypto_sign_SECRETKEYBYTES]
+);
+
+int crypto_sign_final_verify (
+    crypto_sign_state *state,
+    const unsigned char signature[crypto_sign_BYTES],
+    const unsigned char public_key[crypto_sign_PUBLICKEYBYTES]
+);
+
 /*----------------------------------------------------------------------------*/
 
 enum {
@@ -220,4 +681,295 @@ int crypto_verify_32 (
     const unsigned char y[crypto_verify_32_BYTES]
 );
 
+/*----------------------------------------------------------------------------*/
+
+enum {
+    saline_cpu_SSE2 = 1,
+    saline_cpu_SSSE3 = 2,
+    saline_cpu_AVX2 = 4,
+    saline_cpu_BMI2 = 8
+};
+
+/* Describes the kernels chosen for this machine. 'backend' names the
+ * selected backend, the per-primitive names say which kernel each primitive
+ * actually runs, and 'cpu_features' holds the saline_cpu_* bits detected at
+ * startup. Setting SALINE_IMPL=portable (or another backend name) in the
+ * environment before the first crypto call forces that backend, provided
+ * the CPU supports it. 'profile' is the --with-profile the library was
+ * configured with: "small", "balanced" or "fast". */
+
+typedef struct saline_implementation {
+    const char *profile;
+    const char *backend;
+    const char *salsa20;
+    const char *poly1305;
+    const char *sha512;
+    const char *field;
+    unsigned int cpu_features;
+} saline_implementation;
+
+int saline_implementation_info (
+    saline_implementation *info
+);
+
+/*----------------------------------------------------------------------------*/
+
+/* Operation and work counters, compiled in with --enable-stats. Each thread
+ * counts into its own block, and a snapshot sums every thread's counts since
+ * the last saline_stats_reset(). Call counters count every entry to the
+ * function, including the library's own nested calls: a crypto_box() also
+ * counts one crypto_box_beforenm(), crypto_box_afternm(), crypto_secretbox()
+ * and so on. Field multiplications include squarings. Without
+ * --enable-stats both calls return -1, and snapshots are all zero. */
+
+typedef struct saline_stats_counter {
+    unsigned long long calls;
+    unsigned long long bytes;
+} saline_stats_counter;
+
+typedef struct saline_stats {
+    saline_stats_counter hash;
+    saline_stats_counter hash_many;
+    saline_stats_counter hash_tree;
+    saline_stats_counter auth;
+    saline_stats_counter onetimeauth;
+    saline_stats_counter stream;
+    saline_stats_counter secretbox;
+    saline_stats_counter secretbox_open;
+    saline_stats_counter box;
+    saline_stats_counter box_open;
+    saline_stats_counter box_beforenm;
+    saline_stats_counter scalarmult;
+    saline_stats_counter sign;
+    saline_stats_counter sign_verify;
+    saline_stats_counter sign_verify_batch;
+    saline_stats_counter randombytes;
+    unsigned long long salsa20_blocks;
+    unsigned long long poly1305_blocks;
+    unsigned long long sha512_blocks;
+    unsigned long long field_multiplications;
+    unsigned long long field_inversions;
+} saline_stats;
+
+int saline_stats_snapshot (
+    saline_stats *stats
+);
+
+int saline_stats_reset (
+    void
+);
+
+/*----------------------------------------------------------------------------*/
+
+/* Caller-provided workspaces. Each _ws function computes exactly what its
+ * namesake does, but keeps its large temporaries (field elements, point
+ * tables, hash buffers) in the workspace instead of on the stack, so only the
+ * leaf arithmetic stays there: at most about 1.8 KiB on x86-64 with GCC -O2,
+ * where signature verification otherwise takes 10 to 11 KiB.
+ * crypto_sign_open(), crypto_sign_final_verify() and
+ * crypto_sign_verify_batch() have no _ws variant. `make stack-report` prints
+ * the worst case of every public function. A workspace needs no
+ * initialization and may be reused, but not by two calls at once. Afterwards
+ * it holds secret intermediates, so wipe it like a key before releasing it.
+ * The X25519 _ws functions use the portable field kernel whatever the
+ * dispatch selected. */
+
+enum {
+    crypto_hash_WORKSPACEBYTES = 320,
+    crypto_scalarmult_WORKSPACEBYTES = 1440,
+    crypto_sign_WORKSPACEBYTES = 2920,
+    crypto_sign_verify_WORKSPACEBYTES = 9040
+};
+
+typedef union crypto_hash_workspace {
+    unsigned char bytes[crypto_hash_WORKSPACEBYTES];
+    int64_t align;
+} crypto_hash_workspace;
+
+typedef union crypto_scalarmult_workspace {
+    unsigned char bytes[crypto_scalarmult_WORKSPACEBYTES];
+    int64_t align;
+} crypto_scalarmult_workspace;
+
+typedef union crypto_sign_workspace {
+    unsigned char bytes[crypto_sign_WORKSPACEBYTES];
+    int64_t align;
+} crypto_sign_workspace;
+
+typedef union crypto_sign_verify_workspace {
+    unsigned char bytes[crypto_sign_verify_WORKSPACEBYTES];
+    int64_t align;
+} crypto_sign_verify_workspace;
+
+int crypto_hash_ws (
+    unsigned char hash[crypto_hash_BYTES],
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    crypto_hash_workspace *workspace
+);
+
+int crypto_scalarmult_ws (
+    unsigned char result[crypto_scalarmult_BYTES],
+    const unsigned char secret_key[crypto_scalarmult_SCALARBYTES],
+    const unsigned char public_key[crypto_scalarmult_BYTES],
+    crypto_scalarmult_workspace *workspace
+);
+
+int crypto_scalarmult_base_ws (
+    unsigned char public_key[crypto_scalarmult_BYTES],
+    const unsigned char secret_key[crypto_scalarmult_SCALARBYTES],
+    crypto_scalarmult_workspace *workspace
+);
+
+int crypto_box_beforenm_ws (
+    unsigned char shared_secret[crypto_box_BEFORENMBYTES],
+    const unsigned char receiver_public[crypto_box_PUBLICKEYBYTES],
+    const unsigned char sender_secret[crypto_box_SECRETKEYBYTES],
+    crypto_scalarmult_workspace *workspace
+);
+
+int crypto_sign_keypair_ws (
+    unsigned char public_key[crypto_sign_PUBLICKEYBYTES],
+    unsigned char secret_key[crypto_sign_SECRETKEYBYTES],
+    crypto_sign_workspace *workspace
+);
+
+int crypto_sign_detached_ws (
+    unsigned char signature[crypto_sign_BYTES],
+    unsigned long long *signature_length,
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    const unsigned char secret_key[crypto_sign_SECRETKEYBYTES],
+    crypto_sign_workspace *workspace
+);
+
+int crypto_sign_verify_detached_ws (
+    const unsigned char signature[crypto_sign_BYTES],
+    const unsigned char *msg,
+    unsigned long long msg_length,
+    const unsigned char public_key[crypto_sign_PUBLICKEYBYTES],
+    crypto_sign_verify_workspace *workspace
+);
+
+/*----------------------------------------------------------------------------*/
+
+/* Asynchronous jobs on a pool of worker threads, for programs that can't
+ * block their event loop on crypto. saline_async_create() starts 'threads'
+ * workers (0 for one per online CPU). Fill in a job and submit it; the caller
+ * owns the job and every buffer it points to until it completes. Each job
+ * runs the function its 'op' names, with the same argument conventions:
+ *
+ *   BOX, BOX_OPEN             crypto_box(out, in, in_length, nonce,
+ *                             peer_key, key) and crypto_box_open()
+ *   SECRETBOX, SECRETBOX_OPEN crypto_secretbox(out, in, in_length, nonce,
+ *                             key) and crypto_secretbox_open()
+ *   SIGN, SIGN_OPEN           crypto_sign(out, out_length, in, in_length,
+ *                             key) and crypto_sign_open(), with 'key' the
+ *                             public key
+ *   HASH                      crypto_hash(out, in, in_length), or
+ *                             crypto_hash_tree() if chunk_length is nonzero
+ *
+ * 'result' receives the function's return value. A tree hash is split into
+ * sub-tasks of whole leaves that idle workers steal. When a job completes,
+ * its callback runs on the worker thread. Jobs without a callback are queued
+ * for saline_async_poll() instead, and saline_async_fd() becomes readable:
+ * read it, then poll until NULL. Callbacks may submit jobs but must not
+ * destroy the pool. saline_async_create() returns NULL when saline is built
+ * without threads. saline_async_destroy() waits for every submitted job. */
+
+enum {
+    saline_async_BOX = 1,
+    saline_async_BOX_OPEN = 2,
+    saline_async_SECRETBOX = 3,
+    saline_async_SECRETBOX_OPEN = 4,
+    saline_async_SIGN = 5,
+    saline_async_SIGN_OPEN = 6,
+    saline_async_HASH = 7
+};
+
+typedef struct saline_async saline_async;
+typedef struct saline_async_job saline_async_job;
+
+typedef void (*saline_async_callback)(saline_async_job *job, void *arg);
+
+struct saline_async_job {
+    int op;
+    int result;
+    unsigned char *out;
+    unsigned long long *out_length;
+    const unsigned char *in;
+    unsigned long long in_length;
+    const unsigned char *nonce;
+    const unsigned char *key;
+    const unsigned char *peer_key;
+    unsigned long long chunk_length;
+    saline_async_callback callback;
+    void *arg;
+
+    /* Private to the pool. */
+    saline_async_job *next;
+    saline_async_job *prev;
+    saline_async_job *parent;
+    void *scratch;
+    unsigned long long begin;
+    unsigned long long end;
+    unsigned long long pending;
+};
+
+saline_async *saline_async_create (
+    unsigned int threads
+);
+
+int saline_async_submit (
+    saline_async *pool,
+    saline_async_job *job
+);
+
+int saline_async_fd (
+    saline_async *pool
+);
+
+saline_async_job *saline_async_poll (
+    saline_async *pool
+);
+
+void saline_async_destroy (
+    saline_async *pool
+);
+
+/*----------------------------------------------------------------------------*/
+
+/* A pool of fixed-size slots for keys and other secret state.
+ * saline_arena_create() reserves 'slots' slots of 'slot_bytes' bytes each,
+ * rounded up to 16, in one slab between two guard pages. The slab is locked
+ * into RAM and, where supported, left out of core dumps. Slots are 16-byte
+ * aligned and start zeroed. Allocating and freeing make no system calls and
+ * take no locks, so any thread may use the arena. saline_arena_alloc()
+ * returns NULL when every slot is in use. saline_arena_free() wipes the slot
+ * before reuse, and returns -1 for a pointer the arena didn't hand out or a
+ * slot that is already free. saline_arena_destroy() wipes every slot,
+ * including those still in use. saline_arena_create() returns NULL if the
+ * slab can't be mapped or locked; a large arena may need a higher
+ * RLIMIT_MEMLOCK (ulimit -l). */
+
+typedef struct saline_arena saline_arena;
+
+saline_arena *saline_arena_create (
+    unsigned int slot_bytes,
+    unsigned int slots
+);
+
+void *saline_arena_alloc (
+    saline_arena *arena
+);
+
+int saline_arena_free (
+    saline_arena *arena,
+    void *slot
+);
+
+void saline_arena_destroy (
+    saline_arena *arena
+);
+
 #endif
@@ -0,0 +1,457 @@
+#ifndef SALINE_HPP
+#define SALINE_HPP
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+extern "C" {
+#include "saline.h"
+}
+
+/* C++20 layer over saline.h. Inputs and outputs are std::span, with fixed
+ * extents wherever the C API fixes a size, so a wrong-sized key or nonce is a
+ * compile error. Everything is inline and nothing allocates: each call writes
+ * into caller buffers and forwards to one C function. Box and secretbox use
+ * the detached C calls, so no ZEROBYTES padding is needed. The combined forms
+ * lay out the authenticator and then the cypher text, which is
+ * crypto_box()'s output without its leading zeros. Functions return the C
+ * result, 0 or -1, and return -1 without calling into C if a dynamic span
+ * has the wrong size. Secret keys are move-only and wipe themselves. */
+
+namespace saline {
+
+using bytes = std::span<const unsigned char>;
+using mutable_bytes = std::span<unsigned char>;
+
+template <std::size_t N>
+using fixed_bytes = std::span<const unsigned char, N>;
+
+template <std::size_t N>
+using mutable_fixed_bytes = std::span<unsigned char, N>;
+
+inline constexpr std::size_t hash_bytes = crypto_hash_BYTES;
+
+inline constexpr std::size_t auth_bytes = crypto_auth_BYTES;
+inline constexpr std::size_t auth_key_bytes = crypto_auth_KEYBYTES;
+
+inline constexpr std::size_t onetimeauth_bytes = crypto_onetimeauth_BYTES;
+inline constexpr std::size_t onetimeauth_key_bytes =
+    crypto_onetimeauth_KEYBYTES;
+
+inline constexpr std::size_t box_public_key_bytes = crypto_box_PUBLICKEYBYTES;
+inline constexpr std::size_t box_secret_key_bytes = crypto_box_SECRETKEYBYTES;
+inline constexpr std::size_t box_shared_key_bytes = crypto_box_BEFORENMBYTES;
+inline constexpr std::size_t box_nonce_bytes = crypto_box_NONCEBYTES;
+inline constexpr std::size_t box_mac_bytes = crypto_box_MACBYTES;
+
+inline constexpr std::size_t secretbox_key_bytes = crypto_secretbox_KEYBYTES;
+inline constexpr std::size_t secretbox_nonce_bytes =
+    crypto_secretbox_NONCEBYTES;
+inline constexpr std::size_t secretbox_mac_bytes = crypto_secretbox_MACBYTES;
+
+inline constexpr std::size_t scalarmult_bytes = crypto_scalarmult_BYTES;
+inline constexpr std::size_t scalarmult_scalar_bytes =
+    crypto_scalarmult_SCALARBYTES;
+
+inline constexpr std::size_t sign_bytes = crypto_sign_BYTES;
+inline constexpr std::size_t sign_public_key_bytes =
+    crypto_sign_PUBLICKEYBYTES;
+inline constexpr std::size_t sign_secret_key_bytes =
+    crypto_sign_SECRETKEYBYTES;
+
+inline constexpr std::size_t stream_key_bytes = crypto_stream_KEYBYTES;
+inline constexpr std::size_t stream_nonce_bytes = crypto_stream_NONCEBYTES;
+
+/*----------------------------------------------------------------------------*/
+
+/* N bytes of key material that can be moved but not copied. The source of a
+ * move and the key itself are wiped with volatile stores, which the compiler
+ * can't drop as dead. 'Tag' keeps keys of the same size apart, so a box key
+ * can't be passed where a secretbox key is expected. */
+
+template <std::size_t N, class Tag>
+class secret_key {
+public:
+    static constexpr std::size_t size = N;
+
+    secret_key() noexcept = default;
+
+    explicit secret_key(fixed_bytes<N> key) noexcept
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            data_[i] = key[i];
+        }
+    }
+
+    secret_key(const secret_key &) = delete;
+    secret_key &operator=(const secret_key &) = delete;
+
+    secret_key(secret_key &&other) noexcept
+    {
+        take(other);
+    }
+
+    secret_key &operator=(secret_key &&other) noexcept
+    {
+        if (this != &other) {
+            take(other);
+        }
+
+        return *this;
+    }
+
+    ~secret_key()
+    {
+        wipe();
+    }
+
+    void wipe() noexcept
+    {
+        volatile unsigned char *p = data_;
+
+        for (std::size_t i = 0; i < N; ++i) {
+            p[i] = 0;
+        }
+    }
+
+    unsigned char *data() noexcept
+    {
+        return data_;
+    }
+
+    const unsigned char *data() const noexcept
+    {
+        return data_;
+    }
+
+    fixed_bytes<N> bytes() const noexcept
+    {
+        return fixed_bytes<N>(data_, N);
+    }
+
+private:
+    void take(secret_key &other) noexcept
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            data_[i] = other.data_[i];
+        }
+
+        other.wipe();
+    }
+
+    unsigned char data_[N] = {};
+};
+
+using auth_key = secret_key<auth_key_bytes, struct auth_key_tag>;
+using onetimeauth_key =
+    secret_key<onetimeauth_key_bytes, struct onetimeauth_key_tag>;
+using box_secret_key = secret_key<box_secret_key_bytes, struct box_key_tag>;
+using box_shared_key =
+    secret_key<box_shared_key_bytes, struct box_shared_key_tag>;
+using secretbox_key = secret_key<secretbox_key_bytes, struct secretbox_tag>;
+using sign_secret_key = secret_key<sign_secret_key_bytes, struct sign_tag>;
+using stream_key = secret_key<stream_key_bytes, struct stream_key_tag>;
+
+using box_public_key = std::array<unsigned char, box_public_key_bytes>;
+using sign_public_key = std::array<unsigned char, sign_public_key_bytes>;
+
+/*----------------------------------------------------------------------------*/
+
+[[nodiscard]] inline int hash(mutable_fixed_bytes<hash_bytes> out,
+                              bytes msg) noexcept
+{
+    return crypto_hash(out.data(), msg.data(), msg.size());
+}
+
+[[nodiscard]] inline int auth(mutable_fixed_bytes<auth_bytes> out, bytes msg,
+                              const auth_key &key) noexcept
+{
+    return crypto_auth(out.data(), msg.data(), msg.size(), key.data());
+}
+
+[[nodiscard]] inline int auth_verify(fixed_bytes<auth_bytes> tag, bytes msg,
+                                     const auth_key &key) noexcept
+{
+    return crypto_auth_verify(tag.data(), msg.data(), msg.size(), key.data());
+}
+
+[[nodiscard]] inline int onetimeauth(
+    mutable_fixed_bytes<onetimeauth_bytes> out, bytes msg,
+    const onetimeauth_key &key) noexcept
+{
+    return crypto_onetimeauth(out.data(), msg.data(), msg.size(), key.data());
+}
+
+[[nodiscard]] inline int onetimeauth_verify(
+    fixed_bytes<onetimeauth_bytes> tag, bytes msg,
+    const onetimeauth_key &key) noexcept
+{
+    return crypto_onetimeauth_verify(tag.data(), msg.data(), msg.size(),
+                                     key.data());
+}
+
+[[nodiscard]] inline int stream(mutable_bytes out,
+                                fixed_bytes<stream_nonce_bytes> nonce,
+                                const stream_key &key) noexcept
+{
+    return crypto_stream(out.data(), out.size(), nonce.data(), key.data());
+}
+
+[[nodiscard]] inline int stream_xor(mutable_bytes out, bytes in,
+                                    fixed_bytes<stream_nonce_bytes> nonce,
+                                    const stream_key &key) noexcept
+{
+    if (out.size() != in.size()) {
+        return -1;
+    }
+
+    return crypto_stream_xor(out.data(), in.data(), in.size(), nonce.data(),
+                             key.data());
+}
+
+/*----------------------------------------------------------------------------*/
+
+[[nodiscard]] inline int secretbox_detached(
+    mutable_bytes cypher, mutable_fixed_bytes<secretbox_mac_bytes> mac,
+    bytes msg, fixed_bytes<secretbox_nonce_bytes> nonce,
+    const secretbox_key &key) noexcept
+{
+    if (cypher.size() != msg.size()) {
+        return -1;
+    }
+
+    return crypto_secretbox_detached(cypher.data(), mac.data(), msg.data(),
+                                     msg.size(), nonce.data(), key.data());
+}
+
+[[nodiscard]] inline int secretbox_open_detached(
+    mutable_bytes msg, bytes cypher, fixed_bytes<secretbox_mac_bytes> mac,
+    fixed_bytes<secretbox_nonce_bytes> nonce,
+    const secretbox_key &key) noexcept
+{
+    if (msg.size() != cypher.size()) {
+        return -1;
+    }
+
+    return crypto_secretbox_open_detached(msg.data(), cypher.data(),
+                                          mac.data(), cypher.size(),
+                                          nonce.data(), key.data());
+}
+
+/* 'out' holds the authenticator and then the cypher text, so it is
+ * secretbox_mac_bytes longer than 'msg'. */
+
+[[nodiscard]] inline int secretbox(mutable_bytes out, bytes msg,
+                                   fixed_bytes<secretbox_nonce_bytes> nonce,
+                                   const secretbox_key &key) noexcept
+{
+    if (out.size() != msg.size() + secretbox_mac_bytes) {
+        return -1;
+    }
+
+    return crypto_secretbox_detached(out.data() + secretbox_mac_bytes,
+                                     out.data(), msg.data(), msg.size(),
+                                     nonce.data(), key.data());
+}
+
+[[nodiscard]] inline int secretbox_open(
+    mutable_bytes msg, bytes in, fixed_bytes<secretbox_nonce_bytes> nonce,
+    const secretbox_key &key) noexcept
+{
+    if (in.size() < secretbox_mac_bytes ||
+        msg.size() != in.size() - secretbox_mac_bytes) {
+        return -1;
+    }
+
+    return crypto_secretbox_open_detached(msg.data(),
+                                          in.data() + secretbox_mac_bytes,
+                                          in.data(), msg.size(),
+                                          nonce.data(), key.data());
+}
+
+/*----------------------------------------------------------------------------*/
+
+[[nodiscard]] inline int box_keypair(box_public_key &public_key,
+                                     box_secret_key &secret_key) noexcept
+{
+    return crypto_box_keypair(public_key.data(), secret_key.data());
+}
+
+[[nodiscard]] inline int box_beforenm(
+    box_shared_key &shared, fixed_bytes<box_public_key_bytes> public_key,
+    const box_secret_key &secret_key) noexcept
+{
+    return crypto_box_beforenm(shared.data(), public_key.data(),
+                               secret_key.data());
+}
+
+[[nodiscard]] inline int box_detached(
+    mutable_bytes cypher, mutable_fixed_bytes<box_mac_bytes> mac, bytes msg,
+    fixed_bytes<box_nonce_bytes> nonce,
+    fixed_bytes<box_public_key_bytes> receiver_public,
+    const box_secret_key &sender_secret) noexcept
+{
+    if (cypher.size() != msg.size()) {
+        return -1;
+    }
+
+    return crypto_box_detached(cypher.data(), mac.data(), msg.data(),
+                               msg.size(), nonce.data(),
+                               receiver_public.data(), sender_secret.data());
+}
+
+[[nodiscard]] inline int box_open_detached(
+    mutable_bytes msg, bytes cypher, fixed_bytes<box_mac_bytes> mac,
+    fixed_bytes<box_nonce_bytes> nonce,
+    fixed_bytes<box_public_key_bytes> sender_public,
+    const box_secret_key &receiver_secret) noexcept
+{
+    if (msg.size() != cypher.size()) {
+        return -1;
+    }
+
+    return crypto_box_open_detached(msg.data(), cypher.data(), mac.data(),
+                                    cypher.size(), nonce.data(),
+                                    sender_public.data(),
+                                    receiver_secret.data());
+}
+
+[[nodiscard]] inline int box(mutable_bytes out, bytes msg,
+                             fixed_bytes<box_nonce_bytes> nonce,
+                             fixed_bytes<box_public_key_bytes> receiver_public,
+                             const box_secret_key &sender_secret) noexcept
+{
+    if (out.size() != msg.size() + box_mac_bytes) {
+        return -1;
+    }
+
+    return crypto_box_detached(out.data() + box_mac_bytes, out.data(),
+                               msg.data(), msg.size(), nonce.data(),
+                               receiver_public.data(), sender_secret.data());
+}
+
+[[nodiscard]] inline int box_open(
+    mutable_bytes msg, bytes in, fixed_bytes<box_nonce_bytes> nonce,
+    fixed_bytes<box_public_key_bytes> sender_public,
+    const box_secret_key &receiver_secret) noexcept
+{
+    if (in.size() < box_mac_bytes || msg.size() != in.size() - box_mac_bytes) {
+        return -1;
+    }
+
+    return crypto_box_open_detached(msg.data(), in.data() + box_mac_bytes,
+                                    in.data(), msg.size(), nonce.data(),
+                                    sender_public.data(),
+                                    receiver_secret.data());
+}
+
+/* With a precomputed key, box is secretbox under that key. */
+
+[[nodiscard]] inline int box_afternm(mutable_bytes out, bytes msg,
+                                     fixed_bytes<box_nonce_bytes> nonce,
+                                     const box_shared_key &shared) noexcept
+{
+    if (out.size() != msg.size() + box_mac_bytes) {
+        return -1;
+    }
+
+    return crypto_secretbox_detached(out.data() + box_mac_bytes, out.data(),
+                                     msg.data(), msg.size(), nonce.data(),
+                                     shared.data());
+}
+
+[[nodiscard]] inline int box_open_afternm(
+    mutable_bytes msg, bytes in, fixed_bytes<box_nonce_bytes> nonce,
+    const box_shared_key &shared) noexcept
+{
+    if (in.size() < box_mac_bytes || msg.size() != in.size() - box_mac_bytes) {
+        return -1;
+    }
+
+    return crypto_secretbox_open_detached(msg.data(),
+                                          in.data() + box_mac_bytes,
+                                          in.data(), msg.size(),
+                                          nonce.data(), shared.data());
+}
+
+/*----------------------------------------------------------------------------*/
+
+[[nodiscard]] inline int scalarmult(
+    mutable_fixed_bytes<scalarmult_bytes> out,
+    fixed_bytes<scalarmult_scalar_bytes> scalar,
+    fixed_bytes<scalarmult_bytes> point) noexcept
+{
+    return crypto_scalarmult(out.data(), scalar.data(), point.data());
+}
+
+[[nodiscard]] inline int scalarmult_base(
+    mutable_fixed_bytes<scalarmult_bytes> out,
+    fixed_bytes<scalarmult_scalar_bytes> scalar) noexcept
+{
+    return crypto_scalarmult_base(out.data(), scalar.data());
+}
+
+/*----------------------------------------------------------------------------*/
+
+[[nodiscard]] inline int sign_keypair(sign_public_key &public_key,
+                                      sign_secret_key &secret_key) noexcept
+{
+    return crypto_sign_keypair(public_key.data(), secret_key.data());
+}
+
+[[nodiscard]] inline int sign_detached(mutable_fixed_bytes<sign_bytes> sig,
+                                       bytes msg,
+                                       const sign_secret_key &key) noexcept
+{
+    return crypto_sign_detached(sig.data(), nullptr, msg.data(), msg.size(),
+                                key.data());
+}
+
+[[nodiscard]] inline int sign_verify_detached(
+    fixed_bytes<sign_bytes> sig, bytes msg,
+    fixed_bytes<sign_public_key_bytes> key) noexcept
+{
+    return crypto_sign_verify_detached(sig.data(), msg.data(), msg.size(),
+                                       key.data());
+}
+
+/* 'out' receives the signature followed by the message, so it is sign_bytes
+ * longer than 'msg'. */
+
+[[nodiscard]] inline int sign(mutable_bytes out, bytes msg,
+                              const sign_secret_key &key) noexcept
+{
+    unsigned long long length;
+
+    if (out.size() != msg.size() + sign_bytes) {
+        return -1;
+    }
+
+    return crypto_sign(out.data(), &length, msg.data(), msg.size(),
+                       key.data());
+}
+
+/* Verifies a signed message in place. On success, 'msg' is set to the
+ * message inside 'in', so nothing is copied. */
+
+[[nodiscard]] inline int sign_open(bytes &msg, bytes in,
+                                   fixed_bytes<sign_public_key_bytes> key)
+    noexcept
+{
+    if (in.size() < sign_bytes) {
+        return -1;
+    }
+
+    if (crypto_sign_verify_detached(in.data(), in.data() + sign_bytes,
+                                    in.size() - sign_bytes, key.data()) != 0) {
+        return -1;
+    }
+
+    msg = in.subspan(sign_bytes);
+    return 0;
+}
+
+} // namespace saline
+
+#endif
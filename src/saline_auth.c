@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include "saline.h"
+#include "stats.h"
 
 extern void crypto_hashblocks(uint8_t *x, const uint8_t *m, uint64_t n);
 
@@ -20,26 +21,78 @@ static const unsigned char iv[64] = {
     0x6b, 0x5b, 0xe0, 0xcd, 0x19, 0x13, 0x7e, 0x21, 0x79
 };
 
-int crypto_auth(unsigned char *out, const unsigned char *in,
-                unsigned long long inlen, const unsigned char *k)
+static void auth_midstate(unsigned char h[64], const unsigned char *k,
+                          unsigned char pad)
 {
-    unsigned char h[64];
-    unsigned char padded[256];
-    uint64_t bytes = 128 + inlen;
+    unsigned char block[128];
 
     for (unsigned int i = 0; i < 64; ++i) {
         h[i] = iv[i];
     }
 
     for (unsigned int i = 0; i < 32; ++i) {
-        padded[i] = k[i] ^ 0x36;
+        block[i] = k[i] ^ pad;
     }
 
     for (unsigned int i = 32; i < 128; ++i) {
-        padded[i] = 0x36;
+        block[i] = pad;
+    }
+
+    crypto_hashblocks(h, block, 128);
+}
+
+static int auth_outer(unsigned char *out, const unsigned char *outer,
+                      const unsigned char *inner_hash)
+{
+    unsigned char h[64];
+    unsigned char padded[128];
+
+    for (unsigned int i = 0; i < 64; ++i) {
+        padded[i] = inner_hash[i];
+    }
+
+    for (unsigned int i = 0; i < 64; ++i) {
+        h[i] = outer[i];
+    }
+
+    for (unsigned int i = 64; i < 128; ++i) {
+        padded[i] = 0;
     }
 
+    padded[64] = 0x80;
+    padded[126] = 6;
+
     crypto_hashblocks(h, padded, 128);
+
+    for (unsigned int i = 0; i < 32; ++i) {
+        out[i] = h[i];
+    }
+
+    return 0;
+}
+
+int crypto_auth_ctx_init(crypto_auth_ctx *ctx,
+                         const unsigned char key[crypto_auth_KEYBYTES])
+{
+    auth_midstate(ctx->inner, key, 0x36);
+    auth_midstate(ctx->outer, key, 0x5c);
+    return 0;
+}
+
+int crypto_auth_with_ctx(unsigned char out[crypto_auth_BYTES],
+                         const unsigned char *in, unsigned long long inlen,
+                         const crypto_auth_ctx *ctx)
+{
+    unsigned char h[64];
+    unsigned char padded[256];
+    uint64_t bytes = 128 + inlen;
+
+    SALINE_STAT_CALL(auth, inlen);
+
+    for (unsigned int i = 0; i < 64; ++i) {
+        h[i] = ctx->inner[i];
+    }
+
     crypto_hashblocks(h, in, inlen);
     in += inlen;
     inlen &= 127;
@@ -83,34 +136,67 @@ int crypto_auth(unsigned char *out, const unsigned char *in,
         crypto_hashblocks(h, padded, 256);
     }
 
-    for (unsigned int i = 0; i < 32; ++i) {
-        padded[i] = k[i] ^ 0x5c;
-    }
+    return auth_outer(out, ctx->outer, h);
+}
 
-    for (unsigned int i = 32; i < 128; ++i) {
-        padded[i] = 0x5c;
-    }
+int crypto_auth_verify_with_ctx(const unsigned char h[crypto_auth_BYTES],
+                                const unsigned char *in,
+                                unsigned long long inlen,
+                                const crypto_auth_ctx *ctx)
+{
+    unsigned char correct[32];
+    crypto_auth_with_ctx(correct, in, inlen, ctx);
+    return crypto_verify_32(h, correct);
+}
 
-    for (unsigned int i = 0; i < 64; ++i) {
-        padded[128 + i] = h[i];
-    }
+int crypto_auth(unsigned char *out, const unsigned char *in,
+                unsigned long long inlen, const unsigned char *k)
+{
+    crypto_auth_ctx ctx;
+    crypto_auth_ctx_init(&ctx, k);
+    return crypto_auth_with_ctx(out, in, inlen, &ctx);
+}
 
+int crypto_auth_init_with_ctx(crypto_auth_state *state,
+                              const crypto_auth_ctx *ctx)
+{
     for (unsigned int i = 0; i < 64; ++i) {
-        h[i] = iv[i];
+        state->inner.h[i] = ctx->inner[i];
+        state->outer[i] = ctx->outer[i];
     }
 
-    for (unsigned int i = 64; i < 128; ++i) {
-        padded[128 + i] = 0;
-    }
+    state->inner.length = 128;
+    return 0;
+}
 
-    padded[128 + 64] = 0x80;
-    padded[128 + 126] = 6;
+int crypto_auth_init(crypto_auth_state *state,
+                     const unsigned char key[crypto_auth_KEYBYTES])
+{
+    crypto_auth_ctx ctx;
+    crypto_auth_ctx_init(&ctx, key);
+    return crypto_auth_init_with_ctx(state, &ctx);
+}
 
-    crypto_hashblocks(h, padded, 256);
+int crypto_auth_update(crypto_auth_state *state, const unsigned char *in,
+                       unsigned long long inlen)
+{
+    SALINE_STAT(auth.bytes, inlen);
+    return crypto_hash_update(&state->inner, in, inlen);
+}
 
-    for (unsigned int i = 0; i < 32; ++i) {
-        out[i] = h[i];
-    }
+int crypto_auth_final(crypto_auth_state *state,
+                      unsigned char out[crypto_auth_BYTES])
+{
+    unsigned char h[64];
+    SALINE_STAT(auth.calls, 1);
+    crypto_hash_final(&state->inner, h);
+    return auth_outer(out, state->outer, h);
+}
 
-    return 0;
+int crypto_auth_final_verify(crypto_auth_state *state,
+                             const unsigned char h[crypto_auth_BYTES])
+{
+    unsigned char correct[32];
+    crypto_auth_final(state, correct);
+    return crypto_verify_32(h, correct);
 }
@@ -0,0 +1,1803 @@
+/* Generated by scripts/gen_base_table.py. Do not edit. */
+
+/* base_table[i][j] = (j + 1) * 256^i * B */
+
+static const uint16_t base_table[32][8][3][16] = {
+    {
+        {{0x3b85, 0xf58c, 0x93c6, 0x2fbc, 0x0e19, 0xfb8c, 0x2dc6, 0xcf93,
+          0x42c2, 0x643d, 0x4898, 0x270b, 0xba65, 0x33d4, 0x9d3a, 0x07cf},
+         {0x913e, 0xd740, 0x3905, 0x9d10, 0xbeb3, 0xd140, 0x9f05, 0xfd39,
+          0x8a09, 0x688f, 0x8434, 0xa5c1, 0x1267, 0x98f8, 0x2f92, 0x44fd},
+         {0xaa68, 0x877a, 0x1205, 0xabc9, 0xc49e, 0xccaa, 0xe823, 0x26d9,
+          0x598c, 0xdd43, 0x7dcb, 0x5a1b, 0x65a8, 0x9f0c, 0x7b68, 0x6f11}},
+        {{0x71d7, 0x933c, 0xe7fc, 0x9224, 0xf5b5, 0x7a0f, 0x9d96, 0x9f46,
+          0x0702, 0xe1d6, 0x9a65, 0x5aa6, 0x2e2e, 0xa87d, 0x063f, 0x590c},
+         {0xd5a8, 0x42b4, 0xa560, 0x8a99, 0xacf6, 0x4e60, 0x810c, 0x8f2b,
+          0x37aa, 0xb16e, 0x236b, 0xe09e, 0x2555, 0x69c9, 0x95a6, 0x6bb5},
+         {0x7a5f, 0xa59b, 0xa8b3, 0x43fa, 0xcf78, 0x5d9a, 0x6bdd, 0x36c1,
+          0x6a31, 0x0b3d, 0xa084, 0x500f, 0x0b73, 0x3ea5, 0xf5b1, 0x701a}},
+        {{0x9730, 0x4cee, 0xb0a8, 0xaf25, 0x4b8a, 0xe886, 0x8430, 0x025a,
+          0x6732, 0x9f01, 0x5002, 0xc11b, 0xf8f4, 0x9a80, 0x4e1b, 0x7a16},
+         {0xd265, 0xa4fc, 0x1fe8, 0x5661, 0xba7d, 0xe5c1, 0x53fd, 0x3bd3,
+          0xd6bd, 0x214b, 0xf31a, 0x8131, 0xda62, 0x555b, 0x1587, 0x2ab9},
+         {0xd889, 0x0dd0, 0x933f, 0x14ae, 0xda62, 0x1c35, 0x2322, 0x5894,
+          0xdb4c, 0x8cf2, 0xe545, 0xd170, 0xb4c6, 0x12b9, 0x26af, 0x5a28}},
+        {{0x099f, 0x8efc, 0x51b9, 0x2873, 0x2538, 0x7dfd, 0xc6f4, 0x6765,
+          0x9265, 0xfb0a, 0x8d3d, 0xca34, 0x8727, 0x21e5, 0x9103, 0x680e},
+         {0x18bf, 0x0568, 0x050a, 0x95fe, 0xfaa9, 0x5660, 0x8971, 0x327e,
+          0x5073, 0x06a0, 0xe3cd, 0xc3e8, 0xa49a, 0x7445, 0x3f4c, 0x2793},
+         {0xff09, 0xc476, 0xfbe9, 0x5a13, 0xc172, 0x7b5c, 0x3945, 0x6e9e,
+          0x4494, 0x102b, 0xdcf9, 0x5ddb, 0x3e2b, 0x6355, 0x0cbf, 0x7f9d}},
+        {{0xbb33, 0x08a5, 0xbc44, 0xa212, 0xed02, 0xc75e, 0x48c3, 0x8d50,
+          0xec44, 0x5abf, 0xeb0c, 0xdd1b, 0x06eb, 0x46e2, 0xccf1, 0x2945},
+         {0xd6ba, 0xa447, 0x82c3, 0x7f91, 0x29b7, 0x4b27, 0x14d1, 0xd500,
+          0xa087, 0xb864, 0xf11c, 0xe33c, 0x55f3, 0xeb1b, 0x7e73, 0x154a},
+         {0x8285, 0x812a, 0xdbf1, 0xbcbb, 0xd1fc, 0xd0bd, 0x0807, 0x270e,
+          0xa72d, 0x1bbd, 0x670b, 0xb41b, 0xb69a, 0x6b3b, 0xbe69, 0x43aa}},
+        {{0x7131, 0x7715, 0xeeeb, 0x3a0c, 0xaf88, 0x00c8, 0x1589, 0x9b27,
+          0xa736, 0xda59, 0xb668, 0x8065, 0x38bd, 0xa2cc, 0x7bb6, 0x51e5},
+         {0x8ca4, 0x7b7d, 0x06b6, 0x4998, 0x2739, 0x27d2, 0xe284, 0x575b,
+          0x53b9, 0x2045, 0x5ce7, 0xbb08, 0x7884, 0xae41, 0x4c41, 0x38b6},
+         {0x4b71, 0x02ea, 0x3267, 0x85ac, 0xbb01, 0x41a1, 0xe003, 0xbe70,
+          0xc144, 0x083b, 0xa24b, 0x53e4, 0x61e3, 0x9f0d, 0xe91a, 0x10b8}},
+        {{0xa3bf, 0x944e, 0x5cd0, 0x6b1a, 0xc0d2, 0xb39d, 0x353a, 0x7470,
+          0x2e49, 0x2854, 0x5282, 0x71b2, 0x927e, 0x283c, 0xea69, 0x461b},
+         {0x21b1, 0xaa32, 0x2c9a, 0xba6f, 0x23a7, 0x3bba, 0x2153, 0x6ca0,
+          0x2c3a, 0x9219, 0x764f, 0x9dea, 0x17e0, 0x2e53, 0xdd5d, 0x1d6e},
+         {0xb3a2, 0x01b8, 0x6dc8, 0xf183, 0xa49a, 0x053e, 0x5f47, 0xb303,
+          0xadf3, 0x5877, 0x41ba, 0x529c, 0x90a7, 0x6a0f, 0xbb1c, 0x7a9f}},
+        {{0x3e8f, 0x04dd, 0x5966, 0x59b7, 0x702c, 0xe288, 0x0377, 0x6cb3,
+          0xc323, 0x5ed9, 0x9c66, 0xb133, 0xe52f, 0x61bc, 0xe760, 0x0915},
+         {0x34d9, 0xf392, 0x5ded, 0xe2a7, 0x58f9, 0xe1b5, 0x7680, 0x963d,
+          0x23fb, 0x6e3c, 0x41ac, 0x2c27, 0x01c3, 0x320e, 0x24a1, 0x3a90},
+         {0x911a, 0xc9a2, 0xf5d9, 0xe7c1, 0xa7d7, 0x8bcc, 0x7178, 0xb8a3,
+          0x2a32, 0x0eb6, 0x1219, 0x6364, 0x4e95, 0x2ecc, 0x7c5c, 0x2690}}
+    },
+    {
+        {{0x9c1d, 0x632f, 0xdd0e, 0x2ecc, 0x3115, 0x7689, 0xb696, 0x51d0,
+          0x7a58, 0xa863, 0xb76b, 0x52df, 0xef39, 0xa00e, 0x7d49, 0x6dd3},
+         {0x515e, 0x49aa, 0x6354, 0xed5b, 0x823a, 0x0bc6, 0xc49f, 0xa865,
+          0xd1c4, 0x5b42, 0x1fe9, 0x850c, 0x15b9, 0x03d3, 0x6d6f, 0x30d7},
+         {0xe4c7, 0x2106, 0x4417, 0x6c44, 0x7f69, 0x928d, 0xd680, 0xfb53,
+          0x3f26, 0x694d, 0x9ea4, 0xb473, 0x4bb0, 0x2e86, 0x9711, 0x10c6}},
+        {{0xc805, 0x8358, 0x2aa0, 0x0ca6, 0x4247, 0x7a20, 0x4ae3, 0x6a3d,
+          0xeddc, 0x3b11, 0xd3a6, 0x7464, 0x06ef, 0x5508, 0x9baf, 0x03bf},
+         {0x5fde, 0x7dbe, 0xc427, 0x6493, 0x7ea2, 0x19ad, 0x4fad, 0x265d,
+          0x4590, 0x4630, 0xdfc8, 0x0e00, 0xfe09, 0xed66, 0x1cab, 0x25e6},
+         {0x6604, 0xcc58, 0xe128, 0x3f13, 0x747e, 0xb459, 0x73ec, 0x6f58,
+          0x68f5, 0xcc12, 0x3ded, 0xa0b6, 0xe22c, 0x4586, 0x7863, 0x566d}},
+        {{0x2fd0, 0xc65a, 0x4285, 0xa105, 0x67c3, 0xf316, 0x112a, 0x6c64,
+          0xee58, 0x731a, 0xe240, 0x680a, 0xb22a, 0x4793, 0xa5f3, 0x14fb},
+         {0x0834, 0x9cc1, 0xa49f, 0x1637, 0xc451, 0xa89b, 0x56d5, 0xbc8e,
+          0xd2db, 0x7f7f, 0xec0f, 0x1cb5, 0x35d9, 0x5ecc, 0x5bca, 0x3397},
+         {0xf7d4, 0x6985, 0x4616, 0x3cd7, 0x0057, 0xc9c8, 0x5e84, 0x593e,
+          0x131e, 0x7b61, 0xf2b6, 0x2fc3, 0x526c, 0x83fc, 0x9cea, 0x1482}},
+        {{0xecb8, 0x4e71, 0x0b2f, 0x21e7, 0x77e3, 0x40a4, 0xddb9, 0xe656,
+          0x4f80, 0xce1d, 0x56ce, 0xbf65, 0x7b7e, 0x535d, 0x3bc4, 0x05fc},
+         {0x95c2, 0x97dd, 0x7b84, 0xff43, 0xb5a7, 0xaa4e, 0x4e30, 0x6c74,
+          0xe88b, 0x3c85, 0x5d61, 0x9e0c, 0x8173, 0x5f75, 0xc71e, 0x2fd9},
+         {0xdedd, 0x52af, 0xb3ae, 0x24b8, 0x30cf, 0xed3b, 0x638c, 0x3495,
+          0x8195, 0xa9be, 0xbc83, 0x33a4, 0x1f04, 0x5c65, 0x6747, 0x3737}},
+        {{0x6590, 0x1424, 0x95cb, 0x6340, 0x5535, 0x16c1, 0x1440, 0xef12,
+          0xbc60, 0x8910, 0x140c, 0x9e38, 0x7c8c, 0x3090, 0x9057, 0x6bf5},
+         {0xadd9, 0x40d1, 0x99fd, 0x2fba, 0xd027, 0x96f4, 0x166f, 0xb307,
+          0x3bae, 0x15f0, 0xf052, 0x4363, 0xf999, 0x3b18, 0xa56c, 0x1fbe},
+         {0x5b8a, 0xe141, 0x78f1, 0x0fa7, 0xa77e, 0xbac3, 0x9ff7, 0x0640,
+          0x9a50, 0x9aa2, 0xd7b8, 0x6f52, 0x5a56, 0x7a63, 0x1cf6, 0x0252}},
+        {{0x5ee4, 0x772f, 0x6720, 0xb114, 0x9ace, 0x9607, 0x94b1, 0xe8f8,
+          0x824a, 0x00ac, 0x224d, 0x4af8, 0x6cc4, 0xf7cd, 0x53d9, 0x0017},
+         {0x5294, 0x0a9d, 0xee0b, 0x513f, 0x5a66, 0x0fdf, 0xe75c, 0x8f98,
+          0x07ce, 0xbfe1, 0x8688, 0xd461, 0x2ced, 0x7138, 0x0a7e, 0x3fa0},
+         {0xdb34, 0x963d, 0x232d, 0x3c69, 0x3858, 0xb497, 0x87da, 0x1dde,
+          0xf285, 0xa091, 0xd1f9, 0xaad7, 0xedb6, 0xa048, 0xfe2f, 0x12b5}},
+        {{0x1e92, 0xad6f, 0x7c26, 0xdf2b, 0x8913, 0x504b, 0xd323, 0x4b66,
+          0x8bc3, 0x751c, 0x9dc0, 0x8c40, 0xc7b8, 0x0796, 0x93c2, 0x6f7e},
+         {0xe34d, 0x96fc, 0xfbc4, 0x71f0, 0x5bed, 0xadf3, 0x826b, 0x73b9,
+          0xc561, 0xff28, 0x7261, 0xd204, 0x206f, 0x6fb1, 0x76f9, 0x749b},
+         {0xae05, 0xaea6, 0xf604, 0x1f5a, 0x9c99, 0xbee4, 0x51f1, 0xc123,
+          0x6b66, 0xeeff, 0x08b5, 0x61a8, 0x2151, 0x01e0, 0xc10f, 0x0fce}},
+        {{0x4e45, 0xc424, 0xd29d, 0x3df2, 0xde0a, 0x93d8, 0x0e74, 0x2b02,
+          0x214d, 0x820c, 0x067e, 0x6cc8, 0xb90a, 0x6fea, 0x7916, 0x4137},
+         {0x1e44, 0x49fe, 0x58a6, 0x644d, 0x777e, 0x31ad, 0xaea2, 0x21fc,
+          0xd0d2, 0x887f, 0x1c5a, 0x0244, 0x11f3, 0x83c5, 0xaa71, 0x4901},
+         {0xf8f0, 0x8c1a, 0xb754, 0x08b1, 0x99b4, 0x2462, 0x7a7c, 0xce0f,
+          0xd939, 0x1e06, 0xb0f9, 0xf760, 0x1213, 0x726d, 0x887b, 0x41bb}}
+    },
+    {
+        {{0x91ae, 0x7c66, 0x4c59, 0x7e23, 0xb4c8, 0x0a85, 0x9d3d, 0x6488,
+          0xfae7, 0x354a, 0xc90c, 0xdae2, 0x9e1d, 0x0c6a, 0x1e07, 0x0a87},
+         {0x46be, 0x7443, 0x7d44, 0x40e8, 0x2b25, 0x15b5, 0xdad4, 0x1d48,
+          0x603e, 0xa13b, 0x8a18, 0x7c3a, 0xbdf7, 0x2fcd, 0x28c1, 0x4eb7},
+         {0x8989, 0x4bbc, 0xb599, 0x3301, 0x4260, 0x5bdd, 0xae3a, 0x736b,
+          0x9e3c, 0x19d5, 0xade2, 0x0d61, 0xd464, 0x2685, 0x300f, 0x3ee7}},
+        {{0x7518, 0x841e, 0x7947, 0x43fa, 0x46d7, 0x639c, 0xfa59, 0xe5c6,
+          0x2b74, 0xe305, 0x5e1d, 0xa106, 0x9030, 0xcfb8, 0xc6a2, 0x7d47},
+         {0xd6b7, 0x9e7d, 0x55e4, 0xf5d2, 0x1eac, 0x610b, 0x115c, 0x8016,
+          0x87ca, 0x92e1, 0x975d, 0x3c99, 0x25c2, 0x9791, 0x5762, 0x1381},
+         {0xd6e0, 0x8ef0, 0xd014, 0x3fda, 0x6f3c, 0x9154, 0x749a, 0x9d3e,
+          0x8157, 0x26bb, 0x6210, 0x71ec, 0xec80, 0x34c9, 0xf58d, 0x148c}},
+        {{0x756d, 0x9ae4, 0x2f7d, 0xe257, 0x487f, 0x88f3, 0x45bb, 0x56c3,
+          0xa88d, 0x6960, 0x0b6d, 0x9fd1, 0xa1b9, 0x4eae, 0xebad, 0x278f},
+         {0xf027, 0x7934, 0x92f6, 0x46a4, 0x0aa9, 0xf684, 0x84be, 0x4699,
+          0x1854, 0x8961, 0xbc2a, 0x5ca1, 0xbbd4, 0xbd5d, 0xfa1e, 0x3ff2},
+         {0x3966, 0x8c93, 0x681f, 0xb1aa, 0x0c98, 0x2029, 0x949c, 0x8c21,
+          0x3c52, 0x219d, 0x5291, 0x3911, 0x677b, 0xfe9c, 0xdd02, 0x4104}},
+        {{0x6ab8, 0xdb09, 0x4e06, 0x8121, 0x4f35, 0x0ce4, 0xb6c9, 0x21a8,
+          0x2af5, 0x409e, 0xc12a, 0x6524, 0xa481, 0x8efc, 0xb5a4, 0x0165},
+         {0x422a, 0x1124, 0xbf5e, 0x72b2, 0x3ab5, 0x98a3, 0x0c33, 0xa1fa,
+          0xb666, 0xfa52, 0x6101, 0x94cb, 0x53d5, 0xafaf, 0x3b00, 0x2c86},
+         {0x6a76, 0xa084, 0xa474, 0xf190, 0x7cc0, 0xcd2f, 0xf984, 0x12ef,
+          0x2b8f, 0x58aa, 0x2906, 0x695e, 0xc8b8, 0xbffe, 0x67d9, 0x591b}},
+        {{0xb55d, 0x9f18, 0xb371, 0x99b9, 0x641e, 0xa18c, 0xe5fa, 0xe465,
+          0x05ed, 0xc29f, 0x1136, 0x6108, 0x128b, 0x7030, 0x4f86, 0x489b},
+         {0x9bfa, 0x80b4, 0x0d1c, 0x312f, 0xec8a, 0xabf3, 0x515e, 0x5979,
+          0x1c88, 0x9ef0, 0x33c0, 0x7270, 0x7bcb, 0xca8f, 0x2ec7, 0x3de0},
+         {0x92ef, 0x3aeb, 0x102d, 0xd232, 0xa861, 0x6116, 0x53b4, 0xe162,
+          0xaa24, 0x190b, 0xabe7, 0x3d7e, 0xbebf, 0x496c, 0xfbba, 0x49f5}},
+        {{0x572e, 0x1e9c, 0x628c, 0x155d, 0x4741, 0xc588, 0x86ac, 0x8a4d,
+          0x63eb, 0x5157, 0x52f6, 0x91a3, 0x515b, 0x8867, 0xa6c2, 0x06a1},
+         {0xcfd4, 0x8a5b, 0x9a10, 0x3094, 0x73eb, 0xbc64, 0xdd70, 0xdc40,
+          0x0d1c, 0x307c, 0x94c1, 0x92c2, 0x6e74, 0xcbfa, 0xa86d, 0x5604},
+         {0x64b6, 0x7c17, 0xd1d4, 0x7288, 0x8b51, 0xe041, 0x1140, 0x7254,
+          0xf6d1, 0x18ac, 0x1a60, 0x9f03, 0x42c6, 0xfe27, 0x9e89, 0x2098}},
+        {{0xec2e, 0x85ea, 0x278b, 0x1674, 0x2bdf, 0x7acb, 0xdc07, 0x5621,
+          0xf45a, 0x61cb, 0x4c16, 0x640a, 0x95d3, 0xf705, 0x9950, 0x730b},
+         {0xcc7f, 0x3a2d, 0x77fd, 0x4997, 0xd892, 0xa54f, 0x7c2c, 0x3285,
+          0xe3a0, 0xd207, 0xd864, 0xa279, 0x7e29, 0x0ca6, 0xed1d, 0x0403},
+         {0xc552, 0x874e, 0x2d35, 0xc94b, 0x6f8d, 0x9824, 0xc8cf, 0xc5e6,
+          0x35ce, 0x16c0, 0x46fa, 0xf7cb, 0x3dcc, 0x0830, 0x4543, 0x5bd7}},
+        {{0x792a, 0x15e7, 0x9321, 0x85c4, 0xddc9, 0xbdcd, 0x89a2, 0xc64c,
+          0xd762, 0xada3, 0x3da8, 0x9d1e, 0xf82c, 0x3067, 0xdb12, 0x5bb7},
+         {0x4cc2, 0x28b2, 0xd195, 0x7f9a, 0xc181, 0x6335, 0x5465, 0x7f6b,
+          0x7236, 0x4fc0, 0xb66e, 0x66b8, 0xad83, 0x7380, 0x7800, 0x133a},
+         {0x62be, 0xc6ca, 0xf467, 0x0961, 0x52ee, 0x2119, 0x21d6, 0x04ec,
+          0x4770, 0x9bd5, 0x6077, 0x1823, 0xe0d2, 0x58f0, 0xca6d, 0x740d}}
+    },
+    {
+        {{0x433c, 0x0478, 0x8c57, 0x231a, 0x439d, 0xc281, 0x270e, 0xb7b5,
+          0x079f, 0xe3d9, 0x99ea, 0xdbaa, 0x03d9, 0x6c2b, 0xf525, 0x2c03},
+         {0xce4e, 0x52cf, 0xee07, 0xdf48, 0x08b7, 0x06ec, 0xfaf3, 0xc3ff,
+          0x59c4, 0xb954, 0x0b2a, 0x0571, 0xa38d, 0x963e, 0x25fa, 0x161d},
+         {0xa47d, 0x7b53, 0x1875, 0x790f, 0x5879, 0xcf0c, 0x0130, 0x307b,
+          0xf7f9, 0x257e, 0x3d77, 0x3190, 0xbbaf, 0xbd96, 0x68bd, 0x6994}},
+        {{0x1948, 0x6aa9, 0x3de6, 0xd8dd, 0xd2cc, 0x2fc0, 0x64c2, 0x4850,
+          0xea2f, 0x34fd, 0x2466, 0x9b48, 0x2e3a, 0x6c4a, 0x1c4e, 0x293e},
+         {0xfecf, 0xf4da, 0x2f46, 0xbd1f, 0xd6f7, 0xa47f, 0x0114, 0x7cef,
+          0xb37f, 0x4a47, 0xfdda, 0xd31f, 0x5785, 0x7390, 0x19a4, 0x5252},
+         {0x12e1, 0x9251, 0x134b, 0x376e, 0x5da0, 0xdca1, 0x78b5, 0x7037,
+          0x3111, 0x461c, 0x89af, 0xb045, 0x2823, 0x7f03, 0x5c44, 0x5b60}},
+        {{0xf04c, 0xf0e7, 0xfec6, 0x3be9, 0x4962, 0x75e3, 0x579e, 0x866a,
+          0xe61a, 0x1e1d, 0xef16, 0x5542, 0xbdd5, 0xcc5a, 0xfef4, 0x2f12},
+         {0x7c89, 0x20c4, 0x8059, 0xb965, 0x8fcc, 0x923b, 0x100c, 0xe7f0,
+          0xef77, 0x02e2, 0x2565, 0x0001, 0xb3ee, 0xa8ae, 0x6dce, 0x24a7},
+         {0xc740, 0xdfc0, 0x22b2, 0x0a45, 0xa407, 0x40c9, 0x6e7f, 0x10d0,
+          0xf668, 0x78cf, 0x1441, 0xc6cf, 0x3790, 0x18a4, 0x7b25, 0x5e60}},
+        {{0xcf14, 0xa596, 0x431c, 0xa02c, 0xe400, 0xaed3, 0x2d40, 0xe3c4,
+          0x26db, 0x2e0f, 0x2680, 0xd245, 0x7068, 0x9e45, 0x3313, 0x201f},
+         {0x1818, 0x6cdf, 0x1d8f, 0x58b3, 0x58a2, 0xc362, 0xa74f, 0x35cf,
+          0x1d6e, 0x66e6, 0xff4f, 0xe1b3, 0xd5f7, 0x6ccd, 0xacab, 0x5067},
+         {0x9d51, 0x0803, 0x7f6b, 0xfd52, 0x0006, 0x017c, 0x4964, 0x18b1,
+          0xa4a8, 0x2e25, 0x0eb0, 0xd522, 0x0375, 0x6246, 0xba88, 0x397c}},
+        {{0x79e7, 0xc813, 0xc3fb, 0x7815, 0x2af1, 0xdde1, 0x9420, 0xa661,
+          0xfdd5, 0x85a8, 0xc0f8, 0xffa9, 0xc252, 0xc1e1, 0x4022, 0x771b},
+         {0x59b2, 0xf059, 0x3093, 0x30c1, 0x7976, 0xe9a9, 0xa18d, 0xe23a,
+          0x5e26, 0x721d, 0xd491, 0x222f, 0x6c3a, 0x766e, 0xd320, 0x2339},
+         {0x2fa7, 0x513a, 0xd986, 0xd87d, 0xcf08, 0xf9d4, 0x9b71, 0xf5ac,
+          0x83b3, 0x1ea2, 0xc31b, 0xd06b, 0x1a76, 0x1997, 0x1892, 0x331a}},
+        {{0x72af, 0x9d75, 0x2f3a, 0x2651, 0x4a9e, 0x6807, 0xe288, 0x5bcb,
+          0xf7c4, 0x1180, 0xc1c1, 0x84ed, 0xa67b, 0xf649, 0x619f, 0x1ac9},
+         {0x80c6, 0xfb4f, 0x6f45, 0xf516, 0x75cf, 0x61c7, 0xc7de, 0x9c36,
+          0xd91c, 0x9041, 0xe81b, 0xe3d4, 0xfe21, 0x83bd, 0x7c6b, 0x3116},
+         {0x1068, 0x524b, 0x3842, 0xf22b, 0xe987, 0xee9c, 0x343b, 0x5068,
+          0x50c8, 0x4a62, 0x7184, 0xfc9d, 0xb111, 0x1f08, 0x3634, 0x6124}},
+        {{0x2638, 0x1a2d, 0x49e3, 0x8b63, 0xfd35, 0x9bd3, 0xb700, 0x9ddf,
+          0x6ba4, 0xa3a0, 0xf1b8, 0x7f8b, 0x0445, 0x78d9, 0xaa31, 0x1522},
+         {0x898d, 0x874e, 0x41db, 0xd99d, 0xdc20, 0x6c07, 0xa5f1, 0x09fe,
+          0x9bbc, 0xd00f, 0x2c67, 0x793d, 0xff40, 0x9e5e, 0xe230, 0x46eb},
+         {0x4938, 0x6961, 0x2f53, 0x2c38, 0x6d10, 0xb72d, 0x409a, 0xdafe,
+          0xf227, 0xb646, 0x3391, 0xe8c8, 0x306c, 0x0524, 0x70f5, 0x45fe}},
+        {{0x1491, 0xc895, 0x4920, 0x62f2, 0x0ca2, 0x3f63, 0x07c8, 0x05f0,
+          0xd4b8, 0xf5c9, 0x45d2, 0x6fbb, 0x2245, 0xb57a, 0x9f6d, 0x1661},
+         {0x0b8c, 0x960c, 0x75a6, 0xda48, 0x2f20, 0xef0e, 0xd076, 0x5b68,
+          0x8fd4, 0x3d0b, 0x51cf, 0x07fb, 0x92d4, 0xa0e3, 0x1623, 0x428d},
+         {0x08fd, 0x01a3, 0x4a44, 0x084f, 0xcaac, 0x76a5, 0x19c3, 0xa822,
+          0xbc7d, 0x43d1, 0xde46, 0xdeb8, 0x38c6, 0x60bd, 0x592d, 0x1d81}}
+    },
+    {
+        {{0xc5e8, 0x7b85, 0xb69f, 0x8765, 0xbab2, 0xd168, 0x678b, 0x6ff0,
+          0x0f9b, 0x1d33, 0xe77c, 0x3a70, 0x8e7c, 0xb0af, 0x6d51, 0x3a5f},
+         {0xac5f, 0xa60d, 0x8756, 0x6136, 0xdc57, 0xebab, 0x2f6a, 0x17e0,
+          0x0f7d, 0x4cce, 0x3f2d, 0x7f19, 0xdcf0, 0x89ec, 0x4a77, 0x2023},
+         {0xb252, 0x7178, 0x0db6, 0x76d2, 0xd160, 0xd51e, 0x34f9, 0x071c,
+          0x1170, 0xb3e4, 0x4a20, 0xf62a, 0xe366, 0x3cff, 0x8235, 0x7cd6}},
+        {{0xf4f3, 0x68ac, 0xcd60, 0xa665, 0xe3d3, 0x3cd7, 0x2d18, 0x42d9,
+          0x25d9, 0x3360, 0x389d, 0x5759, 0xd8ff, 0x2b2c, 0x253b, 0x3ef0},
+         {0xfab6, 0xd887, 0xa45b, 0x0be1, 0x3b6e, 0xba40, 0x6a32, 0x2a84,
+          0x6000, 0xe96e, 0x1012, 0xd992, 0x0943, 0x3bdc, 0xc886, 0x2838},
+         {0x5030, 0x4a46, 0xb0cf, 0xd16b, 0x77ab, 0x15c5, 0x6b41, 0xfa49,
+          0x419d, 0xf4ab, 0xae8a, 0x82cf, 0x2812, 0x06a8, 0xb8a6, 0x21dc}},
+        {{0x31ba, 0xbe77, 0x00fa, 0x9a8d, 0x1889, 0x629e, 0x607e, 0x8203,
+          0xd97f, 0x43f3, 0x0237, 0xb2cc, 0x678b, 0x6c6f, 0x0dbf, 0x5d84},
+         {0x9fc8, 0x8c9d, 0x0446, 0x5c60, 0xa3cb, 0xd42a, 0x096e, 0x2540,
+          0x2f9c, 0x12ee, 0x4d4c, 0x125b, 0x1dab, 0x94a3, 0xd081, 0x0bc3},
+         {0xe18b, 0x309f, 0x380d, 0x706e, 0x65c7, 0xb9e1, 0x2da6, 0x6eb0,
+          0x20ab, 0x7dae, 0xba99, 0x57bb, 0x96dd, 0x2ac1, 0x7623, 0x3a42}},
+        {{0x7ecb, 0xdb44, 0xc172, 0x3bf8, 0x2dbd, 0xc628, 0xc41f, 0x5fcf,
+          0x15fe, 0x75aa, 0xffc0, 0x80ac, 0xa9f9, 0x24e1, 0xc9e8, 0x0770},
+         {0x84fa, 0x8a70, 0x432c, 0x4b42, 0xe545, 0xdfb9, 0x19e3, 0x898a,
+          0xe45d, 0x9c58, 0x0021, 0xbe9f, 0xebd1, 0xa16d, 0x77ce, 0x1ff1},
+         {0xb5fd, 0x45b5, 0xd99a, 0xcf61, 0x7924, 0x1b3a, 0x84e9, 0x8609,
+          0x3e89, 0x303e, 0x0919, 0xe730, 0x0b1e, 0x4150, 0x64fd, 0x39f2}},
+        {{0x7be1, 0xfe09, 0x4aab, 0xd19b, 0x1929, 0xdfe0, 0xfce1, 0xa46d,
+          0xf1ff, 0x2ca6, 0x0894, 0xc3c9, 0xf14e, 0x2c35, 0x2127, 0x65c6},
+         {0xe29c, 0xdbe7, 0x3417, 0xa7ad, 0x139c, 0x2b9c, 0x376a, 0xbd94,
+          0x7ba9, 0x9359, 0x1b8e, 0xa0e9, 0x9840, 0x6888, 0xd734, 0x1712},
+         {0x93dd, 0xce31, 0x89f8, 0xe72b, 0xc0bb, 0xa125, 0x3356, 0x4d10,
+          0xfe83, 0x2e1c, 0xa93d, 0x0419, 0xe272, 0xb19c, 0x800a, 0x22f9}},
+        {{0xfdac, 0x9a6e, 0x9fdd, 0x4202, 0x4941, 0x34a5, 0xcebe, 0xb912,
+          0xf37b, 0x87bd, 0x64b9, 0x640f, 0xcab4, 0x8598, 0xa4d3, 0x4171},
+         {0xf8cb, 0x3e9e, 0x368a, 0x605a, 0x4715, 0xa550, 0xc022, 0xe3e9,
+          0x248f, 0x5f24, 0x48b0, 0x553d, 0x26e5, 0x6476, 0x16cd, 0x13f4},
+         {0x4c8c, 0x99c9, 0x58aa, 0xfa27, 0xb807, 0xb000, 0x6f6f, 0x2300,
+          0x5392, 0xadda, 0x91dd, 0xfbd2, 0xd1ab, 0x574b, 0x14fa, 0x5082}},
+        {{0x03d6, 0x53d0, 0x15bb, 0x461a, 0xc965, 0xbcf3, 0x2888, 0xb210,
+          0x3a5a, 0x6c68, 0x7675, 0x27c5, 0xb447, 0xc86c, 0x58a4, 0x3a77},
+         {0xfe4b, 0x3ed6, 0x6915, 0xc202, 0x77c4, 0x511d, 0x6739, 0xa65a,
+          0xaf94, 0x2c14, 0x2646, 0xcbde, 0xa74b, 0x6fab, 0x60ec, 0x22f9},
+         {0x5076, 0x93ae, 0x11f6, 0x5481, 0x54a6, 0x1dfd, 0x21df, 0x1dae,
+          0x5e65, 0xf311, 0x8c90, 0x1224, 0xf494, 0x8de7, 0xd15f, 0x5d9f}},
+        {{0x521e, 0xeed7, 0x4d2a, 0x3f24, 0x9615, 0x432e, 0x9028, 0x8e3a,
+          0x16d4, 0x2e9c, 0xba77, 0xe164, 0x98d8, 0x47eb, 0x87fa, 0x3bc1},
+         {0x727f, 0x6d63, 0x08d3, 0x0314, 0xb533, 0xd7c7, 0x9aef, 0x6a37,
+          0xe24b, 0xccae, 0x8fc5, 0xa9e1, 0xbed3, 0x4f8f, 0x3591, 0x332f},
+         {0xc20c, 0xea86, 0x0115, 0x6d47, 0xd125, 0x6c46, 0xb7cb, 0x998a,
+          0x0188, 0x3a66, 0x32b5, 0xd778, 0xba03, 0x906f, 0x81ce, 0x450d}}
+    },
+    {
+        {{0x743f, 0x1cae, 0xd896, 0xd074, 0x63ed, 0xee1c, 0x18f5, 0xf86d,
+          0xed29, 0xe7f4, 0xc55b, 0x97bd, 0xb108, 0x663a, 0xd279, 0x4cba},
+         {0x5275, 0xa620, 0xb6a1, 0x6e7b, 0x8e83, 0x413c, 0x21d7, 0xaa4f,
+          0x5cb2, 0xe88f, 0xd155, 0x6f56, 0x5be1, 0xa634, 0x5d4b, 0x2de2},
+         {0x1fcd, 0xa0d7, 0x9024, 0x80d1, 0x8af8, 0xfb28, 0xc20a, 0xc525,
+          0x6419, 0x5f3a, 0x974b, 0xb1a3, 0x7233, 0xe200, 0xbcef, 0x7d7f}},
+        {{0x9094, 0xf3c2, 0x5dc5, 0xcd7c, 0x05ab, 0x2a91, 0xa29a, 0xc781,
+          0x3058, 0x421c, 0x1d36, 0x80c6, 0xd4d7, 0xdcd8, 0xd196, 0x4f9c},
+         {0x2801, 0x266b, 0x1e6a, 0xfaef, 0x9f16, 0xd573, 0x68c4, 0x866c,
+          0x762c, 0x1b03, 0x2fbc, 0xf68a, 0x5a8d, 0x87b7, 0x435e, 0x5975},
+         {0x3768, 0x6a7b, 0x97d8, 0x1992, 0x7a63, 0x1ad1, 0x5824, 0xd0d0,
+          0x0c17, 0x5c1c, 0x9cad, 0xba02, 0x0307, 0x387a, 0xd084, 0x7ccd}},
+        {{0xcc93, 0x6760, 0x8418, 0x9b0c, 0x2a99, 0x1ab3, 0x007a, 0xcdae,
+          0xda18, 0x620b, 0xec86, 0xa88d, 0xca44, 0x8190, 0xca84, 0x3593},
+         {0x0417, 0x6d26, 0x422c, 0xdca6, 0x40bd, 0x9482, 0x3d50, 0xae15,
+          0xc677, 0xfb68, 0xc1b4, 0xa9c0, 0xcf53, 0x61d0, 0xd0ed, 0x428b},
+         {0x9aa7, 0x5e84, 0x189a, 0x9213, 0xfacd, 0x65d8, 0xc335, 0xd4d8,
+          0xbbd1, 0x53fd, 0x545b, 0x8c52, 0x63e6, 0xda2d, 0x8308, 0x2739}},
+        {{0x2453, 0x0a70, 0x0e4c, 0xb9a1, 0x1bde, 0xd57d, 0x5866, 0x0fa2,
+          0xdaf7, 0xcd27, 0xd9b5, 0xffb9, 0x33fd, 0x492c, 0x2945, 0x572c},
+         {0xd413, 0x435e, 0x8d28, 0x42c3, 0xccc9, 0x3278, 0xf360, 0xbd50,
+          0x03ef, 0x79da, 0xab1a, 0xbb07, 0x3355, 0xbe8c, 0x97ae, 0x2695},
+         {0x30be, 0xd6cd, 0xc745, 0xc77f, 0xaefb, 0xe3ba, 0xe8d3, 0xe4df,
+          0xda0c, 0xaa5d, 0x8830, 0xa22c, 0xca80, 0xc05b, 0x5498, 0x7f98}},
+        {{0x6363, 0x0fbf, 0x1552, 0xd356, 0xfba6, 0xcf4d, 0x5a45, 0x0804,
+          0xa0c2, 0x873f, 0x4fbc, 0xeec2, 0x12e7, 0xd69b, 0x653c, 0x30f2},
+         {0xe117, 0x9f0b, 0xce88, 0x3849, 0xa288, 0x7b54, 0xad1b, 0x8005,
+          0x921c, 0x23fc, 0xc39f, 0x3da3, 0xf304, 0x0a31, 0xec47, 0x76c2},
+         {0x0c85, 0xaac1, 0xc938, 0x8a08, 0x6bcb, 0xdb27, 0x9b60, 0x4617,
+          0xac70, 0x0e6f, 0xc01e, 0xa920, 0x73da, 0x5964, 0x73f1, 0x2f12}},
+        {{0x0bc0, 0x55a7, 0x8bd7, 0x3048, 0x42e7, 0xf1d4, 0xb5a4, 0x06d6,
+          0x6162, 0xbc59, 0xa69e, 0xead1, 0xf784, 0xedc5, 0x1997, 0x38ac},
+         {0x1e11, 0x8ae0, 0xfc7c, 0x4739, 0xab9f, 0x4a6a, 0x7490, 0xfd52,
+          0x8f2e, 0x8772, 0x8a82, 0x41d9, 0x69f2, 0xd85b, 0x572a, 0x5d9e},
+         {0xb13b, 0xa751, 0xb517, 0x0666, 0x858c, 0x7e9b, 0x0686, 0x747d,
+          0xde49, 0x454d, 0xc011, 0xacac, 0xe69c, 0xbfe9, 0xcd9c, 0x22df}},
+        {{0xe0a1, 0x103b, 0x59b4, 0x56ec, 0xf969, 0xd259, 0xbaec, 0x2ee3,
+          0xcd32, 0x13f5, 0xb294, 0x797c, 0xe472, 0x24cd, 0x8778, 0x0fe9},
+         {0x0cd9, 0xc30d, 0xd2e0, 0x8ddb, 0x4333, 0xacbb, 0x665f, 0xad8e,
+          0x961f, 0x322a, 0x258c, 0x8f6b, 0xc1c7, 0x5448, 0x16c0, 0x6b29},
+         {0x913b, 0x0aba, 0x34d1, 0x7edb, 0xac0e, 0x2e6d, 0xcd82, 0x4ea3,
+          0xf815, 0x6578, 0x3dff, 0x6608, 0x0a17, 0x7ff0, 0x3f30, 0x4c30}},
+        {{0x4500, 0x0dd9, 0x0358, 0x29fc, 0xec93, 0x6fbb, 0x7aa4, 0xecd2,
+          0xa7f8, 0xc2e2, 0x155f, 0x130a, 0xa1d5, 0xb706, 0x151a, 0x416b},
+         {0x8c85, 0x17b2, 0x3bd6, 0xd30a, 0x3bea, 0x3977, 0x77b7, 0xc5d3,
+          0x5cbf, 0x1e6a, 0xe78c, 0xc6c6, 0xb7c4, 0x8b2a, 0xb8f7, 0x0d61},
+         {0x36b0, 0xe9c1, 0xd7ef, 0x56a8, 0x4b20, 0x58e4, 0xe5cd, 0xbd07,
+          0xe0ab, 0x1b57, 0x2fda, 0xafe6, 0xe8d2, 0x4277, 0x2af7, 0x191a}}
+    },
+    {
+        {{0x0efb, 0x4f46, 0x2b43, 0x9fe6, 0x07d6, 0xa636, 0x03d4, 0xded3,
+          0xda24, 0xb7a0, 0x210e, 0xf052, 0x5b93, 0x0054, 0x7dbe, 0x237e},
+         {0x1431, 0xc53c, 0xf74b, 0xce16, 0xedde, 0x2072, 0x25ce, 0x2b97,
+          0x3ee7, 0xb5b2, 0xc36f, 0xb8b9, 0xc908, 0x0b5c, 0x0e45, 0x7e2e},
+         {0xb430, 0x6701, 0x75ed, 0x0135, 0xfd10, 0x9f0b, 0x94e6, 0x2310,
+          0x7f22, 0x83e4, 0x0f15, 0x7532, 0x55e3, 0xb111, 0xa699, 0x71af}},
+        {{0x50d6, 0x473b, 0x3c1c, 0xea42, 0xef10, 0x3b38, 0x7a1f, 0x51e8,
+          0xbe95, 0xb2c9, 0xbf5f, 0x9b84, 0x9a1c, 0x78f8, 0x1fbc, 0x0073},
+         {0xb61d, 0x3953, 0x6f9b, 0x65ce, 0x41e6, 0xafa1, 0x39ea, 0xc658,
+          0x59fe, 0xa9f7, 0x5ffd, 0x0f43, 0xc28e, 0xc2b1, 0x42e9, 0x0211},
+         {0x1880, 0x48f8, 0xc718, 0xe430, 0xc119, 0x5ece, 0x0c22, 0xbf96,
+          0x15e3, 0x6bba, 0xe083, 0xb6da, 0x5808, 0x47e1, 0x6f33, 0x4c4d}},
+        {{0x1970, 0x988f, 0xddfc, 0x2f0c, 0xf51b, 0xb0b9, 0x6227, 0x6b91,
+          0x76be, 0x7791, 0xb6c4, 0x6ec7, 0x9fa8, 0xa88f, 0x9500, 0x38bf},
+         {0x1fc9, 0xc17d, 0xeccf, 0x18f7, 0x3c14, 0x5140, 0xf5a6, 0x6c75,
+          0x0cdf, 0xf7ee, 0x712b, 0xdbde, 0x7a22, 0xa7e4, 0xddaa, 0x193f},
+         {0x876f, 0x37e8, 0xc93c, 0x1fd2, 0x462c, 0x18d1, 0x1e5a, 0xa2f6,
+          0x1276, 0x3924, 0xf582, 0x5080, 0x4969, 0xbf0d, 0xb99e, 0x6a6f}},
+        {{0x23c6, 0xb6e4, 0x22b5, 0xeeb1, 0xff8e, 0xf286, 0x7010, 0x939d,
+          0x5d8c, 0x1dcf, 0x2a83, 0x90a9, 0xeb10, 0x42c5, 0xda9f, 0x136f},
+         {0x55eb, 0x5608, 0xc1bb, 0x6a46, 0xf09d, 0xf893, 0xbb38, 0x2416,
+          0xacc1, 0x8f71, 0x1137, 0xd71d, 0x96ea, 0xa318, 0x6914, 0x75f7},
+         {0xbdd1, 0xa305, 0xdfb1, 0xf94c, 0x2c08, 0x9ff8, 0x4b9d, 0x0f36,
+          0x588a, 0xc3bb, 0xd8a5, 0x2a87, 0xdcba, 0x0be8, 0x8351, 0x0221}},
+        {{0x7a7f, 0x4330, 0x7101, 0x9d5a, 0xa45f, 0xc47d, 0xde9e, 0xb063,
+          0x7ad3, 0xbe92, 0xfe52, 0x22bb, 0x426c, 0xfd40, 0xc441, 0x1387},
+         {0x2d14, 0x5ead, 0x6638, 0x4af7, 0x5830, 0xca7c, 0xd880, 0xa08e,
+          0x1e3d, 0x1021, 0xa6e6, 0x0d13, 0x6c03, 0x7b80, 0x1ce1, 0x6a07},
+         {0x8af8, 0x8797, 0xc3d1, 0xb5d3, 0x4413, 0x7f0e, 0x5a3d, 0x722b,
+          0x7ca0, 0xbb47, 0x4848, 0x0d7b, 0xdc92, 0xaf1e, 0xb26a, 0x3171}},
+        {{0x47d1, 0xb28a, 0xb7d8, 0xa60d, 0xa4f1, 0x1770, 0x14d6, 0xa6bf,
+          0xbd58, 0x53dd, 0xf893, 0xd4a1, 0x43e9, 0x3442, 0x4a63, 0x6c51},
+         {0x4ca8, 0x9756, 0x3190, 0xa92f, 0xe119, 0x2275, 0xb84c, 0xff7b,
+          0x5150, 0xa487, 0xfe37, 0x4f55, 0x835a, 0x3cf0, 0xd487, 0x221f},
+         {0x6341, 0x3a15, 0x204f, 0x2322, 0x032d, 0xba0a, 0xe0e9, 0xfb73,
+          0x030e, 0x410f, 0xdd4c, 0xfce0, 0x4aaa, 0xfb92, 0xa596, 0x48da}},
+        {{0x9793, 0xc84c, 0x1d5d, 0x14f6, 0x8206, 0xef41, 0xf9e3, 0x9941,
+          0x77ac, 0x3462, 0xb88f, 0xcdf5, 0x79a9, 0x0e8a, 0x37fa, 0x58c8},
+         {0x9cc7, 0x5ca5, 0x8e66, 0x6eca, 0xaca0, 0x2e38, 0x254b, 0xa847,
+          0x17ce, 0xd21e, 0xc708, 0x31af, 0x4af7, 0xcad8, 0xd6fc, 0x676d},
+         {0x9058, 0x96fc, 0x6885, 0x0cf9, 0xa01b, 0x7b56, 0xbbf3, 0x1ddc,
+          0xd66a, 0x4935, 0xe77d, 0xdcc2, 0x7f0a, 0xc6a5, 0x73f2, 0x1c4f}},
+        {{0x3484, 0xfc7c, 0x706e, 0xb36e, 0xcf61, 0xc3c1, 0xc9b4, 0x73df,
+          0xc7e5, 0x781c, 0x79c9, 0xeb1d, 0x675c, 0x7daf, 0x9adb, 0x7045},
+         {0xa0bb, 0x305f, 0x4fbd, 0x0e7a, 0x63ad, 0x54c6, 0x4ce0, 0x829d,
+          0x3848, 0x2fe3, 0xc383, 0xf421, 0x4c42, 0x1bf6, 0xc80d, 0x795a},
+         {0x2bb3, 0x91b4, 0xdb49, 0x1b91, 0xdcca, 0x4b02, 0x9623, 0x5726,
+          0x78dc, 0x1f8c, 0x9ee5, 0x9fdf, 0x1fd3, 0x8ce2, 0x6284, 0x5fe1}}
+    },
+    {
+        {{0xb208, 0x5d7c, 0x852d, 0x2879, 0xf2e7, 0x687d, 0xdd70, 0xb8de,
+          0x7891, 0x2168, 0xffab, 0xdc0b, 0xaa35, 0x677d, 0xc043, 0x2b44},
+         {0x961a, 0xe194, 0x214f, 0x4e59, 0xcd4f, 0x0d71, 0x7dc7, 0x49be,
+          0xf22d, 0x3b50, 0xcfd2, 0x9300, 0x7232, 0xfc91, 0xd446, 0x4789},
+         {0xb78e, 0x074e, 0x87ab, 0x1a1c, 0xf467, 0x99da, 0xd18e, 0xfac6,
+          0x9067, 0x484f, 0xbbcd, 0x3eac, 0xa4e4, 0x2bb9, 0x2eef, 0x60c5}},
+        {{0x6d11, 0x7cae, 0xc5c2, 0x702b, 0x8cab, 0x54a4, 0x699b, 0x44c7,
+          0x2eb2, 0xba49, 0x4056, 0xefbc, 0x676d, 0xd9b6, 0x7248, 0x70d7},
+         {0x8bf1, 0x3bfd, 0x89bc, 0x0b5d, 0x551a, 0xc9f3, 0x9237, 0xb06b,
+          0x28f5, 0xd530, 0x16b0, 0x0e4c, 0xcaab, 0x2ccf, 0x9c31, 0x10bc},
+         {0xa05b, 0x3ec2, 0xe84b, 0xaa8a, 0x81e0, 0xed17, 0x9ef4, 0x9869,
+          0x85d1, 0x708e, 0x13e4, 0x7945, 0xf413, 0xa976, 0x5bd3, 0x6375}},
+        {{0xacb7, 0x97f1, 0x1018, 0x3dc7, 0xbbd8, 0xc165, 0x7d5e, 0x5dda,
+          0x020f, 0x0fa1, 0x5b9c, 0x508e, 0x2a56, 0x37c5, 0x7517, 0x2763},
+         {0x0853, 0x2ad1, 0xa03e, 0xb55f, 0x3569, 0x9ee6, 0x7590, 0x356f,
+          0xb890, 0xbe69, 0xf1fd, 0x9ff9, 0x6f84, 0x8bc1, 0xc1c4, 0x0d8c},
+         {0x19a9, 0x6eb4, 0x02d3, 0x0294, 0x60a5, 0x77b4, 0x4e7e, 0xf0b4,
+          0x4956, 0xd43c, 0x6230, 0xcfa8, 0x66e7, 0x7ad1, 0xdd8a, 0x70c2}},
+        {{0x7e13, 0xb8ed, 0x967d, 0x91d4, 0x817a, 0xd776, 0x2f0a, 0x7425,
+          0x2564, 0x0d85, 0x82e0, 0xe409, 0x3ce5, 0x16a5, 0x6138, 0x32b8},
+         {0xec0e, 0x9f6f, 0x9450, 0x6561, 0x518d, 0x46c6, 0x7ea9, 0xee2e,
+          0x9b5c, 0x67e0, 0xc1f3, 0x9733, 0x8495, 0x6394, 0xac63, 0x2e0f},
+         {0xcd64, 0xe448, 0xf7be, 0x79e7, 0x86d0, 0x0878, 0x3a67, 0x6ac8,
+          0xdb2e, 0xa0e4, 0xd4d9, 0xf89f, 0x4f41, 0x735a, 0x215c, 0x4179}},
+        {{0xcd34, 0x286b, 0x33b9, 0xe4ae, 0xd6dc, 0x559d, 0x7eb6, 0xb7ef,
+          0x8e1f, 0xb3d3, 0x141f, 0x278b, 0xc286, 0x2241, 0x8566, 0x31fa},
+         {0xed2a, 0xd7dc, 0x94e7, 0x8c70, 0x9c70, 0x47d3, 0x8ac3, 0x97fb,
+          0xd902, 0xa906, 0xe033, 0xe13b, 0x9d76, 0x0cd9, 0x44a3, 0x7003},
+         {0x22f4, 0x2e36, 0x6c42, 0xaf82, 0x502d, 0x9833, 0x2987, 0xc120,
+          0x9123, 0x2b38, 0xb7e1, 0x9bc1, 0x2489, 0xa995, 0x2312, 0x24bb}},
+        {{0x5c6b, 0xf5f8, 0x0c2a, 0x41f8, 0x6794, 0x04fa, 0x84c3, 0x6872,
+          0x1bad, 0xa3ba, 0xdf99, 0x8945, 0x5d16, 0xffeb, 0x2af9, 0x0d1d},
+         {0x67c3, 0x32de, 0xed17, 0xb1a8, 0x4948, 0x461b, 0x9418, 0x3cb4,
+          0xbcd2, 0x76cf, 0x4343, 0x8ebd, 0x8008, 0x1e18, 0x3e87, 0x0fee},
+         {0x1edf, 0x3262, 0x8aa1, 0xa9da, 0x6579, 0x5922, 0x22a1, 0x30b8,
+          0xc193, 0xa79a, 0x197b, 0x4004, 0x1d76, 0x1853, 0xd797, 0x16ac}},
+        {{0xb6ad, 0x7887, 0xc6c5, 0xc959, 0xfeba, 0x5f90, 0x9ead, 0x94e1,
+          0xf504, 0xa342, 0x4e62, 0x16e2, 0x1700, 0x1816, 0xd34b, 0x164e},
+         {0x1d3d, 0x2d9b, 0x72af, 0x72df, 0x245a, 0xa432, 0x2a36, 0x6346,
+          0x9637, 0x16b3, 0xa079, 0x3ece, 0x2309, 0xb930, 0x0ef6, 0x123e},
+         {0xe69a, 0x192f, 0xd94c, 0x487e, 0x1513, 0x3a91, 0x2cea, 0x61ae,
+          0xde27, 0xb9a4, 0xf6d3, 0x877b, 0xf3eb, 0x1073, 0x0fc6, 0x78da}},
+        {{0x3a94, 0x680c, 0x80f1, 0xa29f, 0xe7e6, 0x1ae9, 0x7e15, 0x71f7,
+          0x7973, 0x4801, 0xf158, 0x1100, 0x8ddd, 0x16b3, 0xa4b3, 0x054a},
+         {0xc66a, 0xe52b, 0x5d28, 0x5bf1, 0x1a8e, 0x70f0, 0xe318, 0x2c47,
+          0x8bdd, 0x06c2, 0xafbc, 0x2419, 0x173a, 0x256b, 0xdeeb, 0x2d25},
+         {0x7cb8, 0x1926, 0x468d, 0xdfc8, 0x4daf, 0x66e5, 0x789c, 0x0b28,
+          0xec17, 0x666e, 0x1d2a, 0x2aeb, 0xa760, 0xab7d, 0x10a6, 0x1346}}
+    },
+    {
+        {{0xf515, 0x77d1, 0x65e7, 0xcd2a, 0x60f1, 0x8faa, 0x9187, 0x5489,
+          0x06e5, 0xdabc, 0x3bbc, 0xb1b7, 0xc9fb, 0xa97c, 0x78cb, 0x6548},
+         {0xb0fe, 0x8df6, 0x8ec7, 0x5113, 0xf51b, 0xe575, 0xda89, 0x5397,
+          0xf1b9, 0x717a, 0x7a1d, 0x0920, 0xd650, 0x2b20, 0xfdba, 0x2102},
+         {0xe6a1, 0x055c, 0xe405, 0x969e, 0xad29, 0x1251, 0xa768, 0x36bc,
+          0xa415, 0xaa7d, 0xf517, 0x3a1a, 0xb2ba, 0x29ec, 0x25db, 0x0ad7}},
+        {{0x6f85, 0x9b05, 0xbc0c, 0xfec7, 0xffd7, 0xe7f5, 0x5268, 0x537d,
+          0xaefa, 0x4312, 0xc662, 0x77af, 0x9fd9, 0x0239, 0x5f53, 0x4f67},
+         {0x2457, 0x834e, 0x67b1, 0xdc42, 0x1bc5, 0x70ce, 0x44b5, 0xb675,
+          0x5ed7, 0xf7d1, 0x7a0b, 0x1af0, 0x3650, 0x71a0, 0xcffb, 0x4aef},
+         {0x171e, 0x0415, 0x3636, 0xc32d, 0x483b, 0x8998, 0xef11, 0xcd2b,
+          0x5110, 0xd094, 0x6ead, 0x870a, 0x6561, 0xa2a8, 0xbb72, 0x0bcc}},
+        {{0x1296, 0x50fe, 0x5e4c, 0x186d, 0x9f7e, 0xfee8, 0x7b82, 0xe039,
+          0x31b0, 0x5070, 0xf6c5, 0x3bc7, 0x37c2, 0x108f, 0xfd69, 0x6678},
+         {0xa9c8, 0xeab1, 0x962f, 0x185e, 0x7dcd, 0x6514, 0xe635, 0x86e7,
+          0x6df2, 0xbb5b, 0xe031, 0xb092, 0xb73e, 0x59d6, 0xf0ab, 0x4024},
+         {0x63c2, 0x6368, 0xfa31, 0x1586, 0x33f2, 0x572d, 0x8c48, 0x07f6,
+          0xaefc, 0x789e, 0xcc9f, 0x4f73, 0x4701, 0x8ead, 0xe210, 0x2d42}},
+        {{0x7593, 0x0f53, 0x7b0d, 0x2171, 0x064c, 0x131e, 0x690b, 0x914e,
+          0xe09f, 0x752a, 0x87ae, 0x1bb6, 0x3c6e, 0x9b42, 0xf3a7, 0x420b},
+         {0xd29b, 0x94df, 0x1315, 0x97f5, 0x4c6a, 0x313f, 0x985d, 0x6155,
+          0x5010, 0x0845, 0x3f07, 0xeba1, 0xd322, 0xb8d2, 0x2608, 0x676b},
+         {0x2b47, 0x1c5b, 0xba65, 0x8138, 0x1b80, 0x311b, 0xb6ec, 0x8671,
+          0x35b0, 0xbc31, 0x0cb1, 0x7bff, 0xf1e0, 0x9c0c, 0x2ffa, 0x745d}},
+        {{0x4e6a, 0x21d3, 0xdf57, 0x6036, 0xb3d0, 0x997b, 0x8827, 0xb1db,
+          0x6afa, 0xc875, 0x09c3, 0xd3c2, 0xc839, 0x4c1d, 0x5be5, 0x06e1},
+         {0xc8bd, 0x2bc9, 0x5a1e, 0xbf52, 0x9d81, 0x2647, 0x2608, 0xea5b,
+          0x55db, 0xdf01, 0xc70e, 0xd511, 0xf5d0, 0x960c, 0x3ceb, 0x1ae2},
+         {0x994a, 0x1932, 0x5d87, 0x5b72, 0xdab0, 0xceb1, 0x1cb5, 0x3235,
+          0xca05, 0xdab7, 0x1549, 0x7dc4, 0xc1f7, 0x278e, 0xd861, 0x58de}},
+        {{0xc9a8, 0xb6c2, 0x5ba8, 0x2dfb, 0x598c, 0xf52c, 0xef8e, 0x48ee,
+          0x1573, 0xf12d, 0x9107, 0x3380, 0x5bd8, 0x531d, 0x696b, 0x08ba},
+         {0xc55c, 0xf266, 0x3793, 0xd817, 0x4e49, 0xcc45, 0x76c5, 0xc8c9,
+          0xc3a8, 0xbc26, 0x82f8, 0x5ce3, 0xf6f9, 0x5485, 0x9de8, 0x2ff3},
+         {0xc57a, 0xc3ef, 0x3eee, 0x77ed, 0x4811, 0xd4ff, 0x5517, 0x04e0,
+          0x71cb, 0xf1a6, 0x7a3f, 0xea3d, 0xfe54, 0x947c, 0x33b4, 0x1206}},
+        {{0x100a, 0x4912, 0x3147, 0x82bd, 0xbe06, 0x7e6f, 0x7b6d, 0xde23,
+          0x79c6, 0x11ea, 0x7619, 0xe11e, 0x3bde, 0xcb39, 0x3be3, 0x0743},
+         {0x0042, 0x9161, 0x9878, 0x0b94, 0xfae8, 0xeceb, 0xb13c, 0x4ee7,
+          0xa4c0, 0x94f0, 0x7395, 0x70be, 0x9185, 0xb4d5, 0x0a99, 0x35d3},
+         {0x97f4, 0x5ce9, 0x44c0, 0xff79, 0x51a3, 0xb05c, 0x3de4, 0x575d,
+          0x847c, 0x5a76, 0x81fd, 0x5833, 0xda9f, 0x7af6, 0x3ede, 0x2d87}},
+        {{0xf981, 0x4e5d, 0x02e1, 0xaa62, 0xe1f5, 0x5015, 0x5917, 0xa20d,
+          0x1d6c, 0xbae2, 0x75d3, 0x18a2, 0x0253, 0x0160, 0x618a, 0x0543},
+         {0x3409, 0x4337, 0x3164, 0x157a, 0x81d9, 0xf4aa, 0xb7ee, 0xfab8,
+          0x4806, 0xf5a6, 0xfee6, 0xb093, 0xa7b6, 0x707f, 0x3654, 0x2e77},
+         {0x23c1, 0x974c, 0xbdf4, 0x0dea, 0x4693, 0x9dce, 0x0a25, 0xaa6f,
+          0xba2c, 0xa29a, 0x2cb8, 0x0420, 0x960d, 0x2d07, 0x4336, 0x4b14}}
+    },
+    {
+        {{0x9ccb, 0x1c52, 0x54e9, 0x967c, 0x35fb, 0x64c6, 0x2692, 0x30f6,
+          0x1965, 0x7812, 0xaff4, 0x2747, 0x6f5c, 0xeaf6, 0x8418, 0x1703},
+         {0x1f7a, 0xb66e, 0xb7c7, 0xccc4, 0x2f7e, 0xf50c, 0x7e25, 0x4415,
+          0xaf1c, 0x713e, 0x6dfc, 0x3ef0, 0x63f7, 0x52da, 0x4467, 0x582f},
+         {0x4ce4, 0x2032, 0x7bd3, 0xc631, 0x8bc4, 0xa448, 0x42e8, 0xa810,
+          0x1364, 0x4e5a, 0xf18b, 0xb21e, 0x8dc9, 0xcda2, 0x1c4b, 0x0c2a}},
+        {{0x6945, 0x69bd, 0x8148, 0xedc4, 0x8d22, 0xbe1c, 0x907d, 0x0d6d,
+          0xc5ab, 0xd55c, 0xd212, 0xc63b, 0xdc83, 0xa314, 0x9b30, 0x5a6a},
+         {0x0447, 0x6f1f, 0xc7d0, 0xd24d, 0xc059, 0xdb87, 0x9e3e, 0xb226,
+          0xd28f, 0xfbb2, 0x0272, 0xd15b, 0x4877, 0xc6f6, 0x8bd1, 0x7c55},
+         {0x463d, 0xd396, 0x1524, 0xd0ec, 0x24f0, 0xc35a, 0x628a, 0x12bb,
+          0x5fa4, 0x1cbc, 0x3a79, 0xa50c, 0xafc3, 0x0afb, 0xa5ca, 0x0404}},
+        {{0x6fd1, 0x2a41, 0x9e1b, 0x62bc, 0x598b, 0xe350, 0xf728, 0xb5c6,
+          0x6967, 0x3d5d, 0x3fd8, 0x0434, 0xee98, 0xe7f8, 0x7516, 0x3952},
+         {0x43d6, 0x0aa7, 0x4007, 0x8c1f, 0x5ee8, 0x5b26, 0xd0cb, 0xccba,
+          0xd2de, 0x668f, 0x046b, 0x574b, 0x9633, 0xcadd, 0x5bfd, 0x4639},
+         {0x9a9c, 0x1a5d, 0xdb2d, 0x117f, 0x5c2a, 0xd100, 0x45bc, 0x9c77,
+          0x6fea, 0x54d5, 0xbef1, 0xefd4, 0xd016, 0xe822, 0x9a29, 0x7657}},
+        {{0x34f2, 0x52b4, 0xb513, 0x333c, 0x80e1, 0x93de, 0x2849, 0xd832,
+          0x35ce, 0x750d, 0x2887, 0xb551, 0x77c1, 0x2a27, 0x14bb, 0x02c5},
+         {0x2a17, 0x49c0, 0x8e7e, 0x45b6, 0xa37f, 0xbca9, 0x51a2, 0x23cd,
+          0x4c1b, 0xec22, 0x5f11, 0x3ed6, 0xbdb1, 0x9e05, 0x84dc, 0x43a3},
+         {0xb645, 0x8bf1, 0xd5da, 0x684b, 0x4b53, 0xf6b5, 0xd37e, 0xfb8b,
+          0xd253, 0xa9b0, 0x16d7, 0x3139, 0x8059, 0x6154, 0x9209, 0x1160}},
+        {{0x4dcd, 0x369b, 0x5616, 0x7a38, 0x3563, 0x655c, 0x2ca7, 0x75c0,
+          0x8021, 0xd4f1, 0x1bf9, 0x7dc2, 0xe042, 0x91e6, 0x7d74, 0x2f63},
+         {0xcfaa, 0x29da, 0x1669, 0xb44d, 0x598f, 0x8413, 0x9f4c, 0xda52,
+          0x5559, 0x453d, 0x63ca, 0xe9ef, 0x8e0b, 0xc569, 0x125b, 0x351e},
+         {0x7bbe, 0x1af6, 0x9b46, 0xd4b4, 0x8961, 0xc8ab, 0x037a, 0xd603,
+          0x99fb, 0xf9a6, 0xe19f, 0x71de, 0x2a9a, 0xe7ce, 0x2d06, 0x7f18}},
+        {{0x7522, 0x8e21, 0x4b72, 0x0945, 0xb8d8, 0xd484, 0xe8f4, 0xaa58,
+          0x903c, 0x7f46, 0x254d, 0xd358, 0x5217, 0x241c, 0xc043, 0x44ac},
+         {0x68ec, 0xab01, 0x8e64, 0x7a7c, 0xc543, 0x15ed, 0x4a55, 0xcb5a,
+          0x0eda, 0x47cd, 0x19d3, 0x0955, 0x93b0, 0x343e, 0xac8c, 0x67d4},
+         {0x5777, 0x4f7a, 0x6bbb, 0x1c7d, 0x13e1, 0x9183, 0xfed4, 0x8b35,
+          0x4684, 0xc96b, 0xa1c6, 0x4adc, 0x71bd, 0x12ad, 0x1c83, 0x556d}},
+        {{0xe821, 0xb11b, 0x6756, 0x81f0, 0xf3dd, 0x10a3, 0xf823, 0x0faf,
+          0x465d, 0x6a99, 0xd055, 0xf8b2, 0x7f05, 0xcc8c, 0xbe38, 0x097a},
+         {0x3982, 0x0c8d, 0x40e3, 0x17ef, 0xfa34, 0x15a3, 0x073e, 0x31f7,
+          0x646e, 0x0773, 0xf3cb, 0x4f21, 0x4eff, 0x1d82, 0x6c6d, 0x746c},
+         {0x2da4, 0x7ea5, 0xc987, 0x0c49, 0x1d43, 0x9bdc, 0x6955, 0x4c43,
+          0xebd2, 0xf7cc, 0x3809, 0x022c, 0x84bd, 0x4bee, 0x14a3, 0x577e}},
+        {{0xd72b, 0xbd4d, 0xcebe, 0x94fe, 0x2211, 0x060f, 0x4fda, 0xf46a,
+          0xd1ff, 0xc0c8, 0x5977, 0x124a, 0x9295, 0xfb00, 0x04b8, 0x7053},
+         {0x3b0a, 0x61a7, 0x68ac, 0xf0e2, 0xa5f5, 0x3791, 0xfa10, 0xf2fa,
+          0x00e9, 0x6b6d, 0x3e82, 0xc1e1, 0x8f42, 0x6fd7, 0x7ee9, 0x60fa},
+         {0x6ec6, 0x4d29, 0x1d35, 0xb63d, 0x31d8, 0x5fad, 0x053e, 0xf3c3,
+          0x42ec, 0xb4bd, 0x958c, 0x670b, 0x53fd, 0xa163, 0x8e0c, 0x2139}}
+    },
+    {
+        {{0x5601, 0xb4b7, 0xaaf9, 0x2798, 0xad72, 0x5c8d, 0x7213, 0x5eac,
+          0xa023, 0x61b7, 0xaa61, 0xd2ce, 0x7d4e, 0xe98f, 0xb284, 0x1bbf},
+         {0x33f3, 0x382b, 0x058a, 0x89f5, 0xc0b4, 0xad48, 0xba0b, 0x5ae2,
+          0xb36e, 0xa53d, 0xb503, 0x8f93, 0x32e6, 0x95a2, 0xed9d, 0x5aa3},
+         {0x6561, 0xc7d9, 0x77e9, 0x6567, 0x8036, 0x72c7, 0x1254, 0xcb2b,
+          0x6eee, 0xd950, 0x3299, 0x6505, 0x57cc, 0x5e89, 0xe14e, 0x4a07}},
+        {{0xa49b, 0xc477, 0x58cd, 0x240b, 0xf017, 0x6447, 0xdade, 0xfd38,
+          0x6aad, 0xa7c8, 0x8d32, 0x1992, 0xa081, 0x84af, 0x7aed, 0x50af},
+         {0xf999, 0x980d, 0x12cb, 0x4ee4, 0xc771, 0x3c6e, 0xd76f, 0xa315,
+          0x77fd, 0x925c, 0xedde, 0xbba5, 0x3402, 0x1d31, 0xac39, 0x3f0b},
+         {0x5be5, 0x15f6, 0xde01, 0x6e4f, 0x09b2, 0x2161, 0x2621, 0x2998,
+          0xd6d9, 0x0bad, 0x0581, 0x7802, 0xd006, 0xbaeb, 0xa316, 0x1921}},
+        {{0xc18b, 0xd9f3, 0xad9a, 0xd75a, 0xc19c, 0x60b1, 0x0eef, 0x566a,
+          0x0ed9, 0x255c, 0x0bac, 0x3e9a, 0xc7f5, 0xa062, 0x9dec, 0x7b04},
+         {0x70fc, 0xdfb8, 0x2f7e, 0x8942, 0xb3bd, 0x4f76, 0x6beb, 0x2c29,
+          0x4df7, 0x36c2, 0xf1d4, 0x0738, 0xaeb0, 0xe273, 0xdf41, 0x6458},
+         {0x4483, 0x3544, 0xe37a, 0xdccb, 0xbe93, 0x0fed, 0x7933, 0x7588,
+          0xdd87, 0x12c5, 0x04c3, 0x7860, 0x0e64, 0xc295, 0xdccb, 0x6093}},
+        {{0x034b, 0x6084, 0xeebe, 0x6bde, 0xb854, 0x780f, 0xc2b6, 0x3199,
+          0x0695, 0xb62d, 0x76ab, 0x9733, 0x7d90, 0x8b64, 0x80c9, 0x6e31},
+         {0x706d, 0x85e0, 0x9a85, 0x1ff3, 0x3933, 0xb3e7, 0xa5d8, 0x36d0,
+          0x453b, 0x718f, 0xf2e1, 0x43b9, 0xa97c, 0x4827, 0xea08, 0x57d1},
+         {0xb071, 0xa128, 0xb6e7, 0xee7a, 0x8baa, 0x93a8, 0x596d, 0xa4c1,
+          0x6130, 0xb221, 0xde82, 0xf7b4, 0xbd18, 0xdd97, 0x999d, 0x363e}},
+        {{0xaec6, 0xe24b, 0x48dc, 0x2f18, 0xaf60, 0xbabc, 0x7255, 0x769b,
+          0xe931, 0x3cef, 0x3c6e, 0x90cb, 0xb355, 0xc6f9, 0x979b, 0x231f},
+         {0x1fc4, 0x35ee, 0x43c1, 0x96a8, 0xc8cf, 0x08e4, 0xb355, 0x976e,
+          0xd330, 0xb58c, 0x6801, 0xb42f, 0x052b, 0x693a, 0x9b78, 0x48ee},
+         {0xf3c6, 0xcc2a, 0xde4b, 0x5c31, 0x8d1f, 0xfe20, 0xb030, 0xb04b,
+          0xb466, 0xc14f, 0x7009, 0xb78d, 0x2413, 0x0879, 0xfa9b, 0x079b}},
+        {{0x4245, 0xa2d5, 0xed80, 0xf3c9, 0x3952, 0x77f6, 0x8b78, 0x0aa0,
+          0x5475, 0xd108, 0xac63, 0xd76d, 0x636b, 0x9470, 0xfb15, 0x1ef4},
+         {0x0df4, 0xda30, 0x3a51, 0xe390, 0x5ab0, 0x3da9, 0x6423, 0x8439,
+          0x6480, 0x0b35, 0xf12d, 0xed3c, 0x7194, 0x8481, 0x77f6, 0x038c},
+         {0x7bec, 0x5b16, 0x5ee6, 0x854e, 0xcdc2, 0x96d0, 0x0a42, 0x5959,
+          0x2199, 0x9810, 0xdf34, 0x72b2, 0xff56, 0x4a0b, 0xe92a, 0x575e}},
+        {{0xd801, 0x0aa4, 0xbc45, 0x5d46, 0xb9d8, 0xa533, 0x1227, 0xc3af,
+          0x06c2, 0x2b89, 0x3b26, 0x389e, 0x581b, 0x382f, 0x1e7e, 0x200a},
+         {0x2fcf, 0x8a18, 0x8090, 0xd4c0, 0x9dbd, 0x9948, 0x70c2, 0x30e1,
+          0x33de, 0x52f7, 0xbd57, 0x05ba, 0xfd00, 0x2cd3, 0xe711, 0x43d4},
+         {0x3ac5, 0xeaf9, 0xb967, 0x518d, 0x52c0, 0x0566, 0x989b, 0x71bc,
+          0x97f5, 0x5671, 0x85d9, 0xfe2b, 0x4e38, 0x651e, 0xca52, 0x050e}},
+        {{0x68ea, 0x60e6, 0x3976, 0x97ac, 0xb497, 0x153a, 0xbbfe, 0x9b19,
+          0xa79f, 0x34ec, 0x79b5, 0x4cb1, 0xae57, 0xa131, 0xc09f, 0x6151},
+         {0x0c9c, 0x453f, 0x1ade, 0xc343, 0x3b9b, 0xff70, 0x045e, 0xe9f5,
+          0x7b3d, 0xed84, 0x7ac9, 0xfcd9, 0xf4c6, 0x1c58, 0xe6c2, 0x4b0e},
+         {0x5d96, 0xfdf0, 0x5c0d, 0x3af5, 0xee7a, 0x2ab4, 0x2ee0, 0xdd26,
+          0x1709, 0x1217, 0xbb87, 0x11b2, 0x030b, 0x800f, 0x24fa, 0x1fef}}
+    },
+    {
+        {{0x6b86, 0x3097, 0xaff5, 0x22d2, 0x4604, 0xc2d2, 0xb806, 0x8d90,
+          0xbae5, 0x4de5, 0x896c, 0xdca1, 0x0c17, 0xc834, 0x5fe6, 0x2800},
+         {0x3196, 0x1aa7, 0x53fb, 0x37d6, 0x6418, 0x3fd7, 0x9530, 0x0f94,
+          0x17b2, 0xfb3a, 0x0b09, 0xad20, 0x613e, 0x2fc8, 0x4929, 0x544d},
+         {0x8688, 0x3452, 0xba9f, 0x6aef, 0x7da1, 0x2510, 0xff94, 0x5c1b,
+          0x4b36, 0x66d9, 0xbbcd, 0xf75b, 0x6dfa, 0x0f31, 0x7293, 0x72e4}},
+        {{0x7627, 0xd32a, 0xf635, 0x07f3, 0x66f0, 0x5f65, 0x4d86, 0x7aaa,
+          0x4450, 0x28d0, 0xe797, 0x3c85, 0x6438, 0x0fe0, 0x7f00, 0x1fee},
+         {0x084f, 0x9781, 0x208c, 0x2695, 0x0ee1, 0x2345, 0x2a0b, 0xb150,
+          0xde02, 0x03ef, 0xaea6, 0xfd9d, 0xa34c, 0x2733, 0x2e8c, 0x5a9d},
+         {0xf7e5, 0x03db, 0x05da, 0x7653, 0xcdbd, 0x1434, 0xf249, 0xa4da,
+          0x88ec, 0xd24a, 0xd5cd, 0x7b4a, 0x0543, 0xee04, 0x4051, 0x00f9}},
+        {{0x9753, 0x07af, 0x93bb, 0xd7ef, 0x66a7, 0x3db7, 0xd0cf, 0x583e,
+          0x1ec5, 0x6e0b, 0x98bf, 0xce69, 0x0452, 0x5dd4, 0xffd2, 0x47b7},
+         {0x30b2, 0xc3d3, 0x6b23, 0x8d35, 0x1b06, 0xb047, 0x8b9b, 0xf21c,
+          0xb83c, 0x6e42, 0x316c, 0xb36c, 0xb10d, 0x8bea, 0x9c7e, 0x07d7},
+         {0xdd12, 0xbc08, 0xfb9c, 0x87fb, 0xc29b, 0xe1ee, 0x6b3a, 0x8a06,
+          0xc1bf, 0xdb1f, 0x242b, 0x0d57, 0x4bb6, 0x5ea6, 0x20a3, 0x1c35}},
+        {{0xc059, 0x216b, 0x6f40, 0xcda8, 0xd87e, 0x12bc, 0x231d, 0x1fbb,
+          0x0990, 0x17c7, 0x6a9e, 0xb495, 0x2e55, 0x66d1, 0x0c3b, 0x3875},
+         {0xa34a, 0xbccb, 0x53a6, 0x80d2, 0x219b, 0x3838, 0xc3a1, 0x3e61,
+          0xe396, 0x9882, 0xb601, 0x90c3, 0xe66f, 0x5d0e, 0x0577, 0x1c3d},
+         {0xe51a, 0x9422, 0xf140, 0x692e, 0xf671, 0x2b5d, 0xc73c, 0xcbc0,
+          0xe029, 0x744c, 0x4fe7, 0x2101, 0x487c, 0xd330, 0xe2c7, 0x0621}},
+        {{0xf0f3, 0xb0db, 0x1796, 0xb7ae, 0xe196, 0xe17c, 0xafb9, 0x54df,
+          0xa3b4, 0xe9aa, 0x3071, 0x2592, 0x2e9d, 0xa100, 0x589c, 0x5d8e},
+         {0x838d, 0x8259, 0x60cc, 0xaf98, 0x9adc, 0xc69f, 0x48c1, 0x90ea,
+          0x1e30, 0x6558, 0x4837, 0x6526, 0xa5bc, 0x7bd3, 0xd609, 0x0007},
+         {0xa94b, 0x0842, 0x1d95, 0xc0bf, 0x2e3e, 0x588f, 0xc363, 0xb2d3,
+          0xe2ef, 0xbb51, 0x1438, 0x0a96, 0xbf86, 0x3c1c, 0xd778, 0x1583}},
+        {{0x28c7, 0xcc9d, 0x4704, 0x9003, 0xc58f, 0xf72c, 0x679e, 0x1d1b,
+          0x8726, 0xbe5b, 0x2b5f, 0x16e1, 0x580a, 0x83c5, 0x064e, 0x4958},
+         {0x7ae1, 0x5da2, 0xa2ef, 0xecee, 0x0174, 0x5567, 0x3a14, 0x597c,
+          0x167a, 0x6609, 0x2a12, 0xc9a6, 0x8f70, 0x81ed, 0x5f2e, 0x252a},
+         {0xe80d, 0x5066, 0x9426, 0x0d28, 0x8c6b, 0x307c, 0xf785, 0xfcc3,
+          0x12fd, 0x0c11, 0xda78, 0x1b53, 0xb388, 0xd843, 0x170b, 0x079c}},
+        {{0xd056, 0xc0d5, 0xcd50, 0xcdd6, 0x573b, 0xbb03, 0x686d, 0x9af7,
+          0xef48, 0xf3c3, 0x723f, 0x3ca6, 0x8acc, 0x317b, 0xc0d7, 0x6768},
+         {0x6fff, 0x64fa, 0xece4, 0x0506, 0xe523, 0x6205, 0x431e, 0xbee3,
+          0xea42, 0x51b8, 0x4224, 0x3579, 0xfb00, 0x4ac9, 0x05e3, 0x6dec},
+         {0xc1b3, 0xf155, 0x25e5, 0x94b6, 0x7b91, 0x997b, 0xf3a7, 0x417b,
+          0x2600, 0x6d6b, 0xbddc, 0xc22c, 0x52f4, 0xddcd, 0x5e14, 0x5144}},
+        {{0xa455, 0x2bbe, 0x47ab, 0x8931, 0x9129, 0x9207, 0xa24f, 0x8c53,
+          0xf7a7, 0xbe30, 0xf948, 0x4b49, 0xd43d, 0x6e4f, 0x9008, 0x12e9},
+         {0x4951, 0x3b14, 0x2b4b, 0x5750, 0xbcb3, 0x444b, 0xff6b, 0x8e67,
+          0x85db, 0x1663, 0x6927, 0xb8bd, 0x95c8, 0xe392, 0x6f31, 0x1318},
+         {0xbb2e, 0x7fdf, 0x96b3, 0xf10c, 0xeaf9, 0x121c, 0x935e, 0x9f9a,
+          0x983f, 0x3a5b, 0x36c4, 0xdf11, 0x99af, 0x5d3e, 0xe3f0, 0x77b2}}
+    },
+    {
+        {{0xb0a4, 0x12dd, 0x639c, 0xd598, 0x866b, 0xc024, 0x9f30, 0xa5d1,
+          0xe460, 0x58fc, 0x2f03, 0xd17c, 0x5e8a, 0x2e09, 0x9515, 0x07a1},
+         {0xc4de, 0x9c2e, 0xa9c5, 0x296f, 0xf3cb, 0x4f84, 0x61bf, 0xbc8b,
+          0xf908, 0x17a8, 0x06d9, 0x1c77, 0x255d, 0x7ad3, 0x95fc, 0x63b7},
+         {0x5fc8, 0x389e, 0x8f02, 0xa836, 0xe43b, 0xcf8d, 0x3b02, 0x9043,
+          0x2643, 0xc541, 0xfd5d, 0xafa1, 0x0137, 0x032f, 0xe83d, 0x3e8f}},
+        {{0xd13c, 0xe8ef, 0x4c8d, 0x0870, 0x3731, 0x33e0, 0x1a8e, 0xdfc5,
+          0xcde3, 0x1260, 0x5da5, 0xa59d, 0x8c86, 0xa625, 0x0899, 0x22d6},
+         {0xa294, 0x0570, 0x15b9, 0x2f8b, 0x4549, 0x6708, 0x4270, 0x94f2,
+          0xfd84, 0x61bb, 0x5ae1, 0xde1c, 0x4007, 0x7fac, 0x3b79, 0x75ba},
+         {0xd196, 0x70cd, 0xdbc0, 0x6239, 0x8a9a, 0x6c7d, 0x8a8b, 0x60fe,
+          0x1260, 0xeb40, 0x47bc, 0xb388, 0x9e5e, 0x8777, 0xd07b, 0x0904}},
+        {{0x40b9, 0x48f9, 0x2d66, 0xf432, 0x0c39, 0xbd2d, 0x2f0c, 0x0695,
+          0xf931, 0xa081, 0x97ad, 0x1676, 0x2a6c, 0xbaf7, 0xaace, 0x6240},
+         {0x919c, 0xddba, 0x1fd4, 0xb4ce, 0x8daa, 0xc74c, 0xdb3e, 0xcf31,
+          0xcc51, 0xad86, 0xcc63, 0x2c63, 0xde07, 0xbc1d, 0x143f, 0x43e2},
+         {0x95a0, 0x5ba2, 0x749c, 0xf834, 0xd25a, 0xca37, 0x7c5b, 0xd694,
+          0x316a, 0xe7c9, 0x3ba7, 0x66f1, 0x0cac, 0x8db4, 0xaf23, 0x56bd}},
+        {{0x3bb2, 0xc19d, 0xd36c, 0x1310, 0x86b9, 0x6223, 0x6bb7, 0x062a,
+          0x4f5c, 0xd7a1, 0x8591, 0x7c9b, 0x5754, 0x7e1e, 0x3150, 0x03aa},
+         {0x33eb, 0xf535, 0xb9e3, 0x362a, 0x3d40, 0x6eb9, 0x68d5, 0x3385,
+          0x5572, 0x1d5a, 0x1452, 0x9e0e, 0x1318, 0x8374, 0xa86d, 0x1d24},
+         {0xce1f, 0xffd4, 0x7648, 0xf4ec, 0x8c1c, 0x54ac, 0xeaf0, 0xe045,
+          0x357c, 0x1d09, 0x2582, 0x88d2, 0x4859, 0x9aeb, 0x61dc, 0x43b2}},
+        {{0x1364, 0x6c95, 0x3d8b, 0x1951, 0xf47b, 0x000b, 0x7126, 0x94fe,
+          0x9567, 0xd54f, 0x10dd, 0x028d, 0x0964, 0x4294, 0xd5e2, 0x02b4},
+         {0x79bb, 0x88bb, 0x1e19, 0xe55b, 0x359d, 0xc17a, 0xd07d, 0xa09e,
+          0xea33, 0x603d, 0x2ee2, 0xb02c, 0x6bc2, 0x5b27, 0x55cf, 0x3260},
+         {0x8df2, 0x28d1, 0x55cb, 0xb4a1, 0xe508, 0x186c, 0x4646, 0xeacc,
+          0x4389, 0x6c82, 0xf493, 0xc49c, 0x3410, 0xae5d, 0xc809, 0x27a6}},
+        {{0x6954, 0xc43d, 0x270a, 0xcd2c, 0xcab2, 0x6a66, 0x3e57, 0xdd4a,
+          0x036c, 0x69d7, 0x5924, 0x79fa, 0x2599, 0x3d8c, 0x0360, 0x2215},
+         {0xb188, 0x1f0d, 0xebcd, 0x8ba6, 0x5be8, 0x675a, 0xd73a, 0x37d3,
+          0x585a, 0x15f5, 0xdfa3, 0xf22e, 0xa17e, 0xff60, 0x7174, 0x2cb6},
+         {0xe1d0, 0x390b, 0xcdf9, 0x59ee, 0xe3f1, 0x728c, 0x2044, 0xa942,
+          0xf0f4, 0x7a94, 0x1c66, 0x8289, 0xf436, 0x3890, 0xf4b7, 0x7b1d}},
+        {{0xf58c, 0x07f8, 0x2218, 0x5f2e, 0x09d4, 0xd494, 0x5c9f, 0xe355,
+          0xa630, 0x1fb6, 0xa88d, 0xb2aa, 0xe03d, 0xd352, 0x8245, 0x6869},
+         {0xa224, 0xb3b2, 0xf2e0, 0xe492, 0x1160, 0x2b55, 0x9e06, 0x7c6c,
+          0x7b0e, 0x0d7f, 0x8fe2, 0x15eb, 0x5992, 0x58fc, 0xef26, 0x61fc},
+         {0x187a, 0x2a18, 0x5d85, 0xdbb1, 0xacd7, 0x86dd, 0xaad3, 0xf3e4,
+          0xc482, 0x0ff6, 0xe281, 0x44ba, 0x01cf, 0x3daf, 0x4c47, 0x46cf}},
+        {{0x8140, 0xf149, 0x6ea7, 0x213c, 0x4854, 0x392b, 0x7ef8, 0x7c1e,
+          0xceba, 0x5629, 0xc38c, 0x2488, 0xc5bb, 0x0d8c, 0xaae5, 0x1065},
+         {0xe5f9, 0x9ec4, 0x25ed, 0x4265, 0x3303, 0x1690, 0xda01, 0x0e5e,
+          0xcadc, 0xcbe5, 0xa7f2, 0x72b1, 0x5f40, 0x14eb, 0x7bcd, 0x2938},
+         {0x0d57, 0xdf20, 0x4525, 0x1c2c, 0x674a, 0xbfca, 0x2dd6, 0x5c3b,
+          0x4030, 0xe183, 0xe7b1, 0x0a07, 0xe716, 0x4f1c, 0x98e6, 0x69a1}}
+    },
+    {
+        {{0xcaed, 0xdcc5, 0x4434, 0xe101, 0xfb33, 0x3c84, 0x5d96, 0x47ed,
+          0xa0e7, 0xed86, 0x9576, 0x7001, 0xf9e4, 0xd267, 0x697b, 0x25b2},
+         {0x78bc, 0xd91a, 0xb2e0, 0x9062, 0x9667, 0xc850, 0x889c, 0x47c9,
+          0x70b8, 0x4050, 0x4a66, 0x9df5, 0xa1bf, 0x2493, 0xe6a9, 0x7369},
+         {0x6864, 0x1398, 0x3ffb, 0x9d67, 0xc7b8, 0x415d, 0xfbd9, 0x3ca5,
+          0x3b5e, 0xdf27, 0xcc3b, 0xe04e, 0x4cd2, 0xb54e, 0x683d, 0x1420}},
+        {{0x5ad0, 0xc1cc, 0xbb6f, 0x34ee, 0xac8b, 0x9646, 0x0ce9, 0x6a1b,
+          0xde53, 0xa66b, 0xda49, 0xd3b0, 0x81c1, 0x61d0, 0x3b41, 0x31e8},
+         {0xd197, 0x249d, 0xbd1e, 0xb478, 0xc102, 0x5e58, 0x3500, 0x620c,
+          0xac5c, 0xccba, 0xd32f, 0xfb02, 0xa72d, 0xf508, 0x3beb, 0x60b6},
+         {0x2b4f, 0x9e06, 0xc712, 0x97e8, 0x0ad8, 0x2932, 0x8f4f, 0x49e4,
+          0x683f, 0x6f18, 0xe14b, 0x5bec, 0x0317, 0x2d55, 0x1eb6, 0x55cf}},
+        {{0x8c52, 0x7df5, 0xb5e3, 0x3076, 0xcc36, 0xe799, 0xb9dd, 0xd73a,
+          0xee20, 0x4913, 0x1ce3, 0xbd83, 0x0133, 0x62ba, 0xfbaa, 0x1a56},
+         {0x3d58, 0x65c2, 0x1010, 0x5879, 0x819c, 0x5094, 0x086d, 0x8b9d,
+          0x5fa7, 0x12c5, 0x2fa9, 0xe240, 0x91d4, 0x5708, 0x6564, 0x669a},
+         {0xc9ec, 0x5c9d, 0x6b50, 0x943e, 0x371a, 0xa77c, 0x57bb, 0x3025,
+          0x7651, 0x4134, 0xae56, 0x9873, 0x8a5c, 0x99c5, 0x8367, 0x13c4}},
+        {{0xd080, 0x5d8b, 0xfb6a, 0xc4dc, 0x4842, 0x571a, 0xc4ec, 0xdeeb,
+          0x5365, 0xb8e5, 0xe883, 0xd4b2, 0xb827, 0xc8e5, 0xc87d, 0x50bd},
+         {0xe1b9, 0x5ab3, 0x5d46, 0x423a, 0x3f61, 0xc7f1, 0xc187, 0xfc13,
+          0xb9b6, 0xecb5, 0x3664, 0x19f8, 0xb607, 0xa637, 0x0c93, 0x66f8},
+         {0xe111, 0x6edf, 0x3783, 0x606d, 0xabd9, 0xf011, 0x3e15, 0x3235,
+          0x3b96, 0x25b7, 0x3ac3, 0x64b0, 0xd5ae, 0x725f, 0x6444, 0x1dd5}},
+        {{0xc89a, 0x08ba, 0xe600, 0xc297, 0xc3e0, 0xeae1, 0xea11, 0x7d4c,
+          0x977c, 0x9fe7, 0x8be1, 0xf3e3, 0x05cd, 0x63a3, 0x450f, 0x3a3a},
+         {0x127d, 0x3362, 0x7ff8, 0x8fa4, 0x7c15, 0x71cd, 0x6ac4, 0xbc9f,
+          0x0c8b, 0x4922, 0x4543, 0x6e71, 0x732e, 0x219f, 0x5912, 0x0e64},
+         {0x4627, 0xd839, 0x2f31, 0x078f, 0xa510, 0xde94, 0x3183, 0x389d,
+          0x6f80, 0x1799, 0x6c6d, 0xd1e3, 0xa87b, 0x93a9, 0x8d93, 0x318c}},
+        {{0xd398, 0xab1d, 0x9e29, 0x5d66, 0x9e3b, 0x342d, 0x1658, 0xfc92,
+          0x73cd, 0xf359, 0x1dfd, 0x5585, 0x0af6, 0x2595, 0x41c3, 0x509a},
+         {0xfe19, 0x2aff, 0x5d03, 0xf274, 0xdb66, 0x7f24, 0x3c49, 0x0c9f,
+          0x98ef, 0xba85, 0xd3e3, 0xbc98, 0x5314, 0x9a1d, 0x7c67, 0x224c},
+         {0x25e9, 0xa6f9, 0x6edc, 0xbdc0, 0x1f33, 0x641b, 0xf3f4, 0x793e,
+          0x3e89, 0x9d83, 0x1280, 0x82ec, 0x1389, 0x28a1, 0xf023, 0x05bf}},
+        {{0x12e4, 0x0dc5, 0xa0dd, 0x6881, 0xfafe, 0x44a5, 0x0dc8, 0x4fe7,
+          0x5240, 0x8f4a, 0x8e6b, 0x1f74, 0xa3ea, 0xee01, 0x77cd, 0x5762},
+         {0xe00b, 0x23ca, 0x1370, 0x3632, 0xcf59, 0xd1ac, 0xcf0a, 0x544a,
+          0x1c88, 0xd21a, 0x1049, 0x9674, 0x44a7, 0xfa2a, 0x8cc3, 0x780b},
+         {0x305f, 0x234f, 0x8abc, 0x1ef3, 0xde08, 0x1405, 0x7fbd, 0x9a57,
+          0x2a0d, 0x34e6, 0xa514, 0x5e82, 0xb7a1, 0x6271, 0x1872, 0x5ff4}},
+        {{0x9540, 0x13b6, 0x47e8, 0xe5db, 0x10e1, 0x4326, 0x2a3b, 0xf35d,
+          0x1276, 0x3878, 0x26e9, 0xac1f, 0xcb69, 0xa0a0, 0xdb8c, 0x29d4},
+         {0xdb9d, 0x1789, 0x080c, 0x398e, 0x78f5, 0xf3e7, 0x2025, 0xa760,
+          0x035d, 0x06bd, 0x894c, 0xfa98, 0x66be, 0x25a9, 0x03dc, 0x106a},
+         {0x53d0, 0x3333, 0x0aaf, 0xd9ad, 0x09e5, 0xacd3, 0x9da5, 0x3866,
+          0xf7f0, 0xc888, 0x658a, 0x3c57, 0xbefa, 0x052c, 0x8a51, 0x4ab3}}
+    },
+    {
+        {{0xc09c, 0x5fdd, 0xd1ef, 0xd6cf, 0x5dce, 0xf757, 0x3efd, 0xe82b,
+          0x34c2, 0x2016, 0x6b5d, 0x25d5, 0x2b9b, 0x04ed, 0xc6bb, 0x3041},
+         {0xd593, 0x6768, 0x2b25, 0xda7c, 0xca13, 0x4422, 0xc057, 0x98c1,
+          0xce1d, 0xca0a, 0x0bd5, 0xf1a8, 0xa690, 0xc088, 0xd1ad, 0x29cd},
+         {0xe148, 0xd956, 0xf2f9, 0x0ff2, 0x6b2e, 0x9f35, 0x9775, 0xade7,
+          0x025c, 0x5f6c, 0x98bb, 0x1a46, 0x9a7b, 0x1404, 0xbd68, 0x104b}},
+        {{0xf163, 0xd67f, 0x9a5f, 0xa95d, 0x5681, 0x4cc7, 0xe69d, 0xe92b,
+          0xf257, 0xde20, 0x024c, 0xb7f8, 0x2df5, 0xfb07, 0x2a20, 0x204f},
+         {0xed67, 0x68f1, 0xfd31, 0x51f0, 0x3bc2, 0xd86f, 0x1dcd, 0x2c81,
+          0xf2de, 0x04d2, 0x5c43, 0x44dc, 0x7149, 0x092a, 0xcc57, 0x5be8},
+         {0xb079, 0x30eb, 0x3b3d, 0xc814, 0x2e30, 0xbd65, 0x155a, 0x7589,
+          0x5c31, 0x8f6d, 0x3c31, 0x653c, 0x161f, 0xc279, 0xfb17, 0x2570}},
+        {{0x245a, 0x0bb8, 0xa955, 0x192e, 0x50d1, 0x8f90, 0xfba8, 0xc8e6,
+          0xc935, 0x88a4, 0xea2d, 0x7986, 0x8668, 0xde01, 0x5f91, 0x241c},
+         {0x1575, 0x2cb6, 0x367f, 0x3efa, 0x026c, 0x1cd6, 0x6f76, 0xf5f9,
+          0x2562, 0x65b5, 0x142a, 0xe8c7, 0x0acd, 0x5303, 0x65ea, 0x3dcb},
+         {0x6caa, 0x40de, 0x1729, 0x28d8, 0x733a, 0x22d9, 0x2cf0, 0x8fbf,
+          0x01d1, 0x235b, 0xfcdd, 0x16d7, 0xf0e5, 0x5fcd, 0x0edd, 0x0842}},
+        {{0x10ce, 0x04f4, 0xc34e, 0x0358, 0x0685, 0x276e, 0x5b5a, 0xb613,
+          0x1521, 0xebb9, 0x70c7, 0x5d96, 0x889c, 0x21db, 0x54f3, 0x04d6},
+         {0xfa4a, 0x8362, 0x20ab, 0xcdff, 0x3e6e, 0xe21a, 0x18d4, 0x57e1,
+          0xe62b, 0xfc39, 0x9617, 0xe317, 0x69fd, 0xbc17, 0x53ef, 0x0d9a},
+         {0xb5d5, 0xddbd, 0xc116, 0x5e7d, 0xdd2d, 0x8da5, 0xdeb6, 0x2954,
+          0xa292, 0x3334, 0x0817, 0x1cb6, 0x1ad7, 0x1899, 0x4f26, 0x4a7a}},
+        {{0x2a4b, 0xaf37, 0xb291, 0x24c3, 0x47f2, 0x7181, 0x8270, 0x93da,
+          0x9ef2, 0x8689, 0x8564, 0xdd84, 0xee33, 0x23e0, 0x3142, 0x4a96},
+         {0x5f95, 0x5fb1, 0x1802, 0xf4a7, 0x1b8f, 0x6b5c, 0x5f34, 0x3df6,
+          0x1112, 0x00e0, 0xf085, 0xcdfc, 0x1848, 0xddd3, 0x0c4c, 0x11b5},
+         {0xffd6, 0x08a4, 0x2744, 0xa6e8, 0x76d9, 0x9c15, 0x177e, 0x738e,
+          0xb3f2, 0x3d02, 0x48b6, 0x7733, 0xcc51, 0xce6b, 0xce4d, 0x4f4b}},
+        {{0x0b6f, 0xc49d, 0x616e, 0x30e2, 0x2317, 0xcaec, 0x718f, 0xe456,
+          0x4fa6, 0xf26b, 0x409b, 0x48eb, 0x5f37, 0x6159, 0xcee5, 0x3042},
+         {0x2584, 0xe224, 0xce5a, 0xa71f, 0x8a9e, 0x92f5, 0x7256, 0x26ea,
+          0x3cf4, 0x1cea, 0x09d7, 0xd21a, 0x01e6, 0xb71c, 0xdd14, 0x73fc},
+         {0xac41, 0x449b, 0x7079, 0x427e, 0x310a, 0xbce2, 0xe36d, 0x855a,
+          0x1a7c, 0x5f84, 0x7621, 0x4cae, 0xe1d6, 0x9a9c, 0x740c, 0x389e}},
+        {{0xac28, 0x570e, 0x78f6, 0xc9bd, 0x9ce1, 0x2791, 0x0b32, 0xe55b,
+          0x91ed, 0xa19b, 0x3eab, 0x65fc, 0x3690, 0xd626, 0x25e5, 0x25c4},
+         {0xb9ce, 0x34dc, 0xb3ae, 0x64fc, 0xd0ad, 0xe348, 0x0323, 0x9750,
+          0x381b, 0x62c6, 0xf07d, 0x45b3, 0x6788, 0x465a, 0x5379, 0x6154},
+         {0xde6e, 0xf1d7, 0x06a6, 0x3f3e, 0x2308, 0x8e06, 0x7627, 0x3ef9,
+          0x6c77, 0x4e8a, 0xf626, 0x8c14, 0x4759, 0x1548, 0xa089, 0x6539}},
+        {{0x4a19, 0x14bb, 0xdbd4, 0xddc4, 0x4f8e, 0x9842, 0xbc3c, 0x19b2,
+          0x7169, 0x36ca, 0x9fd7, 0x48a8, 0xbd90, 0xf019, 0x320e, 0x0f65},
+         {0xf773, 0xc3d2, 0x1f74, 0xe9d2, 0x6845, 0x25c4, 0x5441, 0xc150,
+          0x9e33, 0xf9b9, 0x5ce8, 0x624e, 0x186c, 0xc5cd, 0xe4aa, 0x11c5},
+         {0xe0c6, 0xcafd, 0xd1b1, 0xd486, 0x5181, 0x163b, 0xe6e3, 0x4f3f,
+          0x939a, 0xfaf2, 0xaf0d, 0x59a8, 0x072a, 0xec33, 0xc7bd, 0x4cab}}
+    },
+    {
+        {{0xd289, 0x3f78, 0x788f, 0xc08f, 0x4d9f, 0xa140, 0xa72c, 0xfe30,
+          0xcc9d, 0xcf65, 0x8bfc, 0xf277, 0x2021, 0x5acb, 0x9816, 0x7ee4},
+         {0x0a2e, 0x089c, 0x9624, 0x239e, 0x4738, 0x3afe, 0xc4c0, 0xc748,
+          0xa12a, 0x764f, 0xed2a, 0x17db, 0x8582, 0x321c, 0x93f0, 0x639b},
+         {0xa1c3, 0x9111, 0x08e3, 0x7bd5, 0x7489, 0x8090, 0x90d4, 0x2b2b,
+          0xfd19, 0xae72, 0xaec2, 0xe7d2, 0x02a6, 0x85b6, 0x493c, 0x0edf}},
+        {{0x4113, 0x8476, 0xc4d2, 0x6767, 0xf835, 0xf7f5, 0x403f, 0xa090,
+          0xbede, 0xcae6, 0xcffa, 0x1c8f, 0xa369, 0xd1df, 0x0c54, 0x04c0},
+         {0x5a68, 0x599b, 0x8158, 0xaecc, 0xe20e, 0xebad, 0x4f0f, 0xea57,
+          0x7f07, 0x22b6, 0x1d74, 0x4fe4, 0x4fb4, 0x019d, 0x92e3, 0x403b},
+         {0x5cf8, 0x8b46, 0x2f81, 0x4dc2, 0xeff8, 0x1480, 0xf35a, 0x71a0,
+          0xd657, 0x04c7, 0xbfad, 0xaee8, 0x76f4, 0xb261, 0xb12a, 0x355b}},
+        {{0x7318, 0x5a8c, 0xdac7, 0xa301, 0xaa11, 0xb3ce, 0x039d, 0xed90,
+          0x3f2d, 0x3bae, 0x7cbf, 0x6f07, 0xad8e, 0xe052, 0xeaf8, 0x7518},
+         {0xbbf4, 0x7493, 0x64cc, 0xa71e, 0xb0c3, 0xeca3, 0x84d9, 0xe5bd,
+          0xe785, 0xfa05, 0xc50c, 0x0a6b, 0xc312, 0x182e, 0x8132, 0x0f9b},
+         {0x6c32, 0x1b7f, 0x59c4, 0xa488, 0x3298, 0xf438, 0x60bc, 0x0f2d,
+          0xd1d9, 0xc9b1, 0xa929, 0x1815, 0x55c4, 0xbb17, 0x871b, 0x47c3}},
+        {{0x66b0, 0xc850, 0x5d50, 0xfbe6, 0x99b0, 0xb3a2, 0xc4b0, 0x62ec,
+          0xe8e0, 0x441a, 0x54ea, 0xe537, 0x8d5f, 0xe8d4, 0xa02c, 0x08fe},
+         {0x4f48, 0x71ec, 0x5397, 0x5144, 0x5d6e, 0xc98c, 0xb17d, 0xf805,
+          0xc66b, 0x47c3, 0xc11a, 0xf762, 0x99dc, 0x7646, 0x9b85, 0x00b8},
+         {0xead0, 0x68de, 0xdd76, 0x824d, 0x5d23, 0x4b68, 0x4520, 0xc864,
+          0xd665, 0x5d89, 0xcfcd, 0xb514, 0xd537, 0x4f75, 0x29a7, 0x4738}},
+        {{0x02c9, 0xad39, 0x533a, 0x23d9, 0x588f, 0xef03, 0xddce, 0x64c2,
+          0x2fb4, 0xcfe1, 0x7390, 0x1525, 0xd390, 0x44e4, 0x8b4d, 0x6c66},
+         {0xc418, 0x4679, 0xda75, 0x82d2, 0x8df0, 0xb261, 0xd7d8, 0xe63b,
+          0xeb0a, 0xac47, 0xef24, 0x355e, 0xc6b4, 0x4833, 0x684c, 0x2078},
+         {0x820c, 0x7a78, 0xcf21, 0x3b48, 0x3e97, 0x8127, 0x0ab2, 0xf76a,
+          0xed7b, 0x8c8e, 0x65a7, 0xa96c, 0x433f, 0x4f8a, 0xa605, 0x7411}},
+        {{0x75b4, 0x18b1, 0xe53d, 0x579a, 0xa102, 0xf392, 0x3159, 0x6871,
+          0x35f5, 0x1eef, 0xecba, 0x8455, 0x398f, 0x458c, 0xa872, 0x1ec9},
+         {0xc86d, 0xb99d, 0x9d32, 0x4d65, 0xf115, 0x603a, 0xdc75, 0x044c,
+          0xe488, 0xdcc2, 0x712c, 0xb34c, 0x34ff, 0xfb81, 0x6574, 0x7c13},
+         {0x509b, 0x00a2, 0xa4d4, 0xb8e6, 0x82b4, 0x0bc8, 0xd702, 0x9b81,
+          0x7561, 0xf195, 0xcc9b, 0x57e7, 0x6460, 0xc7cd, 0x88a5, 0x3add}},
+        {{0x3046, 0x5939, 0x98d4, 0x85c2, 0x59ec, 0x5ff6, 0x3598, 0x8f7e,
+          0x6e3a, 0xf2f6, 0xa22a, 0x1d2c, 0xa720, 0xa406, 0x1131, 0x61ba},
+         {0xdcf2, 0xb635, 0x5770, 0xab89, 0x1fbc, 0xf66c, 0xef6c, 0x02df,
+          0xd187, 0xbeb6, 0x0268, 0x8553, 0x9e74, 0xcc87, 0x29fc, 0x2499},
+         {0x9029, 0x1695, 0xa0f1, 0xa3d0, 0xbd89, 0xba7e, 0x6b6c, 0x023b,
+          0x3307, 0x2678, 0x5a3e, 0x7bf1, 0xece7, 0xbbd8, 0x310c, 0x5620}},
+        {{0x85d6, 0x77e2, 0xb5f4, 0x6646, 0x6193, 0x6c8f, 0xff67, 0x40e8,
+          0x94dd, 0xabb5, 0x7311, 0xa6ec, 0xec4d, 0x658c, 0x46f3, 0x7ec8},
+         {0xd643, 0x4934, 0x9343, 0x5289, 0x22f5, 0xa512, 0xf806, 0xb9db,
+          0x1c22, 0xc3f4, 0x878f, 0x8f6d, 0x9730, 0x4d9d, 0x6a2a, 0x3767},
+         {0x2ec7, 0x1da2, 0x8f3f, 0x9b5e, 0xcd13, 0x6c01, 0x1d77, 0x130f,
+          0x9fb8, 0xa298, 0x8fcf, 0x214c, 0x9dd5, 0x399b, 0xf723, 0x6daa}}
+    },
+    {
+        {{0x8ea2, 0xacad, 0x04bf, 0x583b, 0xe884, 0x148b, 0x43e8, 0x29b7,
+          0xc5db, 0x0810, 0x583b, 0x2b1e, 0xbbaa, 0x8eb3, 0x49e5, 0x2b54},
+         {0xbe47, 0xeb3d, 0x7562, 0x5f3a, 0xa0b8, 0x8ebd, 0x3854, 0xf7ea,
+          0x7299, 0x4574, 0xe531, 0x00c3, 0xd551, 0x1627, 0xe9e7, 0x1304},
+         {0x9cfe, 0x6adc, 0x14d2, 0x7898, 0xdd0b, 0x8b48, 0xab3f, 0x3c1b,
+          0xc60a, 0xf979, 0xe1ff, 0xda0f, 0xd693, 0x7c2d, 0xde2d, 0x4468}},
+        {{0x07ce, 0xf863, 0xd8c6, 0x4b9a, 0x0c28, 0x435d, 0x3531, 0x2111,
+          0x772c, 0x657a, 0x66c5, 0xd4a8, 0x7352, 0x6324, 0x427e, 0x5da6},
+         {0x469e, 0x9419, 0x355e, 0x51bb, 0xc754, 0x23dd, 0xdc4c, 0x33e6,
+          0x9962, 0x447f, 0xb6d6, 0x93a5, 0xbd63, 0xfb44, 0x7c6f, 0x6cce},
+         {0x22ca, 0xdeac, 0xc688, 0x1a94, 0x1ff8, 0xbbae, 0x6ef7, 0xb906,
+          0x580f, 0x8d59, 0x8c38, 0x88ad, 0x2ca8, 0xe79f, 0x9abf, 0x58f2}},
+        {{0xcdf6, 0x710e, 0x64bf, 0x4b5a, 0x293c, 0x462c, 0xe538, 0xb14c,
+          0x3ab9, 0xd50b, 0xd056, 0x3643, 0x4870, 0x185b, 0x3724, 0x6af9},
+         {0x3e68, 0x8de7, 0xcfab, 0xe90e, 0x76a5, 0x377e, 0x6f9f, 0x5403,
+          0x5982, 0xbe01, 0x5b0b, 0xf049, 0x1e36, 0xa7f4, 0x29c4, 0x5776},
+         {0xa888, 0x09c6, 0x0245, 0x3220, 0x8973, 0x4b55, 0x3613, 0xd2e0,
+          0x289f, 0x3c33, 0x3623, 0x83e2, 0xc18f, 0x0cae, 0x25bb, 0x701f}},
+        {{0xc113, 0x7cbe, 0xf6d9, 0x9d18, 0xdbe4, 0x74bf, 0x06e6, 0x844a,
+          0x60d6, 0xac4e, 0xb522, 0x20f5, 0x5e51, 0x5095, 0x5bc0, 0x720a},
+         {0x6ced, 0xe461, 0xb0f8, 0xc3a8, 0xa87d, 0x9e25, 0x660e, 0xf700,
+          0xa59c, 0xf4bc, 0x061f, 0x61e3, 0x0be9, 0xbdc4, 0x92bf, 0x2e0c},
+         {0x5a35, 0x9b80, 0x0943, 0x0c3f, 0xabfc, 0x6242, 0x8b37, 0xe84e,
+          0x9346, 0x5c22, 0x17f3, 0x6914, 0xf0ec, 0x144e, 0x9cbb, 0x0e9b}},
+        {{0xbeee, 0x5db1, 0x9bd5, 0x8dee, 0x3fb9, 0x0a72, 0xab37, 0xc9c3,
+          0xd791, 0x1c68, 0xf1bf, 0x44a8, 0x3cde, 0x1cfd, 0x4419, 0x366d},
+         {0x20ad, 0xfb57, 0xd48f, 0xfbba, 0x0d0e, 0xdbf9, 0x916b, 0xee81,
+          0x43bf, 0x6355, 0x3152, 0xd481, 0x7bd8, 0x3f33, 0x04eb, 0x2211},
+         {0x8c14, 0xf2bc, 0x1743, 0x9e3c, 0x6c3b, 0xb585, 0x26fc, 0x2eda,
+          0xfb97, 0x68a7, 0x2f0e, 0xccb8, 0x3244, 0xbc59, 0xa4e6, 0x4167}},
+        {{0x8fee, 0xf8ce, 0x2665, 0xc2be, 0xd62c, 0xe880, 0xff14, 0xe967,
+          0x4eee, 0x2f36, 0x6e7e, 0xf12e, 0xd2f6, 0xcb7e, 0x3370, 0x34b3},
+         {0x2700, 0x76f6, 0x9d28, 0x643b, 0x68eb, 0x0e76, 0x9d40, 0x5d1d,
+          0x0684, 0x21fc, 0x4303, 0x1b4b, 0x246a, 0x2255, 0xbb7e, 0x7938},
+         {0xd6cc, 0x8681, 0x91ee, 0xcdc5, 0xa753, 0xed85, 0x109c, 0xce02,
+          0x8883, 0x5880, 0x85c1, 0xed74, 0x65e4, 0x2dfe, 0xfc6e, 0x1176}},
+        {{0x0eb8, 0x4977, 0xe289, 0xdb90, 0x40a3, 0xacf4, 0xcc2a, 0x98fb,
+          0x879b, 0xded7, 0x4ffe, 0x2135, 0x06b6, 0xf269, 0x3e54, 0x1f6a},
+         {0x619b, 0x5b9c, 0x6cd0, 0xb4af, 0x8480, 0xb2a5, 0xc9f4, 0x2ddf,
+          0x4dc4, 0xebe9, 0xa502, 0x3d4f, 0x5f34, 0x677d, 0x3a4c, 0x08fc},
+         {0x34ea, 0xd307, 0xc199, 0x60a4, 0x5cd6, 0x3116, 0x85b6, 0x40c0,
+          0x8295, 0xf759, 0x3e23, 0xe233, 0x00d1, 0x16b9, 0xad01, 0x4f2f}},
+        {{0xb638, 0xb73b, 0xd91d, 0x962c, 0x9c08, 0xfc12, 0x77aa, 0xe605,
+          0x1689, 0xf3b6, 0x9b39, 0x6f61, 0xee81, 0x2944, 0x995f, 0x3451},
+         {0x4e54, 0x94ae, 0xb241, 0x44be, 0xef6c, 0x1857, 0x1c51, 0x5f54,
+          0x0498, 0x368d, 0x6b2d, 0xa61e, 0xf7ab, 0x972e, 0x84a4, 0x4454},
+         {0x7d7c, 0x9fea, 0xfcd0, 0x9152, 0x5cf6, 0xb093, 0x6c94, 0x4a81,
+          0x5c40, 0x4728, 0x9aaa, 0x258e, 0x93b7, 0x0428, 0x9ca6, 0x10b8}}
+    },
+    {
+        {{0xf06e, 0x5a45, 0x41be, 0x7539, 0x5f65, 0x6d9c, 0xaeed, 0xd07c,
+          0x51b6, 0x72ff, 0x6b9c, 0x1177, 0x4da9, 0xef0d, 0xd1d9, 0x17d2},
+         {0x289c, 0x9718, 0x4749, 0x3d59, 0x3f26, 0x2453, 0xf8c5, 0x12eb,
+          0xef15, 0x14c3, 0xbfcb, 0x0262, 0x518e, 0x77b7, 0x78d5, 0x20b8},
+         {0x3e6a, 0x073f, 0xaf18, 0x27f2, 0x1069, 0xd752, 0xe519, 0xfd3f,
+          0x0022, 0x3ca6, 0xb72c, 0x22e3, 0xc6a7, 0xcc65, 0x4f63, 0x7221}},
+        {{0x29c9, 0xf43b, 0xb7b9, 0x1d9d, 0x8f75, 0x4f51, 0x824a, 0xd605,
+          0x9dc4, 0x312f, 0x72bd, 0xf2c0, 0x45b0, 0x5a15, 0xac85, 0x1f24},
+         {0xa693, 0x5307, 0x7f40, 0xb4e3, 0x6795, 0x2f33, 0x14d7, 0xaba7,
+          0x1099, 0x7376, 0xd0a7, 0xd6fb, 0xcbc9, 0x8171, 0x48c5, 0x5fdf},
+         {0x05aa, 0x8e95, 0x0832, 0x24d6, 0x20ee, 0x0c14, 0xc1d1, 0x4748,
+          0x25a2, 0x06fb, 0xe45c, 0xc7ff, 0x95e6, 0x2ae3, 0x739e, 0x00ba}},
+        {{0xbb26, 0xea88, 0x26f5, 0xae44, 0x3bfb, 0x8497, 0x79d9, 0x3606,
+          0x4e50, 0x2669, 0x030c, 0x5c9f, 0xd226, 0xd518, 0x7de7, 0x7229},
+         {0x90d6, 0x5c87, 0x98de, 0x592e, 0xa2df, 0x45c2, 0xb7d3, 0xe5bf,
+          0x9922, 0xf9b4, 0x3b60, 0x115a, 0x78f3, 0x67ad, 0x3a3e, 0x0328},
+         {0xb939, 0xbe0c, 0x1dc7, 0x4824, 0x3080, 0x8b63, 0x9b4d, 0x32f1,
+          0x9308, 0x0228, 0xc90d, 0xd3df, 0x1945, 0x4627, 0x2968, 0x05e1}},
+        {{0x4550, 0x242c, 0xbbc8, 0xadbf, 0x81d9, 0xd030, 0x0cec, 0xbcc8,
+          0xdf92, 0xf5c8, 0x66a6, 0x8435, 0xce4c, 0x8258, 0x25d3, 0x78cf},
+         {0x495a, 0x2d9c, 0xeeb3, 0xba82, 0xb97c, 0xf12b, 0xc8fc, 0xceef,
+          0xd1e0, 0x93b5, 0xabae, 0xb02d, 0x8d9b, 0x1369, 0x0c9c, 0x39c0},
+         {0x9d68, 0x3148, 0x6b8e, 0x15ae, 0xf087, 0x9c2b, 0x1cab, 0xaa85,
+          0xfa05, 0xf04e, 0x5a97, 0xc9a7, 0xf832, 0x6b3f, 0x5207, 0x006b}},
+        {{0x082d, 0xb9ce, 0x7e16, 0xf5cb, 0xbc29, 0x417a, 0xf14c, 0x3407,
+          0xa7ab, 0x2bf4, 0x6bce, 0xd4b3, 0x75ce, 0x1a9f, 0xe956, 0x7de2},
+         {0x781c, 0x9d95, 0xcfe1, 0x29e0, 0x10e2, 0x9663, 0xdf18, 0xb681,
+          0x6b39, 0x7051, 0x39d3, 0x57df, 0x6122, 0x3bc7, 0xe344, 0x4d57},
+         {0x5ecb, 0xb6a5, 0xd4f4, 0xde70, 0xdb99, 0x5d85, 0x527f, 0x4801,
+          0x9a81, 0xd3ee, 0xc440, 0xdbc9, 0x29ed, 0x1a60, 0x90af, 0x6b2a}},
+        {{0xd80a, 0x5bb2, 0xf324, 0x77eb, 0x079b, 0x2fb9, 0x1b47, 0xd830,
+          0x7333, 0x4cee, 0xe6f2, 0xc647, 0x2109, 0x276c, 0x12c8, 0x4658},
+         {0x1e97, 0x9ae6, 0xf4fc, 0x6923, 0x5fd1, 0xe03f, 0x281d, 0x5735,
+          0xd12d, 0xe6ed, 0xae43, 0xa764, 0x3e4a, 0xd12d, 0xf4e9, 0x5fd8},
+         {0x62d9, 0x2a10, 0xbeb2, 0x4d43, 0xdc16, 0x3831, 0xfb75, 0x7065,
+          0x68d7, 0xde29, 0x4a7b, 0x180d, 0x6790, 0x1cb1, 0x2c2b, 0x05b3}},
+        {{0x8195, 0x7ad5, 0xa42c, 0xf7fc, 0xf3cc, 0x4333, 0x286e, 0x3214,
+          0x979d, 0x340b, 0x9d0d, 0xb6c2, 0x07e1, 0x5673, 0x1a48, 0x3177},
+         {0xa8fd, 0xd24d, 0x5ecc, 0xc8c0, 0xef83, 0x05df, 0x1aac, 0xa1cf,
+          0xcd61, 0x7df9, 0xeff2, 0xdbbe, 0x1e99, 0x7b47, 0x56a3, 0x3b55},
+         {0xd482, 0xe14d, 0xc524, 0x32b0, 0xa4b6, 0x1a2b, 0x5154, 0xedb3,
+          0x5af3, 0x282b, 0x6048, 0xa3d1, 0x36eb, 0x7a73, 0x79d2, 0x4fc0}},
+        {{0xc50d, 0x0c86, 0x8b44, 0xdc34, 0xe651, 0xcc94, 0xcbc9, 0x1337,
+          0x3cb9, 0x643e, 0xf74d, 0x6422, 0xcd08, 0xbae3, 0x70c2, 0x2411},
+         {0x2f7f, 0x89bf, 0x38b0, 0x51c9, 0xe9a7, 0x02df, 0xbd65, 0x2497,
+          0xe453, 0x7880, 0xc09c, 0xffff, 0x8e92, 0xcaf9, 0x67ce, 0x1245},
+         {0x73b4, 0x0ac4, 0xab86, 0x3ff9, 0xe435, 0x0113, 0x1dee, 0xf091,
+          0xc4af, 0xebc6, 0x5060, 0x4ae7, 0x000d, 0x6c87, 0x1296, 0x3f86}}
+    },
+    {
+        {{0x8d13, 0x3604, 0xfcfa, 0x9c18, 0x9ddd, 0x7389, 0x9db3, 0x2915,
+          0xd0aa, 0x9f92, 0x350b, 0xdc9f, 0x19d4, 0x878a, 0x7eee, 0x26f5},
+         {0x0dde, 0x782a, 0x0cc9, 0x559a, 0x8385, 0xea71, 0xcdb2, 0x551d,
+          0x238c, 0x31ef, 0x865b, 0x7f62, 0x613d, 0x7973, 0xa776, 0x504a},
+         {0xefb1, 0x5687, 0x2cd5, 0x0cab, 0xf17b, 0x247a, 0xd162, 0x5180,
+          0x2467, 0x4f5a, 0x5a34, 0x85c1, 0x3069, 0x9dba, 0x943d, 0x4041}},
+        {{0xaadd, 0xa26c, 0x7743, 0x4b21, 0xb7ce, 0x648a, 0xb424, 0x47a6,
+          0xc9e3, 0x03fb, 0x4f7a, 0xcb1d, 0xd019, 0x9800, 0x3142, 0x12d9},
+         {0xcc96, 0x43eb, 0xeeba, 0xc3c0, 0x9caf, 0x26ea, 0x9c9c, 0x8d74,
+          0xccc6, 0x1c77, 0x95ee, 0xd9fa, 0x340f, 0x7684, 0xa1d9, 0x1420},
+         {0x594f, 0xd337, 0x7799, 0x00c6, 0xa47b, 0xb23a, 0x5140, 0x5e3c,
+          0xf395, 0xe35f, 0x2854, 0x4418, 0xa012, 0x4359, 0x9231, 0x1b4f}},
+        {{0x66b1, 0xa498, 0x3030, 0x33cf, 0x4859, 0x215f, 0x73d2, 0x251f,
+          0xf4f6, 0x51de, 0xaa40, 0xab82, 0x23f6, 0x6f9a, 0x91d5, 0x5ff1},
+         {0x0951, 0x8915, 0x109d, 0x3e5c, 0x696a, 0x2de9, 0xfa91, 0x39ce,
+          0x3020, 0x975f, 0xe43f, 0x20ea, 0x2dae, 0x7f13, 0x572a, 0x239b},
+         {0x9068, 0xac2d, 0xd433, 0x819e, 0x8523, 0x5fc9, 0xab79, 0x2883,
+          0xeb3d, 0x5593, 0x7280, 0xef45, 0x36cb, 0x758f, 0x526a, 0x020c}},
+        {{0xcc89, 0xf042, 0xef59, 0xe931, 0x4bb6, 0x8e12, 0x9c9d, 0x2c58,
+          0x5997, 0xaec7, 0xe18a, 0xadc8, 0xc50c, 0x5602, 0xfe0a, 0x452c},
+         {0xdbbc, 0x9ed8, 0x34f8, 0x7798, 0xa46c, 0xdc7c, 0xaaf9, 0xc8f2,
+          0xb074, 0xa3e1, 0x4cdc, 0xa952, 0x3877, 0x1531, 0xcc46, 0x02aa},
+         {0x77df, 0x6478, 0xf7a0, 0x86a0, 0x7c9f, 0x0e60, 0x6427, 0xbbc4,
+          0x11c9, 0xf1fb, 0xea25, 0xab17, 0x877b, 0x304b, 0x7d7b, 0x4cfb}},
+        {{0xef12, 0x9789, 0x99c2, 0xe286, 0x190d, 0xdf57, 0xcd71, 0x2b6e,
+          0x70d0, 0xecc9, 0xc857, 0xc343, 0x3ac5, 0x434d, 0x4cbc, 0x5b1d},
+         {0x75fe, 0xb89b, 0x3d6c, 0x72b4, 0xdc80, 0x9c6a, 0x94d9, 0x54c6,
+          0x4c9f, 0x3ee3, 0xaa37, 0xb8c3, 0x5364, 0x3907, 0x622b, 0x14b4},
+         {0x9f26, 0xcc0a, 0x2615, 0xb6fb, 0xcce5, 0xb88d, 0x0e2b, 0x3a4f,
+          0xa705, 0x3369, 0x498b, 0x1301, 0x2dd1, 0x5859, 0xf712, 0x2f98}},
+        {{0xa701, 0x4f54, 0xae44, 0x2e12, 0xd7de, 0xa9cb, 0x3ef0, 0xfcfe,
+          0x5de0, 0x7583, 0x890d, 0xcebf, 0x4554, 0xe761, 0x62e9, 0x1d80},
+         {0x9e56, 0xb50f, 0xa74c, 0x0c94, 0x1320, 0x8e8e, 0xf4a9, 0x5b1f,
+          0x0f67, 0x8230, 0xcc21, 0x9a2a, 0xaaf9, 0xd806, 0xe249, 0x3a6a},
+         {0x7c5a, 0xa990, 0xda85, 0x657a, 0x0f62, 0x91b9, 0xa8b5, 0x1a0e,
+          0xb4e9, 0xdf34, 0x1dfb, 0x8d0e, 0x5ff3, 0xaef2, 0x8ce8, 0x298b}},
+        {{0x65de, 0x0a21, 0x72ea, 0x837a, 0x79f6, 0x0bcf, 0x07b4, 0x3fab,
+          0xae70, 0x7738, 0x36c7, 0x5216, 0xd7dc, 0x03a7, 0x2718, 0x6ba6},
+         {0x0cb2, 0xeff7, 0x7953, 0x2a92, 0x7076, 0x7915, 0xc92a, 0x4b89,
+          0xcf6a, 0x30a7, 0x457a, 0x9418, 0xe485, 0x4d5c, 0xa840, 0x34b8},
+         {0x3335, 0x8369, 0xecb5, 0xc26e, 0xfefd, 0x63b5, 0x13df, 0xd5a8,
+          0x2573, 0xa4b2, 0xaa9a, 0xa293, 0x1c6a, 0x465e, 0x2bdd, 0x71d6}},
+        {{0x5ef5, 0xb1f7, 0xb5da, 0xcd2d, 0x65f5, 0x16b0, 0x95cf, 0xd77f,
+          0xf085, 0x3f49, 0x1fea, 0x1457, 0x2b3d, 0x262b, 0x3621, 0x1c33},
+         {0xdf80, 0xd378, 0xcc28, 0x6533, 0xa4b4, 0x0a0f, 0x4379, 0xf6db,
+          0xda5a, 0xf701, 0x5ff9, 0xe364, 0x2ba4, 0xf317, 0xf317, 0x74d5},
+         {0xca81, 0x67d9, 0xe554, 0xa86f, 0x8c37, 0x2b29, 0x7c75, 0x398b,
+          0x623b, 0xe3ac, 0x0892, 0xda6d, 0xd98c, 0x47e9, 0xcc45, 0x4aeb}}
+    },
+    {
+        {{0xb610, 0x7354, 0x8d9e, 0x0b40, 0x5b6e, 0x5ba8, 0x3253, 0x806b,
+          0xa207, 0x4a58, 0x3a03, 0xdbe6, 0xdf2c, 0xc9a1, 0xd9dd, 0x173b},
+         {0x01c9, 0x276d, 0x071b, 0x12f0, 0x8c70, 0x86c4, 0xbac5, 0xe7b8,
+          0xfba9, 0x71d6, 0x129b, 0x5308, 0xb792, 0x5a3d, 0xfbf9, 0x5d88},
+         {0x72df, 0xfe58, 0x0f1e, 0x2b50, 0x18c1, 0xd439, 0x582e, 0x58d6,
+          0x3ae0, 0xc967, 0x278e, 0xe6ed, 0xa319, 0xb19e, 0xcd13, 0x06e1}},
+        {{0x0353, 0x9e5b, 0xaf62, 0x472b, 0x0447, 0x278d, 0x0b90, 0x3baa,
+          0xbf27, 0x9643, 0x5f46, 0x0c78, 0x7b13, 0x8d83, 0x6a1a, 0x7f3a},
+         {0x6f23, 0x6f16, 0xad51, 0x40d0, 0x6abe, 0x1fab, 0x3293, 0x118e,
+          0x088e, 0xa04d, 0x5e14, 0x3fe3, 0x6266, 0x26e1, 0x6035, 0x3080},
+         {0x800b, 0x5d3d, 0x4439, 0xf7e6, 0xedf6, 0xc901, 0xd555, 0x95a8,
+          0x6339, 0x592c, 0x7830, 0x68cd, 0x307e, 0x2e51, 0xfded, 0x30d0}},
+        {{0x4750, 0x68b8, 0x971e, 0x9cb4, 0xbbcf, 0x6664, 0x7229, 0xa095,
+          0x412b, 0x72fa, 0xe726, 0x5c8d, 0x89d9, 0x51c5, 0x0843, 0x4615},
+         {0x33b3, 0xf212, 0x4d1a, 0xe059, 0x4d9c, 0xf0cc, 0xe78e, 0x1bdb,
+          0x9a77, 0x8f49, 0x187f, 0x6965, 0x9868, 0x2c09, 0x1420, 0x0a92},
+         {0xa02e, 0xaeb9, 0x19c0, 0xbc90, 0x4cae, 0x1603, 0x110d, 0x55c7,
+          0x32ec, 0x6599, 0xf501, 0x0e6d, 0x5dfe, 0x95ca, 0x0d28, 0x3bca}},
+        {{0x01bf, 0x9ecc, 0x8eb6, 0x9c68, 0x896f, 0xa644, 0x83ad, 0xf0bc,
+          0x9fe2, 0x5f7a, 0x955f, 0xca2d, 0x8241, 0x8df2, 0xb403, 0x4ea8},
+         {0x62a4, 0x3c5d, 0x31bc, 0x40f0, 0x7a60, 0xcff0, 0x8b3e, 0x19fc,
+          0xb545, 0x130f, 0x3da2, 0x9818, 0x13cd, 0xae8f, 0xdedd, 0x5631},
+         {0xd202, 0xf1ca, 0x460a, 0x2aed, 0xee83, 0xa48c, 0x5305, 0x4630,
+          0x1a5f, 0x49f1, 0x7745, 0x9121, 0xa463, 0x542c, 0x0930, 0x24ce}},
+        {{0x0b85, 0xfdf3, 0xa155, 0x3fcf, 0x2ea4, 0x3637, 0x168e, 0xd2f7,
+          0xf844, 0x6492, 0x64de, 0xb2e0, 0x4280, 0x324f, 0x28a7, 0x5499},
+         {0xc106, 0xfd06, 0x90f5, 0x1fe8, 0x10f2, 0x5d88, 0x6835, 0xb5c4,
+          0xaf3e, 0x6e8c, 0x08fe, 0x8278, 0xd74b, 0x8a06, 0xe3c2, 0x41d4},
+         {0x1a2e, 0x63ee, 0x32a7, 0xf26e, 0xfdea, 0xd25f, 0xe4b7, 0xae91,
+          0x4d69, 0xd17f, 0xd33b, 0xbc3b, 0xff6a, 0xc0dc, 0x66de, 0x491b}},
+        {{0x64a1, 0xd0da, 0x4a8e, 0x75f0, 0x284b, 0x67e2, 0x2caf, 0xed22,
+          0x7ba4, 0x1f7b, 0xa379, 0x8234, 0x8b67, 0xb701, 0xb8b0, 0x4cf6},
+         {0x32a7, 0xc7ea, 0xb13d, 0x98f5, 0xdb98, 0x7e16, 0xf8cc, 0xe3d5,
+          0xd947, 0xcbf8, 0xbf52, 0xac0a, 0xe4ac, 0xc85e, 0x38d0, 0x08f3},
+         {0x73bd, 0x991a, 0xa821, 0xc383, 0x0c7a, 0xdf32, 0xbc01, 0xab27,
+          0x7063, 0x8477, 0x331b, 0xc13d, 0x8a99, 0xeb07, 0x4a82, 0x530d}},
+        {{0xbf9e, 0x6c9a, 0x7345, 0x6d69, 0xa880, 0x4900, 0xb2fc, 0x257f,
+          0xb850, 0xc8cf, 0xf412, 0x2bac, 0xbd5b, 0x0cbf, 0xe7e0, 0x0db3},
+         {0x4825, 0xe1f9, 0x3630, 0x004c, 0x535a, 0x8cab, 0x7826, 0x7e2d,
+          0xff8b, 0xcc84, 0x2323, 0xc748, 0x70b9, 0x1017, 0x753f, 0x65ea},
+         {0x6363, 0xe209, 0xfc3e, 0x3d66, 0xcb6b, 0x61b5, 0x2c7f, 0x81d6,
+          0x3b1a, 0x1344, 0x0442, 0x0fbe, 0xa1db, 0x21e1, 0xec19, 0x02a4}},
+        {{0x795f, 0xf1cf, 0x6162, 0xf5c8, 0x57f2, 0x26ee, 0x8619, 0x118c,
+          0x3578, 0x1c06, 0x2485, 0x1721, 0x7fcf, 0xec06, 0x2b5d, 0x36d1},
+         {0xb8a2, 0x3b24, 0x259a, 0x5ce6, 0xa0b8, 0x45af, 0x7acc, 0xb857,
+          0x7037, 0x8ba0, 0xe6e8, 0xcccb, 0x09bf, 0x1278, 0x3c51, 0x3d14},
+         {0x4557, 0x7915, 0x2791, 0x126d, 0x3a0a, 0xfc78, 0x8f5c, 0xd5e4,
+          0x9bac, 0xdf17, 0xb6e8, 0x36bd, 0x2859, 0x5ba8, 0x1788, 0x2ef5}}
+    },
+    {
+        {{0x2f51, 0x305b, 0xbffb, 0x96ee, 0x96b8, 0x8895, 0x38ad, 0xd3f9,
+          0xdd25, 0x46d5, 0x2dc7, 0xf0f5, 0x0095, 0xbb3a, 0x8290, 0x5796},
+         {0xaedc, 0x8c58, 0x974e, 0x4637, 0x41a4, 0xabf0, 0x22fb, 0xb9ef,
+          0x718a, 0xe980, 0xd956, 0xe185, 0xa8a6, 0xb143, 0x78fa, 0x2f1b},
+         {0xe101, 0x0a20, 0xb843, 0xf71a, 0xec47, 0x24f0, 0x658d, 0xf393,
+          0xeed1, 0x6ee2, 0x09a8, 0xcf75, 0xa3e1, 0xdc2a, 0x3e35, 0x7dc4}},
+        {{0x9718, 0x273e, 0x2a5c, 0x5a78, 0xfd94, 0x5e4e, 0xc699, 0x3576,
+          0x7d3e, 0x1f23, 0xd805, 0x0f2e, 0x0a99, 0x82d5, 0xb81d, 0x044f},
+         {0xd9c3, 0x887d, 0x6665, 0x8596, 0x5355, 0x4bb0, 0x9b31, 0xc90f,
+          0x79b1, 0xef20, 0x8df8, 0xc6e0, 0xc12f, 0x758c, 0x2016, 0x7ef7},
+         {0xe3d9, 0xa907, 0x18c5, 0xc1df, 0x6359, 0xce4c, 0x371d, 0x57b3,
+          0xbb49, 0xb201, 0x4534, 0xca70, 0xdd2e, 0x9c30, 0x823f, 0x7f79}},
+        {{0x87ba, 0x68f5, 0x1ff0, 0x6a9c, 0xc8de, 0x0050, 0x894e, 0x0827,
+          0x5be7, 0x7ded, 0x9955, 0x3cbf, 0xd6f0, 0x1c06, 0xb043, 0x64a9},
+         {0x13e8, 0xa3b5, 0xd239, 0x8334, 0xa8d8, 0xb91f, 0x70d4, 0xc136,
+          0xbd33, 0xf590, 0x4136, 0x12b5, 0xd9b4, 0xd784, 0x0373, 0x0a4e},
+         {0x2919, 0x5b7d, 0xd6a1, 0x2eb3, 0x8235, 0xd53a, 0xf6a0, 0xb0b4,
+          0x5d47, 0x89a4, 0xce43, 0x7156, 0x346c, 0xce18, 0x7d0a, 0x071a}},
+        {{0x4431, 0x20e1, 0x3552, 0xcc0c, 0x5141, 0x09b1, 0x9507, 0x0d65,
+          0x5f36, 0x209d, 0x621b, 0x9af5, 0x55d3, 0x6177, 0xbcf7, 0x7c69},
+         {0xba0b, 0xc887, 0x2daa, 0xd307, 0x62ee, 0xbfa5, 0x2905, 0x0126,
+          0x768b, 0xc0ef, 0x3002, 0xcf54, 0x7e9c, 0x46ea, 0xcc71, 0x2c3b},
+         {0x295f, 0x04e8, 0xd7eb, 0x07f0, 0xf37d, 0x2f50, 0x1825, 0x10db,
+          0x98d7, 0x1717, 0xa9a3, 0xe951, 0xa51d, 0x22ac, 0x9a73, 0x6f5a}},
+        {{0x44be, 0xa3d9, 0xd4eb, 0xe729, 0xaf9e, 0x8078, 0x0940, 0x8d9e,
+          0x9c03, 0x4786, 0x567a, 0x4525, 0x3b24, 0xee8d, 0x9680, 0x02ab},
+         {0xc6c5, 0x2f41, 0x000c, 0x8ba1, 0xfb9b, 0x0cfe, 0x79c1, 0xc49f,
+          0x1c9f, 0x3cc5, 0x4770, 0x4efa, 0xafca, 0xe147, 0x21a2, 0x494e},
+         {0x0d9a, 0xdde5, 0x8a85, 0xefa4, 0xa249, 0x0fb9, 0x224e, 0x219a,
+          0xf6d9, 0xd91e, 0x1f1d, 0xfa09, 0xbb34, 0xea46, 0x76cb, 0x6b5d}},
+        {{0x2522, 0x1e78, 0x4117, 0xe0f9, 0x36d3, 0x0369, 0xae74, 0xf1e6,
+          0xc746, 0xd0fc, 0x3ea2, 0x408b, 0x313e, 0x03dd, 0x869c, 0x16fb},
+         {0xd994, 0xec0c, 0x556c, 0x8857, 0x1dba, 0x5cd0, 0xdc6f, 0x6472,
+          0xb477, 0x8f42, 0x6914, 0xaf01, 0x7354, 0x8527, 0x33f6, 0x0ae3},
+         {0x0962, 0x33b6, 0x1997, 0x288e, 0xe133, 0xd8ab, 0x72b4, 0x24fc,
+          0xd03e, 0x0991, 0xf7ed, 0x4811, 0xd075, 0x8f70, 0xe38b, 0x3f81}},
+        {{0xc824, 0x5f17, 0x7f35, 0x0adb, 0x99a4, 0xd742, 0x23c3, 0x74b9,
+          0xeaf7, 0xcbf8, 0x3e8b, 0xd57c, 0xdc3d, 0x4cde, 0xe2d3, 0x0ad3},
+         {0xaffe, 0x7ed9, 0x0fcc, 0x7f91, 0x874b, 0x2465, 0xb8a1, 0x545c,
+          0x4704, 0x4b0c, 0x7ed2, 0xa839, 0x0993, 0x04f5, 0x0fc1, 0x5051},
+         {0x249d, 0x336e, 0x0fc5, 0x6f0c, 0xcfd9, 0xc331, 0xde19, 0x745e,
+          0xfe1c, 0x09ee, 0xfd00, 0xf2d6, 0x1ebe, 0xf0fa, 0x158b, 0x127c}},
+        {{0xb974, 0xae51, 0x8fc4, 0xdea2, 0xfe96, 0x744d, 0x73d3, 0x1d99,
+          0x48a8, 0x8738, 0x680b, 0x6240, 0xdf95, 0xd167, 0x2479, 0x4ed8},
+         {0x79a2, 0x2e98, 0x7c42, 0xf619, 0x3647, 0x52ca, 0xddd4, 0xa44a,
+          0xaccb, 0x4b4e, 0x3fc1, 0x9b41, 0x4f68, 0x07ef, 0xf87d, 0x354e},
+         {0xd975, 0x60c5, 0xb522, 0xfee3, 0xb0b8, 0xeb41, 0x2efc, 0x5035,
+          0x653c, 0xa9f6, 0xac30, 0x8808, 0x236d, 0x0539, 0x92d2, 0x302d}}
+    },
+    {
+        {{0xf177, 0xe4e0, 0x6fb6, 0x2dbc, 0x6a93, 0xa4bd, 0xbf29, 0x04e1,
+          0xf6e8, 0x787a, 0x66d4, 0x5e19, 0xd060, 0xb426, 0x5f5e, 0x0edc},
+         {0x283d, 0xbca4, 0xc1a2, 0x7813, 0x3dd9, 0xa186, 0xf091, 0xed62,
+          0xfa86, 0xc268, 0xbcb8, 0xaec7, 0xae4c, 0x6f1c, 0xd3b7, 0x10e5},
+         {0x8e67, 0x53da, 0xbfd6, 0x5453, 0xf641, 0x24a9, 0x1eec, 0xe9dc,
+          0x8a23, 0x0357, 0x263b, 0xbf87, 0xba72, 0x361c, 0x6c51, 0x45b4}},
+        {{0xe3e4, 0x8a7f, 0x4ddd, 0xce9d, 0x0e30, 0x7662, 0x6456, 0xab13,
+          0x9958, 0xb30e, 0x4f7b, 0x4b59, 0x29df, 0x3212, 0x0aef, 0x5c1c},
+         {0x7fa1, 0x314f, 0x2abf, 0xa940, 0xf450, 0x8e8c, 0xf1dc, 0xe257,
+          0xbe84, 0x23a8, 0xd54b, 0x1dbb, 0x713b, 0x6dcb, 0xbfa3, 0x2177},
+         {0xdb8f, 0xfa79, 0x1bbc, 0x3708, 0x59b3, 0xc25f, 0x811e, 0x6048,
+          0x2487, 0x9c83, 0x7665, 0x087a, 0xb5bb, 0x7d8a, 0x1938, 0x4ae6}},
+        {{0xfb83, 0x985b, 0x7e44, 0x6111, 0x3136, 0x7196, 0x462a, 0xfce0,
+          0x904b, 0xd425, 0x3448, 0x83ac, 0x3d64, 0x5ba4, 0x5abe, 0x7568},
+         {0xa32e, 0x5344, 0xf6aa, 0x8ddb, 0x4078, 0xb41b, 0xeab4, 0x7d88,
+          0x0d60, 0x4a13, 0xeb97, 0x5eb0, 0x3e03, 0x17bf, 0xd91b, 0x1a00},
+         {0xf2b2, 0xeb61, 0x0933, 0x6e96, 0x4952, 0xc9ff, 0x0fa8, 0x543d,
+          0x6569, 0x7af6, 0x7510, 0xdf72, 0xe6aa, 0x23b0, 0x29b6, 0x1355}},
+        {{0x83fe, 0xe22e, 0x16bc, 0xf5c7, 0x85c1, 0xe809, 0xeb19, 0xb42b,
+          0x4aae, 0x1425, 0xa637, 0xec9d, 0xa613, 0x1590, 0xea05, 0x5972},
+         {0xd518, 0xadd1, 0xdbd7, 0x18f0, 0x1f11, 0xcfc1, 0x7888, 0x979f,
+          0x759b, 0x7114, 0xe1f0, 0x8732, 0x3a01, 0x65ca, 0xb81a, 0x79b5},
+         {0x7811, 0xdc8f, 0xac20, 0x0fd4, 0x4fa8, 0xac4d, 0xd294, 0x9a9a,
+          0x0434, 0xb336, 0x2d64, 0xc01b, 0x3bdb, 0x905f, 0x9c95, 0x4f7e}},
+        {{0x99fe, 0x3552, 0x443d, 0x71c8, 0xead7, 0xdbeb, 0x3b1c, 0x8bcd,
+          0x9466, 0xf1a4, 0x499e, 0x8092, 0xadc8, 0xa144, 0xeec4, 0x1942},
+         {0x302e, 0x5781, 0x4bbc, 0x6267, 0xdc0f, 0x89ad, 0x0f39, 0xd852,
+          0xd9c6, 0x53fb, 0x99ae, 0x8c29, 0x8e4c, 0x2e63, 0x3ad9, 0x3199},
+         {0x4992, 0xae23, 0x5319, 0x7dac, 0x3e92, 0x0cea, 0x3d91, 0x2c1b,
+          0x1122, 0x253c, 0xe494, 0x553c, 0xca75, 0x4ef9, 0x6531, 0x2a0a}},
+        {{0x793a, 0x3c1c, 0x1acd, 0xcf36, 0xbc3b, 0x5a35, 0xbcac, 0x2f9e,
+          0xa6ab, 0xa8cd, 0x60e9, 0x60e8, 0x1a13, 0x6dea, 0xc39b, 0x055d},
+         {0x27c2, 0xf7f9, 0x937f, 0x2db7, 0xa635, 0x17d0, 0x1f06, 0xdb74,
+          0xaf76, 0x1155, 0xf3a2, 0x5982, 0x2ded, 0x647c, 0xe218, 0x4cf6},
+         {0x5bb6, 0xc28d, 0x227c, 0xb119, 0xffab, 0x774d, 0x4ebc, 0x07e2,
+          0x2c89, 0xe4a3, 0x78ce, 0xa83c, 0x24b6, 0x10aa, 0x3077, 0x121a}},
+        {{0x83c9, 0xc774, 0x713e, 0xd659, 0x96af, 0xb82b, 0xe077, 0x88bf,
+          0xbcd3, 0x1097, 0x2823, 0x289e, 0x3a9b, 0x6ced, 0xb94a, 0x527b},
+         {0x4a97, 0x9f03, 0x5d5e, 0xe4db, 0xbc2d, 0x3034, 0xfc09, 0xe153,
+          0xd3b1, 0x9551, 0x4691, 0x4605, 0xe52d, 0x7a40, 0xc76c, 0x333f},
+         {0x482e, 0x995b, 0x992a, 0x563d, 0x3801, 0x6e38, 0xd07c, 0x3405,
+          0xd8e5, 0x2f64, 0x35de, 0x4850, 0xa9f7, 0x20a7, 0x069b, 0x6b89}},
+        {{0xdb77, 0xb5c7, 0xfa8c, 0x4082, 0xc155, 0xc734, 0x86f8, 0x0686,
+          0xa57e, 0xf6e7, 0xc8d9, 0x29e6, 0x9bcf, 0xa763, 0xd308, 0x0473},
+         {0x220d, 0x6270, 0xa041, 0x812a, 0x5b4e, 0xf924, 0x89fa, 0x995a,
+          0xef05, 0x5072, 0xc4ce, 0xffad, 0xeb73, 0xaa73, 0x2103, 0x23bc},
+         {0x9e05, 0x0358, 0x7926, 0xcaee, 0xc492, 0x46dc, 0x4212, 0x2b4b,
+          0xa94f, 0xe601, 0xef74, 0x02a1, 0x341a, 0xde04, 0x73bf, 0x102f}}
+    },
+    {
+        {{0x1c9a, 0xb551, 0xdae0, 0xa2b4, 0xff06, 0x2bff, 0x6029, 0x7ac8,
+          0x4234, 0xf550, 0x375d, 0x981f, 0xa12d, 0xda4e, 0xd725, 0x3f6b},
+         {0x45c6, 0x7f57, 0xb9ab, 0xeb18, 0xc690, 0x5787, 0x8aee, 0x023a,
+          0xafa9, 0x2df7, 0x12da, 0xb727, 0x013d, 0xea5c, 0x7d25, 0x3659},
+         {0x58ac, 0x1060, 0x8d7b, 0x734d, 0x905f, 0x6fc6, 0x579e, 0xd940,
+          0x932d, 0x9202, 0xf8f9, 0x6466, 0xd6d0, 0xda60, 0xcc19, 0x7b7e}},
+        {{0xfa9b, 0xa77c, 0x4a51, 0x6dae, 0x8650, 0xe7a3, 0x3654, 0x8226,
+          0x82db, 0x8f2d, 0xffcd, 0x09bb, 0xcaba, 0x1bf5, 0xdc66, 0x03be},
+         {0x690d, 0x695c, 0x373c, 0x78c2, 0x906e, 0x0642, 0x2e66, 0xdd25,
+          0x2bd2, 0x4ae1, 0x4444, 0x951d, 0x3956, 0x0174, 0xad76, 0x4235},
+         {0x75f5, 0x0789, 0xcb0d, 0x6258, 0xf298, 0x9189, 0x4254, 0x4929,
+          0x6ee4, 0xe2e3, 0xb423, 0xa0ca, 0x66a1, 0xcdf0, 0xe2b0, 0x0e7c}},
+        {{0x70f9, 0xd94b, 0xfedf, 0xfea6, 0xba2d, 0xc1fc, 0xc051, 0xf130,
+          0xab89, 0x7f2f, 0xd47e, 0x4882, 0xeeb5, 0x8aec, 0x5613, 0x6152},
+         {0x85a3, 0xc48c, 0x643a, 0xc494, 0x39ad, 0x3c61, 0x1df4, 0xfd36,
+          0x4d48, 0x3ae9, 0x17dd, 0x09db, 0x674a, 0x8fb4, 0x0a5d, 0x666e},
+         {0xcb0d, 0x4870, 0xf64e, 0x2abb, 0x8b6b, 0xaa45, 0xbcf0, 0xcd65,
+          0x985d, 0x75e8, 0x4eba, 0x9abe, 0xdee4, 0xd514, 0xc810, 0x7f0b}},
+        {{0x13a0, 0x7372, 0x9dad, 0x83ac, 0x2e98, 0x2ef7, 0xf8ba, 0x9ff6,
+          0x6957, 0x43ec, 0x2edd, 0x311e, 0xab75, 0xdec5, 0x907d, 0x1d3a},
+         {0x136f, 0x26f4, 0x6ba4, 0xb900, 0x3035, 0x57e0, 0x369e, 0x8d67,
+          0x3c28, 0x4f46, 0xdfd9, 0xcbc8, 0xdbf5, 0xf8ee, 0x8dbc, 0x0d1f},
+         {0x81dc, 0x3ed0, 0x9331, 0xba16, 0x3480, 0x851b, 0x9fad, 0x2932,
+          0x21cb, 0x0303, 0x013c, 0x0128, 0xfde3, 0xa31b, 0x1b44, 0x0001}},
+        {{0xa75c, 0x6a0a, 0x1f69, 0x1656, 0xbd6a, 0x5852, 0x725c, 0xc1bf,
+          0x66ad, 0x9a79, 0xdd7f, 0x11a8, 0x1026, 0xd285, 0x88a2, 0x63d9},
+         {0x6c0c, 0x3fc6, 0xa06c, 0x3fdf, 0x0dd2, 0x4dd6, 0xe38e, 0x5d40,
+          0x4d71, 0x268e, 0x8b38, 0x7ae3, 0x57e1, 0x6e83, 0x8d91, 0x3ac4},
+         {0x232e, 0xafbd, 0x0753, 0x0012, 0xf683, 0xfdd8, 0xceb8, 0xe92b,
+          0x2b91, 0x84e7, 0x69b3, 0xf816, 0xa066, 0x2368, 0xd52b, 0x33fa}},
+        {{0xcfe8, 0xc422, 0xc8d0, 0x8d2c, 0x3acb, 0x05a1, 0x4f7b, 0x072b,
+          0xa56f, 0xecf6, 0xb6e6, 0xa3fe, 0x71e2, 0xb90a, 0x55cc, 0x3cc3},
+         {0x1e16, 0xc5e4, 0x49c6, 0x5406, 0x7735, 0x333f, 0x6430, 0x0af8,
+          0xe746, 0xf305, 0xfcd2, 0xb2ac, 0xdca7, 0xa256, 0xf429, 0x16c0},
+         {0x9131, 0x903e, 0x9443, 0xe9b6, 0x37ce, 0x7a56, 0x94cb, 0xb8a4,
+          0x9244, 0xbaba, 0xd1a4, 0xc87c, 0x7568, 0x6bae, 0xaf42, 0x631e}},
+        {{0x0de8, 0xa370, 0x75b9, 0x47d9, 0x0552, 0xe2f8, 0xc5fb, 0x7280,
+          0x5de1, 0x32e4, 0x8f27, 0x5365, 0x80b5, 0x665f, 0x2c7f, 0x431f},
+         {0xfe9f, 0xda66, 0x0410, 0xb3e9, 0xe5a6, 0x6c16, 0x4b52, 0x85dd,
+          0xbf83, 0x1ef9, 0x9761, 0xbc3d, 0x19b5, 0x1ea9, 0x648b, 0x5599},
+         {0x7b19, 0x858f, 0x6344, 0xd602, 0x514a, 0xa1ea, 0x352f, 0x14ab,
+          0xa9d7, 0x2090, 0x441a, 0x8900, 0x3b26, 0x9125, 0x715f, 0x7b04}},
+        {{0xbac6, 0xc4e6, 0xc280, 0xb376, 0x9b0b, 0x6d1d, 0xd3dd, 0x970e,
+          0xf944, 0x450b, 0x9558, 0xb09a, 0xe223, 0x57cd, 0xacfa, 0x48d0},
+         {0xae43, 0xacf6, 0xbd28, 0x83ed, 0x7ab4, 0x7d5c, 0x7c8b, 0x8635,
+          0x2c44, 0xb7eb, 0x4769, 0xc040, 0x583f, 0xc2f6, 0x7bf5, 0x59b3},
+         {0xe671, 0x7dab, 0x26e4, 0xb60f, 0x3a37, 0x622f, 0xa197, 0xf1d1,
+          0x0394, 0xe996, 0xce7e, 0x4208, 0x3bdb, 0x336d, 0x4191, 0x1623}}
+    },
+    {
+        {{0x8640, 0x1ff3, 0x9cd6, 0xdd49, 0x25a0, 0x0636, 0x9bc3, 0x29cd,
+          0x3dc3, 0x3dd7, 0xd802, 0x51e2, 0x9231, 0x203b, 0x707a, 0x4a25},
+         {0x7ff6, 0xf626, 0x99de, 0xb9e4, 0x0843, 0x742c, 0xca7b, 0x7772,
+          0xf2b1, 0xe9a4, 0x153f, 0x23a0, 0x5006, 0xd5d0, 0xdfec, 0x2cdf},
+         {0xed6a, 0x53f6, 0x668a, 0x2ab7, 0x70a1, 0x1dd1, 0x4258, 0x3042,
+          0x0161, 0x3ae2, 0x144c, 0x4000, 0x49fc, 0x248e, 0x896d, 0x5721}},
+        {{0xda4e, 0xa1d0, 0x5091, 0x285d, 0x3e08, 0xb5fe, 0x6fa7, 0x4baa,
+          0x93b3, 0xe193, 0x177c, 0x63e5, 0x30fd, 0xc4b0, 0x35af, 0x03c9},
+         {0x1bae, 0xfd18, 0x5517, 0x0b6e, 0x63b4, 0x2bb9, 0x629f, 0x9022,
+          0x4625, 0x3206, 0xbce9, 0x5509, 0x13da, 0xf63c, 0xdd74, 0x578e},
+         {0x0c3d, 0x492b, 0x76c6, 0x9972, 0x05fc, 0xdfe2, 0xc2c4, 0x47cc,
+          0x3a3c, 0xdd62, 0x9b84, 0xdcd2, 0xc7a2, 0x0288, 0xab59, 0x3ec2}},
+        {{0xd1cb, 0xae32, 0x3a09, 0xa721, 0xc2d5, 0x40f5, 0x87df, 0x0f2b,
+          0xab29, 0xe81e, 0xa4c6, 0x0bae, 0xac5e, 0x6adb, 0xf66c, 0x0e1b},
+         {0x7bb9, 0xe4d8, 0xd27b, 0xa1a0, 0x1aed, 0x6139, 0x4deb, 0xa98b,
+          0x9b83, 0x73cb, 0xddd0, 0x99a0, 0xcace, 0x200f, 0xc25a, 0x2dd5},
+         {0x887e, 0x792c, 0xd5e9, 0xe2ab, 0x6d5d, 0xcb92, 0x0018, 0x1a02,
+          0x5f1e, 0xbaae, 0x69cd, 0xbfba, 0x8f5f, 0x5ae8, 0x48b3, 0x7305}},
+        {{0xe334, 0xa1d6, 0x094b, 0x805b, 0x3f19, 0x0935, 0xf177, 0xbf3e,
+          0x702b, 0x0622, 0x06cb, 0x423f, 0x45dd, 0xd878, 0x2277, 0x585a},
+         {0xb8ee, 0xcba8, 0x51a3, 0xc435, 0x5f16, 0xb211, 0x6f1d, 0x65a2,
+          0x3850, 0xab8c, 0x4f52, 0x760f, 0xb8ca, 0x411d, 0x443b, 0x3043},
+         {0x8962, 0x33d4, 0x5f82, 0xa18a, 0x257f, 0xec78, 0xc4b5, 0x6698,
+          0x41ff, 0x373e, 0x6fa5, 0xa78e, 0x981f, 0x50ef, 0x2789, 0x7656}},
+        {{0xcf9d, 0xea86, 0x73a3, 0xe170, 0x5fdc, 0x0715, 0xfbb7, 0x3a8c,
+          0x8a8e, 0x3183, 0xe7fc, 0x4853, 0xf616, 0xb613, 0xf484, 0x28bb},
+         {0xc8c0, 0xd51f, 0xcf59, 0x38c3, 0xb6f2, 0x0506, 0xd2fd, 0x9bed,
+          0x0e8f, 0xab57, 0x109f, 0x26bf, 0x46a6, 0xc1b8, 0x60a8, 0x3f41},
+         {0x6c7c, 0x6f13, 0x2f5c, 0xf261, 0x11be, 0xf6dd, 0xd107, 0xafea,
+          0x6f33, 0x13de, 0x9ad2, 0x527e, 0xf75d, 0x8188, 0xcb35, 0x1e79}},
+        {{0x8181, 0xf5e0, 0x53d8, 0x77e9, 0xded9, 0x299d, 0x0c44, 0x84a5,
+          0x25e5, 0x8645, 0x2d0c, 0xdc6c, 0xf2f4, 0x39d1, 0xb52d, 0x478a},
+         {0xe3f1, 0xeef7, 0x36c3, 0x0134, 0x10f8, 0xfe9e, 0x6a7f, 0x828b,
+          0xdefc, 0xbcf9, 0x08e5, 0x7ff9, 0x3831, 0x3a3b, 0x951b, 0x65d7},
+         {0xd159, 0x9252, 0xa4d3, 0x66a6, 0xc807, 0x871a, 0xe1bc, 0xe5dd,
+          0xc96f, 0xa6c1, 0x6b40, 0xb82c, 0x2214, 0x1a21, 0x7a41, 0x16d8}},
+        {{0x0583, 0xd54e, 0xd5e2, 0xfba4, 0x99fa, 0x2ebd, 0xafd7, 0xe21f,
+          0x778f, 0x6ee9, 0xc273, 0x497a, 0x6dde, 0x7a5a, 0x0b57, 0x1f99},
+         {0x6215, 0x4206, 0x7e5a, 0xb3bd, 0x24c1, 0x0c5a, 0xe3cd, 0x879b,
+          0x94b7, 0xd6f9, 0x5db1, 0x57c0, 0x8ca6, 0x65f3, 0x7c81, 0x28f8},
+         {0xf7d6, 0x1be8, 0x4ead, 0xa334, 0x798f, 0xacea, 0x50eb, 0x7d1e,
+          0xe052, 0x520d, 0x569e, 0x77c6, 0x6d3e, 0x534d, 0x2fe1, 0x4588}},
+        {{0x6fe4, 0x943c, 0x9929, 0xd8ac, 0x92a2, 0xa383, 0xf161, 0xb5f9,
+          0x9af3, 0xbec8, 0xdb13, 0x2699, 0xf074, 0xe405, 0x843c, 0x7dcf},
+         {0x83d6, 0x7579, 0x345d, 0x6669, 0x11a6, 0x17aa, 0xed11, 0x62b6,
+          0x128f, 0x985e, 0x1857, 0x7ddd, 0xf6dd, 0xf626, 0xe5b8, 0x688f},
+         {0x32c0, 0x4a47, 0xd648, 0x6c90, 0x3299, 0xca56, 0x43fd, 0xd521,
+          0xc6e1, 0x915d, 0x28c3, 0xb3be, 0x191b, 0x7327, 0x687e, 0x6739}}
+    },
+    {
+        {{0x1ac0, 0xc80c, 0xcc9d, 0xa66d, 0xa436, 0x1b38, 0x5cf4, 0x97a0,
+          0xd7c6, 0x95db, 0xf3be, 0xa7eb, 0x7dab, 0x8d7e, 0xb8f6, 0x7da0},
+         {0x75a6, 0x3856, 0x2014, 0xef78, 0xa9e8, 0xaafd, 0x9f30, 0xa264,
+          0xa8cb, 0x5cdf, 0xeb50, 0x4cd1, 0xc0b3, 0x1d4d, 0x5aba, 0x4611},
+         {0xda76, 0xc3b5, 0x1953, 0xd40f, 0x9e9b, 0x2111, 0x6f73, 0x1dac,
+          0x5960, 0xfeb2, 0x6021, 0x03cc, 0x4b4b, 0x8367, 0x887e, 0x5a5f}},
+        {{0x43b9, 0xa0a6, 0x28d3, 0x9e96, 0x2064, 0xe6c3, 0xcb00, 0xb5c3,
+          0xec32, 0x7c2d, 0x0289, 0x9b53, 0xc70c, 0xd5d1, 0x7ae2, 0x43e3},
+         {0x3d11, 0x70a1, 0x01cf, 0x8f63, 0xd0c4, 0x350d, 0xb815, 0xcfce,
+          0xa47e, 0xa4bc, 0x97d4, 0xf702, 0x1434, 0xe44d, 0xb656, 0x3669},
+         {0xe133, 0xeda6, 0x3f06, 0x387e, 0x3ac0, 0x99a1, 0x1d51, 0x6730,
+          0x3811, 0x3626, 0xd8f8, 0xbd5a, 0xe9be, 0x4fd5, 0xe6cd, 0x6a21}},
+        {{0xb2e3, 0x6699, 0x2912, 0xef41, 0x1301, 0x708d, 0x0847, 0x71d3,
+          0xb0bd, 0x1182, 0x32d0, 0x3254, 0x8b36, 0x001e, 0x1b07, 0x4537},
+         {0xe65f, 0x3046, 0x170a, 0xf1c6, 0x3524, 0x00d2, 0x2a2a, 0x5871,
+          0xb755, 0x8c82, 0xbd3c, 0x69db, 0xff57, 0xa195, 0xf9f1, 0x586b},
+         {0x790b, 0x5ef8, 0x088d, 0xa6db, 0x37e5, 0x6109, 0xf0dc, 0x5278,
+          0x6eb8, 0x61a1, 0x49d2, 0xac03, 0x2179, 0x90e5, 0xb037, 0x0eaf}},
+        {{0xae1d, 0x0f75, 0x805e, 0x5140, 0xcc30, 0x2662, 0xfbe3, 0xec02,
+          0x396d, 0xea92, 0xdf1e, 0x2ceb, 0x5bb3, 0xc543, 0x3344, 0x44ae},
+         {0x042f, 0x3748, 0x55c1, 0x9605, 0xaa11, 0x820b, 0x41e6, 0x219a,
+          0x6d0c, 0x7348, 0xf738, 0x1c81, 0xc661, 0x5a02, 0xcc67, 0x309a},
+         {0x43ee, 0xbba5, 0x89b9, 0x9cf2, 0x7142, 0x5ac9, 0x0e9d, 0xf376,
+          0x60aa, 0x4f93, 0xe5c6, 0x1d82, 0x678f, 0x7f94, 0x221b, 0x62d5}},
+        {{0x7a3c, 0x3af7, 0xd426, 0x7585, 0x144d, 0xfee9, 0x7b11, 0xdfae,
+          0x193d, 0x59f7, 0x7080, 0xa506, 0x2037, 0x8392, 0x9a53, 0x14f2},
+         {0x936d, 0x18d0, 0x299c, 0x524c, 0x1a0c, 0x8a0c, 0xb56c, 0xc86b,
+          0x8631, 0xdb4a, 0x052e, 0xa375, 0x4562, 0xbc75, 0xfde4, 0x5c0e},
+         {0xd7f5, 0x25b2, 0x7edc, 0xdf71, 0x3040, 0x99b5, 0x70db, 0x21f9,
+          0x4c62, 0xc3ed, 0x34b7, 0xda92, 0x093e, 0x7bee, 0x365c, 0x5e72}},
+        {{0xb33e, 0x2f08, 0x3906, 0x7d93, 0x32be, 0xdf9f, 0x59e5, 0x5b96,
+          0xbdfd, 0x1f9e, 0x3dad, 0xacff, 0x49b7, 0xcb73, 0x0555, 0x70b2},
+         {0x217f, 0x4571, 0xfc07, 0x575b, 0xd95b, 0x0694, 0x675d, 0x3779,
+          0x1e33, 0xf419, 0x37bb, 0x9a0a, 0xeabc, 0x47b4, 0x104c, 0x77f1},
+         {0x2c4c, 0x5511, 0x13c5, 0xbe51, 0x1fcd, 0x9a88, 0x423a, 0x6688,
+          0x3b47, 0x5e50, 0x7785, 0x4466, 0x404a, 0x4a06, 0x398f, 0x0e34}},
+        {{0x1928, 0x3e4b, 0x0b09, 0x1893, 0xf640, 0x73f3, 0xe10e, 0x7de3,
+          0x5d6f, 0x7339, 0x17da, 0xf432, 0x9c3e, 0xca37, 0xded6, 0x6f8a},
+         {0xbde8, 0x3ece, 0x22d9, 0xb67d, 0x2f07, 0x2782, 0xe841, 0x09b3,
+          0x6d8d, 0xb05b, 0xa61f, 0x743f, 0x2372, 0x8a36, 0x0536, 0x5e54},
+         {0xb29a, 0xfdb7, 0x123d, 0xe340, 0xb291, 0xa21a, 0x97e1, 0x487b,
+          0x949e, 0xfde6, 0x7d02, 0xf996, 0xde97, 0xc8d3, 0xe72e, 0x780d}},
+        {{0x2772, 0x00f4, 0xeaf3, 0x671f, 0x41aa, 0x2a8c, 0xeb2a, 0x8f72,
+          0x3292, 0x9737, 0x7fd7, 0x29a1, 0x87a6, 0x32b5, 0xc6ad, 0x1def},
+         {0xe7bc, 0x089a, 0x8545, 0x0ae2, 0x4d06, 0x1c7f, 0xdecf, 0x388d,
+          0x11b8, 0x0a48, 0x1551, 0x38ac, 0x8ce4, 0x7192, 0x8bf6, 0x0eb2},
+         {0x95a7, 0xef51, 0xbe1a, 0xaf5b, 0x15ed, 0x917b, 0x1277, 0x148c,
+          0xda2e, 0x7ae5, 0xf7fb, 0x2991, 0x2867, 0xf8dd, 0x201b, 0x467d}}
+    },
+    {
+        {{0xe7a9, 0x567a, 0xf4bd, 0xbc1e, 0x98bd, 0xd644, 0x4cb2, 0x3f62,
+          0x4ec8, 0x2c1f, 0x64d2, 0xe410, 0x4001, 0xba38, 0xc5a5, 0x2ef9},
+         {0x4fad, 0x74ef, 0x919a, 0x95fe, 0x08a2, 0xf6a3, 0x7bec, 0x3a82,
+          0x7b01, 0x09a4, 0x01d3, 0x964e, 0xc797, 0x5ba3, 0x3c4f, 0x71c4},
+         {0x74cd, 0xfa9e, 0x6df6, 0xb6fd, 0x267a, 0xe4af, 0x78bc, 0xf182,
+          0x990e, 0xf1ef, 0xb3d0, 0x8255, 0xf293, 0x90c5, 0x8ca3, 0x5a75}},
+        {{0xdc94, 0x1d61, 0x918b, 0x8ce0, 0x3066, 0x9a81, 0x3646, 0x8ded,
+          0xaad3, 0xafe8, 0xa829, 0xd4e6, 0xd43f, 0xf639, 0x8027, 0x0a73},
+         {0x2495, 0xd946, 0x2710, 0xa2b7, 0x5003, 0xd57d, 0xc6d2, 0x3aa8,
+          0x87ca, 0xa0b4, 0x00bf, 0xe3d4, 0x72ec, 0xb3eb, 0xe244, 0x2dba},
+         {0xe1cc, 0x57ff, 0x4a2f, 0x980f, 0x9843, 0xe183, 0x0d0d, 0x0067,
+          0x15fd, 0x49fb, 0x3f4a, 0x105c, 0xa69c, 0x5126, 0xca63, 0x2698}},
+        {{0xd90e, 0x5e3d, 0x702f, 0x2e3d, 0x5386, 0xe4d2, 0x0918, 0x9e3f,
+          0xa96a, 0x024d, 0x3ef6, 0x5e77, 0x3332, 0x4afa, 0x4b0c, 0x3c00},
+         {0xba78, 0x32b0, 0x3188, 0xe765, 0xff8b, 0x925c, 0x31f7, 0x3818,
+          0x1fcc, 0xa029, 0x1b91, 0x08a8, 0xeb07, 0x49ca, 0x3dcc, 0x1fb4},
+         {0xb82b, 0x06f4, 0x46ac, 0x9aa9, 0xc4f3, 0xa806, 0x84a5, 0x1ca2,
+          0x4787, 0xc6cd, 0x265f, 0x3ed3, 0xd217, 0xcd1f, 0xfd01, 0x6b43}},
+        {{0x0ef3, 0x3e76, 0x4258, 0xb5c7, 0xb990, 0xee0a, 0x52b9, 0x75dc,
+          0x923f, 0x072b, 0x27c2, 0xbf14, 0xd9f0, 0x6ff0, 0x0b2d, 0x7342},
+         {0xc544, 0x4697, 0x5d4b, 0xc7a7, 0xffbf, 0xdf0f, 0xf848, 0x15fd,
+          0x785a, 0xaa46, 0xb9eb, 0x2868, 0xf714, 0x5b52, 0xd710, 0x5a68},
+         {0x1e06, 0x9e85, 0xf6cb, 0xaf2c, 0x38c4, 0xc622, 0x3913, 0x8f59,
+          0xf373, 0x99fb, 0xb896, 0xda8a, 0xbc9e, 0xea34, 0x632f, 0x3db5}},
+        {{0x25d5, 0x8298, 0x90b1, 0x2e49, 0x8991, 0x3e9a, 0xeb87, 0xedea,
+          0x4af8, 0x4c70, 0x3d39, 0xeef0, 0x2b0e, 0x95df, 0x7ea4, 0x5919},
+         {0xd9d8, 0xf75d, 0xee2b, 0xf46e, 0x59a5, 0x3967, 0xb1f6, 0x0d17,
+          0x7273, 0x499e, 0xd131, 0x1bf2, 0x5f13, 0x49d7, 0x1adf, 0x0432},
+         {0x5aae, 0xe4e5, 0x6019, 0x04e1, 0x92e9, 0x7e2f, 0x437a, 0xe77b,
+          0x9aa4, 0x6f15, 0x2dc1, 0xc7ce, 0x0cc0, 0xf4d7, 0xfdc1, 0x45ea}},
+        {{0xb1ed, 0xcfcc, 0x4624, 0xb60e, 0x0395, 0xbd5c, 0xc292, 0x59db,
+          0x81c9, 0xdc04, 0x9d1d, 0x31a0, 0xd940, 0x5d56, 0xceea, 0x3f73},
+         {0xd72b, 0x8045, 0x0185, 0x6984, 0x0651, 0xcf2f, 0xfaa2, 0x4c22,
+          0x2dc6, 0x6b22, 0x3665, 0x941a, 0xdade, 0x0362, 0xebc8, 0x5a5e},
+         {0x8dc6, 0x0a4e, 0xbfd1, 0xb7a7, 0xb339, 0x44c9, 0x007e, 0xbe57,
+          0xaefa, 0x1557, 0x207f, 0x60c1, 0x18db, 0x2662, 0x8891, 0x2605}},
+        {{0xe542, 0xc676, 0x8e3c, 0x4c81, 0xccad, 0x03ce, 0x2c93, 0x5e42,
+          0x9f08, 0xb412, 0xccca, 0xec07, 0x43b8, 0xb244, 0xfa10, 0x0ded},
+         {0xff04, 0x8360, 0x04a6, 0x59f7, 0xe6f4, 0x7661, 0x3fde, 0xc3d9,
+          0x3551, 0x1287, 0x2a73, 0x831b, 0x5d57, 0x4e61, 0x0c2e, 0x54ad},
+         {0x522a, 0xb82b, 0x67d5, 0xee3b, 0xc1eb, 0x9fa5, 0x6346, 0x36f1,
+          0x9fd3, 0x6ec1, 0xd2f2, 0xa5b4, 0x9408, 0xa77a, 0xb2ba, 0x62ec}},
+        {{0x2874, 0xafb6, 0x2836, 0x9207, 0x04a5, 0x79e1, 0x5e85, 0x5fcd,
+          0xa14a, 0xc630, 0x01ad, 0x5aad, 0x3f98, 0x7566, 0x3d50, 0x6191},
+         {0x2b3d, 0x6115, 0x7952, 0xe5ed, 0xd7d1, 0x0edd, 0x357d, 0x4962,
+          0x4c71, 0xb96b, 0xc8d0, 0x7482, 0xd8be, 0xa966, 0xf919, 0x2e59},
+         {0x31da, 0x1a32, 0x2d36, 0x0dc6, 0x0270, 0x9420, 0x5832, 0xfa47,
+          0x94ce, 0x3f95, 0x0151, 0x02d8, 0x5d5c, 0x31c0, 0xc2a1, 0x3ddb}}
+    },
+    {
+        {{0xbb14, 0x2796, 0x57a2, 0xf3aa, 0xda21, 0x9b07, 0xbab7, 0x883a,
+          0x391c, 0x31a0, 0xe218, 0xe54b, 0x05f9, 0xd832, 0xfb38, 0x5ee7},
+         {0xc54b, 0xce5e, 0x0ff9, 0x9adc, 0x130d, 0x8c2f, 0x2a6b, 0x039c,
+          0x9515, 0xf0f8, 0x07c7, 0x0280, 0xb36b, 0xac04, 0x8314, 0x7896},
+         {0x6a8e, 0x4144, 0xfdcb, 0x538d, 0x37f9, 0x4349, 0xfda9, 0xa5ac,
+          0x8c78, 0x263c, 0x908d, 0x46af, 0x0d09, 0x9bca, 0x633c, 0x61d0}},
+        {{0x73df, 0xf8fc, 0x28bc, 0xada3, 0x37fc, 0xa6f0, 0x695d, 0xee84,
+          0xa909, 0x38c2, 0xb4db, 0x637f, 0x7bdc, 0xf806, 0xac2d, 0x5b23},
+         {0x2566, 0xffdb, 0x4935, 0x6374, 0x68bb, 0x780b, 0x6b89, 0xc5bd,
+          0xec03, 0x553e, 0x3280, 0x6f1b, 0xd7f5, 0x47ae, 0x5fd8, 0x6e96},
+         {0x527b, 0xee80, 0xb953, 0x9ad2, 0x6d8d, 0xfade, 0x19aa, 0xe88f,
+          0x82cf, 0x150e, 0x1704, 0x0e71, 0xdedc, 0xdd95, 0xbbb9, 0x79b9}},
+        {{0x7374, 0x8e9f, 0x7dae, 0xd199, 0x0816, 0xcfbb, 0xa2f8, 0xa032,
+          0x5f0a, 0x6d44, 0xba12, 0xcd6c, 0xb834, 0x0acc, 0x1146, 0x1ba8},
+         {0x26c2, 0x6a31, 0x5540, 0xebb3, 0xc393, 0x68c8, 0x83a8, 0xd263,
+          0x7a82, 0xe5b9, 0x6429, 0x6c0c, 0x2147, 0xc9fd, 0xf158, 0x5065},
+         {0x9954, 0x0c42, 0x69fb, 0x7081, 0xcf67, 0xd76e, 0x00ac, 0xe146,
+          0x45ba, 0x70e6, 0xb98a, 0x2eaa, 0xfaf2, 0x58a4, 0xf39e, 0x3981}},
+        {{0x6fde, 0x6de6, 0xdfa5, 0xc845, 0x483a, 0x2c40, 0xa500, 0xe152,
+          0xf632, 0xc7b4, 0xe163, 0xe9d2, 0x1b65, 0xdcbc, 0x452e, 0x30f4},
+         {0x0a93, 0x5923, 0x8a75, 0x18fb, 0xf45d, 0x60e6, 0x8f69, 0x1d16,
+          0x3cb5, 0x14a9, 0xa945, 0x3a85, 0xd0fd, 0x05ac, 0x0837, 0x38dc},
+         {0x9740, 0xc575, 0x2782, 0x856d, 0xbecc, 0xf99c, 0x4569, 0xfa13,
+          0x4e71, 0xc0ea, 0xfc73, 0x8844, 0x2469, 0x593f, 0x9a1a, 0x632d}},
+        {{0x84a7, 0xed0c, 0xfd11, 0xbf09, 0x693a, 0x0d9f, 0x7181, 0x63f0,
+          0x8779, 0x57cf, 0x8c2d, 0x2190, 0x4ba2, 0x8af6, 0x7df2, 0x3a5a},
+         {0xcba6, 0xb807, 0x6b15, 0xf6bb, 0xf0d7, 0xbc54, 0xc7df, 0x1823,
+          0x670b, 0x6e29, 0x9703, 0xbb1d, 0x4a57, 0x47ed, 0xf488, 0x0b24},
+         {0xeac7, 0x511b, 0xd4be, 0xdcda, 0xccf2, 0xed26, 0x8075, 0xa453,
+          0x9a65, 0x005f, 0xff9f, 0xe19c, 0x1f63, 0x7548, 0xf744, 0x34fc}},
+        {{0xaa98, 0x78cf, 0x1dab, 0xa5bb, 0x72f2, 0x190b, 0xa267, 0x5ced,
+          0x608e, 0x0a92, 0xc911, 0x9309, 0x74b0, 0x2fb3, 0xa304, 0x0119},
+         {0x67ca, 0x7897, 0xe04c, 0xc197, 0x467d, 0x38d9, 0x4dcb, 0xb871,
+          0x5fa8, 0x83f9, 0x8882, 0x55de, 0x63f7, 0x4dfa, 0xdc16, 0x3d3b},
+         {0x177d, 0xe8c2, 0xd89c, 0x67a2, 0xd0c1, 0x6895, 0xa5f6, 0x669d,
+          0xa2b0, 0xb282, 0x98e5, 0xf565, 0x0a73, 0xede2, 0x88f1, 0x56c0}},
+        {{0x8f02, 0x24f3, 0x5fac, 0x581b, 0x0cbd, 0xbae3, 0xe9fe, 0xa90b,
+          0x92f0, 0x8acf, 0x6902, 0x9a21, 0x038f, 0x8359, 0x7ea4, 0x038b},
+         {0x6e17, 0x10a8, 0x3d11, 0x336d, 0xb2fa, 0x0b75, 0x8832, 0xd7f3,
+          0x2988, 0x2507, 0x3376, 0xf915, 0x8b87, 0x9910, 0x4c6b, 0x0967},
+         {0x6ff8, 0x9931, 0xf821, 0x9f4e, 0x8d4f, 0xeaa7, 0xd282, 0x2f49,
+          0x3174, 0x5aef, 0xa5ab, 0x0971, 0xeb65, 0x5969, 0x3102, 0x6e5e}},
+        {{0x6222, 0x6306, 0xfb0e, 0x3304, 0xba3f, 0x87ac, 0x0689, 0xfb35,
+          0x61a3, 0x8c10, 0x2477, 0xbd19, 0x8620, 0xd183, 0xad43, 0x3058},
+         {0x93fb, 0x87e5, 0x62f5, 0xb16c, 0x3e71, 0xca5d, 0xedde, 0x4999,
+          0x3e6d, 0x14cc, 0xc1e0, 0xb491, 0xdba8, 0x89a8, 0x1147, 0x08f5},
+         {0x63d0, 0xe576, 0x0ffd, 0x323c, 0xa610, 0xa22e, 0xdf38, 0x05c3,
+          0x4f9a, 0xac99, 0x8abd, 0xbdc7, 0xdc99, 0xefe3, 0x9fa4, 0x2654}}
+    },
+    {
+        {{0x666e, 0xaf3f, 0x8549, 0xdb46, 0x0ea5, 0xf14a, 0xcf04, 0xd77f,
+          0x0c47, 0xa4ba, 0x3ff7, 0x3df2, 0x3c85, 0x32ce, 0xdfe1, 0x3a10},
+         {0xf9d6, 0x1e6b, 0x5a46, 0x741d, 0xa581, 0x7777, 0xb3fc, 0x2305,
+          0xd3d9, 0x6474, 0x74a2, 0xd455, 0xe0ff, 0x6401, 0xe1dc, 0x1926},
+         {0xcea0, 0xea17, 0x4e8a, 0xe07f, 0xc1fd, 0x3a1f, 0x1546, 0x2fd5,
+          0xc0f1, 0x31f2, 0x22fd, 0x1753, 0x5d15, 0x861e, 0xd01d, 0x1fa1}},
+        {{0x94ab, 0xd1df, 0xac00, 0x38dc, 0x0de9, 0xd108, 0x2bdd, 0x2e71,
+          0xe262, 0xfdd5, 0xe93e, 0x7f13, 0x01e5, 0xee9a, 0xed18, 0x73fc},
+         {0x9832, 0x7d59, 0x5594, 0xcc80, 0x5520, 0x37f1, 0x56da, 0x1e46,
+          0x9320, 0x4e05, 0xf774, 0x99f6, 0xcf33, 0x6a75, 0x63bc, 0x7735},
+         {0x9cb3, 0x6313, 0xe908, 0x06b1, 0x3ecd, 0xc5a0, 0xda67, 0xa493,
+          0x8932, 0xad63, 0xcec8, 0x8d77, 0x4f44, 0x1b86, 0x6b70, 0x1f42}},
+        {{0x2552, 0x91a1, 0x35c8, 0xf17e, 0x9c76, 0x575e, 0x8153, 0xb76b,
+          0x723e, 0x0d9b, 0x406f, 0xfa83, 0xe438, 0x3fa7, 0xbb1b, 0x0b76},
+         {0x1c01, 0x4191, 0x264c, 0xefc9, 0x2c25, 0x17a2, 0xb7b8, 0xf1a3,
+          0x1447, 0xf30f, 0xda6b, 0x5875, 0xb090, 0x1d31, 0xf527, 0x4e1a},
+         {0x939b, 0x7f92, 0xc1f9, 0x08b8, 0xab6e, 0xd444, 0x71cb, 0xbe67,
+          0x8017, 0x99bb, 0x6463, 0x22e5, 0xa955, 0xb772, 0xd61e, 0x7b6d}},
+        {{0xd2c7, 0xab01, 0xabf9, 0x5730, 0x3b18, 0x4014, 0x76dc, 0x16fb,
+          0xb281, 0xa0cb, 0xbe65, 0x866c, 0x6afe, 0x9bff, 0x9b65, 0x53fa},
+         {0x3d92, 0x50f3, 0xc1e8, 0xb7ad, 0xd5cf, 0x608c, 0xfa4f, 0x7998,
+          0x5bdb, 0x8dfc, 0x2dbd, 0xad96, 0x2f4f, 0xaf1d, 0x9bce, 0x703e},
+         {0x5455, 0x9488, 0xc8e9, 0x6c14, 0xd4e5, 0x65ae, 0x5d66, 0x843a,
+          0x5af1, 0xbcd6, 0xb73e, 0x181b, 0x1f50, 0xc4c6, 0x93e5, 0x398d}},
+        {{0xe3f2, 0xd2e7, 0x7c60, 0xc387, 0x8bb1, 0x3082, 0xaaa0, 0x3b34,
+          0xf138, 0x739e, 0x26e7, 0x283e, 0x0577, 0x02c3, 0x9c90, 0x699c},
+         {0x48f3, 0x33e2, 0xd167, 0x1c4b, 0x0a5f, 0x15bf, 0x1287, 0xbd9e,
+          0x0376, 0xa10b, 0x8cf0, 0xd43f, 0x1b13, 0xdf19, 0x9b5d, 0x53b0},
+         {0xf1cc, 0x5946, 0xa723, 0xf306, 0xd97d, 0xcce5, 0x18b5, 0x9217,
+          0xe975, 0x81b4, 0xd247, 0x28cd, 0xd907, 0x6fcd, 0xf30c, 0x51ca}},
+        {{0x54c7, 0x18ac, 0xf99a, 0x737a, 0xb30f, 0xc51c, 0x78dc, 0x9033,
+          0x0cc7, 0x4ce1, 0xbc33, 0x2b89, 0xe99a, 0x89f8, 0x29c1, 0x12ae},
+         {0xe00a, 0x7674, 0xa742, 0xa60b, 0x7bf3, 0xa17a, 0x8570, 0x630e,
+          0x24cc, 0xcf33, 0x563d, 0x3758, 0xfdaa, 0x2383, 0xaa29, 0x5504},
+         {0x01cf, 0x1f0d, 0xc0cb, 0xa99e, 0xf7ae, 0x3a34, 0xefcc, 0x0dd1,
+          0x4e22, 0xd09c, 0x7521, 0x55ca, 0xa5ea, 0x58eb, 0x4fe9, 0x5fd1}},
+        {{0xcb8e, 0xbf93, 0xfe5e, 0x3c42, 0x565f, 0x36d4, 0xa851, 0xbedf,
+          0x20e8, 0x8842, 0x859e, 0xe0f0, 0xd128, 0x0725, 0x3f96, 0x7dd7},
+         {0xab2c, 0x2845, 0x2ddf, 0xb5dc, 0xe993, 0x0a7f, 0x91b1, 0x0694,
+          0xe346, 0x4002, 0xf3d6, 0x4daa, 0x74d1, 0x5864, 0xf26e, 0x093f},
+         {0x9829, 0x6805, 0x24fe, 0xb10d, 0x23e5, 0xdbaf, 0x0672, 0x7573,
+          0xac29, 0xb457, 0x253a, 0x1367, 0x70a4, 0x86b4, 0xbcbc, 0x2f59}},
+        {{0xc301, 0xb691, 0xd560, 0x7041, 0xe71e, 0xadd7, 0x1b3f, 0x8520,
+          0x5585, 0x1133, 0xe163, 0x16c2, 0x28b1, 0x0108, 0x5e3d, 0x2aa5},
+         {0x135f, 0x9917, 0x7d42, 0x8384, 0x03d7, 0x567d, 0x911f, 0xad1b,
+          0xaad1, 0xbe77, 0x48d9, 0x7e77, 0xaf4a, 0x2e51, 0xb42e, 0x5458},
+         {0x444f, 0x0c07, 0x92e6, 0xed51, 0x1d10, 0x7442, 0x4e2d, 0x42c5,
+          0xc864, 0xfdb5, 0x4c82, 0x352b, 0x8664, 0x8a76, 0x004a, 0x13e9}}
+    },
+    {
+        {{0x877f, 0x193b, 0x00c9, 0xbb2e, 0x506b, 0xe0dc, 0xa890, 0xece3,
+          0x649f, 0x36de, 0xb7c0, 0xecf3, 0x9e1a, 0x98de, 0x0408, 0x5f46},
+         {0xcedb, 0x832f, 0x8845, 0x739d, 0xf863, 0xae6b, 0xd6c9, 0xfa38,
+          0xfef7, 0xb74f, 0x0dca, 0x32bc, 0xe45e, 0x14bc, 0x7e88, 0x7393},
+         {0xf48d, 0x297b, 0x7116, 0xb903, 0x6834, 0xd4f0, 0x3b22, 0xa9d1,
+          0xbdc6, 0x4696, 0x1557, 0xe197, 0xe835, 0x91d5, 0xa4e8, 0x2cf8}},
+        {{0x6ba2, 0x17d0, 0x487e, 0x2cb5, 0x196b, 0x3950, 0x381c, 0x24d2,
+          0x8a30, 0x8597, 0x9c81, 0xd765, 0xa4f6, 0x91d6, 0x7f28, 0x7a6f},
+         {0x0f67, 0x0711, 0xfd87, 0x6d93, 0xb549, 0x7c38, 0x09d3, 0xdd4c,
+          0x6a86, 0xc273, 0x6a4c, 0x7cb1, 0x2a09, 0x5825, 0xbd6e, 0x2049},
+         {0xef49, 0x6a9a, 0xfd8d, 0x7d09, 0xb90b, 0x5b3d, 0x60be, 0xf0ee,
+          0xbfd4, 0x519e, 0xb52c, 0x4c21, 0x941d, 0xc545, 0xaadf, 0x6011}},
+        {{0xf890, 0x02cb, 0xd0c8, 0x63de, 0x6aaa, 0x0dff, 0x98ca, 0xfbd0,
+          0xed99, 0xb9b6, 0x0afd, 0x624d, 0x0b1e, 0x7934, 0x18b7, 0x69ce},
+         {0xf83c, 0xcf95, 0x926d, 0x5f67, 0x9071, 0x7128, 0x8561, 0x7c7e,
+          0x7a5b, 0x998f, 0xe7f3, 0xd6a1, 0xf9e0, 0x0b62, 0xcc1b, 0x6fc5},
+         {0x79cb, 0xb298, 0x5528, 0xd1ef, 0x9092, 0xd47e, 0xae3c, 0xdd1a,
+          0x2352, 0x189f, 0x0442, 0x127e, 0x01f1, 0xe571, 0x6b3a, 0x1559}},
+        {{0x24ca, 0x7e51, 0x3116, 0x09ff, 0x45df, 0xd9c7, 0x158b, 0x0be4,
+          0x56e5, 0x7ef5, 0x7d22, 0x292b, 0xd138, 0xafb6, 0xe241, 0x3aa4},
+         {0x79a2, 0x3f91, 0x39d2, 0x4627, 0xddcf, 0x97d6, 0x1231, 0xff83,
+          0x148a, 0x53f2, 0xdeb5, 0x1307, 0x4dda, 0x7b5f, 0x3768, 0x0d22},
+         {0x05f5, 0x2a33, 0x38bf, 0x2cc1, 0x26c3, 0xa2e9, 0x3f8f, 0x4858,
+          0xd2eb, 0x5549, 0xb1a2, 0x083a, 0xa36c, 0x4687, 0xaa6e, 0x32fc}},
+        {{0xccdf, 0x2787, 0xa473, 0x3207, 0xe3f8, 0xf213, 0x1908, 0x17e3,
+          0x964e, 0xf60d, 0xecd7, 0xd5b2, 0x0be9, 0xc260, 0x6336, 0x746f},
+         {0x9af5, 0xc57d, 0x6e8d, 0x7bc5, 0xbdf2, 0x9df0, 0xd2ed, 0x3e0b,
+          0xe4a3, 0x22ef, 0x14de, 0xaac0, 0x6a5c, 0xfebd, 0xe9ce, 0x4627},
+         {0x971c, 0xab6c, 0xf345, 0x3f4a, 0x731f, 0x9943, 0xeb72, 0xe288,
+          0x186d, 0x0344, 0x6a8a, 0x3359, 0x6293, 0x7ed6, 0x1700, 0x7b49}},
+        {{0xa2dd, 0xdd53, 0x1b28, 0x5434, 0xfc3f, 0xdf42, 0x905b, 0xaa17,
+          0xf8f4, 0x4dd2, 0x92d9, 0x0ff5, 0xd37d, 0xe08c, 0x620f, 0x1d03},
+         {0xb064, 0xab84, 0xfb5c, 0x2d85, 0xbc14, 0x89f3, 0x10d2, 0x4978,
+          0xce0c, 0x7b15, 0xdc44, 0x476a, 0xfd7b, 0xf844, 0xa376, 0x122b},
+         {0xe554, 0xa2b4, 0x32cd, 0xc202, 0x187f, 0x115d, 0xfd42, 0x9ed0,
+          0x79d9, 0x7dd4, 0xb4be, 0x2eab, 0xec4c, 0x2b68, 0x0bf5, 0x02c7}},
+        {{0x72e1, 0x458d, 0x32bf, 0xace5, 0x3cb5, 0x7cb7, 0x68e0, 0x5be7,
+          0xbde7, 0xee8b, 0x7d94, 0x56cf, 0x3a03, 0xfeb4, 0x97e3, 0x6b06},
+         {0x2fbb, 0x5d0b, 0xec4b, 0xa287, 0x82ca, 0x0748, 0x5790, 0x415c,
+          0x815c, 0xc1d0, 0xa61e, 0xe044, 0xf5e0, 0x409e, 0x4f0a, 0x2633},
+         {0xa3c0, 0xdf62, 0xf04a, 0xb6c8, 0xa45d, 0x076d, 0x00ef, 0x3ef0,
+          0xd2a9, 0x49f0, 0xb958, 0x9c9c, 0x2fae, 0x441b, 0x7f43, 0x1cc3}},
+        {{0xaeb9, 0xc9ce, 0x56f1, 0xd766, 0x656a, 0x18e5, 0x15f8, 0x1c5b,
+          0x2334, 0x844c, 0x2832, 0x26e7, 0x6838, 0x2f19, 0x6f77, 0x3a34},
+         {0x324f, 0x5cc7, 0x565a, 0x508f, 0xa922, 0xe506, 0xc4c0, 0xd061,
+          0xac19, 0x5c45, 0xabdb, 0xfb18, 0x314a, 0x0380, 0x09c1, 0x6c68},
+         {0x6ac8, 0xe2da, 0x5112, 0xd2d5, 0x51ed, 0xb1e8, 0x0331, 0xe9bd,
+          0x7262, 0x8ec6, 0x46dd, 0x9607, 0xc5d0, 0x6ef7, 0x1b9f, 0x0591}}
+    },
+    {
+        {{0xeaef, 0x512e, 0xacf3, 0x5349, 0xcb49, 0x1cc1, 0x41d3, 0x20c1,
+          0x688d, 0xa99a, 0x0c07, 0x2418, 0x2d17, 0xc64b, 0xf9d1, 0x555e},
+         {0x0ebb, 0xf5df, 0x9983, 0xc133, 0x4cac, 0x512c, 0x758f, 0xc0f3,
+          0x98e1, 0x0bb3, 0x130a, 0x2cf1, 0x0c62, 0xaa27, 0xecf9, 0x6b3c},
+         {0xbd08, 0x3b73, 0x70ba, 0x36a7, 0xbf0c, 0xa3af, 0xef08, 0x624a,
+          0x46f2, 0xb409, 0xff98, 0x5737, 0x749d, 0x3381, 0x4de1, 0x675f}},
+        {{0xb31d, 0x3bda, 0xf6d9, 0xa12f, 0x2dfe, 0x9d65, 0xd80f, 0x0725,
+          0x9487, 0x9abe, 0x4ff3, 0x019c, 0x3c43, 0x82cd, 0x50b8, 0x60f4},
+         {0x82fc, 0x6b17, 0x5203, 0x0e2c, 0x83b4, 0x6cad, 0x6c81, 0x6481,
+          0x073e, 0x6964, 0xbdd9, 0xd0dc, 0xc520, 0x0164, 0x9df7, 0x13d9},
+         {0xc0ca, 0x21e5, 0x5ec3, 0x014b, 0xbfa2, 0xd719, 0x69c9, 0x4fcb,
+          0x23a0, 0x7500, 0x1c18, 0x4e5f, 0xac80, 0x55ed, 0xde9e, 0x1c06}},
+        {{0x69aa, 0xff6d, 0x2b40, 0xffd5, 0x49bb, 0xdc40, 0x0b18, 0x3453,
+          0x9897, 0xa34d, 0x5c2f, 0x5e4a, 0xba2d, 0x7d32, 0x6f8e, 0x7809},
+         {0xc4e2, 0xa33e, 0x7ad6, 0x990f, 0xe08e, 0xbe2e, 0xf938, 0x6608,
+          0x4515, 0x6328, 0x43c5, 0x9ca1, 0xb60d, 0xec2d, 0x8a1f, 0x4cf3},
+         {0x5ce7, 0x0dfa, 0xaa65, 0xa0aa, 0x478c, 0x48b5, 0x9e2a, 0xf9c4,
+          0x725b, 0x7003, 0xcc7d, 0x4f09, 0x1abe, 0x2609, 0xad3a, 0x373c}},
+        {{0xbbad, 0x89dd, 0xa8fb, 0xf1be, 0xaecb, 0x61ae, 0x2cbc, 0x3bcb,
+          0x8d9d, 0x1f9b, 0xa7bb, 0x8f58, 0xa686, 0x5112, 0x7eda, 0x2154},
+         {0xf57c, 0x82c9, 0x634d, 0xb294, 0x4536, 0x2493, 0xfde1, 0x1fcb,
+          0xdb5a, 0x418c, 0x4db3, 0x9e9c, 0x19fc, 0x4544, 0xf3d9, 0x0040},
+         {0x86d3, 0xfd59, 0xe939, 0xdefd, 0x380c, 0x510a, 0x2c89, 0xf427,
+          0x19b9, 0xbb31, 0xa407, 0xb72b, 0x4df4, 0x4a25, 0x0a33, 0x6355}},
+        {{0x7b49, 0x7254, 0x5845, 0x9bba, 0x08e0, 0xe2c4, 0xc6fa, 0xf305,
+          0xf18d, 0xc734, 0xfa69, 0x60e8, 0x767a, 0xaa7d, 0x2baf, 0x39a9},
+         {0xcf37, 0xb569, 0xd6ed, 0x6507, 0x2ee1, 0x0ca5, 0x29b0, 0x1784,
+          0xd65d, 0xeb6b, 0x0090, 0xea7c, 0x8f51, 0xdaf7, 0x62c7, 0x3eea},
+         {0x274e, 0xe693, 0xc713, 0x9d24, 0xd375, 0x68db, 0x8577, 0x5f63,
+          0xb39a, 0xeb8a, 0x5560, 0x7052, 0xc4cd, 0x65c9, 0x6a06, 0x6843}},
+        {{0x107c, 0xe820, 0xd317, 0x1e56, 0xe965, 0x840a, 0x6844, 0xc526,
+          0xfc7a, 0x320f, 0xa1c6, 0xc1e0, 0x1472, 0x9161, 0x669c, 0x5373},
+         {0x3f27, 0x202f, 0x35e8, 0xbc02, 0x75b0, 0x64f9, 0x00e2, 0xc75c,
+          0x2416, 0xa38c, 0xe9d5, 0x91a4, 0x89f9, 0x8ab7, 0xe7f6, 0x17b6},
+         {0x5257, 0x9a0e, 0x14ab, 0x5d28, 0xb3fc, 0xc9ca, 0x2084, 0x908f,
+          0x1eca, 0x5b2d, 0xf588, 0xafca, 0x7d11, 0x78f8, 0xb5a6, 0x1cb4}},
+        {{0x07e7, 0xa2a0, 0xaa62, 0x6b74, 0xc7b1, 0xf071, 0xe0b0, 0xf311,
+          0xe223, 0x000b, 0xe438, 0x5707, 0x6eac, 0x82ef, 0xfd2d, 0x2dc0},
+         {0xfc6c, 0x394a, 0xc06b, 0xb664, 0x5fb1, 0x98da, 0xde24, 0x0c88,
+          0xd834, 0x4bca, 0x0316, 0x4f8d, 0x34a2, 0xde74, 0xca78, 0x330b},
+         {0x744e, 0x1119, 0xff84, 0x982e, 0x4724, 0x2b07, 0x5e96, 0xf969,
+          0x53fb, 0xbfc9, 0xc14f, 0xc58a, 0x1cf5, 0x369f, 0xbe1b, 0x3c31}},
+        {{0x4272, 0xf9cb, 0xbc93, 0xc168, 0xdb98, 0xc7ce, 0x711f, 0xaeb8,
+          0x8d7a, 0x34ac, 0x52aa, 0x7f0e, 0x55bb, 0x7e7d, 0xc109, 0x41ce},
+         {0x8aee, 0x0894, 0x864d, 0xb0f4, 0x1c6f, 0x91ba, 0x19ee, 0x07dc,
+          0xa158, 0xa6ac, 0xcdae, 0x7975, 0xd4bb, 0x4262, 0x6113, 0x330b},
+         {0x808a, 0xa26d, 0x19d7, 0xf796, 0x156d, 0x1d9e, 0xd49e, 0xbb1f,
+          0xdf27, 0xdba1, 0xc36c, 0x73d7, 0x777d, 0x1f28, 0x4cd9, 0x26b4}}
+    },
+    {
+        {{0x0383, 0x6273, 0xf293, 0xe1b7, 0x8a2c, 0xebca, 0x79ff, 0x4b52,
+          0x1314, 0xbfd4, 0x778a, 0xdafc, 0x610f, 0x9c72, 0x1014, 0x7deb},
+         {0x7475, 0x8f38, 0x4847, 0x51f0, 0xcb3c, 0x9cbe, 0xbcf4, 0xb25d,
+          0x2055, 0xd99f, 0x1244, 0x9aab, 0xa5d6, 0x1c10, 0x9e6c, 0x2c70},
+         {0xee7a, 0x8766, 0xaf6a, 0xcb62, 0xcd0e, 0x5553, 0xec04, 0x66cb,
+          0xe4b5, 0x0f0b, 0x0138, 0x5880, 0xe2ea, 0xf62c, 0x8e9f, 0x08e6}},
+        {{0xf2f9, 0x0ab8, 0x09d5, 0x2f2d, 0x23df, 0xc559, 0x218d, 0xacb9,
+          0x6cb9, 0x7376, 0x3426, 0x4a8f, 0x19f5, 0x38f7, 0x3bd7, 0x4cb1},
+         {0x30ad, 0x4bc1, 0x500a, 0x34ad, 0xd49c, 0x3d0b, 0xdb49, 0x8d38,
+          0x89be, 0x500a, 0x3d98, 0xa25c, 0x3b09, 0xeeba, 0x3f87, 0x2f1f},
+         {0xb64a, 0xe515, 0x8c75, 0xf784, 0x9038, 0xdb4a, 0x01ba, 0xa595,
+          0x1b50, 0x3f75, 0x313f, 0xc20d, 0x2ee8, 0xc0ae, 0xe353, 0x19a1}},
+        {{0xbdbd, 0xd596, 0x72cd, 0xb421, 0xfc40, 0x98ee, 0x4543, 0x93e0,
+          0x09b5, 0xb441, 0x5347, 0x9fb1, 0xae34, 0x0266, 0xd399, 0x736b},
+         {0x05c3, 0xbafa, 0x7560, 0x7d1c, 0x5e61, 0xc6e5, 0xa0a0, 0xb3e1,
+          0x6473, 0xc0d6, 0x9718, 0xe352, 0x3486, 0xc20c, 0x6b11, 0x4154},
+         {0xb3b4, 0x9334, 0x2d50, 0x8553, 0x6573, 0x6081, 0x114b, 0x46fd,
+          0x8375, 0x425c, 0x5f30, 0xcc5f, 0xab5c, 0xb87f, 0x95a2, 0x4122}},
+        {{0xeac6, 0xe293, 0x5261, 0x2e65, 0xacdb, 0x2133, 0x9203, 0x845a,
+          0x996b, 0x7900, 0x75cb, 0x4609, 0xdd80, 0x195a, 0xbb8d, 0x0760},
+         {0xd6e9, 0xf57e, 0x9b88, 0x19c9, 0xc825, 0x6df8, 0xcb26, 0x5393,
+          0xd273, 0xb30a, 0x3213, 0x5cee, 0x2e34, 0xb52d, 0x53eb, 0x14e1},
+         {0x818a, 0xcde6, 0x1a17, 0x413e, 0xa084, 0xed69, 0x6da9, 0x5715,
+          0xccb1, 0x46ca, 0x268f, 0x2cbf, 0xc5f2, 0xc33a, 0xbe9b, 0x6b34}},
+        {{0xf2d3, 0x6571, 0x6965, 0x11fc, 0x737a, 0x530e, 0xe845, 0xc6c9,
+          0x5035, 0xd4fe, 0xe7a2, 0xe33a, 0xd30b, 0x2e6d, 0xc7b6, 0x01b9},
+         {0xc0b2, 0x3a78, 0x2f64, 0xf3df, 0x027c, 0xf22e, 0x971e, 0x4c3e,
+          0xb5a3, 0x49c1, 0x1c5e, 0xec7d, 0xdd2d, 0x0922, 0xc18f, 0x2012},
+         {0x9d29, 0x5ac8, 0x55e5, 0x880b, 0xa763, 0x45a0, 0x241f, 0x1483,
+          0x6c1f, 0xc2e7, 0xefdf, 0x3d36, 0xade8, 0x4e4b, 0x5b78, 0x08af}},
+        {{0x2c4b, 0x89cc, 0x14d2, 0xe273, 0x178d, 0xa287, 0xbd11, 0x4be4,
+          0x64ce, 0xfa33, 0x28d6, 0x18d5, 0x826e, 0xafd9, 0xc1d5, 0x6423},
+         {0x2533, 0x881f, 0x99dc, 0x2834, 0x23b6, 0x7793, 0x25da, 0x9d05,
+          0x41f4, 0x6734, 0xddfb, 0x897a, 0x168d, 0x163a, 0x9d71, 0x32b7},
+         {0xb36a, 0xedfc, 0xf8d9, 0xcc85, 0xe5f9, 0x3746, 0xc28f, 0x22bc,
+          0xd3cd, 0xf9e5, 0xe338, 0xe49d, 0x2dcc, 0xc13e, 0x5efb, 0x480a}},
+        {{0x221f, 0x42ce, 0x4ce4, 0xb661, 0x3928, 0x4c05, 0x9dcc, 0x6e19,
+          0xbe03, 0xdc1c, 0xb4a4, 0x663f, 0x8e06, 0x691c, 0x1d47, 0x24b3},
+         {0x2071, 0x0162, 0xe70b, 0x0b51, 0xafc5, 0x8b1d, 0x05cf, 0x06b5,
+          0xabcd, 0xef5a, 0xb061, 0x2c6b, 0xbf31, 0x0cb7, 0x2760, 0x47aa},
+         {0xf8c3, 0xc015, 0x1eed, 0x2a54, 0x3f7c, 0x7c69, 0xfe7e, 0x11a4,
+          0x78d6, 0x4ea2, 0x6613, 0xf0af, 0xa094, 0x14dd, 0x585d, 0x545b}},
+        {{0x21e1, 0xe3b3, 0xe4d0, 0x6204, 0x1e95, 0x28ff, 0x637a, 0x3baa,
+          0xbd9e, 0x5b99, 0xcffd, 0x0b0c, 0xd071, 0x64c8, 0xdc3e, 0x4d22},
+         {0x3a0f, 0xa0d4, 0x275e, 0x67bf, 0xeebe, 0x089b, 0x8e34, 0xade6,
+          0xe72e, 0xd479, 0x134c, 0x4289, 0x5454, 0x32ba, 0xf9c3, 0x0f62},
+         {0x5f39, 0xd63b, 0x6589, 0xfcb4, 0xcf61, 0x57cb, 0x6a3f, 0x5cae,
+          0xfa05, 0x953a, 0xc2d2, 0xfeba, 0x1436, 0x3637, 0xa01a, 0x1c0f}}
+    },
+    {
+        {{0x6a50, 0x8c93, 0x2b0e, 0x6908, 0xc5b6, 0xc1da, 0xa035, 0xf9c9,
+          0xb634, 0xc4df, 0x3e54, 0x6fb7, 0xc140, 0x1d2b, 0x419b, 0x4005},
+         {0x3dff, 0x2294, 0x04b6, 0xd2c6, 0xb3a0, 0x44cf, 0xbece, 0xbc8c,
+          0x8678, 0x9780, 0x4ff3, 0x5d25, 0xa6bf, 0x3b1c, 0x614f, 0x0fa3},
+         {0x82f0, 0xb9be, 0xfebd, 0xa003, 0xac90, 0x3a44, 0xc1af, 0x2089,
+          0xfa8e, 0x1954, 0x9f91, 0xf849, 0xab42, 0xef40, 0x218a, 0x1fba}},
+        {{0x0194, 0x3e7b, 0x5704, 0x4f3e, 0xaf7f, 0x08da, 0x3eee, 0xa81d,
+          0xdef1, 0x99dc, 0xc6ab, 0xc839, 0x61d5, 0xff77, 0x5d13, 0x6c53},
+         {0xf53e, 0xfac8, 0x9448, 0xab54, 0x3741, 0x7ba6, 0xe89a, 0x81f6,
+          0x5e01, 0x6c2b, 0x6c7d, 0x74fd, 0x6e42, 0xa8c8, 0x3aca, 0x392e},
+         {0x35af, 0x3e8a, 0x34e9, 0x4cbd, 0xe816, 0x5887, 0x8144, 0x2e07,
+          0xb0ab, 0xf29a, 0x9c76, 0x1931, 0xc13b, 0xd50a, 0x7fe4, 0x25e1}},
+        {{0x21a7, 0x76f1, 0x7ff5, 0x915f, 0x87e3, 0x2fcd, 0x3227, 0xc34a,
+          0xe526, 0x4d1b, 0x2fde, 0xccba, 0x899b, 0x8969, 0x828f, 0x6bba},
+         {0xf676, 0x1e04, 0x9bd7, 0x0a28, 0x0f95, 0xd642, 0x1c52, 0x208e,
+          0x1fab, 0x3469, 0xd8b0, 0x5186, 0xb351, 0x2a9f, 0x5144, 0x2557},
+         {0x3901, 0x90fe, 0xbc66, 0xe2d1, 0x7ad5, 0xa099, 0x4a18, 0x4cb5,
+          0x60d4, 0xaf84, 0x6914, 0x971d, 0x7be4, 0x7f6b, 0x504f, 0x559d}},
+        {{0x66fd, 0xf6d2, 0x91e7, 0x9c48, 0x781b, 0x0307, 0xa19b, 0x0744,
+          0xe23b, 0x6061, 0x8f1d, 0x8838, 0xd50e, 0x354b, 0xa6a3, 0x123e},
+         {0x54d5, 0xb3eb, 0x8378, 0xa773, 0x3c7c, 0xa555, 0xd366, 0x1d69,
+          0x00ba, 0xf928, 0xcf62, 0x0a26, 0x3217, 0x807e, 0x12d5, 0x01ab},
+         {0x2d96, 0x41e3, 0x1890, 0x118d, 0x5848, 0xd831, 0xe3c2, 0xb9ed,
+          0x45d9, 0xd832, 0x4271, 0x1eab, 0xa154, 0xc918, 0x61e2, 0x4a39}},
+        {{0x3f1e, 0xf323, 0xd644, 0x0327, 0xf016, 0x34fc, 0x260e, 0x499a,
+          0xb979, 0xf2da, 0xa716, 0x83b5, 0x111f, 0x9bd4, 0xeead, 0x68ac},
+         {0xbba0, 0xf8e6, 0x3be0, 0x71dc, 0xe30a, 0x7eff, 0xf834, 0xd6ce,
+          0x476a, 0xe13a, 0x425f, 0xa992, 0xb763, 0xfb1d, 0xbce3, 0x2cd6},
+         {0xc210, 0xf3d7, 0xc90e, 0x38b4, 0x040c, 0xb7ad, 0x6e24, 0x308e,
+          0x3e23, 0xb7e7, 0xd9f1, 0x3860, 0xf597, 0xb508, 0x60d5, 0x5957}},
+        {{0x2790, 0xfd02, 0xcbeb, 0x882a, 0x5760, 0xc411, 0x3305, 0x89af,
+          0x73f4, 0x7d34, 0x92e3, 0x65f4, 0x5a2b, 0x5451, 0xc5df, 0x2cb2},
+         {0x6397, 0x04aa, 0xbfe1, 0x6129, 0xfccb, 0xa4a7, 0x0008, 0x8f96,
+          0x9458, 0x7d90, 0xc089, 0x3f8b, 0x91a9, 0xdcb2, 0xa43e, 0x709f},
+         {0x2aca, 0x63fd, 0x5d8c, 0xeb0a, 0x4eff, 0x2e69, 0xc166, 0xd22b,
+          0xb03a, 0xf8cb, 0xf36e, 0x2723, 0x131f, 0xf0c8, 0x29ec, 0x70f0}},
+        {{0xb0b9, 0x5e10, 0xafaa, 0x2a6a, 0x1aa9, 0xef04, 0xa370, 0x78f0,
+          0xd61f, 0xaa3a, 0xfb77, 0x773e, 0xd9e1, 0xa74b, 0xa5a2, 0x44ec},
+         {0x3e33, 0x2eed, 0x07b3, 0x4613, 0x81e7, 0xa455, 0x2f33, 0xae04,
+          0x0366, 0x195f, 0x49d3, 0xc944, 0x4858, 0x6c31, 0x5d8a, 0x0b7d},
+         {0xd543, 0x7b95, 0x4832, 0x25d4, 0x0f1d, 0xa334, 0x8300, 0x70d3,
+          0xc52b, 0x60e1, 0x531c, 0xde1c, 0xe9e4, 0x2c7d, 0x2451, 0x2722}},
+        {{0x75fc, 0x42a9, 0xbb8a, 0xbf7b, 0xa358, 0x96ad, 0x3977, 0x8c5c,
+          0xaa48, 0xcded, 0xc76f, 0xe27f, 0x20a6, 0xf6bc, 0x5fd7, 0x1973},
+         {0x342e, 0x49c5, 0x92af, 0x1abc, 0xfad0, 0xb2e6, 0xd811, 0xffee,
+          0x4e29, 0xfcc8, 0x8c8d, 0xefa2, 0xc543, 0xa44c, 0xdf18, 0x11b5},
+         {0x4266, 0x42c8, 0x90d0, 0xe3ab, 0x547e, 0x7f19, 0x8e0f, 0xeb84,
+          0x97b9, 0x65a4, 0xa1d0, 0x2503, 0x895f, 0x91df, 0x9111, 0x0fef}}
+    }
+};
+
+/* base_odd[i] = (2 * i + 1) * B */
+
+static const uint16_t base_odd[32][3][16] = {
+    {{0x3b85, 0xf58c, 0x93c6, 0x2fbc, 0x0e19, 0xfb8c, 0x2dc6, 0xcf93,
+      0x42c2, 0x643d, 0x4898, 0x270b, 0xba65, 0x33d4, 0x9d3a, 0x07cf},
+     {0x913e, 0xd740, 0x3905, 0x9d10, 0xbeb3, 0xd140, 0x9f05, 0xfd39,
+      0x8a09, 0x688f, 0x8434, 0xa5c1, 0x1267, 0x98f8, 0x2f92, 0x44fd},
+     {0xaa68, 0x877a, 0x1205, 0xabc9, 0xc49e, 0xccaa, 0xe823, 0x26d9,
+      0x598c, 0xdd43, 0x7dcb, 0x5a1b, 0x65a8, 0x9f0c, 0x7b68, 0x6f11}},
+    {{0x9730, 0x4cee, 0xb0a8, 0xaf25, 0x4b8a, 0xe886, 0x8430, 0x025a,
+      0x6732, 0x9f01, 0x5002, 0xc11b, 0xf8f4, 0x9a80, 0x4e1b, 0x7a16},
+     {0xd265, 0xa4fc, 0x1fe8, 0x5661, 0xba7d, 0xe5c1, 0x53fd, 0x3bd3,
+      0xd6bd, 0x214b, 0xf31a, 0x8131, 0xda62, 0x555b, 0x1587, 0x2ab9},
+     {0xd889, 0x0dd0, 0x933f, 0x14ae, 0xda62, 0x1c35, 0x2322, 0x5894,
+      0xdb4c, 0x8cf2, 0xe545, 0xd170, 0xb4c6, 0x12b9, 0x26af, 0x5a28}},
+    {{0xbb33, 0x08a5, 0xbc44, 0xa212, 0xed02, 0xc75e, 0x48c3, 0x8d50,
+      0xec44, 0x5abf, 0xeb0c, 0xdd1b, 0x06eb, 0x46e2, 0xccf1, 0x2945},
+     {0xd6ba, 0xa447, 0x82c3, 0x7f91, 0x29b7, 0x4b27, 0x14d1, 0xd500,
+      0xa087, 0xb864, 0xf11c, 0xe33c, 0x55f3, 0xeb1b, 0x7e73, 0x154a},
+     {0x8285, 0x812a, 0xdbf1, 0xbcbb, 0xd1fc, 0xd0bd, 0x0807, 0x270e,
+      0xa72d, 0x1bbd, 0x670b, 0xb41b, 0xb69a, 0x6b3b, 0xbe69, 0x43aa}},
+    {{0xa3bf, 0x944e, 0x5cd0, 0x6b1a, 0xc0d2, 0xb39d, 0x353a, 0x7470,
+      0x2e49, 0x2854, 0x5282, 0x71b2, 0x927e, 0x283c, 0xea69, 0x461b},
+     {0x21b1, 0xaa32, 0x2c9a, 0xba6f, 0x23a7, 0x3bba, 0x2153, 0x6ca0,
+      0x2c3a, 0x9219, 0x764f, 0x9dea, 0x17e0, 0x2e53, 0xdd5d, 0x1d6e},
+     {0xb3a2, 0x01b8, 0x6dc8, 0xf183, 0xa49a, 0x053e, 0x5f47, 0xb303,
+      0xadf3, 0x5877, 0x41ba, 0x529c, 0x90a7, 0x6a0f, 0xbb1c, 0x7a9f}},
+    {{0x632f, 0xa6a8, 0x678a, 0x9b2e, 0x46c5, 0x51bc, 0x9e6f, 0xa650,
+      0xf5b5, 0xc686, 0x33c9, 0xceb2, 0x7f59, 0x8add, 0xed33, 0x34b9},
+     {0x8064, 0x039d, 0x217e, 0xf36e, 0x419b, 0xf520, 0x81b6, 0x98a0,
+      0xb044, 0xe75e, 0xc608, 0x96cb, 0x9c8f, 0xfadc, 0x5a51, 0x49c0},
+     {0xaf1b, 0x9045, 0xe8bf, 0x06b4, 0xd22f, 0xa719, 0x83e8, 0xe2ff,
+      0xcf16, 0x93d4, 0xfc29, 0xaaf6, 0x8b06, 0x1b00, 0x7202, 0x73c1}},
+    {{0x2ade, 0x8a80, 0x0084, 0x2fbf, 0x2e27, 0x0230, 0xfecf, 0xe5d9,
+      0x3406, 0x1770, 0x8471, 0x113e, 0x8faf, 0x546d, 0xaae2, 0x4275},
+     {0x4348, 0x4986, 0x5b02, 0x315f, 0x8381, 0x7708, 0xb369, 0x3ed6,
+      0xeb95, 0x6a8d, 0x7555, 0xa3a0, 0xc77f, 0x29d5, 0x5980, 0x18ab},
+     {0x89e9, 0xfd60, 0x2cc5, 0xd82b, 0xe4a4, 0x3282, 0xb4a1, 0x031e,
+      0x8622, 0xb51a, 0x1199, 0x4431, 0xf948, 0xb53d, 0x5522, 0x3dc6}},
+    {{0x7f6d, 0xa200, 0xc222, 0xbf70, 0xdedb, 0xb5bc, 0xb39a, 0xbf84,
+      0xba07, 0xfb07, 0x0e12, 0x537a, 0xf241, 0xc346, 0xd7ee, 0x234f},
+     {0xbf93, 0x327f, 0x013b, 0x506f, 0x6f6b, 0x9b77, 0xebc9, 0xaefc,
+      0x5968, 0xaaad, 0xb232, 0x9d12, 0x24a7, 0x1760, 0x882d, 0x0267},
+     {0xa378, 0x732e, 0xa119, 0x5360, 0xd471, 0xdf8d, 0xe6b1, 0x2437,
+      0xe533, 0x91a7, 0x37f8, 0xa2ef, 0x7863, 0xaa09, 0xa6fd, 0x497b}},
+    {{0xeaa0, 0x13cf, 0xcc03, 0x24ce, 0x246d, 0x189c, 0xc28d, 0x8648,
+      0xd4d0, 0xc1f2, 0xbdfa, 0x2dbd, 0xe72b, 0xf12d, 0x2917, 0x61e2},
+     {0xcf0b, 0x468c, 0xcd86, 0x040b, 0x10d6, 0x2a99, 0x9ba4, 0xd382,
+      0x5192, 0x07b2, 0x3008, 0x7508, 0x5ebf, 0x18d0, 0xcd42, 0x43b5},
+     {0xb516, 0x9bd0, 0x762f, 0x5d9a, 0xdeee, 0x373f, 0xaf4e, 0xeb38,
+      0x4270, 0x93d6, 0x5a7d, 0x032e, 0xd842, 0x0ae4, 0x6121, 0x511d}},
+    {{0x9d81, 0x950e, 0x76ef, 0x92c6, 0x044f, 0xc0d7, 0x20cd, 0xa546,
+      0x1248, 0x6f8f, 0x3664, 0xaa9b, 0x55e3, 0xddb8, 0x5924, 0x6d32},
+     {0xde87, 0x4420, 0x8648, 0x0813, 0xedb4, 0xb592, 0xf016, 0x8a1c,
+      0x2d25, 0x2994, 0x4e27, 0x39fa, 0x2810, 0xe248, 0xfe6f, 0x71a7},
+     {0xc854, 0xa5c8, 0x82b8, 0x6c71, 0x2a03, 0xfe5f, 0x1479, 0x33fd,
+      0x8d0c, 0x8377, 0x5918, 0x72cf, 0xeaa9, 0x559e, 0xc4b6, 0x4746}},
+    {{0x9a2b, 0x6dc6, 0x7b3c, 0xd377, 0xf617, 0x6f89, 0xb227, 0xdefa,
+      0x16b5, 0xb53a, 0x1cf7, 0x4565, 0x9fb7, 0x34fe, 0x51de, 0x5c9a},
+     {0x1147, 0x6474, 0x46c8, 0x3485, 0xc849, 0x0efc, 0xaedd, 0x7d35,
+      0xa332, 0x0672, 0x9a76, 0xff93, 0xe6d6, 0x7db5, 0x6349, 0x2196},
+     {0x0e67, 0x79f1, 0xf1cf, 0xf510, 0x515b, 0xe658, 0xdaa1, 0xffdd,
+      0x2277, 0x1014, 0xa717, 0x09c3, 0x23bb, 0x6082, 0x503c, 0x4804}},
+    {{0x7fc7, 0x2ca3, 0x9ed0, 0xc424, 0xacab, 0xa615, 0xa0e3, 0xa059,
+      0x0e23, 0xc96e, 0x6ed7, 0x88a9, 0x696d, 0x1650, 0x98a5, 0x5533},
+     {0xd175, 0x3a36, 0x21d2, 0x3b68, 0x9e32, 0xe99b, 0x0aa7, 0xbbb4,
+      0x8a47, 0x2083, 0x5ce4, 0x5d9e, 0x4c5e, 0x58de, 0x0988, 0x771e},
+     {0x1edf, 0x7845, 0xf5d2, 0x9a12, 0x9ccb, 0x8589, 0x5d79, 0x3ada,
+      0x9508, 0x9fa5, 0x4a2d, 0x477f, 0xa611, 0x8ff5, 0xd1d6, 0x5a5e}},
+    {{0x0e83, 0xfe15, 0x122a, 0x1195, 0x35d8, 0x7e4b, 0x9a25, 0xcf20,
+      0x1e20, 0x1e71, 0xf829, 0x7387, 0x92f0, 0xd8bf, 0xb897, 0x44ac},
+     {0x7359, 0x5852, 0xe0c5, 0xbae5, 0x9d7e, 0xcadb, 0x5c19, 0x392e,
+      0xabe9, 0xda1c, 0x3c1e, 0x2865, 0xdc44, 0x5fef, 0x6013, 0x019b},
+     {0x4b83, 0x5e13, 0x6814, 0x1e60, 0x4c16, 0x2430, 0xe64f, 0xc4f5,
+      0x3ed7, 0xfc1a, 0x88a8, 0x506e, 0x2f92, 0xe6ad, 0x49fd, 0x150c}},
+    {{0x1138, 0x0947, 0xf295, 0x8e7b, 0xa651, 0x4f75, 0xef39, 0x5d6f,
+      0x08ad, 0x25a7, 0x79c4, 0x10af, 0x9922, 0x5bb9, 0x5a07, 0x6b2b},
+     {0xa868, 0x9cdc, 0x863c, 0xb849, 0x4ad0, 0xb871, 0x44db, 0xc83f,
+      0x168d, 0x0c36, 0xe356, 0xfe3e, 0xfbc1, 0x1e05, 0xd779, 0x78a6},
+     {0xb976, 0x47a0, 0x704b, 0x58bf, 0x48d5, 0x7417, 0xb355, 0xa601,
+      0xf590, 0xd542, 0x1fb1, 0xaa2b, 0x5d00, 0x4ad5, 0x7ffc, 0x725c}},
+    {{0x99b2, 0xd1cf, 0x6715, 0xe442, 0x0d34, 0x02a2, 0xd511, 0x7352,
+      0x109f, 0x8b12, 0x157b, 0x23d1, 0xf3a3, 0x7cb1, 0xc927, 0x794c},
+     {0x98c0, 0x1cd0, 0x2bf7, 0x9180, 0x6366, 0xed5e, 0x6ca4, 0xfe41,
+      0x994c, 0x4902, 0x5d71, 0xdf58, 0xfae7, 0xf855, 0x4625, 0x4cd5},
+     {0x5053, 0xc2ac, 0xc426, 0x4af6, 0x7258, 0x32f6, 0xedad, 0xbc9a,
+      0x1021, 0x0a31, 0x32f1, 0x2ad0, 0x8e85, 0x6fcc, 0x357b, 0x7008}},
+    {{0x3f01, 0x3877, 0x6727, 0x0b88, 0xccfb, 0x95fb, 0xc8fa, 0xb8cc,
+      0x29b6, 0xb9ad, 0xd5a3, 0x8d2d, 0x0f6a, 0x51ad, 0x7e98, 0x06ef},
+     {0x4a34, 0x8258, 0x9fbb, 0xd01b, 0x792b, 0xd2b4, 0x6463, 0x47ab,
+      0x6202, 0x4853, 0x639c, 0xb631, 0xd428, 0x69d6, 0x2a36, 0x13a9},
+     {0x7de5, 0xc057, 0x771c, 0xca93, 0xdc5c, 0x5035, 0xe41e, 0x7540,
+      0xe071, 0xd802, 0x0f01, 0x2468, 0xf86a, 0x8a2a, 0x6ddf, 0x3c29}},
+    {{0xa713, 0xd914, 0x15f9, 0xaead, 0xf912, 0x8c8f, 0x7bf9, 0xa92f,
+      0xd730, 0x9f53, 0x2317, 0xaff8, 0x77ba, 0x490c, 0xd393, 0x7a99},
+     {0x2541, 0xbb1f, 0x4d2e, 0xfceb, 0xb91f, 0x40ad, 0x10c7, 0xb895,
+      0xad05, 0xd0a1, 0xa37d, 0xfc71, 0x717b, 0x0747, 0x2c70, 0x0a89},
+     {0xa3e8, 0x36bd, 0xed24, 0x8f52, 0x0794, 0x57e8, 0xc841, 0x77a8,
+      0x9ce0, 0x262f, 0x6563, 0xa5a9, 0xf7d2, 0x8302, 0x62d2, 0x2867}},
+    {{0x5b25, 0x3ce3, 0x3609, 0x4e78, 0xaa97, 0xb26b, 0x181d, 0x82e1,
+      0xb83f, 0xcbc7, 0x92d3, 0x0cc1, 0x9d3a, 0x6a9d, 0xda04, 0x32f1},
+     {0xf5bd, 0xce2e, 0x8e2b, 0x7c55, 0xbc63, 0x6747, 0x6cb4, 0xe498,
+      0x89b8, 0x3bbb, 0x179f, 0x154a, 0x767a, 0xd6f1, 0xf2a3, 0x7686},
+     {0x7c6a, 0x6d59, 0x12a6, 0xaa8d, 0x852b, 0x04d3, 0x9303, 0x8f11,
+      0xb022, 0xc209, 0xdc73, 0x3f91, 0x28a6, 0xa9ad, 0x05f8, 0x5613}},
+    {{0xaed1, 0xec92, 0x978d, 0x100c, 0x73e5, 0x4d6d, 0xd543, 0xca43,
+      0xba48, 0xd847, 0x1b22, 0x8313, 0x4d2c, 0xe35d, 0xec53, 0x00aa},
+     {0xc0d5, 0xe7b0, 0xcc28, 0x6722, 0x5c53, 0xdb07, 0xe9bb, 0x709d,
+      0x0a61, 0xd701, 0x8da7, 0xcaf6, 0xcc6c, 0x2c57, 0x1aef, 0x030a},
+     {0xd2aa, 0x003a, 0xf773, 0x7bb1, 0x6608, 0x2b21, 0x2980, 0x0b3f,
+      0xd23e, 0x520e, 0xdc86, 0x7821, 0x5480, 0x2406, 0x9c1c, 0x20be}},
+    {{0x73a6, 0x2496, 0x87d8, 0xe153, 0xe493, 0xf546, 0xbc2d, 0x5943,
+      0x63b5, 0xc36f, 0x9a81, 0x1c7f, 0xc1de, 0x1f0a, 0xb336, 0x750a},
+     {0x5e60, 0xe202, 0xe44a, 0x20e0, 0xb938, 0xcbdc, 0x3b2f, 0xb03b,
+      0x0d1c, 0xf95a, 0x639c, 0x105d, 0xe311, 0x5067, 0x4c54, 0x6976},
+     {0x1037, 0xa2f8, 0x3283, 0x1e8a, 0xcbf1, 0xbd7f, 0xda23, 0x6f2e,
+      0x2563, 0xac2e, 0xd15b, 0xb72f, 0x5040, 0xb707, 0x6b3f, 0x54f9}},
+    {{0x9279, 0x2966, 0xf204, 0x0fad, 0x724a, 0x7d7d, 0xa204, 0x3add,
+      0x60f1, 0x8c57, 0x9482, 0x6f3d, 0x539e, 0x2bb7, 0xe9c5, 0x3d7f},
+     {0x1ecd, 0x16b1, 0xafc6, 0x177d, 0x6479, 0xfa57, 0x4b9c, 0x8976,
+      0xe785, 0xe6ec, 0xa110, 0xb7a8, 0xdbf0, 0xbe85, 0x839f, 0x78e6},
+     {0x856b, 0x37b8, 0x2df7, 0x7033, 0x178a, 0x041a, 0x5d43, 0x75d0,
+      0x9e22, 0xa0e5, 0xf74a, 0x320f, 0x8242, 0x5008, 0x68f3, 0x70f2}},
+    {{0x5f47, 0xb180, 0x4583, 0x6686, 0x7c19, 0x60dd, 0xc5d1, 0xf535,
+      0xb006, 0x1e4c, 0x4eb7, 0xe987, 0x89d9, 0xfad8, 0x345c, 0x7c0d},
+     {0xf355, 0x70dc, 0x1120, 0x2324, 0xe117, 0xe7fc, 0xc97e, 0x380c,
+      0xb698, 0x3552, 0xdeed, 0xb31d, 0xc4b9, 0x39b8, 0x56c0, 0x404e},
+     {0x338a, 0x8c78, 0x1f4b, 0x591f, 0xb5e1, 0x67e0, 0x6ab1, 0xa036,
+      0x3d44, 0xb45f, 0x4152, 0x5cbc, 0xc777, 0x2aae, 0x5476, 0x20d7}},
+    {{0xb758, 0xc73b, 0xc36f, 0x5e8f, 0xbb9a, 0x363c, 0x43a5, 0xace5,
+      0xc922, 0x903b, 0x4a7d, 0xa993, 0xec62, 0xf3ce, 0x1e46, 0x2b8f},
+     {0xf543, 0x35b9, 0xfeb1, 0x9d74, 0x956c, 0xde8c, 0x7df1, 0x84b3,
+      0x8ba9, 0x5713, 0x2b07, 0xe932, 0x4ce1, 0x790b, 0xada8, 0x38b8},
+     {0xf95d, 0xdf51, 0x4a9c, 0xb5c0, 0xdeac, 0xcb1f, 0x52ae, 0x2b39,
+      0x66da, 0x328b, 0x6d8b, 0x1d10, 0x1953, 0xceba, 0xeb32, 0x049a}},
+    {{0x7931, 0x75fc, 0x7d0b, 0xaa50, 0x25d3, 0x7a67, 0x924b, 0x0fef,
+      0x3930, 0x396b, 0x542b, 0x1d82, 0x74fc, 0x30f6, 0xe175, 0x795e},
+     {0xfe7e, 0x63dc, 0x7d3c, 0xd776, 0x6e40, 0x9785, 0x5948, 0x209c,
+      0x7c13, 0xe14f, 0x6861, 0xb667, 0x25fc, 0xc8d6, 0x65e0, 0x51c6},
+     {0xbd81, 0x52ec, 0x5b0a, 0x254a, 0xafe7, 0xe034, 0x1f6e, 0x5d41,
+      0x4a31, 0xcaee, 0x4d0d, 0xe6a2, 0x4477, 0x9dc5, 0x9bf4, 0x6cd1}},
+    {{0xc386, 0x65af, 0x6121, 0x1ffe, 0x1b10, 0xb8d5, 0x2a88, 0x082a,
+      0x0baa, 0x2099, 0x627e, 0x76f6, 0x43e7, 0x429e, 0xb3a7, 0x5e01},
+     {0x9ca3, 0x5217, 0x6190, 0x7e87, 0x9f85, 0x0b2c, 0x0a06, 0x571d,
+      0x711e, 0x8499, 0xbaa8, 0x80a2, 0xe638, 0x40b2, 0xf3db, 0x7520},
+     {0x57a1, 0xd393, 0x0be3, 0x3db5, 0x94a5, 0x599e, 0x6cdd, 0x967b,
+      0x1e6e, 0xdf31, 0x9a64, 0x1a30, 0xc986, 0xcef3, 0x2c9c, 0x7109}},
+    {{0x1dcf, 0x7405, 0xd8ac, 0x856b, 0xaa1e, 0x55b7, 0xa408, 0x03f6,
+      0x3ceb, 0xc974, 0xe7cb, 0x3a4a, 0xabde, 0x7137, 0xa5bb, 0x4173},
+     {0x918c, 0x0364, 0x523f, 0x53d8, 0x6b1c, 0x3fab, 0x04f4, 0xa2b4,
+      0xe5a4, 0x6681, 0x4a9e, 0x080b, 0x7ba7, 0xd025, 0x5b03, 0x0ea1},
+     {0x218a, 0xf0f9, 0x6e31, 0x17c5, 0x4708, 0x1afc, 0x6e2b, 0x5a69,
+      0xf176, 0xf4b2, 0x1668, 0xf793, 0x3a67, 0x4a4e, 0x6561, 0x5fc5}},
+    {{0x988e, 0x7790, 0xe1e6, 0x4892, 0xd722, 0x1c5c, 0x950f, 0x01d5,
+      0x3eed, 0xe592, 0x819a, 0xe3b0, 0x651b, 0x9d46, 0xc740, 0x3214},
+     {0x7ae5, 0xc46d, 0x570d, 0x136e, 0xdc8f, 0x54f8, 0xaacc, 0x0fd0,
+      0xad86, 0x310d, 0x9f03, 0x5954, 0x4aa1, 0x4c45, 0x1c41, 0x6271},
+     {0x1770, 0x0665, 0x8274, 0x1329, 0x9436, 0x8a27, 0xa066, 0x3ba4,
+      0x223c, 0x185d, 0xb8ec, 0xd9b6, 0x833c, 0x3ecb, 0x9407, 0x5bea}},
+    {{0xd2f8, 0xf343, 0xce63, 0xb470, 0xe8f1, 0x0543, 0xba8f, 0x0067,
+      0x7b6f, 0xa211, 0x51a1, 0x35da, 0xbd2f, 0x44f1, 0x7859, 0x4ad0},
+     {0x9be4, 0x12c8, 0xbf09, 0x641d, 0x579c, 0x7d6e, 0x8b31, 0xacf3,
+      0xb065, 0xf697, 0x9e02, 0xabfe, 0x1eec, 0x48f6, 0xd5c1, 0x3aac},
+     {0x8301, 0xc331, 0x3b34, 0x858e, 0x6826, 0x0731, 0xc047, 0xdc99,
+      0xa88c, 0xd39d, 0x5b2e, 0x3408, 0x853d, 0xd902, 0x0cb1, 0x3aff}},
+    {{0x3505, 0xf4c5, 0x430b, 0x9226, 0x2283, 0x261f, 0x9c13, 0x68e4,
+      0x27c6, 0x8fd3, 0x3378, 0x09ef, 0x9e7f, 0x2bd9, 0x9f73, 0x2ccf},
+     {0x405e, 0x3a20, 0xc7eb, 0x87c5, 0x56c9, 0xedad, 0x11ef, 0x8ee3,
+      0xd5f9, 0xad29, 0x2e48, 0x2925, 0x251d, 0xf4cd, 0x7e86, 0x110e},
+     {0xf5e4, 0xd603, 0xd89e, 0x57c0, 0x200c, 0xf0b0, 0x8628, 0x1288,
+      0x3bb7, 0xa02e, 0x2709, 0x5317, 0x3a37, 0xb969, 0x57e0, 0x05c5}},
+    {{0x0eb0, 0x89c2, 0xbbb0, 0xf776, 0xd85c, 0xfa0f, 0x5bf6, 0x61f8,
+      0x21fb, 0x6344, 0x3f4e, 0xb6b9, 0x1205, 0x4186, 0xef08, 0x289f},
+     {0x7e6f, 0x1fc9, 0xce31, 0xd8f9, 0xfdae, 0x11f9, 0x2630, 0x7a3f,
+      0x25dd, 0x8bed, 0x7ea0, 0xe15b, 0x875a, 0x8fe9, 0x4c17, 0x6e15},
+     {0x9abf, 0xfed6, 0x6336, 0xcf61, 0xc94f, 0x8335, 0xe4e7, 0x9b16,
+      0x7fe7, 0x753a, 0x9765, 0x1378, 0xa319, 0xa95c, 0xf642, 0x6afb}},
+    {{0xa8cc, 0xf913, 0x5070, 0x5de5, 0xf561, 0x2b0c, 0x167b, 0x7d1d,
+      0xd489, 0x90ea, 0x56b6, 0xda29, 0x1ed9, 0xdb80, 0x93ce, 0x12c0},
+     {0xd2c1, 0x62f5, 0xde0c, 0x7da8, 0x7b9a, 0xb00e, 0x3da4, 0x98fc,
+      0x70e0, 0x0dad, 0x6ada, 0x7deb, 0x38c4, 0xb950, 0xb851, 0x0db4},
+     {0x190f, 0x08b8, 0x7f93, 0xfc14, 0xe310, 0xa11a, 0x9da0, 0x0696,
+      0xd7fd, 0xdac7, 0x5572, 0xcee7, 0x5ce6, 0xc663, 0x8799, 0x33aa}},
+    {{0x6cb1, 0xfc15, 0xf588, 0x8348, 0x6d27, 0x1a0a, 0xba9b, 0x6da2,
+      0x5ab6, 0x87ca, 0x2d5c, 0xe226, 0x89a6, 0xc8d5, 0xd0c1, 0x212c},
+     {0x5cf2, 0xbd08, 0xf51e, 0xaf0f, 0x3f1f, 0x67d3, 0x1a89, 0x78f5,
+      0x033c, 0x5060, 0xbfe1, 0x6ec2, 0x1a86, 0xe8e2, 0x6f29, 0x233c},
+     {0xc781, 0x7f18, 0xd510, 0xd2f4, 0x9d28, 0x527e, 0xcdf2, 0x122e,
+      0x3341, 0x3d3d, 0x862a, 0xa70a, 0x4ce3, 0x1191, 0x7789, 0x1db7}},
+    {{0x1ab6, 0xdd70, 0x4769, 0xb339, 0x8da5, 0x19cf, 0xded4, 0xe2b8,
+      0xc852, 0xfd2a, 0x4161, 0x15df, 0x24be, 0x017d, 0xca8a, 0x7ae2},
+     {0xc26f, 0x7c6b, 0x5239, 0xddf3, 0x0113, 0x53d5, 0xe2cc, 0x7a97,
+      0xa330, 0xbf79, 0xf43a, 0x7c74, 0xadfc, 0x26e2, 0x97ad, 0x31ad},
+     {0xb962, 0x0920, 0x17ed, 0xb7e8, 0xda9d, 0x3f19, 0x18cc, 0x1e85,
+      0x0a64, 0x2556, 0xc14f, 0xe491, 0x2c83, 0xa662, 0xfc53, 0x1ed1}}
+};
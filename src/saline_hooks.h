@@ -0,0 +1,50 @@
+#ifndef _SALINE_HOOKS_H_
+#define _SALINE_HOOKS_H_
+
+#include <stdint.h>
+
+/* Entry points into saline.c's static building blocks, compiled only with
+ * -D SALINE_TEST_HOOKS. Field elements are int64_t[16] and points are
+ * int64_t[4][16] (or [3][16] for precomputed Niels points), as in saline.c.
+ * These exist so benchmarks and tests can reach the kernels; nothing in the
+ * library calls them. */
+
+void saline_hook_M(int64_t *o, const int64_t *a, const int64_t *b);
+void saline_hook_S(int64_t *o, const int64_t *a);
+void saline_hook_car25519(int64_t *o);
+void saline_hook_inv25519(int64_t *o, const int64_t *i);
+void saline_hook_pow2523(int64_t *o, const int64_t *i);
+void saline_hook_pack25519(uint8_t *o, const int64_t *n);
+void saline_hook_unpack25519(int64_t *o, const uint8_t *n);
+
+void saline_hook_add(int64_t (*p)[16], int64_t (*q)[16]);
+void saline_hook_dbl(int64_t (*r)[16], int64_t (*p)[16]);
+void saline_hook_add_cached(int64_t (*r)[16], int64_t (*p)[16],
+                            int64_t (*q)[16]);
+void saline_hook_madd(int64_t (*r)[16], int64_t (*p)[16], int64_t (*q)[16]);
+void saline_hook_p1p1_to_p3(int64_t (*r)[16], int64_t (*p)[16]);
+void saline_hook_p3_to_cached(int64_t (*r)[16], int64_t (*p)[16]);
+void saline_hook_pack(uint8_t *r, int64_t (*p)[16]);
+int saline_hook_unpackneg(int64_t (*r)[16], const uint8_t *p);
+void saline_hook_scalarbase(int64_t (*p)[16], const uint8_t *s);
+void saline_hook_double_scalarmult(int64_t (*p)[16], const uint8_t *a,
+                                   int64_t (*q)[16], const uint8_t *b);
+
+void saline_hook_core_salsa20(uint8_t *out, const uint8_t *in,
+                              const uint8_t *k);
+void saline_hook_core_hsalsa20(uint8_t *out, const uint8_t *in,
+                               const uint8_t *k);
+
+/* The getrandom-buffered generator in randombytes.c, present when that
+ * backend is compiled in. The seed replaces the calling thread's key and
+ * empties its buffer; the state copies out the 32-byte key and the
+ * SALINE_HOOK_RNG_BUFFER-byte output buffer. */
+
+enum {
+    SALINE_HOOK_RNG_BUFFER = 512
+};
+
+void saline_hook_rng_seed(const uint8_t *key);
+void saline_hook_rng_state(uint8_t *key, uint8_t *buffer);
+
+#endif
@@ -0,0 +1,281 @@
+#include <stdint.h>
+
+#include "config.h"
+#include "randombytes.h"
+#include "saline.h"
+
+/* Nonces are prefix || uint64(counter), with the counter big-endian. The last
+ * counter value is never issued, so an exhausted sequencer stays exhausted
+ * instead of wrapping around to nonces it has already used. */
+
+#if defined SALINE_USE_THREADS
+#define NONCE_LOAD(x) __atomic_load_n((x), __ATOMIC_ACQUIRE)
+#define NONCE_CAS(x, expected, desired) \
+    __atomic_compare_exchange_n((x), (expected), (desired), 0, \
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+#define NONCE_LOAD(x) (*(x))
+
+static int nonce_cas(uint64_t *x, uint64_t *expected, uint64_t desired)
+{
+    if (*x != *expected) {
+        *expected = *x;
+        return 0;
+    }
+
+    *x = desired;
+    return 1;
+}
+
+#define NONCE_CAS(x, expected, desired) nonce_cas((x), (expected), (desired))
+#endif
+
+/* The receive window is two words and a counter, too much for one CAS, so
+ * it is guarded by a spin flag. The critical sections are a few shifts. */
+
+#if defined SALINE_USE_THREADS
+#define NONCE_LOCK(check) \
+    do { \
+        while (__atomic_test_and_set(&(check)->lock, __ATOMIC_ACQUIRE)) { \
+            continue; \
+        } \
+    } while (0)
+#define NONCE_UNLOCK(check) __atomic_clear(&(check)->lock, __ATOMIC_RELEASE)
+#else
+#define NONCE_LOCK(check) ((void) 0)
+#define NONCE_UNLOCK(check) ((void) 0)
+#endif
+
+enum {
+    NONCE_WORDS = crypto_nonce_WINDOW / 64
+};
+
+static void nonce_store(unsigned char nonce[crypto_nonce_BYTES],
+                        const unsigned char prefix[crypto_nonce_PREFIXBYTES],
+                        uint64_t counter)
+{
+    for (int i = 0; i < crypto_nonce_PREFIXBYTES; ++i) {
+        nonce[i] = prefix[i];
+    }
+
+    for (int i = crypto_nonce_BYTES - 1; i >= crypto_nonce_PREFIXBYTES; --i) {
+        nonce[i] = (unsigned char) counter;
+        counter >>= 8;
+    }
+}
+
+int crypto_nonce_seq_init(crypto_nonce_seq *seq)
+{
+    randombytes(seq->prefix, crypto_nonce_PREFIXBYTES);
+    seq->counter = 0;
+    return 0;
+}
+
+int crypto_nonce_seq_next(crypto_nonce_seq *seq,
+                          unsigned char nonce[crypto_nonce_BYTES])
+{
+    uint64_t counter = NONCE_LOAD(&seq->counter);
+
+    do {
+        if (counter == UINT64_MAX) {
+            return -1;
+        }
+    } while (!NONCE_CAS(&seq->counter, &counter, counter + 1));
+
+    nonce_store(nonce, seq->prefix, counter);
+    return 0;
+}
+
+int crypto_nonce_check_init(
+    crypto_nonce_check *check,
+    const unsigned char prefix[crypto_nonce_PREFIXBYTES])
+{
+    for (int i = 0; i < crypto_nonce_PREFIXBYTES; ++i) {
+        check->prefix[i] = prefix[i];
+    }
+
+    for (int i = 0; i < NONCE_WORDS; ++i) {
+        check->window[i] = 0;
+    }
+
+    check->next = 0;
+    check->lock = 0;
+    return 0;
+}
+
+/* Returns the counter in 'nonce', or UINT64_MAX if the nonce can't come from
+ * the sequencer that 'check' follows. */
+
+static uint64_t nonce_counter(const crypto_nonce_check *check,
+                              const unsigned char nonce[crypto_nonce_BYTES])
+{
+    uint64_t counter = 0;
+
+    for (int i = 0; i < crypto_nonce_PREFIXBYTES; ++i) {
+        if (nonce[i] != check->prefix[i]) {
+            return UINT64_MAX;
+        }
+    }
+
+    for (int i = crypto_nonce_PREFIXBYTES; i < crypto_nonce_BYTES; ++i) {
+        counter = (counter << 8) | nonce[i];
+    }
+
+    return counter;
+}
+
+/* 'next' is one past the highest counter accepted, and bit i of the window
+ * (word i / 64, bit i % 64) is set once counter next - 1 - i is accepted.
+ * Both are read and written under the check's lock. */
+
+static int nonce_fresh_locked(const crypto_nonce_check *check,
+                              uint64_t counter)
+{
+    uint64_t behind;
+
+    if (counter == UINT64_MAX) {
+        return 0;
+    }
+
+    if (counter >= check->next) {
+        return 1;
+    }
+
+    behind = check->next - 1 - counter;
+
+    if (behind >= crypto_nonce_WINDOW) {
+        return 0;
+    }
+
+    return !((check->window[behind / 64] >> (behind % 64)) & 1);
+}
+
+static void nonce_mark_locked(crypto_nonce_check *check, uint64_t counter)
+{
+    uint64_t behind;
+
+    if (counter >= check->next) {
+        uint64_t shift = counter - check->next + 1;
+
+        for (int i = NONCE_WORDS - 1; i >= 0; --i) {
+            uint64_t word = 0;
+            uint64_t skip = shift / 64, bits = shift % 64;
+
+            if (skip <= (uint64_t) i) {
+                word = check->window[i - skip] << bits;
+
+                if (bits != 0 && skip + 1 <= (uint64_t) i) {
+                    word |= check->window[i - skip - 1] >> (64 - bits);
+                }
+            }
+
+            check->window[i] = word;
+        }
+
+        check->next = counter + 1;
+    }
+
+    behind = check->next - 1 - counter;
+    check->window[behind / 64] |= (uint64_t) 1 << (behind % 64);
+}
+
+static int nonce_fresh(crypto_nonce_check *check, uint64_t counter)
+{
+    int fresh;
+
+    NONCE_LOCK(check);
+    fresh = nonce_fresh_locked(check, counter);
+    NONCE_UNLOCK(check);
+    return fresh;
+}
+
+/* Records 'counter' once a message has authenticated. Fails, and wipes the
+ * plaintext, if another thread accepted the same counter, or moved the
+ * window past it, in the meantime. */
+
+static int nonce_accept(crypto_nonce_check *check, uint64_t counter,
+                        unsigned char *m, unsigned long long d)
+{
+    int fresh;
+
+    NONCE_LOCK(check);
+    fresh = nonce_fresh_locked(check, counter);
+
+    if (fresh) {
+        nonce_mark_locked(check, counter);
+    }
+
+    NONCE_UNLOCK(check);
+
+    if (!fresh) {
+        for (unsigned long long i = 0; i < d; ++i) {
+            m[i] = 0;
+        }
+
+        return -1;
+    }
+
+    return 0;
+}
+
+int crypto_secretbox_seq(unsigned char *c, const unsigned char *m,
+                         unsigned long long d,
+                         unsigned char nonce[crypto_nonce_BYTES],
+                         crypto_nonce_seq *seq, const unsigned char k[32])
+{
+    if (crypto_nonce_seq_next(seq, nonce)) {
+        return -1;
+    }
+
+    return crypto_secretbox(c, m, d, nonce, k);
+}
+
+int crypto_secretbox_open_seq(unsigned char *m, const unsigned char *c,
+                              unsigned long long d,
+                              const unsigned char nonce[crypto_nonce_BYTES],
+                              crypto_nonce_check *check,
+                              const unsigned char k[32])
+{
+    uint64_t counter = nonce_counter(check, nonce);
+
+    if (!nonce_fresh(check, counter)) {
+        return -1;
+    }
+
+    if (crypto_secretbox_open(m, c, d, nonce, k)) {
+        return -1;
+    }
+
+    return nonce_accept(check, counter, m, d);
+}
+
+int crypto_box_afternm_seq(unsigned char *c, const unsigned char *m,
+                           unsigned long long d,
+                           unsigned char nonce[crypto_nonce_BYTES],
+                           crypto_nonce_seq *seq, const unsigned char k[32])
+{
+    if (crypto_nonce_seq_next(seq, nonce)) {
+        return -1;
+    }
+
+    return crypto_box_afternm(c, m, d, nonce, k);
+}
+
+int crypto_box_open_afternm_seq(unsigned char *m, const unsigned char *c,
+                                unsigned long long d,
+                                const unsigned char nonce[crypto_nonce_BYTES],
+                                crypto_nonce_check *check,
+                                const unsigned char k[32])
+{
+    uint64_t counter = nonce_counter(check, nonce);
+
+    if (!nonce_fresh(check, counter)) {
+        return -1;
+    }
+
+    if (crypto_box_open_afternm(m, c, d, nonce, k)) {
+        return -1;
+    }
+
+    return nonce_accept(check, counter, m, d);
+}
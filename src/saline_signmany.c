@@ -0,0 +1,52 @@
+#include <stdint.h>
+
+#include "parallel.h"
+#include "saline.h"
+
+struct sign_many {
+    unsigned char *sigs;
+    const unsigned char *const *msgs;
+    const unsigned long long *lengths;
+    const crypto_sign_ctx *ctx;
+};
+
+static void sign_many_range(void *arg, uint64_t begin, uint64_t end)
+{
+    struct sign_many *job = arg;
+
+    for (uint64_t i = begin; i < end; ++i) {
+        crypto_sign_detached_with_ctx(job->sigs + i * crypto_sign_BYTES, 0,
+                                      job->msgs[i], job->lengths[i],
+                                      job->ctx);
+    }
+}
+
+int crypto_sign_many_with_ctx(unsigned char *sigs,
+                              const unsigned char *const *msgs,
+                              const unsigned long long *lengths,
+                              unsigned long long count,
+                              const crypto_sign_ctx *ctx,
+                              unsigned int threads)
+{
+    struct sign_many job;
+
+    job.sigs = sigs;
+    job.msgs = msgs;
+    job.lengths = lengths;
+    job.ctx = ctx;
+
+    saline_parallel_for(threads, count, 1, sign_many_range, &job);
+    return 0;
+}
+
+int crypto_sign_many(unsigned char *sigs, const unsigned char *const *msgs,
+                     const unsigned long long *lengths,
+                     unsigned long long count, const unsigned char sk[64],
+                     unsigned int threads)
+{
+    crypto_sign_ctx ctx;
+
+    crypto_sign_ctx_init(&ctx, sk);
+    return crypto_sign_many_with_ctx(sigs, msgs, lengths, count, &ctx,
+                                     threads);
+}
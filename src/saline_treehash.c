@@ -0,0 +1,191 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "parallel.h"
+#include "saline.h"
+#include "stats.h"
+#include "treehash.h"
+
+/* Tree-hash layout (all hashes are SHA-512, all integers big-endian):
+ *
+ *   leaf[i]  = H(0x00 || msg[i * chunk .. min((i + 1) * chunk, length)))
+ *   node     = H(0x01 || left || right)
+ *   root     = H(0x02 || top || uint64(length) || uint64(chunk))
+ *
+ * An empty message has a single empty leaf. Each level pairs nodes from the
+ * left; an unpaired node at the end of a level moves up unchanged. The
+ * prefixes keep leaves, nodes and the root apart, as in RFC 6962, so no
+ * leaf can be passed off as an inner node. The final 0x02 block binds the
+ * message length and chunk size, so two trees only share a root if they
+ * have the same shape. */
+
+enum {
+    TREE_BATCH = 16,
+    TREE_NODE_BYTES = 1 + 2 * crypto_hash_BYTES
+};
+
+/* Hashes leaves [begin, end) into their slots of tree->hashes. */
+
+void saline_tree_hash_leaves(void *arg, uint64_t begin, uint64_t end)
+{
+    struct saline_tree *ctx = arg;
+    const unsigned char *msgs[TREE_BATCH];
+    unsigned long long lengths[TREE_BATCH];
+
+    while (begin < end) {
+        unsigned long long count = end - begin;
+
+        if (count > TREE_BATCH) {
+            count = TREE_BATCH;
+        }
+
+        for (unsigned long long i = 0; i < count; ++i) {
+            unsigned long long offset = (begin + i) * ctx->chunk;
+            unsigned long long remaining = ctx->length - offset;
+
+            msgs[i] = ctx->msg + offset;
+            lengths[i] = (remaining < ctx->chunk) ? remaining : ctx->chunk;
+        }
+
+        saline_hash_many_prefixed(ctx->hashes + begin * crypto_hash_BYTES,
+                                  0x00, msgs, lengths, count);
+        begin += count;
+    }
+}
+
+static void tree_store64(unsigned char *x, unsigned long long u)
+{
+    for (int i = 7; i >= 0; --i) {
+        x[i] = (unsigned char) u;
+        u >>= 8;
+    }
+}
+
+/* Replaces the first 'count' hashes with the next level up. Returns the
+ * number of nodes in the new level. */
+
+static unsigned long long tree_reduce(unsigned char *hashes,
+                                      unsigned long long count)
+{
+    unsigned char nodes[TREE_BATCH][TREE_NODE_BYTES];
+    const unsigned char *msgs[TREE_BATCH];
+    unsigned long long lengths[TREE_BATCH];
+    unsigned long long pairs = count / 2;
+    unsigned long long done = 0;
+
+    while (done < pairs) {
+        unsigned long long batch = pairs - done;
+
+        if (batch > TREE_BATCH) {
+            batch = TREE_BATCH;
+        }
+
+        for (unsigned long long i = 0; i < batch; ++i) {
+            const unsigned char *left = hashes + 2 * crypto_hash_BYTES *
+                                        (done + i);
+
+            nodes[i][0] = 0x01;
+
+            for (int j = 0; j < 2 * crypto_hash_BYTES; ++j) {
+                nodes[i][1 + j] = left[j];
+            }
+
+            msgs[i] = nodes[i];
+            lengths[i] = TREE_NODE_BYTES;
+        }
+
+        crypto_hash_many(hashes + done * crypto_hash_BYTES, msgs, lengths,
+                         batch);
+        done += batch;
+    }
+
+    if (count & 1) {
+        for (int j = 0; j < crypto_hash_BYTES; ++j) {
+            hashes[pairs * crypto_hash_BYTES + j] =
+                hashes[(count - 1) * crypto_hash_BYTES + j];
+        }
+
+        ++pairs;
+    }
+
+    return pairs;
+}
+
+/* Sets up 'tree' and allocates its leaf hashes. Returns the number of
+ * leaves, or 0 if chunk is zero or memory can't be allocated. */
+
+unsigned long long saline_tree_init(struct saline_tree *tree,
+                                    const unsigned char *msg,
+                                    unsigned long long length,
+                                    unsigned long long chunk)
+{
+    unsigned long long count;
+
+    if (chunk == 0) {
+        return 0;
+    }
+
+    count = (length == 0) ? 1 : (length - 1) / chunk + 1;
+
+    if (count > ((size_t) -1) / crypto_hash_BYTES) {
+        return 0;
+    }
+
+    tree->hashes = malloc((size_t) count * crypto_hash_BYTES);
+
+    if (tree->hashes == 0) {
+        return 0;
+    }
+
+    tree->msg = msg;
+    tree->length = length;
+    tree->chunk = chunk;
+    return count;
+}
+
+/* Reduces 'count' hashed leaves to the root, writes it to 'out' and frees
+ * the leaf hashes. */
+
+int saline_tree_finish(unsigned char out[64], struct saline_tree *tree,
+                       unsigned long long count)
+{
+    unsigned char root[1 + crypto_hash_BYTES + 16];
+
+    while (count > 1) {
+        count = tree_reduce(tree->hashes, count);
+    }
+
+    root[0] = 0x02;
+
+    for (int i = 0; i < crypto_hash_BYTES; ++i) {
+        root[1 + i] = tree->hashes[i];
+    }
+
+    tree_store64(root + 1 + crypto_hash_BYTES, tree->length);
+    tree_store64(root + 1 + crypto_hash_BYTES + 8, tree->chunk);
+    free(tree->hashes);
+
+    return crypto_hash(out, root, sizeof(root));
+}
+
+int crypto_hash_tree(unsigned char out[crypto_hash_tree_BYTES],
+                     const unsigned char *msg, unsigned long long length,
+                     unsigned long long chunk, unsigned int threads)
+{
+    struct saline_tree tree;
+    unsigned long long count;
+
+    if (chunk != 0) {
+        SALINE_STAT_CALL(hash_tree, length);
+    }
+
+    count = saline_tree_init(&tree, msg, length, chunk);
+
+    if (count == 0) {
+        return -1;
+    }
+
+    saline_parallel_for(threads, count, TREE_BATCH, saline_tree_hash_leaves,
+                        &tree);
+    return saline_tree_finish(out, &tree, count);
+}
@@ -0,0 +1,153 @@
+#include <stdint.h>
+
+#include "dispatch.h"
+
+#if defined SALINE_DISPATCH_X86
+
+#include <emmintrin.h>
+
+/* Four-way Salsa20 over SSE2. Lane j of x[i] holds word i of block j, so each
+ * quarter-round step runs on four blocks at once and needs no shuffles; the
+ * results are transposed back into byte order at the end. */
+
+#define SSE2_FN __attribute__((target("sse2")))
+
+#define ROTL(v, c) \
+    _mm_or_si128(_mm_slli_epi32((v), (c)), _mm_srli_epi32((v), 32 - (c)))
+
+#define QUARTER(a, b, c, d) \
+    do { \
+        b = _mm_xor_si128(b, ROTL(_mm_add_epi32(a, d), 7)); \
+        c = _mm_xor_si128(c, ROTL(_mm_add_epi32(b, a), 9)); \
+        d = _mm_xor_si128(d, ROTL(_mm_add_epi32(c, b), 13)); \
+        a = _mm_xor_si128(a, ROTL(_mm_add_epi32(d, c), 18)); \
+    } while (0)
+
+static const uint8_t sse2_sigma[16] = "expand 32-byte k";
+
+static uint32_t sse2_ld32(const uint8_t *x)
+{
+    return (uint32_t) x[0] | (uint32_t) x[1] << 8 | (uint32_t) x[2] << 16 |
+           (uint32_t) x[3] << 24;
+}
+
+static uint64_t sse2_ld64(const uint8_t *x)
+{
+    return (uint64_t) sse2_ld32(x) | (uint64_t) sse2_ld32(x + 4) << 32;
+}
+
+static void sse2_st64(uint8_t *x, uint64_t u)
+{
+    for (int i = 0; i < 8; ++i) {
+        x[i] = (uint8_t) u;
+        u >>= 8;
+    }
+}
+
+/* Writes four consecutive keystream blocks for 'counter' into out[256]. */
+
+SSE2_FN static void sse2_blocks4(uint8_t out[256], const uint32_t in[16],
+                                 uint64_t counter)
+{
+    __m128i x[16], y[16];
+
+    for (int i = 0; i < 16; ++i) {
+        x[i] = _mm_set1_epi32((int) in[i]);
+    }
+
+    x[8] = _mm_set_epi32((int) (uint32_t) (counter + 3),
+                         (int) (uint32_t) (counter + 2),
+                         (int) (uint32_t) (counter + 1),
+                         (int) (uint32_t) counter);
+    x[9] = _mm_set_epi32((int) (uint32_t) ((counter + 3) >> 32),
+                         (int) (uint32_t) ((counter + 2) >> 32),
+                         (int) (uint32_t) ((counter + 1) >> 32),
+                         (int) (uint32_t) (counter >> 32));
+
+    for (int i = 0; i < 16; ++i) {
+        y[i] = x[i];
+    }
+
+    for (int i = 0; i < 20; i += 2) {
+        QUARTER(x[0], x[4], x[8], x[12]);
+        QUARTER(x[5], x[9], x[13], x[1]);
+        QUARTER(x[10], x[14], x[2], x[6]);
+        QUARTER(x[15], x[3], x[7], x[11]);
+
+        QUARTER(x[0], x[1], x[2], x[3]);
+        QUARTER(x[5], x[6], x[7], x[4]);
+        QUARTER(x[10], x[11], x[8], x[9]);
+        QUARTER(x[15], x[12], x[13], x[14]);
+    }
+
+    for (int i = 0; i < 16; i += 4) {
+        __m128i a = _mm_add_epi32(x[i], y[i]);
+        __m128i b = _mm_add_epi32(x[i + 1], y[i + 1]);
+        __m128i c = _mm_add_epi32(x[i + 2], y[i + 2]);
+        __m128i d = _mm_add_epi32(x[i + 3], y[i + 3]);
+        __m128i ab_lo = _mm_unpacklo_epi32(a, b);
+        __m128i ab_hi = _mm_unpackhi_epi32(a, b);
+        __m128i cd_lo = _mm_unpacklo_epi32(c, d);
+        __m128i cd_hi = _mm_unpackhi_epi32(c, d);
+
+        _mm_storeu_si128((__m128i *) (out + 4 * i),
+                         _mm_unpacklo_epi64(ab_lo, cd_lo));
+        _mm_storeu_si128((__m128i *) (out + 64 + 4 * i),
+                         _mm_unpackhi_epi64(ab_lo, cd_lo));
+        _mm_storeu_si128((__m128i *) (out + 128 + 4 * i),
+                         _mm_unpacklo_epi64(ab_hi, cd_hi));
+        _mm_storeu_si128((__m128i *) (out + 192 + 4 * i),
+                         _mm_unpackhi_epi64(ab_hi, cd_hi));
+    }
+}
+
+SSE2_FN void saline_salsa20_blocks_sse2(uint8_t *c, const uint8_t *m,
+                                        uint64_t blocks, uint8_t *z,
+                                        const uint8_t *k)
+{
+    uint8_t x[256];
+    uint32_t in[16];
+    uint64_t counter = sse2_ld64(z + 8);
+
+    for (int i = 0; i < 4; ++i) {
+        in[5 * i] = sse2_ld32(sse2_sigma + 4 * i);
+        in[1 + i] = sse2_ld32(k + 4 * i);
+        in[11 + i] = sse2_ld32(k + 16 + 4 * i);
+    }
+
+    in[6] = sse2_ld32(z);
+    in[7] = sse2_ld32(z + 4);
+
+    while (blocks > 0) {
+        uint64_t n = (blocks < 4) ? blocks : 4;
+
+        sse2_blocks4(x, in, counter);
+
+        for (uint64_t i = 0; i < 64 * n; i += 16) {
+            __m128i s = _mm_loadu_si128((const __m128i *) (x + i));
+
+            if (m) {
+                s = _mm_xor_si128(s, _mm_loadu_si128((const __m128i *)
+                                                     (m + i)));
+            }
+
+            _mm_storeu_si128((__m128i *) (c + i), s);
+        }
+
+        counter += n;
+        blocks -= n;
+        c += 64 * n;
+
+        if (m) {
+            m += 64 * n;
+        }
+    }
+
+    sse2_st64(z + 8, counter);
+
+    for (int i = 0; i < 256; ++i) {
+        ((volatile uint8_t *) x)[i] = 0;
+    }
+}
+
+#endif
@@ -0,0 +1,173 @@
+#include <stdint.h>
+
+#include "scalar.h"
+
+/* Scalars are handled as signed 21-bit limbs in int64_t, as in ref10: a
+ * 64-byte input fills 24 limbs, and products of two 12-limb scalars fit in
+ * the same 24 with room to spare. Limb k >= 12 sits at 2^(21k) =
+ * 2^(21(k - 12)) * 2^252, and 2^252 = -c (mod L), where -c in signed 21-bit
+ * digits is sc_mu below. */
+
+enum {
+    SC_LIMBS = 24
+};
+
+static const int64_t sc_mu[6] = {666643, 470296, 654183, -997805, 136657,
+                                 -683901};
+
+static const uint8_t sc_L[32] = {0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12,
+                                 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9,
+                                 0xde, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                 0x00, 0x00, 0x00, 0x10};
+
+/* Splits 'length' bytes into 'count' 21-bit limbs. The last limb takes all
+ * of the remaining high bits. */
+
+static void sc_load(int64_t *x, int count, const uint8_t *s, int length)
+{
+    uint64_t acc = 0;
+    int bits = 0, k = 0;
+
+    for (int i = 0; i < length; ++i) {
+        acc |= (uint64_t) s[i] << bits;
+        bits += 8;
+
+        while (bits >= 21 && k < count - 1) {
+            x[k++] = (int64_t) (acc & 0x1fffff);
+            acc >>= 21;
+            bits -= 21;
+        }
+    }
+
+    x[k++] = (int64_t) acc;
+
+    while (k < count) {
+        x[k++] = 0;
+    }
+}
+
+static void sc_store(uint8_t s[32], const int64_t x[12])
+{
+    uint64_t acc = 0;
+    int bits = 0, k = 0;
+
+    for (int i = 0; i < 32; ++i) {
+        while (bits < 8 && k < 12) {
+            acc |= (uint64_t) x[k++] << bits;
+            bits += 21;
+        }
+
+        s[i] = (uint8_t) acc;
+        acc >>= 8;
+        bits -= 8;
+    }
+}
+
+static void sc_fold(int64_t *x, int k)
+{
+    for (int j = 0; j < 6; ++j) {
+        x[k - 12 + j] += x[k] * sc_mu[j];
+    }
+
+    x[k] = 0;
+}
+
+/* Carries limbs [begin, end) into their neighbours, leaving each of them in
+ * [-2^20, 2^20). */
+
+static void sc_carry(int64_t *x, int begin, int end)
+{
+    for (int i = begin; i < end; ++i) {
+        int64_t carry = (x[i] + (1 << 20)) >> 21;
+        x[i + 1] += carry;
+        x[i] -= carry * (1 << 21);
+    }
+}
+
+/* Same as sc_carry(), but leaves limbs in [0, 2^21). */
+
+static void sc_carry_floor(int64_t *x, int begin, int end)
+{
+    for (int i = begin; i < end; ++i) {
+        int64_t carry = x[i] >> 21;
+        x[i + 1] += carry;
+        x[i] -= carry * (1 << 21);
+    }
+}
+
+/* Reduces carried limbs mod L into x[0..11]. The top limbs are folded down
+ * in two rounds of six, with a carry pass in between to keep every product
+ * well inside 64 bits. */
+
+static void sc_reduce_limbs(int64_t x[SC_LIMBS])
+{
+    int k;
+
+    for (k = 23; k >= 18; --k) {
+        sc_fold(x, k);
+    }
+
+    sc_carry(x, 6, 17);
+
+    for (k = 17; k >= 12; --k) {
+        sc_fold(x, k);
+    }
+
+    sc_carry(x, 0, 12);
+    sc_fold(x, 12);
+    sc_carry_floor(x, 0, 12);
+    sc_fold(x, 12);
+    sc_carry_floor(x, 0, 11);
+}
+
+void saline_sc_reduce(uint8_t s[64])
+{
+    int64_t x[SC_LIMBS];
+
+    sc_load(x, SC_LIMBS, s, 64);
+    sc_reduce_limbs(x);
+    sc_store(s, x);
+
+    for (int i = 32; i < 64; ++i) {
+        s[i] = 0;
+    }
+}
+
+void saline_sc_muladd(uint8_t s[32], const uint8_t a[32], const uint8_t b[32],
+                      const uint8_t c[32])
+{
+    int64_t x[SC_LIMBS], al[12], bl[12];
+
+    sc_load(al, 12, a, 32);
+    sc_load(bl, 12, b, 32);
+    sc_load(x, 12, c, 32);
+
+    for (int i = 12; i < SC_LIMBS; ++i) {
+        x[i] = 0;
+    }
+
+    for (int i = 0; i < 12; ++i) {
+        for (int j = 0; j < 12; ++j) {
+            x[i + j] += al[i] * bl[j];
+        }
+    }
+
+    sc_carry(x, 0, SC_LIMBS - 1);
+    sc_reduce_limbs(x);
+    sc_store(s, x);
+}
+
+/* Returns 1 if s < L, without branching on s. */
+
+int saline_sc_is_canonical(const uint8_t s[32])
+{
+    unsigned int c = 0, n = 1;
+
+    for (int i = 31; i >= 0; --i) {
+        c |= ((s[i] - sc_L[i]) >> 8) & n;
+        n &= ((s[i] ^ sc_L[i]) - 1) >> 8;
+    }
+
+    return c != 0;
+}
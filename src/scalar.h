@@ -0,0 +1,17 @@
+#ifndef _SCALAR_H_
+#define _SCALAR_H_
+
+#include <stdint.h>
+
+/* Arithmetic on Ed25519 scalars modulo the group order
+ * L = 2^252 + 27742317777372353535851937790883648493. Scalars are 32-byte
+ * little-endian strings. */
+
+void saline_sc_reduce(uint8_t s[64]);
+
+void saline_sc_muladd(uint8_t s[32], const uint8_t a[32], const uint8_t b[32],
+                      const uint8_t c[32]);
+
+int saline_sc_is_canonical(const uint8_t s[32]);
+
+#endif
@@ -0,0 +1,194 @@
+#include <stdlib.h>
+
+#include "stats.h"
+
+#if defined SALINE_USE_STATS && defined SALINE_USE_THREADS
+#include <pthread.h>
+#endif
+
+/* Every thread that counts anything gets a block on the 'stats_blocks' list.
+ * Blocks are never freed: when a thread exits, its block is released for the
+ * next new thread to adopt, counts and all, so totals survive thread churn
+ * and the list only grows to the peak number of live threads. Counters only
+ * ever increase; saline_stats_reset() records the current totals as a
+ * baseline that later snapshots subtract, so it never writes another
+ * thread's block. */
+
+enum {
+    STATS_FIELDS = sizeof(saline_stats) / sizeof(unsigned long long)
+};
+
+#if defined SALINE_USE_STATS
+
+struct stats_block {
+    saline_stats counts;
+    struct stats_block *next;
+    int in_use;
+};
+
+static saline_stats stats_baseline;
+
+static unsigned long long *stats_fields(saline_stats *stats)
+{
+    return (unsigned long long *) (void *) stats;
+}
+
+#if defined SALINE_USE_THREADS
+
+STATS_THREAD_LOCAL saline_stats *saline_stats_local;
+
+static struct stats_block *stats_blocks;
+static saline_stats stats_fallback;
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t stats_key;
+static int stats_have_key;
+
+/* Runs on the exiting thread. Its pointer is cleared before the block is
+ * released, so calls from later TSD destructors in this thread attach
+ * afresh (and set the key again, so that block is released in turn) rather
+ * than writing a block that another thread may have adopted. */
+
+static void stats_release(void *arg)
+{
+    struct stats_block *block = arg;
+
+    saline_stats_local = 0;
+    __atomic_store_n(&block->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void stats_init(void)
+{
+    stats_have_key = (pthread_key_create(&stats_key, stats_release) == 0);
+}
+
+/* Adopts a released block or allocates a new one. If that fails, the thread
+ * shares a fallback block whose updates may race and lose counts. */
+
+saline_stats *saline_stats_attach(void)
+{
+    struct stats_block *block;
+
+    pthread_once(&stats_once, stats_init);
+    block = __atomic_load_n(&stats_blocks, __ATOMIC_ACQUIRE);
+
+    for (; block != 0; block = block->next) {
+        int expected = 0;
+
+        if (__atomic_compare_exchange_n(&block->in_use, &expected, 1, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (block == 0) {
+        block = calloc(1, sizeof(*block));
+
+        if (block == 0 || !stats_have_key) {
+            free(block);
+            return &stats_fallback;
+        }
+
+        block->in_use = 1;
+        block->next = __atomic_load_n(&stats_blocks, __ATOMIC_RELAXED);
+
+        while (!__atomic_compare_exchange_n(&stats_blocks, &block->next, block,
+                                            0, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED)) {
+            continue;
+        }
+    }
+
+    if (stats_have_key) {
+        pthread_setspecific(stats_key, block);
+    }
+
+    saline_stats_local = &block->counts;
+    return saline_stats_local;
+}
+
+static void stats_total(saline_stats *total)
+{
+    unsigned long long *sum = stats_fields(total);
+    struct stats_block *block = __atomic_load_n(&stats_blocks,
+                                                __ATOMIC_ACQUIRE);
+
+    for (int i = 0; i < STATS_FIELDS; ++i) {
+        sum[i] = __atomic_load_n(&stats_fields(&stats_fallback)[i],
+                                 __ATOMIC_RELAXED);
+    }
+
+    for (; block != 0; block = block->next) {
+        unsigned long long *counts = stats_fields(&block->counts);
+
+        for (int i = 0; i < STATS_FIELDS; ++i) {
+            sum[i] += __atomic_load_n(&counts[i], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+#define STATS_LOCK() pthread_mutex_lock(&stats_lock)
+#define STATS_UNLOCK() pthread_mutex_unlock(&stats_lock)
+
+#else
+
+static saline_stats stats_counts;
+
+saline_stats *saline_stats_attach(void)
+{
+    return &stats_counts;
+}
+
+static void stats_total(saline_stats *total)
+{
+    *total = stats_counts;
+}
+
+#define STATS_LOCK() ((void) 0)
+#define STATS_UNLOCK() ((void) 0)
+
+#endif
+
+int saline_stats_snapshot(saline_stats *stats)
+{
+    unsigned long long *fields = stats_fields(stats);
+    unsigned long long *base = stats_fields(&stats_baseline);
+
+    STATS_LOCK();
+    stats_total(stats);
+
+    for (int i = 0; i < STATS_FIELDS; ++i) {
+        fields[i] -= base[i];
+    }
+
+    STATS_UNLOCK();
+    return 0;
+}
+
+int saline_stats_reset(void)
+{
+    STATS_LOCK();
+    stats_total(&stats_baseline);
+    STATS_UNLOCK();
+    return 0;
+}
+
+#else
+
+int saline_stats_snapshot(saline_stats *stats)
+{
+    unsigned long long *fields = (unsigned long long *) (void *) stats;
+
+    for (int i = 0; i < STATS_FIELDS; ++i) {
+        fields[i] = 0;
+    }
+
+    return -1;
+}
+
+int saline_stats_reset(void)
+{
+    return -1;
+}
+
+#endif
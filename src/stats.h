@@ -0,0 +1,59 @@
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include "config.h"
+#include "saline.h"
+
+/* SALINE_STAT(field, n) adds 'n' to a saline_stats field in the calling
+ * thread's block, and SALINE_STAT_CALL(counter, n) counts one call and
+ * 'n' bytes. Both compile to nothing without --enable-stats. A thread
+ * only ever writes its own block, so an update is a relaxed load and store
+ * rather than a locked read-modify-write; snapshots read the same fields with
+ * relaxed loads from other threads. */
+
+#if defined SALINE_USE_STATS
+
+saline_stats *saline_stats_attach(void);
+
+#if defined SALINE_USE_THREADS
+
+#if defined __STDC_VERSION__ && __STDC_VERSION__ >= 201112L
+#define STATS_THREAD_LOCAL _Thread_local
+#else
+#define STATS_THREAD_LOCAL __thread
+#endif
+
+extern STATS_THREAD_LOCAL saline_stats *saline_stats_local;
+
+#define STATS_BLOCK() \
+    (saline_stats_local ? saline_stats_local : saline_stats_attach())
+
+#define SALINE_STAT(field, n) \
+    do { \
+        saline_stats *block_ = STATS_BLOCK(); \
+        __atomic_store_n(&block_->field, \
+                         __atomic_load_n(&block_->field, __ATOMIC_RELAXED) + \
+                         (unsigned long long) (n), __ATOMIC_RELAXED); \
+    } while (0)
+
+#else
+
+#define SALINE_STAT(field, n) \
+    (saline_stats_attach()->field += (unsigned long long) (n))
+
+#endif
+
+#define SALINE_STAT_CALL(counter, n) \
+    do { \
+        SALINE_STAT(counter.calls, 1); \
+        SALINE_STAT(counter.bytes, n); \
+    } while (0)
+
+#else
+
+#define SALINE_STAT(field, n) ((void) 0)
+#define SALINE_STAT_CALL(counter, n) ((void) 0)
+
+#endif
+
+#endif
@@ -54,6 +54,19 @@ class CryptoBox():
             ctypes.POINTER(ctypes.c_char)
         )
 
+        for name in ['wrap_crypto_box_detached',
+                     'wrap_crypto_box_open_detached']:
+            getattr(dll, name).restype = ctypes.c_int
+            getattr(dll, name).argtypes = (
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.c_ulonglong,
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.POINTER(ctypes.c_char)
+            )
+
         dll.wrap_crypto_box_beforenm.restype = ctypes.c_int
         dll.wrap_crypto_box_beforenm.argtypes = (
             ctypes.POINTER(ctypes.c_char),
@@ -61,6 +74,13 @@ class CryptoBox():
             ctypes.POINTER(ctypes.c_char)
         )
 
+        dll.wrap_crypto_box_beforenm_ws.restype = ctypes.c_int
+        dll.wrap_crypto_box_beforenm_ws.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char)
+        )
+
         dll.wrap_crypto_box_afternm.restype = ctypes.c_int
         dll.wrap_crypto_box_afternm.argtypes = (
             ctypes.POINTER(ctypes.c_char),
@@ -141,7 +161,34 @@ class CryptoBox():
 
         return buffer.raw[self.crypto_box_ZEROBYTES:]
 
-    def crypto_box_beforenm(self, public, secret):
+    def crypto_box_detached(self, plaintext, public, secret, nonce):
+        """ Encrypts without padding. Returns the authenticator followed by
+        the cypher text, the same bytes crypto_box() returns. """
+
+        mac = ctypes.create_string_buffer(16)
+        buffer = ctypes.create_string_buffer(len(plaintext))
+        result = self.dll.wrap_crypto_box_detached(
+            buffer, mac, plaintext, len(plaintext), nonce, public, secret)
+
+        if result != 0:
+            raise ValueError("Crypto_box_detached() failed")
+
+        return mac.raw + buffer.raw
+
+    def crypto_box_open_detached(self, cypher, public, secret, nonce):
+        """ Decrypts an authenticator followed by unpadded cypher text. """
+
+        buffer = ctypes.create_string_buffer(len(cypher) - 16)
+        result = self.dll.wrap_crypto_box_open_detached(
+            buffer, cypher[16:], cypher[0:16], len(cypher) - 16, nonce,
+            public, secret)
+
+        if result != 0:
+            raise ValueError("Crypto_box_open_detached() failed")
+
+        return buffer.raw
+
+    def crypto_box_beforenm(self, public, secret, workspace=False):
         """ Calculate a crypto_box shared-secret from a one user's public key
         and another user's secret key. The result is supplied to
         crypto_box_afternm() or crypto_box_open_afternm() to get the equivalent
@@ -153,8 +200,10 @@ class CryptoBox():
         assert len(public) == self.crypto_box_PUBLICKEYBYTES
         assert len(secret) == self.crypto_box_SECRETKEYBYTES
 
+        suffix = '_ws' if workspace else ''
+        func = getattr(self.dll, 'wrap_crypto_box_beforenm' + suffix)
         shared = ctypes.create_string_buffer(self.crypto_box_BEFORENMBYTES)
-        result = self.dll.wrap_crypto_box_beforenm(shared, public, secret)
+        result = func(shared, public, secret)
 
         if result != 0:
             error = "Crypto_box_beforenm() failed with exit-code %d" % result
@@ -238,19 +287,35 @@ class CryptoScalarMult():
             ctypes.POINTER(ctypes.c_char)
         )
 
+        dll.wrap_crypto_scalarmult_ws.restype = ctypes.c_int
+        dll.wrap_crypto_scalarmult_ws.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_scalarmult_base_ws.restype = ctypes.c_int
+        dll.wrap_crypto_scalarmult_base_ws.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char)
+        )
+
         self.dll = dll
 
-    def crypto_scalarmult(self, scalar, element):
+    def crypto_scalarmult(self, scalar, element, workspace=False):
         """ This function can be used to calculate a shared-secret one user's
         secret key and another user's public key. Calculated shared-secret will
         have the same value if calculated with the second user's secret key and
-        the first user's public key. """
+        the first user's public key. With 'workspace' set, the computation runs
+        in a caller-provided workspace (where the library supports one). """
 
         assert len(scalar) == self.crypto_scalarmult_SCALARBYTES
         assert len(element) == self.crypto_scalarmult_BYTES
 
+        suffix = '_ws' if workspace else ''
+        func = getattr(self.dll, 'wrap_crypto_scalarmult' + suffix)
         buffer = ctypes.create_string_buffer(self.crypto_scalarmult_BYTES)
-        result = self.dll.wrap_crypto_scalarmult(buffer, scalar, element)
+        result = func(buffer, scalar, element)
 
         if result != 0:
             errcode = "Crypto_scalarmult() failed with exit-code %d" % result
@@ -258,14 +323,16 @@ class CryptoScalarMult():
 
         return buffer.raw
 
-    def crypto_scalarmult_base(self, scalar):
+    def crypto_scalarmult_base(self, scalar, workspace=False):
         """ This function can be used to calculate the public-key that
         matches a secret key for some kinds NaCl operations. """
 
         assert len(scalar) == self.crypto_scalarmult_SCALARBYTES
 
+        suffix = '_ws' if workspace else ''
+        func = getattr(self.dll, 'wrap_crypto_scalarmult_base' + suffix)
         buffer = ctypes.create_string_buffer(self.crypto_scalarmult_BYTES)
-        result = self.dll.wrap_crypto_scalarmult_base(buffer, scalar)
+        result = func(buffer, scalar)
 
         if result != 0:
             errcode = "Crypto_scalarmult_base() failed with exit-code %d"
@@ -315,15 +382,129 @@ class CryptoSign():
             ctypes.POINTER(ctypes.c_char)
         )
 
+        dll.wrap_crypto_sign_detached.restype = ctypes.c_int
+        dll.wrap_crypto_sign_detached.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_sign_verify_detached.restype = ctypes.c_int
+        dll.wrap_crypto_sign_verify_detached.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_sign_keypair_ws.restype = ctypes.c_int
+        dll.wrap_crypto_sign_keypair_ws.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_sign_detached_ws.restype = ctypes.c_int
+        dll.wrap_crypto_sign_detached_ws.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_sign_verify_detached_ws.restype = ctypes.c_int
+        dll.wrap_crypto_sign_verify_detached_ws.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_sign_with_ctx.restype = ctypes.c_int
+        dll.wrap_crypto_sign_with_ctx.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_ulonglong),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_sign_detached_with_ctx.restype = ctypes.c_int
+        dll.wrap_crypto_sign_detached_with_ctx.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_sign_open_vk.restype = ctypes.c_int
+        dll.wrap_crypto_sign_open_vk.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_ulonglong),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        for name in ('vk', 'cached'):
+            func = getattr(dll, 'wrap_crypto_sign_verify_detached_' + name)
+            func.restype = ctypes.c_int
+            func.argtypes = (
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.c_ulonglong,
+                ctypes.POINTER(ctypes.c_char)
+            )
+
+        dll.wrap_crypto_sign_verify_batch.restype = ctypes.c_int
+        dll.wrap_crypto_sign_verify_batch.argtypes = (
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.POINTER(ctypes.c_ulonglong),
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_int)
+        )
+
+        dll.wrap_crypto_sign_many.restype = ctypes.c_int
+        dll.wrap_crypto_sign_many.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.POINTER(ctypes.c_ulonglong),
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_uint
+        )
+
+        dll.wrap_crypto_sign_ph.restype = ctypes.c_int
+        dll.wrap_crypto_sign_ph.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_sign_ph_verify.restype = ctypes.c_int
+        dll.wrap_crypto_sign_ph_verify.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
         self.dll = dll
 
-    def crypto_sign_keypair(self):
+    def crypto_sign_keypair(self, workspace=False):
         """Generates a crypto_sign keypair as binary data. Returns the result
         as a pair of bytes instances. """
 
+        suffix = '_ws' if workspace else ''
+        func = getattr(self.dll, 'wrap_crypto_sign_keypair' + suffix)
         secret = ctypes.create_string_buffer(self.crypto_sign_SECRETKEYBYTES)
         public = ctypes.create_string_buffer(self.crypto_sign_PUBLICKEYBYTES)
-        result = self.dll.wrap_crypto_sign_keypair(public, secret)
+        result = func(public, secret)
 
         if result != 0:
             errcode = "Key generator failed with exit-code %d" % result
@@ -350,6 +531,45 @@ class CryptoSign():
 
         return buffer.raw[0:signed_size.value]
 
+    def crypto_sign_with_ctx(self, message, secret):
+        """ Same as crypto_sign(), but goes through an expanded signing
+        context (where the library supports one). """
+
+        assert len(secret) == self.crypto_sign_SECRETKEYBYTES
+        buffer_length = len(message) + self.crypto_sign_BYTES
+
+        buffer = ctypes.create_string_buffer(buffer_length)
+        signed_size = ctypes.c_ulonglong(0)
+
+        result = self.dll.wrap_crypto_sign_with_ctx(buffer,
+                                                    ctypes.byref(signed_size),
+                                                    message, len(message),
+                                                    secret)
+
+        if result != 0:
+            errcode = "Crypto_sign_with_ctx() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return buffer.raw[0:signed_size.value]
+
+    def crypto_sign_detached_with_ctx(self, message, secret):
+        """ Same as crypto_sign_detached(), but goes through an expanded
+        signing context (where the library supports one). """
+
+        assert len(secret) == self.crypto_sign_SECRETKEYBYTES
+
+        buffer = ctypes.create_string_buffer(self.crypto_sign_BYTES)
+        result = self.dll.wrap_crypto_sign_detached_with_ctx(buffer, message,
+                                                             len(message),
+                                                             secret)
+
+        if result != 0:
+            errcode = "Crypto_sign_detached_with_ctx() failed with "
+            errcode += "exit-code %d"
+            raise ValueError(errcode % result)
+
+        return buffer.raw
+
     def crypto_sign_open(self, signed_message, public):
         """ Verifies a signed message using the sender's public key. Returns a
         copy of the message with the signature removed. """
@@ -370,6 +590,163 @@ class CryptoSign():
         return buffer.raw[0:length.value]
 
 
+    def crypto_sign_detached(self, message, secret, workspace=False):
+        """ Signs a message using the sender's secret key. Returns only the
+        signature, without a copy of the message. """
+
+        assert len(secret) == self.crypto_sign_SECRETKEYBYTES
+
+        suffix = '_ws' if workspace else ''
+        func = getattr(self.dll, 'wrap_crypto_sign_detached' + suffix)
+        buffer = ctypes.create_string_buffer(self.crypto_sign_BYTES)
+        result = func(buffer, message, len(message), secret)
+
+        if result != 0:
+            errcode = "Crypto_sign_detached() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return buffer.raw
+
+    def crypto_sign_verify_detached(self, signature, message, public,
+                                    workspace=False):
+        """ Verifies a detached signature against a message using the
+        sender's public key. """
+
+        assert len(signature) == self.crypto_sign_BYTES
+        assert len(public) == self.crypto_sign_PUBLICKEYBYTES
+
+        suffix = '_ws' if workspace else ''
+        func = getattr(self.dll, 'wrap_crypto_sign_verify_detached' + suffix)
+        result = func(signature, message, len(message), public)
+
+        if result != 0:
+            errcode = "Crypto_sign_verify_detached() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return 0
+
+
+    def crypto_sign_open_vk(self, signed_message, public):
+        """ Same as crypto_sign_open(), but goes through a decoded
+        verification key (where the library supports one). """
+
+        assert len(public) == self.crypto_sign_PUBLICKEYBYTES
+
+        buffer = ctypes.create_string_buffer(len(signed_message))
+        length = ctypes.c_ulonglong(0)
+
+        result = self.dll.wrap_crypto_sign_open_vk(buffer,
+                                                   ctypes.byref(length),
+                                                   signed_message,
+                                                   len(signed_message), public)
+
+        if result != 0:
+            errcode = "Crypto_sign_open_vk() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return buffer.raw[0:length.value]
+
+    def crypto_sign_verify_detached_vk(self, signature, message, public,
+                                       cached=False):
+        """ Same as crypto_sign_verify_detached(), but goes through a decoded
+        verification key, or through a persistent key cache if 'cached' is
+        True (where the library supports them). """
+
+        assert len(signature) == self.crypto_sign_BYTES
+        assert len(public) == self.crypto_sign_PUBLICKEYBYTES
+
+        name = 'cached' if cached else 'vk'
+        func = getattr(self.dll, 'wrap_crypto_sign_verify_detached_' + name)
+        result = func(signature, message, len(message), public)
+
+        if result != 0:
+            errcode = "Crypto_sign_verify_detached_%s() failed with "
+            errcode += "exit-code %d"
+            raise ValueError(errcode % (name, result))
+
+        return 0
+
+    def crypto_sign_verify_batch(self, signatures, messages, publics):
+        """ Verifies a list of detached signatures, each against the message
+        and public key at the same position. Returns a list with one result
+        per signature (0 for a valid signature). """
+
+        count = len(signatures)
+        assert len(messages) == count and len(publics) == count
+
+        for signature in signatures:
+            assert len(signature) == self.crypto_sign_BYTES
+
+        for public in publics:
+            assert len(public) == self.crypto_sign_PUBLICKEYBYTES
+
+        sigs = (ctypes.c_char_p * count)(*signatures)
+        msgs = (ctypes.c_char_p * count)(*messages)
+        lengths = (ctypes.c_ulonglong * count)(*[len(x) for x in messages])
+        keys = (ctypes.c_char_p * count)(*publics)
+        results = (ctypes.c_int * count)()
+
+        status = self.dll.wrap_crypto_sign_verify_batch(sigs, msgs, lengths,
+                                                        keys, count, results)
+
+        assert (status == 0) == all(x == 0 for x in results)
+        return list(results)
+
+    def crypto_sign_many(self, messages, secret, threads=0):
+        """ Signs each message in a list with the same secret key, using up to
+        'threads' workers. Returns a list of detached signatures in the same
+        order as the input. """
+
+        assert len(secret) == self.crypto_sign_SECRETKEYBYTES
+
+        count = len(messages)
+        buffer = ctypes.create_string_buffer(self.crypto_sign_BYTES * count)
+        msgs = (ctypes.c_char_p * count)(*messages)
+        lengths = (ctypes.c_ulonglong * count)(*[len(x) for x in messages])
+        result = self.dll.wrap_crypto_sign_many(buffer, msgs, lengths, count,
+                                                secret, threads)
+
+        if result != 0:
+            errcode = "Crypto_sign_many() failed with exit-code %d" % result
+            raise ValueError(errcode)
+
+        size = self.crypto_sign_BYTES
+        return [buffer.raw[size * k:size * (k + 1)] for k in range(count)]
+
+    def crypto_sign_ph(self, message, secret, step):
+        """ Creates an Ed25519ph signature of a message, feeding it to the
+        streaming sign API in pieces of 'step' bytes. """
+
+        assert len(secret) == self.crypto_sign_SECRETKEYBYTES
+
+        buffer = ctypes.create_string_buffer(self.crypto_sign_BYTES)
+        result = self.dll.wrap_crypto_sign_ph(buffer, message, len(message),
+                                              step, secret)
+
+        if result != 0:
+            errcode = "Crypto_sign_final_create() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return buffer.raw
+
+    def crypto_sign_ph_verify(self, signature, message, public, step):
+        """ Verifies an Ed25519ph signature of a message, feeding it to the
+        streaming verify API in pieces of 'step' bytes. """
+
+        assert len(signature) == self.crypto_sign_BYTES
+        assert len(public) == self.crypto_sign_PUBLICKEYBYTES
+
+        result = self.dll.wrap_crypto_sign_ph_verify(signature, message,
+                                                     len(message), step,
+                                                     public)
+
+        if result != 0:
+            errcode = "Crypto_sign_final_verify() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return 0
+
+
 class CryptoSecretbox():
     """ Ctypes wrapper around the crypto_secretbox() functions from libcrypto
     (which provides wrappers around NaCl functions/constants). """
@@ -406,8 +783,134 @@ class CryptoSecretbox():
             ctypes.POINTER(ctypes.c_char)
         )
 
+        for name in ['wrap_crypto_secretbox_detached',
+                     'wrap_crypto_secretbox_open_detached']:
+            getattr(dll, name).restype = ctypes.c_int
+            getattr(dll, name).argtypes = (
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.c_ulonglong,
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.POINTER(ctypes.c_char)
+            )
+
+        if hasattr(dll, 'wrap_crypto_nonce_seq_init'):
+            for constant in ['wrap_crypto_nonce_SEQBYTES',
+                             'wrap_crypto_nonce_CHECKBYTES',
+                             'wrap_crypto_nonce_WINDOW']:
+                attribute = ctypes.cast(getattr(dll, constant),
+                                        uintptr_t).contents
+                self.__dict__[constant.replace("wrap_", "")] = attribute.value
+
+            dll.wrap_crypto_nonce_seq_init.restype = ctypes.c_int
+            dll.wrap_crypto_nonce_seq_init.argtypes = (
+                ctypes.POINTER(ctypes.c_char),
+            )
+
+            dll.wrap_crypto_nonce_seq_next.restype = ctypes.c_int
+            dll.wrap_crypto_nonce_seq_next.argtypes = (
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.POINTER(ctypes.c_char)
+            )
+
+            dll.wrap_crypto_nonce_check_init.restype = ctypes.c_int
+            dll.wrap_crypto_nonce_check_init.argtypes = (
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.POINTER(ctypes.c_char)
+            )
+
+            for name in ['wrap_crypto_secretbox_seq',
+                         'wrap_crypto_secretbox_open_seq']:
+                getattr(dll, name).restype = ctypes.c_int
+                getattr(dll, name).argtypes = (
+                    ctypes.POINTER(ctypes.c_char),
+                    ctypes.POINTER(ctypes.c_char),
+                    ctypes.c_ulonglong,
+                    ctypes.POINTER(ctypes.c_char),
+                    ctypes.POINTER(ctypes.c_char),
+                    ctypes.POINTER(ctypes.c_char)
+                )
+
         self.dll = dll
 
+    def has_crypto_nonce_seq(self):
+        """ Returns True if the library provides the crypto_nonce_seq
+        functions, which are a saline extension. """
+
+        return hasattr(self.dll, 'wrap_crypto_nonce_seq_init')
+
+    def crypto_nonce_seq(self):
+        """ Returns a fresh sender state (random prefix, counter 0) as a
+        mutable buffer. """
+
+        state = ctypes.create_string_buffer(self.crypto_nonce_SEQBYTES)
+
+        if self.dll.wrap_crypto_nonce_seq_init(state) != 0:
+            raise ValueError("Crypto_nonce_seq_init() failed")
+
+        return state
+
+    def crypto_nonce_seq_next(self, state):
+        """ Draws the next nonce from a sender state. """
+
+        nonce = ctypes.create_string_buffer(self.crypto_secretbox_NONCEBYTES)
+
+        if self.dll.wrap_crypto_nonce_seq_next(state, nonce) != 0:
+            raise ValueError("Crypto_nonce_seq_next() failed")
+
+        return nonce.raw
+
+    def crypto_nonce_check(self, prefix):
+        """ Returns a receiver state that accepts nonces with 'prefix'. """
+
+        state = ctypes.create_string_buffer(self.crypto_nonce_CHECKBYTES)
+
+        if self.dll.wrap_crypto_nonce_check_init(state, prefix) != 0:
+            raise ValueError("Crypto_nonce_check_init() failed")
+
+        return state
+
+    def crypto_secretbox_seq(self, plaintext, key, state):
+        """ Encrypts a block of data under the next nonce from 'state'.
+        Returns the cyphertext and the nonce that was used. """
+
+        assert len(key) == self.crypto_secretbox_KEYBYTES
+
+        plaintext = bytes(self.crypto_secretbox_ZEROBYTES) + plaintext
+        buffer = ctypes.create_string_buffer(len(plaintext))
+        nonce = ctypes.create_string_buffer(self.crypto_secretbox_NONCEBYTES)
+
+        result = self.dll.wrap_crypto_secretbox_seq(buffer, plaintext,
+                                                    len(plaintext), nonce,
+                                                    state, key)
+
+        if result != 0:
+            errcode = "Crypto_secretbox_seq() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return buffer.raw[self.crypto_secretbox_BOXZEROBYTES:], nonce.raw
+
+    def crypto_secretbox_open_seq(self, cypher, key, nonce, state):
+        """ Decrypts a block of data, rejecting nonces that 'state' has
+        already seen or that carry a different prefix. """
+
+        assert len(key) == self.crypto_secretbox_KEYBYTES
+        assert len(nonce) == self.crypto_secretbox_NONCEBYTES
+
+        cypher = bytes(self.crypto_secretbox_BOXZEROBYTES) + cypher
+        buffer = ctypes.create_string_buffer(len(cypher))
+
+        result = self.dll.wrap_crypto_secretbox_open_seq(buffer, cypher,
+                                                         len(cypher), nonce,
+                                                         state, key)
+
+        if result != 0:
+            errcode = "Crypto_secretbox_open_seq() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return buffer.raw[self.crypto_secretbox_ZEROBYTES:]
+
     def crypto_secretbox_key(self):
         """ Generates a random key for use with crypto_secretbox(). Note that
         any random value will also work, assuming that it's the right size. """
@@ -456,6 +959,32 @@ class CryptoSecretbox():
 
         return buffer.raw[self.crypto_secretbox_ZEROBYTES:]
 
+    def crypto_secretbox_detached(self, plaintext, key, nonce):
+        """ Encrypts without padding. Returns the authenticator followed by
+        the cypher text, the same bytes crypto_secretbox() returns. """
+
+        mac = ctypes.create_string_buffer(16)
+        buffer = ctypes.create_string_buffer(len(plaintext))
+        result = self.dll.wrap_crypto_secretbox_detached(
+            buffer, mac, plaintext, len(plaintext), nonce, key)
+
+        if result != 0:
+            raise ValueError("Crypto_secretbox_detached() failed")
+
+        return mac.raw + buffer.raw
+
+    def crypto_secretbox_open_detached(self, cypher, key, nonce):
+        """ Decrypts an authenticator followed by unpadded cypher text. """
+
+        buffer = ctypes.create_string_buffer(len(cypher) - 16)
+        result = self.dll.wrap_crypto_secretbox_open_detached(
+            buffer, cypher[16:], cypher[0:16], len(cypher) - 16, nonce, key)
+
+        if result != 0:
+            raise ValueError("Crypto_secretbox_open_detached() failed")
+
+        return buffer.raw
+
 
 class CryptoStream():
     """ Ctypes wrapper around the crypto_stream() functions from libcrypto
@@ -595,6 +1124,40 @@ class CryptoAuth():
             ctypes.POINTER(ctypes.c_char)
         )
 
+        dll.wrap_crypto_auth_stream.restype = ctypes.c_int
+        dll.wrap_crypto_auth_stream.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_auth_stream_verify.restype = ctypes.c_int
+        dll.wrap_crypto_auth_stream_verify.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_auth_with_ctx.restype = ctypes.c_int
+        dll.wrap_crypto_auth_with_ctx.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
+        dll.wrap_crypto_auth_verify_with_ctx.restype = ctypes.c_int
+        dll.wrap_crypto_auth_verify_with_ctx.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.POINTER(ctypes.c_char)
+        )
+
         self.dll = dll
 
     def crypto_auth_key(self):
@@ -640,6 +1203,82 @@ class CryptoAuth():
         return 0
 
 
+    def crypto_auth_stream(self, message, key, step):
+        """ Same as crypto_auth(), but feeds the message to the incremental
+        auth API in pieces of 'step' bytes. """
+
+        assert len(key) == self.crypto_auth_KEYBYTES
+
+        buffer = ctypes.create_string_buffer(self.crypto_auth_BYTES)
+        result = self.dll.wrap_crypto_auth_stream(buffer, message,
+                                                  len(message), step, key)
+
+        if result != 0:
+            errcode = "Crypto_auth_stream() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return buffer.raw
+
+    def crypto_auth_stream_verify(self, message, authenticator, key, step,
+                                  throw=True):
+        """ Same as crypto_auth_verify(), but feeds the message to the
+        incremental auth API in pieces of 'step' bytes. """
+
+        assert len(key) == self.crypto_auth_KEYBYTES
+        assert len(authenticator) == self.crypto_auth_BYTES
+
+        result = self.dll.wrap_crypto_auth_stream_verify(authenticator,
+                                                         message,
+                                                         len(message), step,
+                                                         key)
+
+        if throw is False:
+            return result == 0
+
+        if result != 0:
+            errcode = "Crypto_auth_stream_verify() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return 0
+
+    def crypto_auth_with_ctx(self, message, key):
+        """ Same as crypto_auth(), but goes through a precomputed per-key
+        context (where the library supports one). """
+
+        assert len(key) == self.crypto_auth_KEYBYTES
+
+        buffer = ctypes.create_string_buffer(self.crypto_auth_BYTES)
+        result = self.dll.wrap_crypto_auth_with_ctx(buffer, message,
+                                                    len(message), key)
+
+        if result != 0:
+            errcode = "Crypto_auth_with_ctx() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return buffer.raw
+
+    def crypto_auth_verify_with_ctx(self, message, authenticator, key,
+                                    throw=True):
+        """ Same as crypto_auth_verify(), but goes through a precomputed
+        per-key context (where the library supports one). """
+
+        assert len(key) == self.crypto_auth_KEYBYTES
+        assert len(authenticator) == self.crypto_auth_BYTES
+
+        result = self.dll.wrap_crypto_auth_verify_with_ctx(authenticator,
+                                                           message,
+                                                           len(message), key)
+
+        if throw is False:
+            return result == 0
+
+        if result != 0:
+            errcode = "Crypto_auth_verify_with_ctx() failed with exit-code %d"
+            raise ValueError(errcode % result)
+
+        return 0
+
+
 class CryptoOnetimeauth():
     """ Ctypes wrapper around the crypto_onetimeauth() functions from libcrypto
     (which provides wrappers around NaCl functions/constants). """
@@ -743,6 +1382,92 @@ class CryptoMisc():
             ctypes.c_ulonglong
         )
 
+        dll.wrap_crypto_hash_ws.restype = ctypes.c_int
+        dll.wrap_crypto_hash_ws.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong
+        )
+
+        dll.wrap_crypto_hash_stream.restype = ctypes.c_int
+        dll.wrap_crypto_hash_stream.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.c_ulonglong,
+            ctypes.c_ulonglong
+        )
+
+        dll.wrap_crypto_hash_many.restype = ctypes.c_int
+        dll.wrap_crypto_hash_many.argtypes = (
+            ctypes.POINTER(ctypes.c_char),
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.POINTER(ctypes.c_ulonglong),
+            ctypes.c_ulonglong
+        )
+
+        if hasattr(dll, 'wrap_crypto_hash_tree'):
+            dll.wrap_crypto_hash_tree.restype = ctypes.c_int
+            dll.wrap_crypto_hash_tree.argtypes = (
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.POINTER(ctypes.c_char),
+                ctypes.c_ulonglong,
+                ctypes.c_ulonglong,
+                ctypes.c_uint
+            )
+
+        if hasattr(dll, 'wrap_saline_stats_snapshot'):
+            attribute = ctypes.cast(dll.wrap_saline_stats_FIELDS,
+                                    uintptr_t).contents
+            self.saline_stats_FIELDS = attribute.value
+
+            dll.wrap_saline_stats_snapshot.restype = ctypes.c_int
+            dll.wrap_saline_stats_snapshot.argtypes = (
+                ctypes.POINTER(ctypes.c_ulonglong),
+            )
+
+            dll.wrap_saline_stats_reset.restype = ctypes.c_int
+            dll.wrap_saline_stats_reset.argtypes = ()
+
+        if hasattr(dll, 'wrap_saline_arena_create'):
+            dll.wrap_saline_arena_create.restype = ctypes.c_void_p
+            dll.wrap_saline_arena_create.argtypes = (ctypes.c_uint,
+                                                     ctypes.c_uint)
+
+            dll.wrap_saline_arena_alloc.restype = ctypes.c_void_p
+            dll.wrap_saline_arena_alloc.argtypes = (ctypes.c_void_p,)
+
+            dll.wrap_saline_arena_free.restype = ctypes.c_int
+            dll.wrap_saline_arena_free.argtypes = (ctypes.c_void_p,
+                                                   ctypes.c_void_p)
+
+            dll.wrap_saline_arena_destroy.restype = None
+            dll.wrap_saline_arena_destroy.argtypes = (ctypes.c_void_p,)
+
+        if hasattr(dll, 'wrap_saline_async_run'):
+            pointers = ctypes.POINTER(ctypes.c_char_p)
+            dll.wrap_saline_async_run.restype = ctypes.c_int
+            dll.wrap_saline_async_run.argtypes = (
+                ctypes.c_uint,
+                ctypes.POINTER(ctypes.c_int),
+                ctypes.POINTER(ctypes.c_void_p),
+                ctypes.POINTER(ctypes.c_ulonglong),
+                pointers,
+                ctypes.POINTER(ctypes.c_ulonglong),
+                pointers,
+                pointers,
+                pointers,
+                ctypes.POINTER(ctypes.c_ulonglong),
+                ctypes.POINTER(ctypes.c_int),
+                ctypes.c_uint
+            )
+
+        if hasattr(dll, 'wrap_saline_implementation_info'):
+            dll.wrap_saline_implementation_info.restype = ctypes.c_int
+            dll.wrap_saline_implementation_info.argtypes = (
+                ctypes.POINTER(ctypes.c_char_p),
+                ctypes.POINTER(ctypes.c_uint)
+            )
+
         dll.wrap_crypto_verify_16.restype = ctypes.c_int
         dll.wrap_crypto_verify_16.argtypes = (
             ctypes.POINTER(ctypes.c_char),
@@ -757,11 +1482,13 @@ class CryptoMisc():
 
         self.dll = dll
 
-    def crypto_hash(self, message):
+    def crypto_hash(self, message, workspace=False):
         """ Calculates the sha512sum of an input message. """
 
+        suffix = '_ws' if workspace else ''
+        func = getattr(self.dll, 'wrap_crypto_hash' + suffix)
         buffer = ctypes.create_string_buffer(self.crypto_hash_BYTES)
-        result = self.dll.wrap_crypto_hash(buffer, message, len(message))
+        result = func(buffer, message, len(message))
 
         if result != 0:
             errcode = "Crypto_hash() failed with exit-code %d" % result
@@ -769,6 +1496,195 @@ class CryptoMisc():
 
         return buffer.raw
 
+    def crypto_hash_stream(self, message, step):
+        """ Calculates the sha512sum of an input message, feeding it to the
+        incremental hash API in pieces of 'step' bytes. """
+
+        buffer = ctypes.create_string_buffer(self.crypto_hash_BYTES)
+        result = self.dll.wrap_crypto_hash_stream(buffer, message,
+                                                  len(message), step)
+
+        if result != 0:
+            errcode = "Crypto_hash_stream() failed with exit-code %d" % result
+            raise ValueError(errcode)
+
+        return buffer.raw
+
+    def crypto_hash_many(self, messages):
+        """ Calculates the sha512sum of each message in a list of messages.
+        Returns the results as a list, in the same order as the input. """
+
+        count = len(messages)
+        buffer = ctypes.create_string_buffer(self.crypto_hash_BYTES * count)
+        inputs = (ctypes.c_char_p * count)(*messages)
+        lengths = (ctypes.c_ulonglong * count)(*[len(x) for x in messages])
+        result = self.dll.wrap_crypto_hash_many(buffer, inputs, lengths, count)
+
+        if result != 0:
+            errcode = "Crypto_hash_many() failed with exit-code %d" % result
+            raise ValueError(errcode)
+
+        size = self.crypto_hash_BYTES
+        return [buffer.raw[size * k:size * (k + 1)] for k in range(count)]
+
+    STATS_COUNTERS = ['hash', 'hash_many', 'hash_tree', 'auth', 'onetimeauth',
+                      'stream', 'secretbox', 'secretbox_open', 'box',
+                      'box_open', 'box_beforenm', 'scalarmult', 'sign',
+                      'sign_verify', 'sign_verify_batch', 'randombytes']
+
+    STATS_WORK = ['salsa20_blocks', 'poly1305_blocks', 'sha512_blocks',
+                  'field_multiplications', 'field_inversions']
+
+    def has_stats(self):
+        """ Returns True if the library was built with --enable-stats. The
+        stats API is a saline extension, and it reports failure when the
+        counters are compiled out. """
+
+        if not hasattr(self.dll, 'wrap_saline_stats_snapshot'):
+            return False
+
+        fields = (ctypes.c_ulonglong * self.saline_stats_FIELDS)()
+        return self.dll.wrap_saline_stats_snapshot(fields) == 0
+
+    def stats_reset(self):
+        """ Starts a new counting interval. """
+
+        if self.dll.wrap_saline_stats_reset() != 0:
+            raise ValueError("Saline_stats_reset() failed")
+
+    def stats_snapshot(self):
+        """ Returns the counters since the last reset as a dict. Call counters
+        map to (calls, bytes) tuples; work counters map to integers. """
+
+        fields = (ctypes.c_ulonglong * self.saline_stats_FIELDS)()
+
+        if self.dll.wrap_saline_stats_snapshot(fields) != 0:
+            raise ValueError("Saline_stats_snapshot() failed")
+
+        count = len(self.STATS_COUNTERS)
+        stats = {x: (fields[2 * i], fields[2 * i + 1])
+                 for i, x in enumerate(self.STATS_COUNTERS)}
+        stats.update({x: fields[2 * count + i]
+                      for i, x in enumerate(self.STATS_WORK)})
+        return stats
+
+    def has_implementation_info(self):
+        """ Returns True if the library reports its dispatched kernels, which
+        is a saline extension. """
+
+        return hasattr(self.dll, 'wrap_saline_implementation_info')
+
+    def implementation_info(self):
+        """ Returns a dict naming the configured profile, the selected backend,
+        the kernel behind each primitive, and the detected CPU feature bits. """
+
+        names = (ctypes.c_char_p * 6)()
+        features = ctypes.c_uint()
+
+        if self.dll.wrap_saline_implementation_info(names, features) != 0:
+            raise ValueError("Saline_implementation_info() failed")
+
+        keys = ['backend', 'salsa20', 'poly1305', 'sha512', 'field',
+                'profile']
+        info = {x: y.decode() for x, y in zip(keys, names)}
+        info['cpu_features'] = features.value
+        return info
+
+    def has_arena(self):
+        """ Returns True if the library has the saline_arena allocator, which
+        is a saline extension. """
+
+        return hasattr(self.dll, 'wrap_saline_arena_create')
+
+    def arena_create(self, slot_bytes, slots):
+        """ Returns a handle to a new arena, or None if the slab couldn't be
+        mapped or locked. """
+
+        return self.dll.wrap_saline_arena_create(slot_bytes, slots)
+
+    def arena_alloc(self, arena):
+        """ Returns the address of a free slot, or None if there is none. """
+
+        return self.dll.wrap_saline_arena_alloc(arena)
+
+    def arena_free(self, arena, slot):
+        """ Returns a slot to its arena. Returns the C result, 0 or -1. """
+
+        return self.dll.wrap_saline_arena_free(arena, slot)
+
+    def arena_destroy(self, arena):
+        """ Wipes and releases an arena and all of its slots. """
+
+        self.dll.wrap_saline_arena_destroy(arena)
+
+    ASYNC_OPS = ['BOX', 'BOX_OPEN', 'SECRETBOX', 'SECRETBOX_OPEN', 'SIGN',
+                 'SIGN_OPEN', 'HASH']
+
+    def has_async(self):
+        """ Returns True if the library has the saline_async job pool, which
+        is a saline extension that needs threads. """
+
+        if not hasattr(self.dll, 'wrap_saline_async_run'):
+            return False
+
+        return self.async_run([], 1) is not None
+
+    def async_run(self, jobs, threads=0):
+        """ Runs a list of jobs on a saline_async pool. Each job is a dict with
+        'op' (one of ASYNC_OPS), 'in', 'out_size' and, where the op uses them,
+        'nonce', 'key', 'peer_key' and 'chunk'. Returns a list of (result,
+        output) pairs, or None if no pool could be created. Signing outputs
+        are cut to the length the op reports. """
+
+        count = len(jobs)
+        outs = [ctypes.create_string_buffer(x['out_size']) for x in jobs]
+        out_lengths = (ctypes.c_ulonglong * count)()
+        in_lengths = (ctypes.c_ulonglong * count)(*[len(x['in']) for x in jobs])
+        chunks = (ctypes.c_ulonglong * count)(*[x.get('chunk', 0)
+                                                 for x in jobs])
+        results = (ctypes.c_int * count)()
+        ops = (ctypes.c_int * count)(*[self.ASYNC_OPS.index(x['op']) + 1
+                                       for x in jobs])
+
+        def pointers(values):
+            return (ctypes.c_char_p * count)(*values)
+
+        result = self.dll.wrap_saline_async_run(
+            count, ops,
+            (ctypes.c_void_p * count)(*[ctypes.addressof(x) for x in outs]),
+            out_lengths, pointers([x['in'] for x in jobs]), in_lengths,
+            pointers([x.get('nonce') for x in jobs]),
+            pointers([x.get('key') for x in jobs]),
+            pointers([x.get('peer_key') for x in jobs]), chunks, results,
+            threads)
+
+        if result != 0:
+            return None
+
+        signs = [x['op'] in ('SIGN', 'SIGN_OPEN') for x in jobs]
+        return [(results[i], outs[i].raw[0:out_lengths[i]] if signs[i]
+                 else outs[i].raw) for i in range(count)]
+
+    def has_crypto_hash_tree(self):
+        """ Returns True if the library provides crypto_hash_tree(), which is
+        a saline-specific extension. """
+
+        return hasattr(self.dll, 'wrap_crypto_hash_tree')
+
+    def crypto_hash_tree(self, message, chunk_length, threads=0):
+        """ Calculates the parallel SHA-512 tree-hash of an input message,
+        using leaves of 'chunk_length' bytes. """
+
+        buffer = ctypes.create_string_buffer(self.crypto_hash_BYTES)
+        result = self.dll.wrap_crypto_hash_tree(buffer, message, len(message),
+                                                chunk_length, threads)
+
+        if result != 0:
+            errcode = "Crypto_hash_tree() failed with exit-code %d" % result
+            raise ValueError(errcode)
+
+        return buffer.raw
+
     def crypto_verify_16(self, block_a, block_b, throw=True):
         """ Verifies whether two 16-byte blocks of data are identical. Does it
         in constant-time in all cases. """
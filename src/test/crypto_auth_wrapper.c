@@ -2,6 +2,8 @@
 #include "saline.h"
 #else
 #include <sodium/crypto_auth.h>
+#include <sodium/crypto_auth_hmacsha512256.h>
+#include <sodium/utils.h>
 #endif
 
 #include "crypto_wrappers.h"
@@ -20,3 +22,89 @@ int wrap_crypto_auth_verify(const unsigned char *auth, const unsigned char *msg,
 {
     return crypto_auth_verify(auth, msg, length, key);
 }
+
+int wrap_crypto_auth_with_ctx(unsigned char *auth, const unsigned char *msg,
+                              unsigned long long length,
+                              const unsigned char *key)
+{
+#ifdef USE_SALINE
+    crypto_auth_ctx ctx;
+    crypto_auth_ctx_init(&ctx, key);
+    return crypto_auth_with_ctx(auth, msg, length, &ctx);
+#else
+    return crypto_auth(auth, msg, length, key);
+#endif
+}
+
+int wrap_crypto_auth_verify_with_ctx(const unsigned char *auth,
+                                     const unsigned char *msg,
+                                     unsigned long long length,
+                                     const unsigned char *key)
+{
+#ifdef USE_SALINE
+    crypto_auth_ctx ctx;
+    crypto_auth_ctx_init(&ctx, key);
+    return crypto_auth_verify_with_ctx(auth, msg, length, &ctx);
+#else
+    return crypto_auth_verify(auth, msg, length, key);
+#endif
+}
+
+#ifdef USE_SALINE
+typedef crypto_auth_state wrap_auth_state;
+#else
+typedef crypto_auth_hmacsha512256_state wrap_auth_state;
+#endif
+
+static void wrap_auth_stream(wrap_auth_state *state, const unsigned char *msg,
+                             unsigned long long length,
+                             unsigned long long step, const unsigned char *key)
+{
+#ifdef USE_SALINE
+    crypto_auth_init(state, key);
+#else
+    crypto_auth_hmacsha512256_init(state, key, crypto_auth_KEYBYTES);
+#endif
+
+    while (length > 0) {
+        unsigned long long chunk = (length < step) ? length : step;
+#ifdef USE_SALINE
+        crypto_auth_update(state, msg, chunk);
+#else
+        crypto_auth_hmacsha512256_update(state, msg, chunk);
+#endif
+        msg += chunk;
+        length -= chunk;
+    }
+}
+
+int wrap_crypto_auth_stream(unsigned char *auth, const unsigned char *msg,
+                            unsigned long long length,
+                            unsigned long long step,
+                            const unsigned char *key)
+{
+    wrap_auth_state state;
+    wrap_auth_stream(&state, msg, length, step, key);
+#ifdef USE_SALINE
+    return crypto_auth_final(&state, auth);
+#else
+    return crypto_auth_hmacsha512256_final(&state, auth);
+#endif
+}
+
+int wrap_crypto_auth_stream_verify(const unsigned char *auth,
+                                   const unsigned char *msg,
+                                   unsigned long long length,
+                                   unsigned long long step,
+                                   const unsigned char *key)
+{
+    wrap_auth_state state;
+    wrap_auth_stream(&state, msg, length, step, key);
+#ifdef USE_SALINE
+    return crypto_auth_final_verify(&state, auth);
+#else
+    unsigned char correct[crypto_auth_BYTES];
+    crypto_auth_hmacsha512256_final(&state, correct);
+    return sodium_memcmp(auth, correct, crypto_auth_BYTES);
+#endif
+}
@@ -4,6 +4,8 @@
 #include <sodium/crypto_box.h>
 #endif
 
+#include <string.h>
+
 #include "crypto_wrappers.h"
 
 const unsigned int wrap_crypto_box_PUBLICKEYBYTES = crypto_box_PUBLICKEYBYTES;
@@ -33,12 +35,48 @@ int wrap_crypto_box_open(unsigned char *plain, const unsigned char *cypher,
     return crypto_box_open(plain, cypher, cypher_length, nonce, pubkey, secret);
 }
 
+int wrap_crypto_box_detached(unsigned char *cypher, unsigned char *mac,
+                             const unsigned char *plain,
+                             unsigned long long plain_length,
+                             const unsigned char *nonce,
+                             const unsigned char *pubkey,
+                             const unsigned char *secret)
+{
+    return crypto_box_detached(cypher, mac, plain, plain_length, nonce, pubkey,
+                               secret);
+}
+
+int wrap_crypto_box_open_detached(unsigned char *plain,
+                                  const unsigned char *cypher,
+                                  const unsigned char *mac,
+                                  unsigned long long cypher_length,
+                                  const unsigned char *nonce,
+                                  const unsigned char *pubkey,
+                                  const unsigned char *secret)
+{
+    return crypto_box_open_detached(plain, cypher, mac, cypher_length, nonce,
+                                    pubkey, secret);
+}
+
 int wrap_crypto_box_beforenm(unsigned char *shared, const unsigned char *pubkey,
                              const unsigned char *secret)
 {
     return crypto_box_beforenm(shared, pubkey, secret);
 }
 
+int wrap_crypto_box_beforenm_ws(unsigned char *shared,
+                                const unsigned char *pubkey,
+                                const unsigned char *secret)
+{
+#ifdef USE_SALINE
+    crypto_scalarmult_workspace workspace;
+    memset(&workspace, 0xa5, sizeof(workspace));
+    return crypto_box_beforenm_ws(shared, pubkey, secret, &workspace);
+#else
+    return crypto_box_beforenm(shared, pubkey, secret);
+#endif
+}
+
 int wrap_crypto_box_afternm(unsigned char *cypher, const unsigned char *plain,
                             unsigned long long plain_length,
                             const unsigned char *nonce,
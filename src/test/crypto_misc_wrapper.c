@@ -1,11 +1,18 @@
 #ifdef USE_SALINE
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
 #include "saline.h"
 #else
 #include <sodium/crypto_hash.h>
+#include <sodium/crypto_hash_sha512.h>
 #include <sodium/crypto_verify_16.h>
 #include <sodium/crypto_verify_32.h>
 #endif
 
+#include <string.h>
+
 #include "crypto_wrappers.h"
 
 const unsigned int wrap_crypto_hash_BYTES = crypto_hash_BYTES;
@@ -16,6 +23,210 @@ int wrap_crypto_hash(unsigned char *output, const unsigned char *input,
     return crypto_hash(output, input, length);
 }
 
+/* The _ws wrappers start from a dirty workspace, since callers aren't
+ * required to clear one between uses. */
+
+int wrap_crypto_hash_ws(unsigned char *output, const unsigned char *input,
+                        unsigned long long length)
+{
+#ifdef USE_SALINE
+    crypto_hash_workspace workspace;
+    memset(&workspace, 0xa5, sizeof(workspace));
+    return crypto_hash_ws(output, input, length, &workspace);
+#else
+    return crypto_hash(output, input, length);
+#endif
+}
+
+int wrap_crypto_hash_many(unsigned char *output,
+                          const unsigned char *const *inputs,
+                          const unsigned long long *lengths,
+                          unsigned long long count)
+{
+#ifdef USE_SALINE
+    return crypto_hash_many(output, inputs, lengths, count);
+#else
+    for (unsigned long long i = 0; i < count; ++i) {
+        unsigned char *hash = output + i * crypto_hash_BYTES;
+
+        if (crypto_hash(hash, inputs[i], lengths[i])) {
+            return -1;
+        }
+    }
+
+    return 0;
+#endif
+}
+
+int wrap_crypto_hash_stream(unsigned char *output, const unsigned char *input,
+                            unsigned long long length,
+                            unsigned long long step)
+{
+#ifdef USE_SALINE
+    crypto_hash_state state;
+    crypto_hash_init(&state);
+#else
+    crypto_hash_sha512_state state;
+    crypto_hash_sha512_init(&state);
+#endif
+
+    while (length > 0) {
+        unsigned long long chunk = (length < step) ? length : step;
+#ifdef USE_SALINE
+        crypto_hash_update(&state, input, chunk);
+#else
+        crypto_hash_sha512_update(&state, input, chunk);
+#endif
+        input += chunk;
+        length -= chunk;
+    }
+
+#ifdef USE_SALINE
+    return crypto_hash_final(&state, output);
+#else
+    return crypto_hash_sha512_final(&state, output);
+#endif
+}
+
+#ifdef USE_SALINE
+int wrap_crypto_hash_tree(unsigned char *output, const unsigned char *input,
+                          unsigned long long length,
+                          unsigned long long chunk_length,
+                          unsigned int threads)
+{
+    return crypto_hash_tree(output, input, length, chunk_length, threads);
+}
+
+int wrap_saline_implementation_info(const char **names, unsigned int *features)
+{
+    saline_implementation info;
+    int result = saline_implementation_info(&info);
+
+    names[0] = info.backend;
+    names[1] = info.salsa20;
+    names[2] = info.poly1305;
+    names[3] = info.sha512;
+    names[4] = info.field;
+    names[5] = info.profile;
+    *features = info.cpu_features;
+    return result;
+}
+
+const unsigned int wrap_saline_stats_FIELDS =
+    sizeof(saline_stats) / sizeof(unsigned long long);
+
+int wrap_saline_stats_snapshot(unsigned long long *fields)
+{
+    saline_stats stats;
+    int result = saline_stats_snapshot(&stats);
+
+    for (unsigned int i = 0; i < wrap_saline_stats_FIELDS; ++i) {
+        fields[i] = ((const unsigned long long *) (const void *) &stats)[i];
+    }
+
+    return result;
+}
+
+int wrap_saline_stats_reset(void)
+{
+    return saline_stats_reset();
+}
+
+void *wrap_saline_arena_create(unsigned int slot_bytes, unsigned int slots)
+{
+    return saline_arena_create(slot_bytes, slots);
+}
+
+void *wrap_saline_arena_alloc(void *arena)
+{
+    return saline_arena_alloc(arena);
+}
+
+int wrap_saline_arena_free(void *arena, void *slot)
+{
+    return saline_arena_free(arena, slot);
+}
+
+void wrap_saline_arena_destroy(void *arena)
+{
+    saline_arena_destroy(arena);
+}
+
+static void wrap_async_done(saline_async_job *job, void *arg)
+{
+    (void) job;
+    __atomic_add_fetch((unsigned int *) arg, 1, __ATOMIC_RELAXED);
+}
+
+/* Runs 'count' jobs on a pool of 'threads' workers and waits for them. Odd
+ * jobs complete through a callback, and even jobs through the completion
+ * queue, which is drained whenever the pool's fd turns readable. */
+
+int wrap_saline_async_run(unsigned int count, const int *ops,
+                          unsigned char **outs,
+                          unsigned long long *out_lengths,
+                          const unsigned char **ins,
+                          const unsigned long long *in_lengths,
+                          const unsigned char **nonces,
+                          const unsigned char **keys,
+                          const unsigned char **peer_keys,
+                          const unsigned long long *chunk_lengths,
+                          int *results, unsigned int threads)
+{
+    saline_async *pool = saline_async_create(threads);
+    saline_async_job *jobs = calloc(count, sizeof(*jobs));
+    unsigned int callbacks = 0, polled = 0;
+    unsigned long long counter;
+
+    if (pool == 0 || (jobs == 0 && count != 0)) {
+        saline_async_destroy(pool);
+        free(jobs);
+        return -1;
+    }
+
+    for (unsigned int i = 0; i < count; ++i) {
+        jobs[i].op = ops[i];
+        jobs[i].out = outs[i];
+        jobs[i].out_length = &out_lengths[i];
+        jobs[i].in = ins[i];
+        jobs[i].in_length = in_lengths[i];
+        jobs[i].nonce = nonces[i];
+        jobs[i].key = keys[i];
+        jobs[i].peer_key = peer_keys[i];
+        jobs[i].chunk_length = chunk_lengths[i];
+        jobs[i].callback = (i & 1) ? wrap_async_done : 0;
+        jobs[i].arg = &callbacks;
+
+        if (saline_async_submit(pool, &jobs[i]) != 0) {
+            count = i;
+            break;
+        }
+    }
+
+    while (polled < (count + 1) / 2) {
+        struct pollfd ready = {saline_async_fd(pool), POLLIN, 0};
+
+        if (poll(&ready, 1, -1) <= 0 ||
+            read(ready.fd, &counter, sizeof(counter)) <= 0) {
+            continue;
+        }
+
+        while (saline_async_poll(pool) != 0) {
+            ++polled;
+        }
+    }
+
+    saline_async_destroy(pool);
+
+    for (unsigned int i = 0; i < count; ++i) {
+        results[i] = jobs[i].result;
+    }
+
+    free(jobs);
+    return (polled + callbacks == count) ? 0 : -1;
+}
+#endif
+
 int wrap_crypto_verify_16(const unsigned char *x, const unsigned char *y)
 {
     return crypto_verify_16(x, y);
@@ -4,6 +4,8 @@
 #include <sodium/crypto_scalarmult.h>
 #endif
 
+#include <string.h>
+
 #include "crypto_wrappers.h"
 
 const unsigned int wrap_crypto_scalarmult_BYTES = \
@@ -24,3 +26,28 @@ int wrap_crypto_scalarmult_base(unsigned char *result,
 {
     return crypto_scalarmult_base(result, scalar);
 }
+
+int wrap_crypto_scalarmult_ws(unsigned char *result,
+                              const unsigned char *scalar,
+                              const unsigned char *element)
+{
+#ifdef USE_SALINE
+    crypto_scalarmult_workspace workspace;
+    memset(&workspace, 0xa5, sizeof(workspace));
+    return crypto_scalarmult_ws(result, scalar, element, &workspace);
+#else
+    return crypto_scalarmult(result, scalar, element);
+#endif
+}
+
+int wrap_crypto_scalarmult_base_ws(unsigned char *result,
+                                   const unsigned char *scalar)
+{
+#ifdef USE_SALINE
+    crypto_scalarmult_workspace workspace;
+    memset(&workspace, 0xa5, sizeof(workspace));
+    return crypto_scalarmult_base_ws(result, scalar, &workspace);
+#else
+    return crypto_scalarmult_base(result, scalar);
+#endif
+}
@@ -33,3 +33,61 @@ int wrap_crypto_secretbox_open(unsigned char *plain,
 {
     return crypto_secretbox_open(plain, cypher, length, nonce, key);
 }
+
+int wrap_crypto_secretbox_detached(unsigned char *cypher, unsigned char *mac,
+                                   const unsigned char *plain,
+                                   unsigned long long length,
+                                   const unsigned char *nonce,
+                                   const unsigned char *key)
+{
+    return crypto_secretbox_detached(cypher, mac, plain, length, nonce, key);
+}
+
+int wrap_crypto_secretbox_open_detached(unsigned char *plain,
+                                        const unsigned char *cypher,
+                                        const unsigned char *mac,
+                                        unsigned long long length,
+                                        const unsigned char *nonce,
+                                        const unsigned char *key)
+{
+    return crypto_secretbox_open_detached(plain, cypher, mac, length, nonce,
+                                          key);
+}
+
+#ifdef USE_SALINE
+const unsigned int wrap_crypto_nonce_SEQBYTES = sizeof(crypto_nonce_seq);
+const unsigned int wrap_crypto_nonce_CHECKBYTES = sizeof(crypto_nonce_check);
+const unsigned int wrap_crypto_nonce_WINDOW = crypto_nonce_WINDOW;
+
+int wrap_crypto_nonce_seq_init(void *seq)
+{
+    return crypto_nonce_seq_init(seq);
+}
+
+int wrap_crypto_nonce_seq_next(void *seq, unsigned char *nonce)
+{
+    return crypto_nonce_seq_next(seq, nonce);
+}
+
+int wrap_crypto_nonce_check_init(void *check, const unsigned char *prefix)
+{
+    return crypto_nonce_check_init(check, prefix);
+}
+
+int wrap_crypto_secretbox_seq(unsigned char *cypher,
+                              const unsigned char *plain,
+                              unsigned long long length, unsigned char *nonce,
+                              void *seq, const unsigned char *key)
+{
+    return crypto_secretbox_seq(cypher, plain, length, nonce, seq, key);
+}
+
+int wrap_crypto_secretbox_open_seq(unsigned char *plain,
+                                   const unsigned char *cypher,
+                                   unsigned long long length,
+                                   const unsigned char *nonce, void *check,
+                                   const unsigned char *key)
+{
+    return crypto_secretbox_open_seq(plain, cypher, length, nonce, check, key);
+}
+#endif
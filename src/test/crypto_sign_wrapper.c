@@ -4,6 +4,8 @@
 #include <sodium/crypto_sign.h>
 #endif
 
+#include <string.h>
+
 #include "crypto_wrappers.h"
 
 const unsigned int wrap_crypto_sign_SECRETKEYBYTES = crypto_sign_SECRETKEYBYTES;
@@ -32,3 +34,218 @@ int wrap_crypto_sign_open(unsigned char *msg,
 {
     return crypto_sign_open(msg, length, signed_msg, signed_length, pubkey);
 }
+
+int wrap_crypto_sign_detached(unsigned char *signature,
+                              const unsigned char *msg,
+                              unsigned long long length,
+                              const unsigned char *secret)
+{
+    return crypto_sign_detached(signature, 0, msg, length, secret);
+}
+
+int wrap_crypto_sign_verify_detached(const unsigned char *signature,
+                                     const unsigned char *msg,
+                                     unsigned long long length,
+                                     const unsigned char *pubkey)
+{
+    return crypto_sign_verify_detached(signature, msg, length, pubkey);
+}
+
+int wrap_crypto_sign_keypair_ws(unsigned char *pubkey, unsigned char *secret)
+{
+#ifdef USE_SALINE
+    crypto_sign_workspace workspace;
+    memset(&workspace, 0xa5, sizeof(workspace));
+    return crypto_sign_keypair_ws(pubkey, secret, &workspace);
+#else
+    return crypto_sign_keypair(pubkey, secret);
+#endif
+}
+
+int wrap_crypto_sign_detached_ws(unsigned char *signature,
+                                 const unsigned char *msg,
+                                 unsigned long long length,
+                                 const unsigned char *secret)
+{
+#ifdef USE_SALINE
+    crypto_sign_workspace workspace;
+    memset(&workspace, 0xa5, sizeof(workspace));
+    return crypto_sign_detached_ws(signature, 0, msg, length, secret,
+                                   &workspace);
+#else
+    return crypto_sign_detached(signature, 0, msg, length, secret);
+#endif
+}
+
+int wrap_crypto_sign_verify_detached_ws(const unsigned char *signature,
+                                        const unsigned char *msg,
+                                        unsigned long long length,
+                                        const unsigned char *pubkey)
+{
+#ifdef USE_SALINE
+    crypto_sign_verify_workspace workspace;
+    memset(&workspace, 0xa5, sizeof(workspace));
+    return crypto_sign_verify_detached_ws(signature, msg, length, pubkey,
+                                          &workspace);
+#else
+    return crypto_sign_verify_detached(signature, msg, length, pubkey);
+#endif
+}
+
+int wrap_crypto_sign_with_ctx(unsigned char *signed_msg,
+                              unsigned long long *signed_length,
+                              const unsigned char *msg,
+                              unsigned long long length,
+                              const unsigned char *secret)
+{
+#ifdef USE_SALINE
+    crypto_sign_ctx ctx;
+    crypto_sign_ctx_init(&ctx, secret);
+    return crypto_sign_with_ctx(signed_msg, signed_length, msg, length, &ctx);
+#else
+    return crypto_sign(signed_msg, signed_length, msg, length, secret);
+#endif
+}
+
+int wrap_crypto_sign_detached_with_ctx(unsigned char *signature,
+                                       const unsigned char *msg,
+                                       unsigned long long length,
+                                       const unsigned char *secret)
+{
+#ifdef USE_SALINE
+    crypto_sign_ctx ctx;
+    crypto_sign_ctx_init(&ctx, secret);
+    return crypto_sign_detached_with_ctx(signature, 0, msg, length, &ctx);
+#else
+    return crypto_sign_detached(signature, 0, msg, length, secret);
+#endif
+}
+
+int wrap_crypto_sign_open_vk(unsigned char *msg, unsigned long long *length,
+                             const unsigned char *signed_msg,
+                             unsigned long long signed_length,
+                             const unsigned char *pubkey)
+{
+#ifdef USE_SALINE
+    crypto_sign_vk vk;
+    crypto_sign_vk_init(&vk, pubkey);
+    return crypto_sign_open_vk(msg, length, signed_msg, signed_length, &vk);
+#else
+    return crypto_sign_open(msg, length, signed_msg, signed_length, pubkey);
+#endif
+}
+
+int wrap_crypto_sign_verify_detached_vk(const unsigned char *signature,
+                                        const unsigned char *msg,
+                                        unsigned long long length,
+                                        const unsigned char *pubkey)
+{
+#ifdef USE_SALINE
+    crypto_sign_vk vk;
+    crypto_sign_vk_init(&vk, pubkey);
+    return crypto_sign_verify_detached_vk(signature, msg, length, &vk);
+#else
+    return crypto_sign_verify_detached(signature, msg, length, pubkey);
+#endif
+}
+
+/* The cache deliberately lives across calls, so repeated tests exercise both
+ * hits and evictions. */
+
+int wrap_crypto_sign_verify_detached_cached(const unsigned char *signature,
+                                            const unsigned char *msg,
+                                            unsigned long long length,
+                                            const unsigned char *pubkey)
+{
+#ifdef USE_SALINE
+    static crypto_sign_vk slots[3];
+    static crypto_sign_vk_cache cache;
+
+    if (cache.count == 0) {
+        crypto_sign_vk_cache_init(&cache, slots, 3);
+    }
+
+    return crypto_sign_verify_detached_cached(signature, msg, length, pubkey,
+                                              &cache);
+#else
+    return crypto_sign_verify_detached(signature, msg, length, pubkey);
+#endif
+}
+
+int wrap_crypto_sign_verify_batch(const unsigned char *const *signatures,
+                                  const unsigned char *const *msgs,
+                                  const unsigned long long *lengths,
+                                  const unsigned char *const *pubkeys,
+                                  unsigned long long count, int *results)
+{
+#ifdef USE_SALINE
+    return crypto_sign_verify_batch(signatures, msgs, lengths, pubkeys, count,
+                                    results);
+#else
+    int status = 0;
+
+    for (unsigned long long i = 0; i < count; ++i) {
+        results[i] = crypto_sign_verify_detached(signatures[i], msgs[i],
+                                                 lengths[i], pubkeys[i]);
+        status |= results[i];
+    }
+
+    return status;
+#endif
+}
+
+int wrap_crypto_sign_many(unsigned char *signatures,
+                          const unsigned char *const *msgs,
+                          const unsigned long long *lengths,
+                          unsigned long long count,
+                          const unsigned char *secret, unsigned int threads)
+{
+#ifdef USE_SALINE
+    return crypto_sign_many(signatures, msgs, lengths, count, secret, threads);
+#else
+    (void) threads;
+
+    for (unsigned long long i = 0; i < count; ++i) {
+        unsigned char *signature = signatures + i * crypto_sign_BYTES;
+
+        if (crypto_sign_detached(signature, 0, msgs[i], lengths[i], secret)) {
+            return -1;
+        }
+    }
+
+    return 0;
+#endif
+}
+
+static void wrap_sign_stream(crypto_sign_state *state, const unsigned char *msg,
+                             unsigned long long length, unsigned long long step)
+{
+    crypto_sign_init(state);
+
+    while (length > 0) {
+        unsigned long long chunk = (length < step) ? length : step;
+        crypto_sign_update(state, msg, chunk);
+        msg += chunk;
+        length -= chunk;
+    }
+}
+
+int wrap_crypto_sign_ph(unsigned char *signature, const unsigned char *msg,
+                        unsigned long long length, unsigned long long step,
+                        const unsigned char *secret)
+{
+    crypto_sign_state state;
+    wrap_sign_stream(&state, msg, length, step);
+    return crypto_sign_final_create(&state, signature, 0, secret);
+}
+
+int wrap_crypto_sign_ph_verify(const unsigned char *signature,
+                               const unsigned char *msg,
+                               unsigned long long length,
+                               unsigned long long step,
+                               const unsigned char *pubkey)
+{
+    crypto_sign_state state;
+    wrap_sign_stream(&state, msg, length, step);
+    return crypto_sign_final_verify(&state, signature, pubkey);
+}
@@ -9,6 +9,26 @@ int wrap_crypto_auth_verify(const unsigned char *auth,
                             unsigned long long length,
                             const unsigned char *key);
 
+int wrap_crypto_auth_with_ctx(unsigned char *auth, const unsigned char *msg,
+                              unsigned long long length,
+                              const unsigned char *key);
+
+int wrap_crypto_auth_verify_with_ctx(const unsigned char *auth,
+                                     const unsigned char *msg,
+                                     unsigned long long length,
+                                     const unsigned char *key);
+
+int wrap_crypto_auth_stream(unsigned char *auth, const unsigned char *msg,
+                            unsigned long long length,
+                            unsigned long long step,
+                            const unsigned char *key);
+
+int wrap_crypto_auth_stream_verify(const unsigned char *auth,
+                                   const unsigned char *msg,
+                                   unsigned long long length,
+                                   unsigned long long step,
+                                   const unsigned char *key);
+
 int wrap_crypto_box_keypair(unsigned char *pubkey, unsigned char *secret);
 
 int wrap_crypto_box(unsigned char *cypher, const unsigned char *plain,
@@ -21,9 +41,28 @@ int wrap_crypto_box_open(unsigned char *plain, const unsigned char *cypher,
                          const unsigned char *pubkey,
                          const unsigned char *secret);
 
+int wrap_crypto_box_detached(unsigned char *cypher, unsigned char *mac,
+                             const unsigned char *plain,
+                             unsigned long long plain_length,
+                             const unsigned char *nonce,
+                             const unsigned char *pubkey,
+                             const unsigned char *secret);
+
+int wrap_crypto_box_open_detached(unsigned char *plain,
+                                  const unsigned char *cypher,
+                                  const unsigned char *mac,
+                                  unsigned long long cypher_length,
+                                  const unsigned char *nonce,
+                                  const unsigned char *pubkey,
+                                  const unsigned char *secret);
+
 int wrap_crypto_box_beforenm(unsigned char *shared, const unsigned char *pubkey,
                              const unsigned char *secret);
 
+int wrap_crypto_box_beforenm_ws(unsigned char *shared,
+                                const unsigned char *pubkey,
+                                const unsigned char *secret);
+
 int wrap_crypto_box_afternm(unsigned char *cypher, const unsigned char *plain,
                             unsigned long long plain_length,
                             const unsigned char *nonce,
@@ -39,6 +78,38 @@ int wrap_crypto_box_open_afternm(unsigned char *plain,
 int wrap_crypto_hash(unsigned char *output, const unsigned char *input,
                      unsigned long long length);
 
+int wrap_crypto_hash_ws(unsigned char *output, const unsigned char *input,
+                        unsigned long long length);
+
+int wrap_crypto_hash_stream(unsigned char *output, const unsigned char *input,
+                            unsigned long long length,
+                            unsigned long long step);
+
+int wrap_crypto_hash_many(unsigned char *output,
+                          const unsigned char *const *inputs,
+                          const unsigned long long *lengths,
+                          unsigned long long count);
+
+int wrap_crypto_hash_tree(unsigned char *output, const unsigned char *input,
+                          unsigned long long length,
+                          unsigned long long chunk_length,
+                          unsigned int threads);
+
+int wrap_saline_implementation_info(const char **names,
+                                    unsigned int *features);
+
+int wrap_saline_stats_snapshot(unsigned long long *fields);
+
+int wrap_saline_stats_reset(void);
+
+void *wrap_saline_arena_create(unsigned int slot_bytes, unsigned int slots);
+
+void *wrap_saline_arena_alloc(void *arena);
+
+int wrap_saline_arena_free(void *arena, void *slot);
+
+void wrap_saline_arena_destroy(void *arena);
+
 int wrap_crypto_verify_16(const unsigned char *x, const unsigned char *y);
 
 
@@ -61,6 +132,13 @@ int wrap_crypto_scalarmult(unsigned char *result,
 int wrap_crypto_scalarmult_base(unsigned char *result,
                                 const unsigned char *scalar);
 
+int wrap_crypto_scalarmult_ws(unsigned char *result,
+                              const unsigned char *scalar,
+                              const unsigned char *element);
+
+int wrap_crypto_scalarmult_base_ws(unsigned char *result,
+                                   const unsigned char *scalar);
+
 
 int wrap_crypto_secretbox(unsigned char *cypher, const unsigned char *plain,
                           unsigned long long length, const unsigned char *nonce,
@@ -72,6 +150,36 @@ int wrap_crypto_secretbox_open(unsigned char *plain,
                                const unsigned char *nonce,
                                const unsigned char *key);
 
+int wrap_crypto_secretbox_detached(unsigned char *cypher, unsigned char *mac,
+                                   const unsigned char *plain,
+                                   unsigned long long length,
+                                   const unsigned char *nonce,
+                                   const unsigned char *key);
+
+int wrap_crypto_secretbox_open_detached(unsigned char *plain,
+                                        const unsigned char *cypher,
+                                        const unsigned char *mac,
+                                        unsigned long long length,
+                                        const unsigned char *nonce,
+                                        const unsigned char *key);
+
+int wrap_crypto_nonce_seq_init(void *seq);
+
+int wrap_crypto_nonce_seq_next(void *seq, unsigned char *nonce);
+
+int wrap_crypto_nonce_check_init(void *check, const unsigned char *prefix);
+
+int wrap_crypto_secretbox_seq(unsigned char *cypher,
+                              const unsigned char *plain,
+                              unsigned long long length, unsigned char *nonce,
+                              void *seq, const unsigned char *key);
+
+int wrap_crypto_secretbox_open_seq(unsigned char *plain,
+                                   const unsigned char *cypher,
+                                   unsigned long long length,
+                                   const unsigned char *nonce, void *check,
+                                   const unsigned char *key);
+
 int wrap_crypto_sign_keypair(unsigned char *pubkey, unsigned char *secret);
 
 int wrap_crypto_sign(unsigned char *signed_msg,
@@ -86,6 +194,76 @@ int wrap_crypto_sign_open(unsigned char *msg,
                           unsigned long long signed_length,
                           const unsigned char *pubkey);
 
+int wrap_crypto_sign_detached(unsigned char *signature,
+                              const unsigned char *msg,
+                              unsigned long long length,
+                              const unsigned char *secret);
+
+int wrap_crypto_sign_verify_detached(const unsigned char *signature,
+                                     const unsigned char *msg,
+                                     unsigned long long length,
+                                     const unsigned char *pubkey);
+
+int wrap_crypto_sign_keypair_ws(unsigned char *pubkey, unsigned char *secret);
+
+int wrap_crypto_sign_detached_ws(unsigned char *signature,
+                                 const unsigned char *msg,
+                                 unsigned long long length,
+                                 const unsigned char *secret);
+
+int wrap_crypto_sign_verify_detached_ws(const unsigned char *signature,
+                                        const unsigned char *msg,
+                                        unsigned long long length,
+                                        const unsigned char *pubkey);
+
+int wrap_crypto_sign_with_ctx(unsigned char *signed_msg,
+                              unsigned long long *signed_length,
+                              const unsigned char *msg,
+                              unsigned long long length,
+                              const unsigned char *secret);
+
+int wrap_crypto_sign_detached_with_ctx(unsigned char *signature,
+                                       const unsigned char *msg,
+                                       unsigned long long length,
+                                       const unsigned char *secret);
+
+int wrap_crypto_sign_open_vk(unsigned char *msg, unsigned long long *length,
+                             const unsigned char *signed_msg,
+                             unsigned long long signed_length,
+                             const unsigned char *pubkey);
+
+int wrap_crypto_sign_verify_detached_vk(const unsigned char *signature,
+                                        const unsigned char *msg,
+                                        unsigned long long length,
+                                        const unsigned char *pubkey);
+
+int wrap_crypto_sign_verify_detached_cached(const unsigned char *signature,
+                                            const unsigned char *msg,
+                                            unsigned long long length,
+                                            const unsigned char *pubkey);
+
+int wrap_crypto_sign_verify_batch(const unsigned char *const *signatures,
+                                  const unsigned char *const *msgs,
+                                  const unsigned long long *lengths,
+                                  const unsigned char *const *pubkeys,
+                                  unsigned long long count, int *results);
+
+int wrap_crypto_sign_many(unsigned char *signatures,
+                          const unsigned char *const *msgs,
+                          const unsigned long long *lengths,
+                          unsigned long long count,
+                          const unsigned char *secret, unsigned int threads);
+
+int wrap_crypto_sign_ph(unsigned char *signature, const unsigned char *msg,
+                        unsigned long long length, unsigned long long step,
+                        const unsigned char *secret);
+
+int wrap_crypto_sign_ph_verify(const unsigned char *signature,
+                               const unsigned char *msg,
+                               unsigned long long length,
+                               unsigned long long step,
+                               const unsigned char *pubkey);
+
 int wrap_crypto_stream(unsigned char *output, unsigned long long length,
                        const unsigned char *nonce, const unsigned char *key);
 
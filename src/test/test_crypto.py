@@ -3,11 +3,14 @@
 behavior against libsodium. """
 
 import sys
+import ctypes
 import os
 import json
 import copy
 import base64
 import random
+import hashlib
+import itertools
 import crypto
 
 #------------------------------------------------------------------------------#
@@ -190,6 +193,15 @@ def verify_crypto_box(source, data, keys):
     readback = source.box.crypto_box_open_afternm(afternm, shared, nonce)
     assert readback == data['box']['msg']
 
+    sender = keys['box']['sender']['secret']
+    receiver = keys['box']['receiver']['public']
+    detached = source.box.crypto_box_detached(msg, receiver, sender, nonce)
+    assert detached == cypher
+    readback = source.box.crypto_box_open_detached(cypher, public, secret,
+                                                   nonce)
+    assert readback == msg
+    assert source.box.crypto_box_beforenm(public, secret, True) == shared
+
     args = {'cypher': cypher, 'public': public, 'secret': secret,
             'nonce': nonce}
 
@@ -232,6 +244,10 @@ def verify_crypto_scalarmult(source, data):
     element = data['scalarmult']['element']
     mult = data['scalarmult']['mult']
     assert mult == source.scalarmult.crypto_scalarmult(scalar, element)
+    assert mult == source.scalarmult.crypto_scalarmult(scalar, element, True)
+
+    base = source.scalarmult.crypto_scalarmult_base(scalar)
+    assert base == source.scalarmult.crypto_scalarmult_base(scalar, True)
 
     args = {'element': element, 'scalar': scalar, 'mult': mult}
 
@@ -262,6 +278,61 @@ def verify_crypto_sign(source, data, keys):
     assert signed == source.sign.crypto_sign(msg, secret)
     readback = source.sign.crypto_sign_open(signed, public)
     assert readback == msg
+    assert source.sign.crypto_sign_open_vk(signed, public) == msg
+
+    signature = source.sign.crypto_sign_detached(msg, secret)
+    assert signature == signed[0:source.sign.crypto_sign_BYTES]
+    source.sign.crypto_sign_verify_detached(signature, msg, public)
+
+    assert signed == source.sign.crypto_sign_with_ctx(msg, secret)
+    assert signature == source.sign.crypto_sign_detached_with_ctx(msg, secret)
+    assert signature == source.sign.crypto_sign_detached(msg, secret, True)
+
+    pair = source.sign.crypto_sign_keypair(workspace=True)
+    assert pair[1][32:] == pair[0]
+    signature_ws = source.sign.crypto_sign_detached(msg, pair[1], True)
+    source.sign.crypto_sign_verify_detached(signature_ws, msg, pair[0], True)
+
+    args = {'signature': signature, 'msg': msg, 'public': public}
+    verifiers = (
+        source.sign.crypto_sign_verify_detached,
+        source.sign.crypto_sign_verify_detached_vk,
+        lambda *x: source.sign.crypto_sign_verify_detached_vk(*x, cached=True),
+        lambda *x: source.sign.crypto_sign_verify_detached(*x, workspace=True)
+    )
+
+    for key, verify in itertools.product(args, verifiers):
+        args[key] = corrupt(args[key], (1,))
+
+        try:
+            verify(*[args[x] for x in args])
+            error = "crypto_sign_verify_detached() succeeded when it should "
+            assert False, error + "fail."
+        except ValueError:
+            pass
+
+        args[key] = corrupt(args[key], (1,), reverse=True)
+        verify(*[args[x] for x in args])
+
+    # S + L is the same scalar mod L, but RFC 8032 requires S < L.
+    order = 2**252 + 27742317777372353535851937790883648493
+    high = int.from_bytes(signature[32:], 'little') + order
+    malleated = signature[0:32] + high.to_bytes(32, 'little')
+
+    for verify in verifiers:
+        try:
+            verify(malleated, msg, public)
+            assert False, "Non-canonical signature was accepted."
+        except ValueError:
+            pass
+
+    # Cycle more keys than the cache has slots through it, mixed with
+    # repeated lookups of the same key.
+    for _ in range(8):
+        other_public, other_secret = source.sign.crypto_sign_keypair()
+        other = source.sign.crypto_sign_detached(msg, other_secret)
+        for sig, key in ((other, other_public), (signature, public)):
+            source.sign.crypto_sign_verify_detached_vk(sig, msg, key, True)
 
     args = {'signed': signed, 'public': public}
 
@@ -279,6 +350,174 @@ def verify_crypto_sign(source, data, keys):
         source.sign.crypto_sign_open(*[args[x] for x in args])
 
 
+def verify_crypto_sign_batch(source, data, keys):
+    """ Verifies batch signing and verification. Checks that crypto_sign_many()
+    matches one-at-a-time signing, that a batch of valid signatures passes,
+    and that corrupted entries are identified exactly. """
+
+    msg = data['sign']['msg']
+    secret = keys['sign']['secret']
+    public = keys['sign']['public']
+    other_public, other_secret = source.sign.crypto_sign_keypair()
+
+    count = 37
+    messages = [msg[0:(x * 7) % (len(msg) + 1)] for x in range(count)]
+    secrets = [(secret, other_secret)[x % 3 == 0] for x in range(count)]
+    publics = [(public, other_public)[x % 3 == 0] for x in range(count)]
+    signatures = [source.sign.crypto_sign_detached(m, k)
+                  for m, k in zip(messages, secrets)]
+
+    results = source.sign.crypto_sign_verify_batch(signatures, messages,
+                                                   publics)
+    assert results == [0] * count
+
+    for threads in (0, 1, 3):
+        signed = source.sign.crypto_sign_many(messages, secret, threads)
+        assert signed == [source.sign.crypto_sign_detached(x, secret)
+                          for x in messages]
+
+    assert source.sign.crypto_sign_many([], secret) == []
+    assert source.sign.crypto_sign_verify_batch([], [], []) == []
+    assert source.sign.crypto_sign_verify_batch(signatures[0:1], messages[0:1],
+                                                 publics[0:1]) == [0]
+
+    bad = {3, 16, 17, 36}
+    signatures[3] = corrupt(signatures[3], (1,))
+    signatures[16] = corrupt(signatures[16], (40,))
+    messages[17] = messages[17] + b'x'
+    publics[36] = publics[35]
+
+    results = source.sign.crypto_sign_verify_batch(signatures, messages,
+                                                   publics)
+    assert [x for x in range(count) if results[x] != 0] == sorted(bad)
+
+    # A signature whose R carries the order-2 point (0, -1). Single and batch
+    # verification both check the equation multiplied by the cofactor, so
+    # both accept it, whether or not its group fails.
+    a = random.randrange(1, ED25519_L)
+    r = random.randrange(1, ED25519_L)
+    public = reference_ed25519_encode(reference_ed25519_mul(a, ED25519_B))
+    point = reference_ed25519_add(reference_ed25519_mul(r, ED25519_B),
+                                  (0, ED25519_P - 1))
+    encoded = reference_ed25519_encode(point)
+    msg = b'small-order component'
+    h = int.from_bytes(hashlib.sha512(encoded + public + msg).digest(),
+                       'little') % ED25519_L
+    torsion = encoded + ((r + h * a) % ED25519_L).to_bytes(32, 'little')
+
+    source.sign.crypto_sign_verify_detached(torsion, msg, public)
+
+    for extra in ([], [(corrupt(signatures[0], (40,)), messages[0],
+                        publics[0])]):
+        batch = [(torsion, msg, public)] + list(zip(signatures[0:3],
+                                                    messages[0:3],
+                                                    publics[0:3])) + extra
+        results = source.sign.crypto_sign_verify_batch(*zip(*batch))
+        assert results[0:4] == [0] * 4
+        assert [x != 0 for x in results[4:]] == [True] * len(extra)
+
+    # R must be a canonical encoding, in single and batch verification: y
+    # below 2^255 - 19, and no sign bit when x is 0.
+    for encoded in (b'\x01' + bytes(30) + b'\x80',
+                    b'\xec' + b'\xff' * 30 + b'\xff',
+                    b'\xed' + b'\xff' * 30 + b'\x7f'):
+        forged = encoded + signatures[1][32:]
+        results = source.sign.crypto_sign_verify_batch(
+            [forged, signatures[0]], messages[1:2] + messages[0:1],
+            publics[1:2] + publics[0:1])
+        assert results == [-1, 0]
+
+        try:
+            source.sign.crypto_sign_verify_detached(forged, messages[1],
+                                                    publics[1])
+            assert False, "single verification accepted a non-canonical R"
+        except ValueError:
+            pass
+
+
+ED25519_P = 2**255 - 19
+ED25519_L = 2**252 + 27742317777372353535851937790883648493
+ED25519_D = -121665 * pow(121666, ED25519_P - 2, ED25519_P) % ED25519_P
+ED25519_B = (
+    0x216936d3cd6e53fec0a4e231fdd6dc5c692cc7609525a7b2c9562d608f25d51a,
+    4 * pow(5, ED25519_P - 2, ED25519_P) % ED25519_P)
+
+
+def reference_ed25519_add(a, b):
+    """ Pure-python model of Edwards25519 point addition, in affine
+    coordinates. """
+
+    t = ED25519_D * a[0] * b[0] * a[1] * b[1]
+    x = (a[0] * b[1] + b[0] * a[1]) * pow(1 + t, ED25519_P - 2, ED25519_P)
+    y = (a[1] * b[1] + a[0] * b[0]) * pow(1 - t, ED25519_P - 2, ED25519_P)
+    return (x % ED25519_P, y % ED25519_P)
+
+
+def reference_ed25519_mul(k, point):
+    """ Pure-python model of Edwards25519 scalar multiplication. """
+
+    result = (0, 1)
+
+    while k > 0:
+        if k & 1:
+            result = reference_ed25519_add(result, point)
+
+        point = reference_ed25519_add(point, point)
+        k >>= 1
+
+    return result
+
+
+def reference_ed25519_encode(point):
+    """ Encodes a point as y with the parity of x in the top bit. """
+
+    return (point[1] | ((point[0] & 1) << 255)).to_bytes(32, 'little')
+
+
+def verify_crypto_sign_ph(source, data, keys):
+    """ Verifies the streaming Ed25519ph portion of the library against the
+    RFC 8032 test vector, and checks that the result doesn't depend on how the
+    message is split up. """
+
+    secret = bytes.fromhex(
+        '833fe62409237b9d62ec77587520911e9a759cec1d19755b7da901b96dca3d42'
+        'ec172b93ad5e563bf4932c70e1245034c35467ef2efd4d64ebf819683467e2bf'
+    )
+    expected = bytes.fromhex(
+        '98a70222f0b8121aa9d30f813d683f809e462b469c7ff87639499bb94e6dae41'
+        '31f85042463c2a355a2003d062adf5aaa10b8c61e636062aaad11c2a26083406'
+    )
+    public = secret[32:]
+
+    assert source.sign.crypto_sign_ph(b'abc', secret, 1) == expected
+    source.sign.crypto_sign_ph_verify(expected, b'abc', public, 2)
+
+    msg = data['sign']['msg']
+    secret = keys['sign']['secret']
+    public = keys['sign']['public']
+    signature = source.sign.crypto_sign_ph(msg, secret, len(msg))
+    assert signature != source.sign.crypto_sign_detached(msg, secret)
+
+    for step in (1, 127, 128, 129):
+        assert source.sign.crypto_sign_ph(msg, secret, step) == signature
+        source.sign.crypto_sign_ph_verify(signature, msg, public, step)
+
+    args = {'signature': signature, 'msg': msg, 'public': public}
+
+    for key in args:
+        args[key] = corrupt(args[key], (1,))
+
+        try:
+            source.sign.crypto_sign_ph_verify(*[args[x] for x in args], 64)
+            error = "crypto_sign_final_verify() succeeded when it should fail."
+            assert False, error
+        except ValueError:
+            pass
+
+        args[key] = corrupt(args[key], (1,), reverse=True)
+        source.sign.crypto_sign_ph_verify(*[args[x] for x in args], 64)
+
+
 def verify_crypto_secretbox(source, data, keys):
     """ Verifies the crypto_secretbox() portion of the nacl library. Tests the
     'secretbox' data and keys against a crypto-source. Also checks to make sure
@@ -294,6 +533,24 @@ def verify_crypto_secretbox(source, data, keys):
     assert readback == data['secretbox']['cypher']
     assert msg == source.secretbox.crypto_secretbox_open(cypher, key, nonce)
 
+    # The detached form must match the padded one on either side of the
+    # 32-byte head and the 64-byte block boundaries.
+    for length in (0, 1, 31, 32, 33, 95, 96, 97, 200):
+        text = bytes(range(length))
+        padded = source.secretbox.crypto_secretbox(text, key, nonce)[0]
+        detached = source.secretbox.crypto_secretbox_detached(text, key, nonce)
+        assert detached == padded
+        readback = source.secretbox.crypto_secretbox_open_detached(detached,
+                                                                   key, nonce)
+        assert readback == text
+
+        try:
+            source.secretbox.crypto_secretbox_open_detached(
+                corrupt(detached, (0,)), key, nonce)
+            assert False, "crypto_secretbox_open_detached() accepted a forgery"
+        except ValueError:
+            pass
+
     args = {'cypher': cypher, 'key': key, 'nonce': nonce}
 
     for key in args:
@@ -309,6 +566,79 @@ def verify_crypto_secretbox(source, data, keys):
         args[key] = corrupt(args[key], (1,), reverse=True)
         source.secretbox.crypto_secretbox_open(*[args[x] for x in args])
 
+    if source.secretbox.has_crypto_nonce_seq():
+        verify_crypto_nonce_seq(source.secretbox, keys['secretbox'])
+
+
+def verify_crypto_nonce_seq(secretbox, key):
+    """ Checks the counter-based nonce sequencer: nonces share a prefix and
+    count up, sequenced boxes open with the plain API, and the receiver
+    accepts out-of-order counters inside its window but rejects replays,
+    counters behind the window, foreign prefixes and counter overflow. """
+
+    seq = secretbox.crypto_nonce_seq()
+    first = secretbox.crypto_nonce_seq_next(seq)
+    second = secretbox.crypto_nonce_seq_next(seq)
+    assert first[0:16] == second[0:16]
+    assert int.from_bytes(first[16:24], 'big') == 0
+    assert int.from_bytes(second[16:24], 'big') == 1
+
+    msgs = [bytes([x]) * (x * 7) for x in range(3)]
+    boxes = [secretbox.crypto_secretbox_seq(x, key, seq) for x in msgs]
+
+    for msg, (cypher, nonce) in zip(msgs, boxes):
+        assert nonce[0:16] == first[0:16]
+        assert secretbox.crypto_secretbox_open(cypher, key, nonce) == msg
+
+    def opens(box, check):
+        try:
+            secretbox.crypto_secretbox_open_seq(box[0], key, box[1], check)
+            return True
+        except ValueError:
+            return False
+
+    # Out-of-order counters inside the window are accepted once each.
+    check = secretbox.crypto_nonce_check(first[0:16])
+    cypher, nonce = boxes[1]
+    readback = secretbox.crypto_secretbox_open_seq(cypher, key, nonce, check)
+    assert readback == msgs[1]
+    assert opens(boxes[0], check)
+    assert not opens(boxes[0], check) and not opens(boxes[1], check)
+    assert opens(boxes[2], check) and not opens(boxes[2], check)
+
+    # Counters 3 .. 3 + window: open the newest first, then the rest in
+    # reverse. The oldest is one past the window and is rejected.
+    window = secretbox.crypto_nonce_WINDOW
+    late = [secretbox.crypto_secretbox_seq(b'late', key, seq)
+            for _ in range(window + 1)]
+    assert opens(late[-1], check)
+    assert all(opens(x, check) for x in late[-2:0:-1])
+    assert not opens(late[0], check)
+    assert not any(opens(x, check) for x in late[1:])
+
+    # A jump far ahead drops the whole window.
+    ahead = secretbox.crypto_nonce_check(first[0:16])
+    assert opens(late[-1], ahead) and not opens(boxes[2], ahead)
+
+    other = secretbox.crypto_nonce_check(bytes(16))
+    try:
+        secretbox.crypto_secretbox_open_seq(cypher, key, nonce, other)
+        assert False, "crypto_secretbox_open_seq() accepted a foreign prefix."
+    except ValueError:
+        pass
+
+    # The counter is stored after the 16-byte prefix in host order.
+    ctypes.memmove(ctypes.addressof(seq) + 16,
+                   (2**64 - 2).to_bytes(8, sys.byteorder), 8)
+    last = secretbox.crypto_nonce_seq_next(seq)
+    assert int.from_bytes(last[16:24], 'big') == 2**64 - 2
+
+    try:
+        secretbox.crypto_nonce_seq_next(seq)
+        assert False, "crypto_nonce_seq_next() wrapped its counter."
+    except ValueError:
+        pass
+
 
 def verify_crypto_stream(source, data, keys):
     """ Verifies the crypto_stream() portion of the nacl library. Tests the
@@ -352,6 +682,40 @@ def verify_crypto_stream(source, data, keys):
         result = source.stream.crypto_stream_xor(*[args[x] for x in args])[0]
         assert result == cypher
 
+    # Whole blocks may go through a multi-block kernel while the tail goes
+    # through the portable core; every split must agree with one long stream.
+    full = source.stream.crypto_stream(1100, keys['stream'], nonce)[0]
+
+    for length in itertools.chain(range(0, 70), range(120, 1100, 61)):
+        result = source.stream.crypto_stream(length, keys['stream'], nonce)[0]
+        assert result == full[0:length]
+
+    if source.misc.has_implementation_info():
+        info = source.misc.implementation_info()
+        assert info['backend'] in ('portable', 'sse2', 'bmi2')
+        assert info['profile'] in ('small', 'balanced', 'fast')
+
+        if info['profile'] == 'small':
+            assert info['backend'] == 'portable'
+
+        if info['backend'] == 'bmi2':
+            assert info['salsa20'] == 'sse2'
+            assert info['poly1305'] == 'bmi2'
+
+        for key in ('salsa20', 'poly1305', 'sha512', 'field'):
+            assert info[key] in ('portable', 'sse2', info['backend'])
+
+        # 'make check' runs the suite again with each backend forced, so the
+        # kernels the CPU wouldn't pick are covered too.
+        forced = os.environ.get('SALINE_IMPL')
+        sse2 = 1  # saline_cpu_SSE2
+
+        if forced == 'portable':
+            assert info['backend'] == 'portable'
+        elif forced == 'sse2' and info['profile'] != 'small' and \
+                info['cpu_features'] & sse2:
+            assert info['backend'] == 'sse2'
+
 
 def verify_crypto_auth(source, data, keys):
     """ Verifies the crypto_auth() portion of the nacl library. Tests the
@@ -362,6 +726,24 @@ def verify_crypto_auth(source, data, keys):
     readback = source.auth.crypto_auth(msg, keys['auth'])
     assert readback == data['auth']['auth']
     source.auth.crypto_auth_verify(msg, data['auth']['auth'], keys['auth'])
+    readback = source.auth.crypto_auth_with_ctx(msg, keys['auth'])
+    assert readback == data['auth']['auth']
+    source.auth.crypto_auth_verify_with_ctx(msg, data['auth']['auth'],
+                                            keys['auth'])
+
+    for length in (0, 1, 111, 112, 127, 128, 129, 240):
+        expected = source.auth.crypto_auth(msg[0:length], keys['auth'])
+        result = source.auth.crypto_auth_with_ctx(msg[0:length], keys['auth'])
+        assert result == expected
+
+    for step in (1, 7, 127, 128, 129, len(msg)):
+        result = source.auth.crypto_auth_stream(msg, keys['auth'], step)
+        assert result == data['auth']['auth']
+        assert source.auth.crypto_auth_stream_verify(msg, result, keys['auth'],
+                                                     step, throw=False)
+        assert not source.auth.crypto_auth_stream_verify(
+            corrupt(msg, (1,)), result, keys['auth'], step, throw=False
+        )
 
     args = {'msg': msg, 'auth': data['auth']['auth'], 'key': keys['auth']}
 
@@ -375,6 +757,14 @@ def verify_crypto_auth(source, data, keys):
         except ValueError:
             pass
 
+        try:
+            source.auth.crypto_auth_verify_with_ctx(*[args[x] for x in args])
+            msg = "crypto_auth_verify_with_ctx() succeeded when it should "
+            msg += "fail."
+            assert False, msg
+        except ValueError:
+            pass
+
         args[key] = corrupt(args[key], (1,), reverse=True)
         source.auth.crypto_auth_verify(*[args[x] for x in args])
 
@@ -408,6 +798,232 @@ def verify_crypto_onetimeauth(source, data, keys):
         args[key] = corrupt(args[key], (1,), reverse=True)
         source.onetimeauth.crypto_onetimeauth_verify(*[args[x] for x in args])
 
+    # Every tail length, and keys and messages of all ones, which drive the
+    # accumulator close to 2^130 - 5 and so exercise the carries and the
+    # final reduction of whichever kernel the dispatch chose.
+    ones = b'\xff' * 300
+
+    for key in (keys['onetimeauth'], ones[0:32], random_message(32)):
+        for length in itertools.chain(range(0, 70), (127, 128, 129, 300)):
+            for msg in (ones[0:length], random_message(length)):
+                readback = source.onetimeauth.crypto_onetimeauth(msg, key)
+                assert readback == reference_poly1305(msg, key)
+
+
+def reference_poly1305(msg, key):
+    """ Pure-python model of Poly1305 (RFC 8439, section 2.5). """
+
+    r = int.from_bytes(key[0:16], 'little')
+    r &= 0x0ffffffc0ffffffc0ffffffc0fffffff
+    s = int.from_bytes(key[16:32], 'little')
+    p = (1 << 130) - 5
+    h = 0
+
+    for i in range(0, len(msg), 16):
+        block = msg[i:i + 16] + b'\x01'
+        h = ((h + int.from_bytes(block, 'little')) * r) % p
+
+    return ((h + s) & ((1 << 128) - 1)).to_bytes(16, 'little')
+
+
+def reference_hash_tree(msg, chunk_length):
+    """ Pure-python model of the documented crypto_hash_tree() layout. """
+
+    sha512 = lambda x: hashlib.sha512(x).digest()
+    offsets = range(0, max(len(msg), 1), chunk_length)
+    level = [sha512(b'\x00' + msg[x:x + chunk_length]) for x in offsets]
+
+    while len(level) > 1:
+        pairs = [sha512(b'\x01' + level[x] + level[x + 1])
+                 for x in range(0, len(level) - 1, 2)]
+        level = pairs + level[len(pairs) * 2:]
+
+    sizes = len(msg).to_bytes(8, 'big') + chunk_length.to_bytes(8, 'big')
+    return sha512(b'\x02' + level[0] + sizes)
+
+
+def verify_crypto_hash(source, data):
+    """ Verifies the crypto_hash() portion of the nacl library. Tests the
+    'hash' data against a crypto-source, and checks that crypto_hash_many()
+    agrees with crypto_hash() for a spread of message lengths. """
+
+    msg = data['hash']['msg']
+    assert source.misc.crypto_hash(msg) == data['hash']['hash']
+
+    lengths = [0, 1, 111, 112, 127, 128, 129, 239, 240, 256, 1000, len(msg)]
+    messages = [msg[0:x] for x in lengths]
+    expected = [source.misc.crypto_hash(x) for x in messages]
+    assert [source.misc.crypto_hash(x, True) for x in messages] == expected
+    assert source.misc.crypto_hash_many(messages) == expected
+    assert source.misc.crypto_hash_many(messages[::-1]) == expected[::-1]
+    assert source.misc.crypto_hash_many(messages[0:1]) == expected[0:1]
+    assert source.misc.crypto_hash_many([]) == []
+
+    for step in (1, 7, 127, 128, 129, len(msg)):
+        assert source.misc.crypto_hash_stream(msg, step) == expected[-1]
+
+    if source.misc.has_crypto_hash_tree():
+        for chunk in (1, 64, 111, 127, 128, 200, len(msg), len(msg) + 1):
+            for length in (0, 1, 128, 129, len(msg)):
+                expected = reference_hash_tree(msg[0:length], chunk)
+                for threads in (0, 1, 3):
+                    result = source.misc.crypto_hash_tree(msg[0:length], chunk,
+                                                          threads)
+                    assert result == expected
+
+
+def verify_saline_stats(source, keys):
+    """ Checks the --enable-stats counters against work with a known cost,
+    including work done on the tree hash's worker threads. Skipped when the
+    counters are compiled out. """
+
+    misc = source.misc
+
+    if not misc.has_stats():
+        return
+
+    misc.stats_reset()
+    misc.crypto_hash(bytes(1000))
+    stats = misc.stats_snapshot()
+    assert stats['hash'] == (1, 1000)
+    assert stats['sha512_blocks'] == 8
+
+    misc.stats_reset()
+    source.stream.crypto_stream(200, keys['stream'], bytes(24))
+    stats = misc.stats_snapshot()
+    assert stats['stream'] == (1, 200)
+    assert stats['salsa20_blocks'] == 1 + 4
+
+    misc.stats_reset()
+    source.onetimeauth.crypto_onetimeauth(bytes(100), keys['onetimeauth'])
+    stats = misc.stats_snapshot()
+    assert stats['onetimeauth'] == (1, 100)
+    assert stats['poly1305_blocks'] == 7
+
+    misc.stats_reset()
+    source.scalarmult.crypto_scalarmult_base(bytes(range(32)))
+    stats = misc.stats_snapshot()
+    assert stats['scalarmult'][0] == 1
+    assert stats['field_inversions'] == 1
+    assert stats['field_multiplications'] > 255 * 10
+
+    # Four 1000-byte leaves, each with its one-byte prefix, hashed on four
+    # threads, then three 129-byte interior and root nodes; the exited
+    # workers' counts must survive.
+    misc.stats_reset()
+    misc.crypto_hash_tree(bytes(4000), 1000, 4)
+    stats = misc.stats_snapshot()
+    assert stats['hash_tree'] == (1, 4000)
+    assert stats['hash_many'][1] == 4004 + 3 * 129
+
+    misc.stats_reset()
+    assert misc.stats_snapshot() == {x: 0 if x in misc.STATS_WORK else (0, 0)
+                                     for x in stats}
+
+
+def verify_saline_async(source, data, keys):
+    """ Runs one job of each kind, plus a failing open and tree hashes big
+    enough to split, through the saline_async pool and checks them against
+    the synchronous calls. Skipped when saline is built without threads. """
+
+    misc = source.misc
+
+    if not misc.has_async():
+        return
+
+    box, sign = keys['box'], keys['sign']
+    boxed = bytes(16) + data['box']['cypher']
+    sealed = bytes(16) + data['secretbox']['cypher']
+    big = bytes(range(256)) * 1000
+    jobs = [
+        {'op': 'BOX', 'in': bytes(32) + data['box']['msg'],
+         'out_size': len(boxed), 'nonce': data['box']['nonce'],
+         'key': box['sender']['secret'],
+         'peer_key': box['receiver']['public']},
+        {'op': 'BOX_OPEN', 'in': boxed, 'out_size': len(boxed),
+         'nonce': data['box']['nonce'], 'key': box['receiver']['secret'],
+         'peer_key': box['sender']['public']},
+        {'op': 'BOX_OPEN', 'in': corrupt(boxed, (20,)),
+         'out_size': len(boxed), 'nonce': data['box']['nonce'],
+         'key': box['receiver']['secret'],
+         'peer_key': box['sender']['public']},
+        {'op': 'SECRETBOX', 'in': bytes(32) + data['secretbox']['msg'],
+         'out_size': len(sealed), 'nonce': data['secretbox']['nonce'],
+         'key': keys['secretbox']},
+        {'op': 'SECRETBOX_OPEN', 'in': sealed, 'out_size': len(sealed),
+         'nonce': data['secretbox']['nonce'], 'key': keys['secretbox']},
+        {'op': 'SIGN', 'in': data['sign']['msg'],
+         'out_size': len(data['sign']['signed']), 'key': sign['secret']},
+        {'op': 'SIGN_OPEN', 'in': data['sign']['signed'],
+         'out_size': len(data['sign']['signed']), 'key': sign['public']},
+        {'op': 'HASH', 'in': big, 'out_size': 64},
+        {'op': 'HASH', 'in': big, 'out_size': 64, 'chunk': 1000},
+        {'op': 'HASH', 'in': big, 'out_size': 64, 'chunk': 65536},
+        {'op': 'HASH', 'in': b'', 'out_size': 64, 'chunk': 1000}
+    ]
+
+    expected = [
+        (0, bytes(16) + data['box']['cypher']),
+        (0, bytes(32) + data['box']['msg']),
+        (-1, None),
+        (0, bytes(16) + data['secretbox']['cypher']),
+        (0, bytes(32) + data['secretbox']['msg']),
+        (0, data['sign']['signed']),
+        (0, data['sign']['msg']),
+        (0, misc.crypto_hash(big)),
+        (0, misc.crypto_hash_tree(big, 1000)),
+        (0, misc.crypto_hash_tree(big, 65536)),
+        (0, misc.crypto_hash_tree(b'', 1000))
+    ]
+
+    for threads in (1, 4):
+        results = misc.async_run(jobs * 3, threads)
+        assert results is not None
+
+        for (result, out), (want, output) in zip(results, expected * 3):
+            assert result == want
+            assert output is None or out == output
+
+
+def verify_saline_arena(source, keys):
+    """ Fills a small arena, checks slot layout and zeroing, and checks that
+    freed slots are wiped and bad frees are refused. Skipped when the slab
+    can't be locked, e.g. under a tight RLIMIT_MEMLOCK. """
+
+    misc = source.misc
+
+    if not misc.has_arena():
+        return
+
+    arena = misc.arena_create(40, 100)
+
+    if arena is None:
+        return
+
+    slots = [misc.arena_alloc(arena) for _ in range(100)]
+    assert None not in slots and misc.arena_alloc(arena) is None
+    assert sorted(y - x for x, y in zip(sorted(slots), sorted(slots)[1:])) \
+        == [48] * 99
+    assert all(x % 16 == 0 and ctypes.string_at(x, 48) == bytes(48)
+               for x in slots)
+
+    secret = keys['secretbox']
+    ctypes.memmove(slots[7], secret, len(secret))
+    assert ctypes.string_at(slots[7], len(secret)) == secret
+    assert misc.arena_free(arena, slots[7]) == 0
+    assert misc.arena_free(arena, slots[7]) == -1
+    assert misc.arena_free(arena, slots[8] + 1) == -1
+    assert misc.arena_free(arena, None) == -1
+
+    again = misc.arena_alloc(arena)
+    assert again == slots[7] and ctypes.string_at(again, 48) == bytes(48)
+    assert misc.arena_alloc(arena) is None
+
+    for slot in slots:
+        assert misc.arena_free(arena, slot) == 0
+
+    misc.arena_destroy(arena)
+
 
 def verify_data(source, data, keys):
     """ Verifies a block of generated data using a batch of pre-existing keys.
@@ -416,10 +1032,16 @@ def verify_data(source, data, keys):
     verify_crypto_box(source, data, keys)
     verify_crypto_scalarmult(source, data)
     verify_crypto_sign(source, data, keys)
+    verify_crypto_sign_batch(source, data, keys)
+    verify_crypto_sign_ph(source, data, keys)
     verify_crypto_secretbox(source, data, keys)
     verify_crypto_stream(source, data, keys)
     verify_crypto_auth(source, data, keys)
     verify_crypto_onetimeauth(source, data, keys)
+    verify_crypto_hash(source, data)
+    verify_saline_stats(source, keys)
+    verify_saline_async(source, data, keys)
+    verify_saline_arena(source, keys)
 
 
 def main():
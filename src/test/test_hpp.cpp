@@ -0,0 +1,108 @@
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include "saline.hpp"
+
+/* Checks that saline.hpp produces the same bytes as the C API it wraps, and
+ * that its key types behave as documented. Run by 'make check' when the
+ * compiler supports C++20. */
+
+static_assert(!std::is_copy_constructible_v<saline::secretbox_key>);
+static_assert(!std::is_copy_assignable_v<saline::secretbox_key>);
+static_assert(std::is_nothrow_move_constructible_v<saline::secretbox_key>);
+static_assert(!std::is_convertible_v<saline::box_secret_key,
+                                     saline::secretbox_key>);
+static_assert(saline::secretbox_mac_bytes ==
+              crypto_secretbox_ZEROBYTES - crypto_secretbox_BOXZEROBYTES);
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        std::printf("test_hpp: %s failed\n", what);
+        ++failures;
+    }
+}
+
+int main()
+{
+    std::array<unsigned char, 32 + 100> padded = {};
+    std::array<unsigned char, 32 + 100> boxed = {};
+    std::array<unsigned char, 16 + 100> combined = {};
+    std::array<unsigned char, 100> plain = {};
+    std::array<unsigned char, 24> nonce = {};
+    std::array<unsigned char, 32> raw = {};
+    saline::bytes msg(padded.data() + 32, 100);
+
+    for (std::size_t i = 0; i < 100; ++i) {
+        padded[32 + i] = static_cast<unsigned char>(i * 7);
+    }
+
+    raw.fill(0x42);
+    nonce.fill(0x24);
+
+    saline::secretbox_key key(raw);
+    crypto_secretbox(boxed.data(), padded.data(), padded.size(), nonce.data(),
+                     raw.data());
+
+    check(saline::secretbox(combined, msg, nonce, key) == 0 &&
+          std::memcmp(combined.data(), boxed.data() + 16, 116) == 0,
+          "secretbox matches crypto_secretbox");
+    check(saline::secretbox_open(plain, combined, nonce, key) == 0 &&
+          std::memcmp(plain.data(), msg.data(), 100) == 0,
+          "secretbox_open");
+    check(saline::secretbox(saline::mutable_bytes(combined).first(100), msg,
+                            nonce, key) == -1,
+          "secretbox rejects a short output");
+
+    combined[20] ^= 1;
+    check(saline::secretbox_open(plain, combined, nonce, key) == -1,
+          "secretbox_open rejects a forgery");
+
+    saline::secretbox_key moved(std::move(key));
+    check(std::memcmp(moved.data(), raw.data(), 32) == 0 &&
+          key.data()[0] == 0 && key.data()[31] == 0,
+          "a moved key is transferred and wiped");
+
+    saline::box_public_key alice_pk, bob_pk;
+    saline::box_secret_key alice_sk, bob_sk;
+    saline::box_shared_key shared;
+
+    check(saline::box_keypair(alice_pk, alice_sk) == 0 &&
+          saline::box_keypair(bob_pk, bob_sk) == 0, "box_keypair");
+    crypto_box(boxed.data(), padded.data(), padded.size(), nonce.data(),
+               bob_pk.data(), alice_sk.data());
+
+    check(saline::box(combined, msg, nonce, bob_pk, alice_sk) == 0 &&
+          std::memcmp(combined.data(), boxed.data() + 16, 116) == 0,
+          "box matches crypto_box");
+    check(saline::box_open(plain, combined, nonce, alice_pk, bob_sk) == 0 &&
+          std::memcmp(plain.data(), msg.data(), 100) == 0, "box_open");
+    check(saline::box_beforenm(shared, alice_pk, bob_sk) == 0 &&
+          saline::box_open_afternm(plain, combined, nonce, shared) == 0,
+          "box_open_afternm");
+
+    saline::sign_public_key sign_pk;
+    saline::sign_secret_key sign_sk;
+    std::array<unsigned char, 64 + 100> signed_msg;
+    saline::bytes opened;
+
+    check(saline::sign_keypair(sign_pk, sign_sk) == 0 &&
+          saline::sign(signed_msg, msg, sign_sk) == 0, "sign");
+    check(saline::sign_open(opened, signed_msg, sign_pk) == 0 &&
+          opened.data() == signed_msg.data() + 64 && opened.size() == 100,
+          "sign_open returns a view into its input");
+
+    signed_msg[70] ^= 1;
+    check(saline::sign_open(opened, signed_msg, sign_pk) == -1,
+          "sign_open rejects a forgery");
+
+    if (failures == 0) {
+        std::printf("test_hpp: all tests passed\n");
+    }
+
+    return failures != 0;
+}
@@ -0,0 +1,145 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "randombytes.h"
+#include "saline.h"
+#include "saline_hooks.h"
+
+/* Checks the getrandom-buffered generator, which this program is built with
+ * whatever --with-rand chose: its output from a fixed key against XSalsa20
+ * computed independently, the key and buffer erasure, and that a child after
+ * fork() doesn't repeat its parent. Run by 'make check' when the host has
+ * getrandom(). */
+
+static const uint8_t next_key[32] = {
+    0xa1, 0x41, 0xcb, 0x32, 0x46, 0xc2, 0xdd, 0x6b,
+    0xfb, 0xb8, 0xae, 0xdf, 0xae, 0xe2, 0xca, 0xf0,
+    0xd6, 0xc7, 0xd5, 0xfd, 0x72, 0xab, 0xfc, 0xa1,
+    0xee, 0x1c, 0xbb, 0xbd, 0x94, 0x05, 0x8d, 0xdc
+};
+
+static const uint8_t first_output[32] = {
+    0x4a, 0x0e, 0xf0, 0x41, 0x98, 0xaa, 0xbf, 0x33,
+    0x5c, 0x54, 0x72, 0x0f, 0x25, 0x46, 0xbe, 0xd2,
+    0xe4, 0x34, 0x74, 0xf0, 0x47, 0xe6, 0x28, 0x4c,
+    0x6b, 0x03, 0x4b, 0x8d, 0x3c, 0xc9, 0xdf, 0x32
+};
+
+static const uint8_t second_output[32] = {
+    0x04, 0x15, 0x0c, 0x08, 0x43, 0x49, 0x39, 0x48,
+    0x4f, 0x5b, 0x7d, 0x9a, 0xaf, 0x88, 0xed, 0x48,
+    0x20, 0x18, 0xb0, 0x25, 0x10, 0xde, 0x2a, 0x6f,
+    0xd4, 0xb8, 0xc6, 0x82, 0x8c, 0x97, 0x68, 0x01
+};
+
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("test_rand: %s failed\n", what);
+        ++failures;
+    }
+}
+
+static int is_zero(const uint8_t *p, size_t n)
+{
+    uint8_t bits = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        bits |= p[i];
+    }
+
+    return bits == 0;
+}
+
+static void seed(uint8_t *key)
+{
+    for (int i = 0; i < 32; ++i) {
+        key[i] = (uint8_t) i;
+    }
+
+    saline_hook_rng_seed(key);
+}
+
+static void test_known_answer(void)
+{
+    static const uint8_t nonce[crypto_stream_NONCEBYTES] = {0};
+    uint8_t block[32 + SALINE_HOOK_RNG_BUFFER];
+    uint8_t buffer[SALINE_HOOK_RNG_BUFFER];
+    uint8_t rest[SALINE_HOOK_RNG_BUFFER - 32];
+    uint8_t out[32], key[32];
+
+    seed(key);
+    crypto_stream(block, sizeof(block), nonce, key);
+    randombytes(out, sizeof(out));
+    saline_hook_rng_state(key, buffer);
+
+    check(memcmp(out, first_output, 32) == 0, "first refill output");
+    check(memcmp(key, next_key, 32) == 0, "key replaced on refill");
+    check(is_zero(buffer, 32), "returned output wiped");
+    check(memcmp(buffer + 32, block + 64, sizeof(rest)) == 0,
+          "buffer holds the rest of the stream");
+
+    randombytes(rest, sizeof(rest));
+    saline_hook_rng_state(key, buffer);
+
+    check(memcmp(rest, block + 64, sizeof(rest)) == 0,
+          "rest of the first refill");
+    check(is_zero(buffer, sizeof(buffer)), "drained buffer wiped");
+    check(memcmp(key, next_key, 32) == 0, "key kept until the next refill");
+
+    randombytes(out, sizeof(out));
+    saline_hook_rng_state(key, buffer);
+
+    check(memcmp(out, second_output, 32) == 0, "second refill output");
+    check(memcmp(key, next_key, 32) != 0 && !is_zero(key, 32),
+          "key replaced on the second refill");
+}
+
+static void test_fork(void)
+{
+    uint8_t parent[32], child[32];
+    int fds[2], status;
+    uint8_t key[32];
+    pid_t pid;
+
+    seed(key);
+
+    if (pipe(fds) != 0 || (pid = fork()) < 0) {
+        check(0, "fork");
+        return;
+    }
+
+    if (pid == 0) {
+        randombytes(child, sizeof(child));
+        _exit(write(fds[1], child, sizeof(child)) == 32 ? 0 : 1);
+    }
+
+    close(fds[1]);
+    randombytes(parent, sizeof(parent));
+
+    check(read(fds[0], child, sizeof(child)) == 32 &&
+          waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+          WEXITSTATUS(status) == 0, "child output");
+    check(memcmp(parent, first_output, 32) == 0, "parent keeps its key");
+    check(memcmp(child, parent, 32) != 0, "child reseeds after fork");
+
+    close(fds[0]);
+}
+
+int main(void)
+{
+    test_known_answer();
+    test_fork();
+
+    if (failures != 0) {
+        return 1;
+    }
+
+    printf("test_rand: all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,34 @@
+#ifndef _TREEHASH_H_
+#define _TREEHASH_H_
+
+#include <stdint.h>
+
+/* The pieces of crypto_hash_tree(), for callers that schedule the leaves
+ * themselves. */
+
+struct saline_tree {
+    unsigned char *hashes;
+    const unsigned char *msg;
+    unsigned long long length;
+    unsigned long long chunk;
+};
+
+unsigned long long saline_tree_init(struct saline_tree *tree,
+                                    const unsigned char *msg,
+                                    unsigned long long length,
+                                    unsigned long long chunk);
+
+void saline_tree_hash_leaves(void *tree, uint64_t begin, uint64_t end);
+
+/* crypto_hash_many() over prefix || m[i], reading each message in place.
+ * Defined in saline.c; it hashes the 0x00-prefixed leaves. */
+
+int saline_hash_many_prefixed(unsigned char *out, unsigned char prefix,
+                              const unsigned char *const *m,
+                              const unsigned long long *n,
+                              unsigned long long count);
+
+int saline_tree_finish(unsigned char out[64], struct saline_tree *tree,
+                       unsigned long long count);
+
+#endif